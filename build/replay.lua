@@ -0,0 +1,78 @@
+local engine_paths = require "common"
+
+project "Ader2_Replay"
+	location (engine_paths.project .. "/Ader2_Replay")
+	kind "ConsoleApp"
+	language "C++"	
+	cppdialect "C++17"
+	staticruntime "on"
+
+	debugdir (engine_paths.out_target)
+
+	targetdir (engine_paths.out_target)
+	objdir (engine_paths.out_object)
+
+	files
+	{
+		"%{prj.location}/src/**.h",
+		"%{prj.location}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		-- Project files
+		"/%{prj.location}/src",
+
+		-- Capture file layout shared with the engine
+		engine_paths.project .. "/Ader2_CPP/src",
+
+		-- GLFW
+		engine_paths.lib["GLFW"]["include"],
+
+		-- Glad
+		engine_paths.lib["Glad"]["include"],
+	}
+
+	libdirs
+	{
+		-- GLFW
+		engine_paths.lib["GLFW"]["lib"],
+
+		-- Glad
+		engine_paths.lib["Glad"]["lib"],
+	}
+
+	links
+	{
+		-- GLFW
+		engine_paths.lib["GLFW"]["dll"],
+
+		-- Glad
+		engine_paths.lib["Glad"]["dll"],
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+		links
+		{
+			"opengl32.lib",
+		}
+
+	filter "configurations:Debug"
+		defines 
+		{
+			"ADER_MACRO_DEBUG"
+		}
+		runtime "Debug"
+		symbols "on"
+	
+	filter "configurations:Release"
+		defines "TR_RELEASE"
+		optimize "on"
+		runtime "Release"
+
+	filter "configurations:Dist"
+		defines "TR_DIST"
+		runtime "Release"
+		optimize "on"
\ No newline at end of file
@@ -10,4 +10,5 @@ workspace "Ader2"
 
 require "build/cpp"
 require "build/csharp"
-require "build/gamecode"
\ No newline at end of file
+require "build/gamecode"
+require "build/replay"
\ No newline at end of file
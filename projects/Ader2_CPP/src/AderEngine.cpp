@@ -1,5 +1,47 @@
 #include "AderEngine.h"
 
+// Message scopes
+#include "Utility/Profiler.h"
+
+namespace
+{
+	/**
+	 * Returns the name of the message used for its profiler scope
+	 */
+	const char* getMessageName(MessageBus::MessageType msg)
+	{
+		switch (msg)
+		{
+		case Messages::msg_Setup: return "msg_Setup";
+		case Messages::msg_SystemUpdate: return "msg_SystemUpdate";
+		case Messages::msg_SystemRender: return "msg_SystemRender";
+		case Messages::msg_SystemPreRender: return "msg_SystemPreRender";
+		case Messages::msg_CreateWindow: return "msg_CreateWindow";
+		case Messages::msg_WindowCreated: return "msg_WindowCreated";
+		case Messages::msg_HeadlessWindowCreated: return "msg_HeadlessWindowCreated";
+		case Messages::msg_LoadAssemblies: return "msg_LoadAssemblies";
+		case Messages::msg_ReloadAssemblies: return "msg_ReloadAssemblies";
+		case Messages::msg_LoadScripts: return "msg_LoadScripts";
+		case Messages::msg_LoadAderScenes: return "msg_LoadAderScenes";
+		case Messages::msg_InitScripts: return "msg_InitScripts";
+		case Messages::msg_ScriptUpdate: return "msg_ScriptUpdate";
+		case Messages::msg_TransmitScenes: return "msg_TransmitScenes";
+		case Messages::msg_TransmitAssets: return "msg_TransmitAssets";
+		case Messages::msg_StateBundleCreated: return "msg_StateBundleCreated";
+		case Messages::msg_WndStateUpdated: return "msg_WndStateUpdated";
+		case Messages::msg_KeyStateUpdated: return "msg_KeyStateUpdated";
+		case Messages::msg_SetScene: return "msg_SetScene";
+		case Messages::msg_LoadScene: return "msg_LoadScene";
+		case Messages::msg_LoadCurrentScene: return "msg_LoadCurrentScene";
+		case Messages::msg_SceneChanged: return "msg_SceneChanged";
+		case Messages::msg_ReloadSceneShaders: return "msg_ReloadSceneShaders";
+		case Messages::msg_ClearAssets: return "msg_ClearAssets";
+		}
+
+		return "msg_Unknown";
+	}
+}
+
 bool AderMessageBus::canShutdown()
 {
 	// Currently the message bus is not blocked and can shut down whenever
@@ -28,6 +70,9 @@ void AderMessageBus::postMessage(MessageType msg, DataType pData)
 
 	// PASS
 
+	// Each message is a profiler scope, messages posted while handling it are nested inside
+	PROFILE_SCOPE(getMessageName(msg));
+
 	// Send the message
 	for (const Memory::reference<Module>& module : prtc_modules)
 	{
@@ -43,7 +88,8 @@ AderEngine::AderEngine()
 	m_inputInterface(new InputInterface()),
 	m_sceneManager(new SceneManager()),
 	m_assetManager(new AssetManager()),
-	m_preRender(new PreRender())
+	m_preRender(new PreRender()),
+	m_particleSystem(new ParticleSystem())
 {
 	// Initialize logger
 	Log::init();
@@ -92,6 +138,11 @@ Memory::reference<PreRender> AderEngine::preRender()
 	return m_preRender;
 }
 
+Memory::reference<ParticleSystem> AderEngine::particles()
+{
+	return m_particleSystem;
+}
+
 std::vector<MessageBus::ModuleEntry> AderEngine::getModules()
 {
 	return
@@ -103,6 +154,9 @@ std::vector<MessageBus::ModuleEntry> AderEngine::getModules()
 		m_sceneManager.as<Module>(),
 		m_assetManager.as<Module>(),
 		m_preRender.as<Module>(),
+
+		// Waits for the simulation after the pre render, both run at the same time
+		m_particleSystem.as<Module>(),
 	};
 }
 
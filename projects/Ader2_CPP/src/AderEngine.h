@@ -30,6 +30,9 @@
 // Pre render module
 #include "Modules/PreRender.h"
 
+// Particle system module
+#include "Modules/ParticleSystem.h"
+
 
 /**
  * The message bus that is used by the AderEngine
@@ -116,6 +119,13 @@ public:
      */
     Memory::reference<PreRender> preRender();
 
+    /**
+     * Get the reference to the particle system module
+     *
+     * @return Memory::reference<ParticleSystem> of the engine's particle system module
+     */
+    Memory::reference<ParticleSystem> particles();
+
 	// Inherited via ModuleSystem
 	virtual std::vector<MessageBus::ModuleEntry> getModules() override;
 	virtual MessageBus* getMBImplementation() override;
@@ -128,4 +138,5 @@ private:
     Memory::reference<SceneManager> m_sceneManager;
     Memory::reference<AssetManager> m_assetManager;
     Memory::reference<PreRender> m_preRender;
+    Memory::reference<ParticleSystem> m_particleSystem;
 };
@@ -48,6 +48,12 @@ namespace Messages
 		 */
 		msg_WindowCreated = 11,
 
+		/**
+		 * This message is sent instead of WindowCreated when a headless window was
+		 * requested, no window exists and the payload are the CreateWindowParams.
+		 */
+		msg_HeadlessWindowCreated = 12,
+
 		/**
 		 * This message instructs script manager to find all assemblies in a specified directory
 		 * and load them in.
@@ -128,8 +128,36 @@ bool GameObject::offsetChanged()
 	return m_offsetUpdate;
 }
 
-const glm::vec2& GameObject::getOffset(const glm::vec2& atlasDims)
+const glm::vec4& GameObject::getTexRect() const
+{
+	return m_texRect;
+}
+
+glm::vec4& GameObject::setTexRect()
+{
+	m_offsetUpdate = true;
+	return m_texRect;
+}
+
+glm::vec2 GameObject::getOffset(const glm::vec2& atlasDims)
 {
 	m_offsetUpdate = false;
 	return glm::vec2(m_texOffset.x, atlasDims.y - 1 - m_texOffset.y) / atlasDims;
 }
+
+glm::vec4 GameObject::getRect(const glm::vec2& atlasDims)
+{
+	if (hasTexRect())
+	{
+		m_offsetUpdate = false;
+		return m_texRect;
+	}
+
+	// Atlas cell of the offset
+	return glm::vec4(getOffset(atlasDims), 1.0f / atlasDims);
+}
+
+bool GameObject::hasTexRect() const
+{
+	return m_texRect.z != 0.0f && m_texRect.w != 0.0f;
+}
@@ -96,10 +96,34 @@ public:
      */
     bool offsetChanged();
 
+    /**
+     * Get texture rectangle data, does not flag the game object as
+     * needing an update
+     */
+    const glm::vec4& getTexRect() const;
+
+    /**
+     * Get texture rectangle data reference, offset in xy and scale in zw.
+     * Does flag the game object as needing an update even if there
+     * were no changes to it
+     */
+    glm::vec4& setTexRect();
+
     /**
      * Get texture offset from the specified atlas dimensions
      */
-    const glm::vec2& getOffset(const glm::vec2& atlasDims);
+    glm::vec2 getOffset(const glm::vec2& atlasDims);
+
+    /**
+     * Get texture rectangle, the texture rectangle of the game object if
+     * one is set, otherwise the atlas cell of the texture offset
+     */
+    glm::vec4 getRect(const glm::vec2& atlasDims);
+
+    /**
+     * Returns true if the game object has a texture rectangle
+     */
+    bool hasTexRect() const;
 private:
     /// Current visual of the game object
     Visual* m_pVisual = nullptr;
@@ -113,6 +137,9 @@ private:
     /// Texture offsets for this game object
     glm::vec2 m_texOffset = glm::vec2(0, 0);
 
+    /// Texture rectangle for this game object, unused while the scale is 0
+    glm::vec4 m_texRect = glm::vec4(0, 0, 0, 0);
+
     /**
      * If true then the next time a game object is updated
      * a new transformation will be created
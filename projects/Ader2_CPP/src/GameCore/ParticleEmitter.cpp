@@ -0,0 +1,382 @@
+#include "ParticleEmitter.h"
+
+// Visual and its atlas dimensions
+#include "MonoWrap/GLUE/AderScene.h"
+
+// Integration of 4 particles at a time
+#include <xmmintrin.h>
+
+// For std::min and std::max
+#include <algorithm>
+
+// The managed settings are read directly
+static_assert(sizeof(ParticleEmitter::Settings) == 88, "Settings don't match Ader2.Core.ParticleEmitterSettings");
+
+ParticleEmitter::ParticleEmitter()
+{
+	setColorCurve(nullptr, nullptr, 0);
+	setSizeCurve(nullptr, nullptr, 0);
+}
+
+void ParticleEmitter::configure(const Settings& settings)
+{
+	m_settings = settings;
+	m_settings.MaxParticles = std::max(m_settings.MaxParticles, 0);
+	m_settings.FrameCount = std::max(m_settings.FrameCount, 1);
+	m_settings.MinLifetime = std::max(m_settings.MinLifetime, 0.0f);
+	m_settings.MaxLifetime = std::max(m_settings.MaxLifetime, m_settings.MinLifetime);
+}
+
+const ParticleEmitter::Settings& ParticleEmitter::getSettings() const
+{
+	return m_settings;
+}
+
+void ParticleEmitter::setPosition(const glm::vec3& position)
+{
+	m_settings.Position = position;
+}
+
+void ParticleEmitter::setEmitting(bool emitting)
+{
+	m_emitting = emitting;
+
+	// Stopping drops the partial particle so restarting doesn't spawn one at once
+	if (!emitting)
+	{
+		m_accumulator = 0.0f;
+	}
+}
+
+bool ParticleEmitter::isEmitting() const
+{
+	return m_emitting;
+}
+
+void ParticleEmitter::setVisual(Visual* visual)
+{
+	m_pVisual = visual;
+}
+
+Visual* ParticleEmitter::getVisual() const
+{
+	return m_pVisual;
+}
+
+void ParticleEmitter::setColorCurve(const float* pTimes, const glm::vec4* pColors, size_t count)
+{
+	glm::vec4 white(1.0f);
+	if (count == 0)
+	{
+		pTimes = nullptr;
+		pColors = &white;
+		count = 1;
+	}
+
+	bakeCurve(pTimes, pColors, count, m_colorCurve);
+}
+
+void ParticleEmitter::setSizeCurve(const float* pTimes, const float* pSizes, size_t count)
+{
+	float one = 1.0f;
+	if (count == 0)
+	{
+		pTimes = nullptr;
+		pSizes = &one;
+		count = 1;
+	}
+
+	bakeCurve(pTimes, pSizes, count, m_sizeCurve);
+}
+
+void ParticleEmitter::spawn(float dt)
+{
+	// Release trailing chunks once all of their particles have died, the storage
+	// shrinks with them so appending a slot adds the chunk again
+	size_t chunks = m_alive.size();
+	while (!m_alive.empty() && m_alive.back() == 0)
+	{
+		m_free.pop_back();
+		m_alive.pop_back();
+	}
+
+	if (m_alive.size() != chunks)
+	{
+		size_t size = m_alive.size() * ms_chunkSize;
+		m_count = std::min(m_count, size);
+
+		m_posX.resize(size);
+		m_posY.resize(size);
+		m_posZ.resize(size);
+		m_velX.resize(size);
+		m_velY.resize(size);
+		m_velZ.resize(size);
+		m_age.resize(size);
+		m_life.resize(size);
+	}
+
+	// Atlas offset of each frame, same convention as the texture offsets of game objects
+	glm::vec2 atlasDims = m_pVisual ? m_pVisual->AtlasDims : glm::vec2(1.0f);
+	int columns = std::max((int)atlasDims.x, 1);
+
+	m_frameOffsets.resize(m_settings.FrameCount);
+	for (int i = 0; i < m_settings.FrameCount; i++)
+	{
+		glm::vec2 cell((float)(i % columns), (float)(i / columns));
+		m_frameOffsets[i] = glm::vec2(cell.x, atlasDims.y - 1 - cell.y) / atlasDims;
+	}
+
+	// Spawn the particles of the elapsed time
+	size_t spawned = 0;
+	if (m_emitting)
+	{
+		m_accumulator += m_settings.Rate * dt;
+		spawned = (size_t)m_accumulator;
+		m_accumulator -= (float)spawned;
+	}
+
+	for (size_t i = 0; i < spawned; i++)
+	{
+		size_t slot = takeSlot();
+		if (slot == m_age.size())
+		{
+			// Full, particles are only spawned again once some have died
+			m_accumulator = 0.0f;
+			break;
+		}
+
+		m_posX[slot] = m_settings.Position.x + m_settings.PositionSpread.x * random();
+		m_posY[slot] = m_settings.Position.y + m_settings.PositionSpread.y * random();
+		m_posZ[slot] = m_settings.Position.z + m_settings.PositionSpread.z * random();
+		m_velX[slot] = m_settings.Velocity.x + m_settings.VelocitySpread.x * random();
+		m_velY[slot] = m_settings.Velocity.y + m_settings.VelocitySpread.y * random();
+		m_velZ[slot] = m_settings.Velocity.z + m_settings.VelocitySpread.z * random();
+
+		float t = random() * 0.5f + 0.5f;
+		m_age[slot] = 0.0f;
+		m_life[slot] = m_settings.MinLifetime + (m_settings.MaxLifetime - m_settings.MinLifetime) * t;
+	}
+
+	// The output covers the slots in use rounded up to the SIMD group, so only
+	// a few dead instances past the last slot are uploaded
+	size_t slots = (m_count + 3) & ~(size_t)3;
+	m_rows.resize(slots * 3);
+	m_offsets.resize(slots);
+	m_colors.resize(slots);
+}
+
+size_t ParticleEmitter::getChunkCount() const
+{
+	return (m_count + ms_chunkSize - 1) / ms_chunkSize;
+}
+
+void ParticleEmitter::simulate(size_t chunk, float dt)
+{
+	size_t first = chunk * ms_chunkSize;
+	size_t last = std::min(first + ms_chunkSize, m_count);
+
+	// The last group is completed with dead slots, the storage is a multiple of the chunk size
+	size_t end = (last + 3) & ~(size_t)3;
+
+	// Velocity is accelerated by gravity and then damped by the drag
+	__m128 step = _mm_set1_ps(dt);
+	__m128 gravityX = _mm_set1_ps(m_settings.Gravity.x * dt);
+	__m128 gravityY = _mm_set1_ps(m_settings.Gravity.y * dt);
+	__m128 gravityZ = _mm_set1_ps(m_settings.Gravity.z * dt);
+	__m128 damping = _mm_set1_ps(1.0f / (1.0f + m_settings.Drag * dt));
+	__m128 minLife = _mm_set1_ps(1e-6f);
+
+	float frameCount = (float)m_settings.FrameCount;
+	float frameRate = m_settings.FrameRate;
+
+	std::vector<uint32_t>& freeSlots = m_free[chunk];
+	freeSlots.clear();
+	size_t alive = 0;
+
+	for (size_t i = first; i < end; i += 4)
+	{
+		__m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_velX[i]), gravityX), damping);
+		__m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_velY[i]), gravityY), damping);
+		__m128 vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_velZ[i]), gravityZ), damping);
+
+		__m128 px = _mm_add_ps(_mm_loadu_ps(&m_posX[i]), _mm_mul_ps(vx, step));
+		__m128 py = _mm_add_ps(_mm_loadu_ps(&m_posY[i]), _mm_mul_ps(vy, step));
+		__m128 pz = _mm_add_ps(_mm_loadu_ps(&m_posZ[i]), _mm_mul_ps(vz, step));
+
+		__m128 age = _mm_add_ps(_mm_loadu_ps(&m_age[i]), step);
+		__m128 life = _mm_loadu_ps(&m_life[i]);
+
+		// Dead particles are integrated too, their values are never read
+		_mm_storeu_ps(&m_velX[i], vx);
+		_mm_storeu_ps(&m_velY[i], vy);
+		_mm_storeu_ps(&m_velZ[i], vz);
+		_mm_storeu_ps(&m_posX[i], px);
+		_mm_storeu_ps(&m_posY[i], py);
+		_mm_storeu_ps(&m_posZ[i], pz);
+		_mm_storeu_ps(&m_age[i], age);
+
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(age, life));
+
+		// Normalized age the curves are sampled with
+		alignas(16) float t[4];
+		_mm_store_ps(t, _mm_div_ps(age, _mm_max_ps(life, minLife)));
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			size_t slot = i + lane;
+			glm::vec4* pRows = &m_rows[slot * 3];
+
+			if ((mask & (1 << lane)) == 0)
+			{
+				pRows[0] = glm::vec4(0.0f);
+				pRows[1] = glm::vec4(0.0f);
+				pRows[2] = glm::vec4(0.0f);
+				m_colors[slot] = glm::u8vec4(0);
+
+				if (slot < last)
+				{
+					freeSlots.push_back((uint32_t)slot);
+				}
+
+				continue;
+			}
+
+			alive++;
+
+			// Curves are interpolated between their baked entries
+			float position = t[lane] * (ms_curveSize - 1);
+			size_t index = std::min((size_t)position, ms_curveSize - 2);
+			float fraction = std::min(position - (float)index, 1.0f);
+
+			float scale = m_sizeCurve[index] + (m_sizeCurve[index + 1] - m_sizeCurve[index]) * fraction;
+			glm::vec4 color = glm::mix(m_colorCurve[index], m_colorCurve[index + 1], fraction);
+
+			pRows[0] = glm::vec4(scale, 0.0f, 0.0f, m_posX[slot]);
+			pRows[1] = glm::vec4(0.0f, scale, 0.0f, m_posY[slot]);
+			pRows[2] = glm::vec4(0.0f, 0.0f, scale, m_posZ[slot]);
+			m_colors[slot] = glm::u8vec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+			float frame = frameRate > 0.0f ? m_age[slot] * frameRate : t[lane] * frameCount;
+			m_offsets[slot] = m_frameOffsets[(size_t)frame % m_frameOffsets.size()];
+		}
+	}
+
+	m_alive[chunk] = alive;
+}
+
+size_t ParticleEmitter::getCount() const
+{
+	return m_count;
+}
+
+size_t ParticleEmitter::getAlive() const
+{
+	size_t alive = 0;
+	for (size_t chunkAlive : m_alive)
+	{
+		alive += chunkAlive;
+	}
+
+	return alive;
+}
+
+std::vector<glm::vec4>& ParticleEmitter::getRows()
+{
+	return m_rows;
+}
+
+std::vector<glm::vec2>& ParticleEmitter::getOffsets()
+{
+	return m_offsets;
+}
+
+std::vector<glm::u8vec4>& ParticleEmitter::getColors()
+{
+	return m_colors;
+}
+
+size_t ParticleEmitter::takeSlot()
+{
+	// Reuse dead particles first, the lowest chunks are filled so the trailing ones can empty
+	for (std::vector<uint32_t>& freeSlots : m_free)
+	{
+		if (!freeSlots.empty())
+		{
+			size_t slot = freeSlots.back();
+			freeSlots.pop_back();
+			return slot;
+		}
+	}
+
+	if (m_count >= (size_t)m_settings.MaxParticles)
+	{
+		return m_age.size();
+	}
+
+	// The chunk of the slot is added once the previous ones are full
+	if (m_count / ms_chunkSize == m_alive.size())
+	{
+		addChunk();
+	}
+
+	// Appended slots start counting towards their chunk once simulated, the
+	// chunk must not be released before that
+	m_alive[m_count / ms_chunkSize]++;
+	return m_count++;
+}
+
+void ParticleEmitter::addChunk()
+{
+	size_t size = m_age.size() + ms_chunkSize;
+
+	m_posX.resize(size);
+	m_posY.resize(size);
+	m_posZ.resize(size);
+	m_velX.resize(size);
+	m_velY.resize(size);
+	m_velZ.resize(size);
+
+	// Zero lifetime, the new slots are dead
+	m_age.resize(size, 0.0f);
+	m_life.resize(size, 0.0f);
+
+	m_free.emplace_back();
+	m_alive.push_back(0);
+}
+
+float ParticleEmitter::random()
+{
+	// Xorshift, quality doesn't matter for spreading particles
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+
+	return (float)(m_random >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+template<typename T>
+void ParticleEmitter::bakeCurve(const float* pTimes, const T* pValues, size_t count, T* pTable)
+{
+	size_t key = 0;
+	for (size_t i = 0; i < ms_curveSize; i++)
+	{
+		float t = (float)i / (ms_curveSize - 1);
+
+		// A single key is constant
+		if (count == 1)
+		{
+			pTable[i] = pValues[0];
+			continue;
+		}
+
+		while (key + 1 < count - 1 && pTimes[key + 1] <= t)
+		{
+			key++;
+		}
+
+		// Values before the first key and after the last one are held
+		float span = pTimes[key + 1] - pTimes[key];
+		float fraction = span > 0.0f ? glm::clamp((t - pTimes[key]) / span, 0.0f, 1.0f) : 1.0f;
+		pTable[i] = pValues[key] + (pValues[key + 1] - pValues[key]) * fraction;
+	}
+}
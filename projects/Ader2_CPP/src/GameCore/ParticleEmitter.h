@@ -0,0 +1,247 @@
+#pragma once
+
+// Particle storage
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Particle settings and instance data
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// Asset base class
+#include "CommonTypes/Asset.h"
+
+// Forward declaration
+struct Visual;
+
+
+/**
+ * Particle emitter spawns particles at a fixed rate and simulates them natively,
+ * effects are configured once instead of being driven by a game object per
+ * particle. Particles are drawn with the vertex array, shader, textures and
+ * atlas dimensions of the emitter visual.
+ *
+ * Particles are stored as arrays of their components and are split into chunks
+ * that are simulated independently, the integration handles 4 particles at a
+ * time with SSE. The simulation writes the instance data of each particle in
+ * place, the rows are the compact instance rows and the offsets are the atlas
+ * offsets of the animation frame, so the output is uploaded as is. Dead
+ * particles keep their slot until it's reused and are written with a zero
+ * scale.
+ *
+ * Spawning and configuration must happen on the thread updating the engine,
+ * chunks can be simulated on any thread after the particles have been spawned.
+ */
+class ParticleEmitter : public Asset
+{
+public:
+    /**
+     * Settings of the emitter, the layout matches Ader2.Core.ParticleEmitterSettings
+     * so the managed struct is passed without conversion
+     */
+    struct Settings
+    {
+        /// Position particles are spawned at
+        glm::vec3 Position = glm::vec3(0.0f);
+
+        /// Particles are spawned up to this far from the position on each axis
+        glm::vec3 PositionSpread = glm::vec3(0.0f);
+
+        /// Velocity of spawned particles
+        glm::vec3 Velocity = glm::vec3(0.0f, 1.0f, 0.0f);
+
+        /// Velocity of spawned particles varies up to this much on each axis
+        glm::vec3 VelocitySpread = glm::vec3(0.0f);
+
+        /// Acceleration applied to every particle
+        glm::vec3 Gravity = glm::vec3(0.0f);
+
+        /// Fraction of the velocity lost each second
+        float Drag = 0.0f;
+
+        /// Particles spawned per second
+        float Rate = 10.0f;
+
+        /// Most particles alive at once
+        int MaxParticles = 1000;
+
+        /// Seconds a particle lives, picked between the minimum and the maximum
+        float MinLifetime = 1.0f;
+        float MaxLifetime = 1.0f;
+
+        /// Atlas cells the particles animate through, counted row by row from the top left
+        int FrameCount = 1;
+
+        /// Frames per second of the animation, 0 plays the frames once over the lifetime
+        float FrameRate = 0.0f;
+    };
+public:
+    ParticleEmitter();
+
+    /**
+     * Replaces the settings, living particles keep their state
+     */
+    void configure(const Settings& settings);
+
+    /**
+     * Returns the settings of the emitter
+     */
+    const Settings& getSettings() const;
+
+    /**
+     * Moves the emitter, only affects particles spawned after
+     */
+    void setPosition(const glm::vec3& position);
+
+    /**
+     * Starts or stops spawning, living particles keep being simulated
+     */
+    void setEmitting(bool emitting);
+
+    /**
+     * Returns true if the emitter spawns particles
+     */
+    bool isEmitting() const;
+
+    /**
+     * Sets the visual the particles are drawn with
+     */
+    void setVisual(Visual* visual);
+
+    /**
+     * Returns the visual the particles are drawn with
+     */
+    Visual* getVisual() const;
+
+    /**
+     * Sets the color over the lifetime of a particle, colors are interpolated
+     * between the keys
+     *
+     * @param pTimes Normalized ages of the keys in increasing order
+     * @param pColors Color of each key
+     * @param count Number of keys, 0 resets the color to white
+     */
+    void setColorCurve(const float* pTimes, const glm::vec4* pColors, size_t count);
+
+    /**
+     * Sets the scale over the lifetime of a particle, scales are interpolated
+     * between the keys
+     *
+     * @param pTimes Normalized ages of the keys in increasing order
+     * @param pSizes Scale of each key
+     * @param count Number of keys, 0 resets the scale to 1
+     */
+    void setSizeCurve(const float* pTimes, const float* pSizes, size_t count);
+
+    /**
+     * Spawns the particles of the elapsed time and prepares the output for the
+     * simulation, trailing chunks without living particles are released
+     *
+     * @param dt Elapsed time in seconds
+     */
+    void spawn(float dt);
+
+    /**
+     * Returns the number of chunks that have to be simulated
+     */
+    size_t getChunkCount() const;
+
+    /**
+     * Simulates the particles of a chunk and writes their instance data, chunks
+     * can be simulated at the same time
+     *
+     * @param chunk Index of the chunk
+     * @param dt Elapsed time in seconds
+     */
+    void simulate(size_t chunk, float dt);
+
+    /**
+     * Returns the number of instances to draw, dead particles are included
+     */
+    size_t getCount() const;
+
+    /**
+     * Returns the number of living particles after the last simulation
+     */
+    size_t getAlive() const;
+
+    /**
+     * Instance data written by the simulation, the first getCount() instances are valid
+     */
+    std::vector<glm::vec4>& getRows();
+    std::vector<glm::vec2>& getOffsets();
+    std::vector<glm::u8vec4>& getColors();
+private:
+    /**
+     * Returns a free particle slot, or the size of the storage if the emitter is full
+     */
+    size_t takeSlot();
+
+    /**
+     * Adds a chunk of dead particles
+     */
+    void addChunk();
+
+    /**
+     * Returns a random number between -1 and 1
+     */
+    float random();
+
+    /**
+     * Bakes piecewise linear keys into a lookup table
+     */
+    template<typename T>
+    static void bakeCurve(const float* pTimes, const T* pValues, size_t count, T* pTable);
+private:
+    /// Particles per chunk, a multiple of 4 so chunks never share a SIMD group
+    static constexpr size_t ms_chunkSize = 1024;
+
+    /// Entries of the baked curves
+    static constexpr size_t ms_curveSize = 32;
+
+    /// Settings of the emitter
+    Settings m_settings;
+
+    /// True while particles are spawned
+    bool m_emitting = true;
+
+    /// Visual the particles are drawn with
+    Visual* m_pVisual = nullptr;
+
+    /// Curves baked over the normalized age
+    glm::vec4 m_colorCurve[ms_curveSize];
+    float m_sizeCurve[ms_curveSize];
+
+    /// Atlas offset of each animation frame, rebuilt before every simulation
+    std::vector<glm::vec2> m_frameOffsets;
+
+    /// Particle components, a particle is dead once its age reaches its lifetime
+    std::vector<float> m_posX;
+    std::vector<float> m_posY;
+    std::vector<float> m_posZ;
+    std::vector<float> m_velX;
+    std::vector<float> m_velY;
+    std::vector<float> m_velZ;
+    std::vector<float> m_age;
+    std::vector<float> m_life;
+
+    /// Slots in use, slots past this are never drawn
+    size_t m_count = 0;
+
+    /// Dead slots of each chunk and the living particles of each chunk, written
+    /// by the simulation of the chunk
+    std::vector<std::vector<uint32_t>> m_free;
+    std::vector<size_t> m_alive;
+
+    /// Instance data, 3 compact rows, an atlas offset and a color per slot
+    std::vector<glm::vec4> m_rows;
+    std::vector<glm::vec2> m_offsets;
+    std::vector<glm::u8vec4> m_colors;
+
+    /// Fraction of a particle left over from the previous spawn
+    float m_accumulator = 0.0f;
+
+    /// State of the random number generator
+    uint32_t m_random = 0x9E3779B9u;
+};
@@ -1,7 +1,7 @@
 #include "InputInterface.h"
 
-// GLFW
-#include <GLFW/glfw3.h>
+// Headless window parameters, includes GLFW after Glad
+#include "OpenGLModules/GLWindow.h"
 
 // Engine messages
 #include "Enums/Messages.h"
@@ -31,6 +31,8 @@ int InputInterface::onMessage(MessageBus::MessageType msg, MessageBus::DataType
 		return setup();
 	case Messages::msg_WindowCreated:
 		return initWindowInput(pData);
+	case Messages::msg_HeadlessWindowCreated:
+		return initHeadlessInput(pData);
 	case Messages::msg_SystemUpdate:
 		return update();
 	}
@@ -92,6 +94,21 @@ int InputInterface::initWindowInput(MessageBus::DataType pWindow)
 	return 0;
 }
 
+int InputInterface::initHeadlessInput(MessageBus::DataType pParams)
+{
+	// Headless windows only have a size
+	const GLWindow::CreateWindowParams* params = static_cast<const GLWindow::CreateWindowParams*>(pParams);
+	m_actualState.WndState.width = params->width;
+	m_actualState.WndState.height = params->height;
+
+	// Make sure to init the engine with the window size
+	m_actualState.WndState.resized = true;
+	m_msgState = m_actualState;
+	this->postMessage(Messages::msg_WndStateUpdated);
+
+	return 0;
+}
+
 int InputInterface::update()
 {
 	// Reset window state flags
@@ -19,6 +19,7 @@
  * MODULE
  * Messages:
  *  - WindowCreated
+ *  - HeadlessWindowCreated
  *  - SystemUpdate
  *
  * Posts:
@@ -70,6 +71,15 @@ private:
      */
     int initWindowInput(MessageBus::DataType pWindow);
 
+    /**
+     * Initialize InputInterface for a headless window, there are no inputs
+     *
+     * @param pParams Pointer to the data passed in by the HeadlessWindowCreated payload
+     *
+     * @return 0 if there were no errors, otherwise error code
+     */
+    int initHeadlessInput(MessageBus::DataType pParams);
+
     /**
      * Update inputs, in this method the states are equalized so that in the case
      * that a module accidentally updates the states it would not cause problems
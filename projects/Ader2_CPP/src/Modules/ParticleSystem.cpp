@@ -0,0 +1,118 @@
+#include "ParticleSystem.h"
+
+// Engine messages
+#include "Enums/Messages.h"
+
+// Update and wait scopes
+#include "Utility/Profiler.h"
+
+// For std::min
+#include <algorithm>
+
+bool ParticleSystem::canShutdown()
+{
+	return false;
+}
+
+void ParticleSystem::shutdown()
+{
+	// Emitters are deleted with the assets, nothing may still simulate them
+	m_workers.wait();
+}
+
+int ParticleSystem::onMessage(MessageBus::MessageType msg, MessageBus::DataType pData)
+{
+	switch (msg)
+	{
+	case Messages::msg_SceneChanged:
+		sceneChanged(pData);
+		return 0;
+	case Messages::msg_SystemUpdate:
+		update();
+		return 0;
+	case Messages::msg_SystemPreRender:
+		wait();
+		return 0;
+	}
+
+	return 0;
+}
+
+ParticleSystem::Statistics ParticleSystem::getStatistics() const
+{
+	return m_statistics;
+}
+
+void ParticleSystem::sceneChanged(MessageBus::DataType pData)
+{
+	m_workers.wait();
+	m_currentScene = *static_cast<Memory::reference<AderScene>*>(pData);
+	m_started = false;
+}
+
+void ParticleSystem::update()
+{
+	PROFILE_SCOPE("ParticleSystem::update");
+
+	if (!m_currentScene.valid())
+	{
+		return;
+	}
+
+	// Long frames are clamped so a stall doesn't fling the particles
+	auto now = std::chrono::steady_clock::now();
+	float dt = m_started ? std::chrono::duration<float>(now - m_lastUpdate).count() : 0.0f;
+	dt = std::min(dt, 0.1f);
+	m_lastUpdate = now;
+	m_started = true;
+
+	// Spawning isn't thread safe, it's done before any chunk is handed out
+	m_workers.wait();
+	m_tasks.clear();
+	for (ParticleEmitter* pEmitter : m_currentScene->getEmitters())
+	{
+		pEmitter->spawn(dt);
+
+		for (size_t i = 0; i < pEmitter->getChunkCount(); i++)
+		{
+			Task task;
+			task.pEmitter = pEmitter;
+			task.Chunk = i;
+			m_tasks.push_back(task);
+		}
+	}
+
+	m_simulationTime = 0;
+	m_workers.dispatch(m_tasks.size(), [this, dt](size_t i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		m_tasks[i].pEmitter->simulate(m_tasks[i].Chunk, dt);
+		m_simulationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	});
+}
+
+void ParticleSystem::wait()
+{
+	if (!m_currentScene.valid())
+	{
+		return;
+	}
+
+	// Only the part of the simulation that didn't overlap with the pre render is waited for
+	{
+		PROFILE_SCOPE("ParticleSystem::wait");
+		m_workers.wait();
+	}
+
+	m_statistics.Emitters = m_currentScene->getEmitters().size();
+	m_statistics.Particles = 0;
+	m_statistics.Chunks = m_tasks.size();
+	m_statistics.Milliseconds = m_simulationTime / 1000000.0;
+
+	for (ParticleEmitter* pEmitter : m_currentScene->getEmitters())
+	{
+		m_statistics.Particles += pEmitter->getAlive();
+	}
+
+	Utility::Profiler::sample("Particles", "Simulation", m_statistics.Milliseconds);
+}
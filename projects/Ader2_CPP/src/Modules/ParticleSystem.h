@@ -0,0 +1,109 @@
+#pragma once
+
+// ParticleSystem is part of the module system
+#include "ModuleSystem/ModuleSystem.h"
+
+// Emitters of the current scene
+#include "MonoWrap/GLUE/AderScene.h"
+
+// Chunks are simulated on worker threads
+#include "Utility/WorkerPool.h"
+
+// Frame time and simulation time
+#include <chrono>
+#include <atomic>
+
+/**
+ * ParticleSystem module simulates the particle emitters of the current scene.
+ * Particles are spawned when the system updates and the chunks of every
+ * emitter are handed to the workers without waiting, the simulation runs while
+ * the rest of the frame is prepared and is waited for once the pre render
+ * modules are done. The module must come after PreRender so that both overlap.
+ *
+ * MODULE
+ * Messages:
+ *  - SceneChanged
+ *  - SystemUpdate
+ *  - SystemPreRender
+ *
+ * Posts:
+ *
+ */
+class ParticleSystem : public Module
+{
+public:
+    /**
+     * Statistics of the last simulated frame
+     */
+    struct Statistics
+    {
+        /// Emitters of the scene
+        size_t Emitters = 0;
+
+        /// Living particles
+        size_t Particles = 0;
+
+        /// Chunks simulated by the workers
+        size_t Chunks = 0;
+
+        /// Time spent simulating summed over all threads
+        double Milliseconds = 0.0;
+    };
+public:
+    // Inherited via Module
+    virtual bool canShutdown() override;
+
+    // Inherited via Module
+    virtual void shutdown() override;
+
+    // Inherited via Module
+    virtual int onMessage(MessageBus::MessageType msg, MessageBus::DataType pData) override;
+
+    /**
+     * Returns the statistics of the last simulated frame
+     */
+    Statistics getStatistics() const;
+private:
+    /**
+     * Set scene to the one received from the SceneManager
+     */
+    void sceneChanged(MessageBus::DataType pData);
+
+    /**
+     * Spawns particles and starts the simulation
+     */
+    void update();
+
+    /**
+     * Waits until the simulation has finished
+     */
+    void wait();
+private:
+    /**
+     * Chunk of an emitter simulated by a worker
+     */
+    struct Task
+    {
+        ParticleEmitter* pEmitter = nullptr;
+        size_t Chunk = 0;
+    };
+private:
+    /// Current scene
+    Memory::reference<AderScene> m_currentScene;
+
+    /// Chunks of the current frame, kept between frames to avoid allocations
+    std::vector<Task> m_tasks;
+
+    /// Time of the previous update, the first update doesn't advance the particles
+    std::chrono::steady_clock::time_point m_lastUpdate;
+    bool m_started = false;
+
+    /// Nanoseconds spent simulating in the current frame
+    std::atomic<long long> m_simulationTime{ 0 };
+
+    /// Statistics of the last simulated frame
+    Statistics m_statistics;
+
+    /// Threads the chunks are simulated on
+    Utility::WorkerPool m_workers;
+};
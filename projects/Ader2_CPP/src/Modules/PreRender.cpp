@@ -6,6 +6,13 @@
 // Logging
 #include "Utility/Log.h"
 
+// Culling pass scope
+#include "Utility/Profiler.h"
+
+// For FLT_MAX, std::min and std::max
+#include <cfloat>
+#include <algorithm>
+
 bool PreRender::canShutdown()
 {
 	return false;
@@ -37,17 +44,21 @@ void PreRender::sceneChanged(MessageBus::DataType pData)
 
 void PreRender::preRender()
 {
+	// Depth is measured along the view direction of the active camera
+	glm::mat4 view = m_currentScene->getActiveCamera()->getViewMatrix();
+
 	// Iterate over each visual
 	for (Visual* visual : m_currentScene->getVisuals())
 	{
-		// For now
-		visual->RenderCount = visual->Objects.size();
-
 		// Update transforms
 		updateTransforms(visual);
 
 		// Update texture offsets
 		updateTexOffsets(visual);
+
+		// Decide what is drawn and in which order
+		orderObjects(visual, view);
+		visual->RenderCount = visual->Order.size();
 	}
 }
 
@@ -79,6 +90,7 @@ void PreRender::updateTexOffsets(Visual* visual)
 	if (visual->Offsets.size() <= visual->Objects.size())
 	{
 		visual->Offsets.resize(visual->Objects.size());
+		visual->TexRects.resize(visual->Objects.size());
 	}
 
 	// Iterate over each game object
@@ -92,7 +104,93 @@ void PreRender::updateTexOffsets(Visual* visual)
 			{
 				// Update offset
 				visual->Offsets[i] = visual->Objects[i]->getOffset(visual->AtlasDims);
+
+				// Update rectangle, atlas cells are used for objects without one
+				visual->TexRects[i] = visual->Objects[i]->getRect(visual->AtlasDims);
+				visual->UseTexRects |= visual->Objects[i]->hasTexRect();
 			}
 		}
 	}
 }
+
+void PreRender::orderObjects(Visual* visual, const glm::mat4& view)
+{
+	PROFILE_SCOPE("PreRender::orderObjects");
+
+	visual->Order.clear();
+	m_depths.clear();
+
+	// Row of the view matrix that gives the view space z of a point
+	glm::vec4 row(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+	float nearest = FLT_MAX;
+	float farthest = -FLT_MAX;
+
+	for (size_t i = 0; i < visual->Objects.size(); i++)
+	{
+		if (!visual->Render[i])
+		{
+			continue;
+		}
+
+		// The camera looks down -z, the origin of the object is used as its depth
+		float depth = -glm::dot(row, visual->Transforms[i][3]);
+
+		visual->Order.push_back((unsigned int)i);
+		m_depths.push_back(depth);
+
+		nearest = std::min(nearest, depth);
+		farthest = std::max(farthest, depth);
+	}
+
+	// Opaque batches are drawn nearest first, transparent ones farthest first
+	visual->Depth = visual->Order.empty() ? 0.0f : visual->Transparent ? farthest : nearest;
+
+	// Everything at the same depth doesn't need sorting
+	size_t count = visual->Order.size();
+	if (count < 2 || nearest == farthest)
+	{
+		return;
+	}
+
+	// Blending needs an exact back to front order, the keys are inverted so
+	// that the ascending radix sort puts the farthest object first
+	if (visual->Transparent)
+	{
+		m_sortKeys.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			m_sortKeys[i] = ~Utility::RadixSort::floatKey(m_depths[i]);
+		}
+
+		m_radixSort.sort(m_sortKeys, visual->Order, &m_workers);
+		return;
+	}
+
+	// Counting sort into depth buckets, objects inside a bucket keep their order.
+	// The order only has to be roughly front to back for the depth test to reject
+	// most hidden fragments, so this is cheaper than a full sort
+	float scale = (float)(ms_depthBuckets - 1) / (farthest - nearest);
+
+	m_keys.resize(count);
+	m_buckets.assign(ms_depthBuckets + 1, 0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		m_keys[i] = (unsigned int)((m_depths[i] - nearest) * scale);
+		m_buckets[m_keys[i] + 1]++;
+	}
+
+	for (unsigned int i = 1; i <= ms_depthBuckets; i++)
+	{
+		m_buckets[i] += m_buckets[i - 1];
+	}
+
+	m_sorted.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_sorted[m_buckets[m_keys[i]]++] = visual->Order[i];
+	}
+
+	visual->Order.swap(m_sorted);
+}
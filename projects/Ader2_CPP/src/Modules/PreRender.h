@@ -6,6 +6,10 @@
 // SceneManager manages scene instances
 #include "MonoWrap/GLUE/AderScene.h"
 
+// Back to front sorting of transparent objects
+#include "Utility/RadixSort.h"
+#include "Utility/WorkerPool.h"
+
 /**
  * PreRender module is used to determine which game objects should be
  * rendered and updated, and then does the necessary updates
@@ -47,11 +51,35 @@ private:
     void updateTransforms(Visual* visual);
 
     /**
-     * Updates the texture offset values of the necessary game objects
-     * of the specified visual
+     * Updates the texture offset and rectangle values of the necessary
+     * game objects of the specified visual
      */
     void updateTexOffsets(Visual* visual);
+
+    /**
+     * Collects the game objects of the visual that should be rendered into
+     * its draw order, opaque visuals are coarsely sorted front to back and
+     * transparent ones are sorted back to front
+     *
+     * @param visual Visual whose order is built
+     * @param view View matrix of the active camera
+     */
+    void orderObjects(Visual* visual, const glm::mat4& view);
 private:
+    /// Depth buckets of the front to back sort
+    static constexpr unsigned int ms_depthBuckets = 256;
+
     /// Current scene
     Memory::reference<AderScene> m_currentScene;
+
+    /// Sorting memory, kept between frames to avoid allocations
+    std::vector<float> m_depths;
+    std::vector<unsigned int> m_keys;
+    std::vector<unsigned int> m_buckets;
+    std::vector<unsigned int> m_sorted;
+    std::vector<uint32_t> m_sortKeys;
+
+    /// Radix sort of transparent objects and the threads it runs on
+    Utility::RadixSort m_radixSort;
+    Utility::WorkerPool m_workers;
 };
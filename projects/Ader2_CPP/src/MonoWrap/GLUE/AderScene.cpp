@@ -166,3 +166,13 @@ void AderScene::addUI(Text* pText)
 {
 	m_textAreas.push_back(pText);
 }
+
+const std::vector<ParticleEmitter*>& AderScene::getEmitters() const
+{
+	return m_emitters;
+}
+
+void AderScene::addEmitter(ParticleEmitter* pEmitter)
+{
+	m_emitters.push_back(pEmitter);
+}
@@ -23,6 +23,9 @@
 // Text
 #include "OpenGLModules/GLContext.h"
 
+// Particle emitters
+#include "GameCore/ParticleEmitter.h"
+
 /**
  * Visual struct is used to define a single way something looks.
  * When creating a GameObject a valid visual must first be created,
@@ -39,6 +42,15 @@ struct Visual : public Asset
     /// Vector containing texture offsets of game objects
     std::vector<glm::vec2> Offsets;
 
+    /// Vector containing texture rectangles (offset xy, scale zw) of game objects
+    std::vector<glm::vec4> TexRects;
+
+    /**
+     * True once a game object of this visual has a texture rectangle,
+     * variant shaders then read the rectangles instead of the offsets
+     */
+    bool UseTexRects = false;
+
     /**
      * Vector containing true or false that signalizes the engine
      * if the game object should be updated and rendered. This is
@@ -52,6 +64,27 @@ struct Visual : public Asset
     /// The number of true entries in the Render vector
     size_t RenderCount = 0;
 
+    /**
+     * Indices of the game objects that are rendered in the order they are
+     * drawn, opaque visuals are sorted front to back so that the depth test
+     * rejects hidden fragments before they are shaded, transparent visuals
+     * are sorted back to front so that they blend correctly
+     */
+    std::vector<unsigned int> Order;
+
+    /**
+     * View depth used to order the batches of the visual, the nearest rendered
+     * game object of opaque visuals and the farthest one of transparent visuals
+     */
+    float Depth = 0.0f;
+
+    /**
+     * True if the visual blends with what is behind it. Opaque visuals are
+     * drawn first and write depth, transparent ones are drawn after them with
+     * blending and without depth writes
+     */
+    bool Transparent = false;
+
     /// Reference to the vertex array of this visual
     VAO* VAO;
 
@@ -189,6 +222,16 @@ public:
      * Add UI(Text) element to this scene
      */
     void addUI(Text* pText);
+
+    /**
+     * Returns the particle emitters simulated for this scene
+     */
+    const std::vector<ParticleEmitter*>& getEmitters() const;
+
+    /**
+     * Add a particle emitter to this scene
+     */
+    void addEmitter(ParticleEmitter* pEmitter);
 private:
     /// Class representation of this implementation
     Memory::reference<SharpClass> m_class;
@@ -217,6 +260,9 @@ private:
     /// Text UI elements
     std::vector<Text*> m_textAreas;
 
+    /// Particle emitters
+    std::vector<ParticleEmitter*> m_emitters;
+
     /// The current active camera of the scene
     Camera* m_pActiveCamera;
 
@@ -3,6 +3,9 @@
 #include "MonoWrap/MonoManager.h"
 #include "Modules/AssetManager.h"
 #include "Utility/Log.h"
+#include "Utility/MeshFile.h"
+
+#include <algorithm>
 
 VAO* VAOnew(AssetManager* assetManager, MonoObject* name)
 {
@@ -52,6 +55,58 @@ void VAOsetUV(VAO* vao, MonoArray* texCoords)
 	vao->createUVBuffer(tex, false);
 }
 
+void VAOsetVertexData(VAO* vao, MonoArray* data, MonoArray* layout)
+{
+	// Layout is the stride followed by the location, components, type,
+	// normalized flag and offset of every attribute
+	int layoutSize = mono_array_length(layout);
+	unsigned int* pLayout = mono_array_addr(layout, unsigned int, 0);
+
+	if (layoutSize < 6 || (layoutSize - 1) % 5 != 0)
+	{
+		LOG_ERROR("Vertex layout must be the stride followed by 5 values per attribute");
+		return;
+	}
+
+	VertexLayout vertexLayout;
+	vertexLayout.Stride = pLayout[0];
+	for (int i = 1; i + 4 < layoutSize; i += 5)
+	{
+		VertexAttribute attribute;
+		attribute.Location = pLayout[i + 0];
+		attribute.Components = pLayout[i + 1];
+		attribute.Type = pLayout[i + 2];
+		attribute.Normalized = pLayout[i + 3];
+		attribute.Offset = pLayout[i + 4];
+		vertexLayout.Attributes.push_back(attribute);
+	}
+
+	// Nothing is recorded for a layout that would read outside of the vertices
+	if (!isValidLayout(vertexLayout.Attributes.data(), vertexLayout.Attributes.size(), vertexLayout.Stride))
+	{
+		LOG_ERROR("Invalid vertex layout, attributes must have 1 to 4 components of a known type inside the stride");
+		return;
+	}
+
+	// Float and byte arrays are both accepted
+	size_t size = (size_t)mono_array_length(data) * mono_array_element_size(mono_object_get_class((MonoObject*)data));
+	if (size % vertexLayout.Stride != 0)
+	{
+		LOG_ERROR("Vertex data size doesn't match the layout");
+		return;
+	}
+
+	// The data is read from the managed array directly
+	vao->bind();
+	vao->createInterleavedBuffer(vertexLayout, mono_array_addr(data, char, 0), size / vertexLayout.Stride, false);
+}
+
+bool VAOload(VAO* vao, MonoObject* path)
+{
+	// The mesh is read from the file directly without going through managed arrays
+	return vao->load(SharpUtility::toString(path));
+}
+
 
 
 Visual* Visualnew(AssetManager* assetManager, MonoObject* name)
@@ -101,6 +156,16 @@ void VisualsetSize(Visual* visual, glm::vec2* value)
 	visual->AtlasDims = *value;
 }
 
+void VisualgetTransparent(Visual* visual, bool* value)
+{
+	*value = visual->Transparent;
+}
+
+void VisualsetTransparent(Visual* visual, bool* value)
+{
+	visual->Transparent = *value;
+}
+
 
 Shader* Shadernew(AssetManager* assetManager, MonoObject* name)
 {
@@ -131,6 +196,58 @@ void Textureload(Texture* texture, MonoObject* source)
 	texture->load();
 }
 
+void TextureloadAsync(Texture* texture, MonoObject* source)
+{
+	texture->Source = SharpUtility::toString(source);
+
+	texture->loadAsync();
+}
+
+bool TextureisLoaded(Texture* texture)
+{
+	return texture->isLoaded();
+}
+
+
+
+TextureAtlas* TextureAtlasnew(AssetManager* assetManager, MonoObject* name)
+{
+	std::string assetName = SharpUtility::toString(name);
+	return assetManager->newAsset<TextureAtlas>(assetName);
+}
+
+void TextureAtlasaddSource(TextureAtlas* atlas, MonoObject* source)
+{
+	atlas->addSource(SharpUtility::toString(source));
+}
+
+int TextureAtlasbuild(TextureAtlas* atlas, int maxSize, int padding)
+{
+	return (int)atlas->build((unsigned int)maxSize, (unsigned int)padding);
+}
+
+Texture* TextureAtlasgetRegion(TextureAtlas* atlas, MonoObject* source, glm::vec4* rect)
+{
+	const TextureAtlas::Region* region = atlas->getRegion(SharpUtility::toString(source));
+	if (!region)
+	{
+		return nullptr;
+	}
+
+	*rect = region->Rect;
+	return atlas->getPage(region->Page);
+}
+
+int TextureAtlasgetPageCount(TextureAtlas* atlas)
+{
+	return (int)atlas->getPageCount();
+}
+
+Texture* TextureAtlasgetPage(TextureAtlas* atlas, int index)
+{
+	return atlas->getPage((size_t)index);
+}
+
 
 
 Asset* AssetManagerget(AssetManager* manager, MonoObject* name)
@@ -170,6 +287,11 @@ void SceneaddText(AderScene* scene, Text* text)
 	scene->addUI(text);
 }
 
+void SceneaddEmitter(AderScene* scene, ParticleEmitter* emitter)
+{
+	scene->addEmitter(emitter);
+}
+
 
 Visual* GOgetVisual(GameObject* gObject)
 {
@@ -221,6 +343,16 @@ void GOsetTexOffset(GameObject* gObject, glm::vec2* value)
 	gObject->setTexOffset() = *value;
 }
 
+void GOgetTexRect(GameObject* gObject, glm::vec4* value)
+{
+	*value = gObject->getTexRect();
+}
+
+void GOsetTexRect(GameObject* gObject, glm::vec4* value)
+{
+	gObject->setTexRect() = *value;
+}
+
 
 void CameragetPosition(Camera* camera, glm::vec3* value)
 {
@@ -369,8 +501,14 @@ MonoString* TextSlotgetContent(Text::Slot* slot)
 
 void TextSlotsetContent(Text::Slot* slot, MonoObject* value)
 {
-	slot->Content = SharpUtility::toString(value);
-	slot->Regenerate = true;
+	// Setting the same content doesn't lay out the slot again
+	std::string content = SharpUtility::toString(value);
+	slot->setContent(content.data(), content.length());
+}
+
+void TextSlotsetNumber(Text::Slot* slot, double value, int decimals)
+{
+	slot->setNumber(value, decimals);
 }
 
 void TextSlotgetPosition(Text::Slot* slot, glm::vec2* value)
@@ -380,7 +518,18 @@ void TextSlotgetPosition(Text::Slot* slot, glm::vec2* value)
 
 void TextSlotsetPosition(Text::Slot* slot, glm::vec2* value)
 {
+	// Only the offset of the slot is written
 	slot->Position = *value;
+}
+
+void TextSlotgetColor(Text::Slot* slot, glm::vec4* value)
+{
+	*value = slot->Color;
+}
+
+void TextSlotsetColor(Text::Slot* slot, glm::vec4* value)
+{
+	slot->Color = *value;
 	slot->Regenerate = true;
 }
 
@@ -400,9 +549,11 @@ Text* Textnew(AssetManager* assetManager, MonoObject* name)
 	return assetManager->newAsset<Text>(assetName);
 }
 
-void Textload(Text* text, MonoObject* source)
+void Textload(Text* text, MonoObject* source, unsigned int size, bool distanceField)
 {
 	text->FontSource = SharpUtility::toString(source);
+	text->Size = size;
+	text->DistanceField = distanceField;
 	text->load();
 }
 
@@ -416,6 +567,66 @@ Text::Slot* TextgetSlot(Text* text, MonoObject* slot)
 	return &text->getSlot(SharpUtility::toString(slot));
 }
 
+void SpriteBatchsubmit(Texture* texture, Shader* shader, MonoArray* sprites, int count)
+{
+	// Only the first count sprites are submitted so arrays can be reused between frames
+	size_t length = mono_array_length(sprites);
+	size_t submitted = count < 0 ? length : std::min(length, (size_t)count);
+
+	// The managed struct has the layout of the native one, the array is read directly
+	SpriteRenderer::submit(texture, shader, mono_array_addr(sprites, SpriteRenderer::Sprite, 0), submitted);
+}
+
+ParticleEmitter* ParticleEmitternew(AssetManager* assetManager, MonoObject* name)
+{
+	std::string assetName = SharpUtility::toString(name);
+	return assetManager->newAsset<ParticleEmitter>(assetName);
+}
+
+void ParticleEmitterconfigure(ParticleEmitter* emitter, ParticleEmitter::Settings* settings)
+{
+	emitter->configure(*settings);
+}
+
+void ParticleEmittersetVisual(ParticleEmitter* emitter, Visual* visual)
+{
+	emitter->setVisual(visual);
+}
+
+void ParticleEmittersetColorCurve(ParticleEmitter* emitter, MonoArray* times, MonoArray* colors)
+{
+	// Keys without a value are ignored
+	size_t count = std::min(mono_array_length(times), mono_array_length(colors));
+	emitter->setColorCurve(mono_array_addr(times, float, 0), mono_array_addr(colors, glm::vec4, 0), count);
+}
+
+void ParticleEmittersetSizeCurve(ParticleEmitter* emitter, MonoArray* times, MonoArray* sizes)
+{
+	// Keys without a value are ignored
+	size_t count = std::min(mono_array_length(times), mono_array_length(sizes));
+	emitter->setSizeCurve(mono_array_addr(times, float, 0), mono_array_addr(sizes, float, 0), count);
+}
+
+void ParticleEmittergetPosition(ParticleEmitter* emitter, glm::vec3* value)
+{
+	*value = emitter->getSettings().Position;
+}
+
+void ParticleEmittersetPosition(ParticleEmitter* emitter, glm::vec3* value)
+{
+	emitter->setPosition(*value);
+}
+
+void ParticleEmittergetEmitting(ParticleEmitter* emitter, bool* value)
+{
+	*value = emitter->isEmitting();
+}
+
+void ParticleEmittersetEmitting(ParticleEmitter* emitter, bool* value)
+{
+	emitter->setEmitting(*value);
+}
+
 
 void AderInternals::addInternals()
 {
@@ -429,12 +640,17 @@ void AderInternals::addInternals()
 	mono_add_internal_call("Ader2.Visual::__getTexture(intptr,int)", VisualgetTexture);
 	mono_add_internal_call("Ader2.Visual::__getSize(intptr,Ader2.Core.Vector2&)", VisualgetSize);
 	mono_add_internal_call("Ader2.Visual::__setSize(intptr,Ader2.Core.Vector2&)", VisualsetSize);
+	mono_add_internal_call("Ader2.Visual::__getTransparent(intptr,bool&)", VisualgetTransparent);
+	mono_add_internal_call("Ader2.Visual::__setTransparent(intptr,bool&)", VisualsetTransparent);
 
 	// Add VAO internals
 	mono_add_internal_call("Ader2.Core.VAO::__new(intptr,string)", VAOnew);
 	mono_add_internal_call("Ader2.Core.VAO::__setIndices(intptr,uint[])", VAOsetIndices);
 	mono_add_internal_call("Ader2.Core.VAO::__setVertices(intptr,single[])", VAOsetVertices);
 	mono_add_internal_call("Ader2.Core.VAO::__setUV(intptr,single[])", VAOsetUV);
+	mono_add_internal_call("Ader2.Core.VAO::__load(intptr,string)", VAOload);
+	mono_add_internal_call("Ader2.Core.VAO::__setVertexData(intptr,single[],uint[])", VAOsetVertexData);
+	mono_add_internal_call("Ader2.Core.VAO::__setVertexData(intptr,byte[],uint[])", VAOsetVertexData);
 
 	// Add Shader internals
 	mono_add_internal_call("Ader2.Core.Shader::__new(intptr,string)", Shadernew);
@@ -443,6 +659,16 @@ void AderInternals::addInternals()
 	// Add texture internals
 	mono_add_internal_call("Ader2.Core.Texture::__new(intptr,string)", Texturenew);
 	mono_add_internal_call("Ader2.Core.Texture::__load(intptr,string)", Textureload);
+	mono_add_internal_call("Ader2.Core.Texture::__loadAsync(intptr,string)", TextureloadAsync);
+	mono_add_internal_call("Ader2.Core.Texture::__isLoaded(intptr)", TextureisLoaded);
+
+	// Add texture atlas internals
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__new(intptr,string)", TextureAtlasnew);
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__addSource(intptr,string)", TextureAtlasaddSource);
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__build(intptr,int,int)", TextureAtlasbuild);
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__getRegion(intptr,string,Ader2.Core.Vector4&)", TextureAtlasgetRegion);
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__getPageCount(intptr)", TextureAtlasgetPageCount);
+	mono_add_internal_call("Ader2.Core.TextureAtlas::__getPage(intptr,int)", TextureAtlasgetPage);
 
 	// Add asset manager internals
 	mono_add_internal_call("Ader2.Core.AderAssets::__get(intptr,string)", AssetManagerget);
@@ -454,6 +680,7 @@ void AderInternals::addInternals()
 	mono_add_internal_call("Ader2.AderScene::__getActiveCamera(intptr)", ScenegetActiveCamera);
 	mono_add_internal_call("Ader2.AderScene::__setActiveCamera(intptr,intptr)", ScenesetActiveCamera);
 	mono_add_internal_call("Ader2.AderScene::__addText(intptr,intptr)", SceneaddText);
+	mono_add_internal_call("Ader2.AderScene::__addEmitter(intptr,intptr)", SceneaddEmitter);
 
 	// Add game object internals
 	mono_add_internal_call("Ader2.GameObject::__getVisual(intptr)", GOgetVisual);
@@ -466,6 +693,8 @@ void AderInternals::addInternals()
 	mono_add_internal_call("Ader2.GameObject::__setScale(intptr,Ader2.Core.Vector3&)", GOsetScale);
 	mono_add_internal_call("Ader2.GameObject::__getTexOffset(intptr,Ader2.Core.Vector2&)", GOgetTexOffset);
 	mono_add_internal_call("Ader2.GameObject::__setTexOffset(intptr,Ader2.Core.Vector2&)", GOsetTexOffset);
+	mono_add_internal_call("Ader2.GameObject::__getTexRect(intptr,Ader2.Core.Vector4&)", GOgetTexRect);
+	mono_add_internal_call("Ader2.GameObject::__setTexRect(intptr,Ader2.Core.Vector4&)", GOsetTexRect);
 
 	// Add camera internals
 	mono_add_internal_call("Ader2.Camera::__getPosition(intptr,Ader2.Core.Vector3&)", CameragetPosition);
@@ -503,13 +732,30 @@ void AderInternals::addInternals()
 	// Text and TextSlot
 	mono_add_internal_call("Ader2.Core.TextSlot::__getContent(intptr)", TextSlotgetContent);
 	mono_add_internal_call("Ader2.Core.TextSlot::__setContent(intptr,string)", TextSlotsetContent);
+	mono_add_internal_call("Ader2.Core.TextSlot::__setNumber(intptr,double,int)", TextSlotsetNumber);
 	mono_add_internal_call("Ader2.Core.TextSlot::__getPosition(intptr,Ader2.Core.Vector2&)", TextSlotgetPosition);
 	mono_add_internal_call("Ader2.Core.TextSlot::__setPosition(intptr,Ader2.Core.Vector2&)", TextSlotsetPosition);
+	mono_add_internal_call("Ader2.Core.TextSlot::__getColor(intptr,Ader2.Core.Vector4&)", TextSlotgetColor);
+	mono_add_internal_call("Ader2.Core.TextSlot::__setColor(intptr,Ader2.Core.Vector4&)", TextSlotsetColor);
 	mono_add_internal_call("Ader2.Core.TextSlot::__getVisible(intptr,bool&)", TextSlotgetVisible);
 	mono_add_internal_call("Ader2.Core.TextSlot::__setVisible(intptr,bool&)", TextSlotsetVisible);
 
 	mono_add_internal_call("Ader2.Core.Text::__new(intptr,string)", Textnew);
-	mono_add_internal_call("Ader2.Core.Text::__load(intptr,string)", Textload);
+	mono_add_internal_call("Ader2.Core.Text::__load(intptr,string,uint,bool)", Textload);
 	mono_add_internal_call("Ader2.Core.Text::__setShader(intptr,intptr)", TextsetShader);
 	mono_add_internal_call("Ader2.Core.Text::__getSlot(intptr,string)", TextgetSlot);
+
+	// Sprites
+	mono_add_internal_call("Ader2.Core.SpriteBatch::__submit(intptr,intptr,Ader2.Core.Sprite[],int)", SpriteBatchsubmit);
+
+	// Particles
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__new(intptr,string)", ParticleEmitternew);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__configure(intptr,Ader2.Core.ParticleEmitterSettings&)", ParticleEmitterconfigure);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__setVisual(intptr,intptr)", ParticleEmittersetVisual);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__setColorCurve(intptr,single[],Ader2.Core.Vector4[])", ParticleEmittersetColorCurve);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__setSizeCurve(intptr,single[],single[])", ParticleEmittersetSizeCurve);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__getPosition(intptr,Ader2.Core.Vector3&)", ParticleEmittergetPosition);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__setPosition(intptr,Ader2.Core.Vector3&)", ParticleEmittersetPosition);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__getEmitting(intptr,bool&)", ParticleEmittergetEmitting);
+	mono_add_internal_call("Ader2.Core.ParticleEmitter::__setEmitting(intptr,bool&)", ParticleEmittersetEmitting);
 }
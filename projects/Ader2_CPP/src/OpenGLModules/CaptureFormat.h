@@ -0,0 +1,170 @@
+#pragma once
+
+// OpenGL types
+#include <glad/glad.h>
+
+
+/**
+ * Layout of the files written by GLCapture and read by the replay tool.
+ *
+ * A file starts with a CaptureHeader followed by records. Each record is a
+ * CaptureOp byte, the size of the arguments as an unsigned int and the
+ * arguments. Arguments are written in the order of the OpenGL call with
+ * their OpenGL types, pointers into bound buffers are written as GLintptr
+ * offsets and client memory as a GLsizeiptr size followed by the bytes.
+ * Object names are the names returned during the capture, the replay maps
+ * them to the names it creates.
+ *
+ * Records before CaptureOp::Start create the resources and state the
+ * captured frames start with, each captured frame ends with CaptureOp::Frame.
+ */
+
+/// Identifies a capture file, "A2GC"
+constexpr unsigned int c_captureMagic = 0x43473241;
+
+/// Incremented when the layout of the records changes
+constexpr unsigned int c_captureVersion = 1;
+
+/**
+ * Header of a capture file
+ */
+struct CaptureHeader
+{
+    /// c_captureMagic and c_captureVersion
+    unsigned int Magic = c_captureMagic;
+    unsigned int Version = c_captureVersion;
+
+    /// Size of the window the frames were captured in
+    int Width = 0;
+    int Height = 0;
+
+    /// Captured frames, written when the capture is finished
+    unsigned int Frames = 0;
+};
+
+/**
+ * Recorded calls, the arguments match the OpenGL call of the same name unless
+ * specified otherwise
+ */
+enum class CaptureOp : unsigned char
+{
+    /// End of the setup, the captured frames follow
+    Start,
+
+    /// End of a captured frame
+    Frame,
+
+    /// Contents of mapped buffer memory: buffer, offset, data
+    BufferUpdate,
+
+    ActiveTexture,
+    AttachShader,
+    BindBuffer,
+    BindBufferRange,
+    BindFramebuffer,
+    BindImageTexture,
+    BindTexture,
+    BindVertexArray,
+    BlendFunc,
+    BlitFramebuffer,
+
+    /// target, size, data, usage, the data is empty if no pointer was passed
+    BufferData,
+
+    /// target, size, data, flags, the data is empty if no pointer was passed
+    BufferStorage,
+
+    /// target, offset, data
+    BufferSubData,
+
+    Clear,
+    ClearColor,
+    ColorMask,
+    CompileShader,
+
+    /// Pixels like TexImage2D
+    CompressedTexImage2D,
+
+    CopyBufferSubData,
+    CopyImageSubData,
+
+    /// Created name
+    CreateProgram,
+
+    /// type, created name
+    CreateShader,
+
+    /// Count followed by the names
+    DeleteBuffers,
+    DeleteFramebuffers,
+
+    DeleteProgram,
+    DeleteShader,
+
+    /// Count followed by the names
+    DeleteTextures,
+    DeleteVertexArrays,
+
+    DepthFunc,
+    DepthMask,
+    Disable,
+    DisableVertexAttribArray,
+    DispatchCompute,
+    DrawArrays,
+    DrawArraysIndirect,
+    DrawArraysInstanced,
+    DrawArraysInstancedBaseInstance,
+    DrawElements,
+    DrawElementsIndirect,
+    DrawElementsInstanced,
+    Enable,
+    EnableVertexAttribArray,
+    FramebufferTexture2D,
+
+    /// Count followed by the created names
+    GenBuffers,
+    GenFramebuffers,
+    GenTextures,
+    GenVertexArrays,
+
+    GenerateMipmap,
+    LinkProgram,
+
+    /// glMemoryBarrier, MemoryBarrier is a macro on Windows
+    Barrier,
+
+    MultiDrawArraysIndirect,
+    PixelStorei,
+    PolygonMode,
+
+    /// program, binaryFormat, data
+    ProgramBinary,
+
+    ProgramParameteri,
+
+    /// shader, the sources joined into one string as data
+    ShaderSource,
+
+    /// Arguments before the pixels followed by a GLboolean that is true if the
+    /// pixels are read from the bound pixel unpack buffer. In that case the
+    /// offset follows, otherwise the data, which is empty if no pointer was passed
+    TexImage2D,
+    TexSubImage2D,
+    TexSubImage3D,
+
+    TexParameteri,
+    TexStorage2D,
+    TexStorage3D,
+    Uniform1i,
+
+    /// location, count, data
+    Uniform4fv,
+
+    /// location, count, transpose, data
+    UniformMatrix4fv,
+
+    UseProgram,
+    VertexAttribDivisor,
+    VertexAttribPointer,
+    Viewport,
+};
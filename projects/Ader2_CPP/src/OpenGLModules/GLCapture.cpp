@@ -0,0 +1,1614 @@
+#include "GLCapture.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Copying recorded data
+#include <algorithm>
+#include <cstring>
+
+// For offsetof
+#include <cstddef>
+
+GLCapture* GLCapture::ms_pInstance = nullptr;
+
+namespace
+{
+    /**
+     * Returns the size of a pixel with the specified format and type in bytes
+     */
+    size_t getPixelSize(GLenum format, GLenum type)
+    {
+        size_t components = 4;
+        switch (format)
+        {
+        case GL_RED:
+            components = 1;
+            break;
+        case GL_RG:
+            components = 2;
+            break;
+        case GL_RGB:
+            components = 3;
+            break;
+        }
+
+        switch (type)
+        {
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_FLOAT:
+            return components * 4;
+        }
+
+        return components;
+    }
+
+    /**
+     * Returns the size of client pixel data read by a texture upload, rows
+     * except the last one are padded to the alignment
+     */
+    size_t getImageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLint alignment)
+    {
+        size_t row = (size_t)width * getPixelSize(format, type);
+        size_t paddedRow = (row + alignment - 1) / alignment * alignment;
+        size_t rows = (size_t)height * depth;
+        return rows == 0 ? 0 : paddedRow * (rows - 1) + row;
+    }
+}
+
+GLCapture::GLCapture()
+{
+    ms_pInstance = this;
+}
+
+GLCapture::~GLCapture()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void GLCapture::configure(const std::string& path, size_t firstFrame, size_t frames, int width, int height)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_path = path;
+    s.m_firstFrame = firstFrame;
+    s.m_frames = std::max<size_t>(frames, 1);
+    s.m_width = width;
+    s.m_height = height;
+}
+
+void GLCapture::install()
+{
+    GLCapture& s = *ms_pInstance;
+
+    if (s.m_path.empty())
+    {
+        return;
+    }
+
+    s.m_file.open(s.m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!s.m_file.is_open())
+    {
+        LOG_WARN("Can't open capture file '{0}'!", s.m_path);
+        return;
+    }
+
+    // The frame count is written once the capture is finished
+    CaptureHeader header;
+    header.Width = s.m_width;
+    header.Height = s.m_height;
+    s.m_file.write(reinterpret_cast<const char*>(&header), sizeof(CaptureHeader));
+    s.m_written = sizeof(CaptureHeader);
+
+    // Calls are forwarded to the entry points installed before
+    s.m_gl.activeTexture = glad_glActiveTexture;
+    s.m_gl.attachShader = glad_glAttachShader;
+    s.m_gl.bindBuffer = glad_glBindBuffer;
+    s.m_gl.bindBufferRange = glad_glBindBufferRange;
+    s.m_gl.bindFramebuffer = glad_glBindFramebuffer;
+    s.m_gl.bindImageTexture = glad_glBindImageTexture;
+    s.m_gl.bindTexture = glad_glBindTexture;
+    s.m_gl.bindVertexArray = glad_glBindVertexArray;
+    s.m_gl.blendFunc = glad_glBlendFunc;
+    s.m_gl.blitFramebuffer = glad_glBlitFramebuffer;
+    s.m_gl.bufferData = glad_glBufferData;
+    s.m_gl.bufferStorage = glad_glBufferStorage;
+    s.m_gl.bufferSubData = glad_glBufferSubData;
+    s.m_gl.clear = glad_glClear;
+    s.m_gl.clearColor = glad_glClearColor;
+    s.m_gl.colorMask = glad_glColorMask;
+    s.m_gl.compileShader = glad_glCompileShader;
+    s.m_gl.compressedTexImage2D = glad_glCompressedTexImage2D;
+    s.m_gl.copyBufferSubData = glad_glCopyBufferSubData;
+    s.m_gl.copyImageSubData = glad_glCopyImageSubData;
+    s.m_gl.createProgram = glad_glCreateProgram;
+    s.m_gl.createShader = glad_glCreateShader;
+    s.m_gl.deleteBuffers = glad_glDeleteBuffers;
+    s.m_gl.deleteFramebuffers = glad_glDeleteFramebuffers;
+    s.m_gl.deleteProgram = glad_glDeleteProgram;
+    s.m_gl.deleteShader = glad_glDeleteShader;
+    s.m_gl.deleteTextures = glad_glDeleteTextures;
+    s.m_gl.deleteVertexArrays = glad_glDeleteVertexArrays;
+    s.m_gl.depthFunc = glad_glDepthFunc;
+    s.m_gl.depthMask = glad_glDepthMask;
+    s.m_gl.disable = glad_glDisable;
+    s.m_gl.disableVertexAttribArray = glad_glDisableVertexAttribArray;
+    s.m_gl.dispatchCompute = glad_glDispatchCompute;
+    s.m_gl.drawArrays = glad_glDrawArrays;
+    s.m_gl.drawArraysIndirect = glad_glDrawArraysIndirect;
+    s.m_gl.drawArraysInstanced = glad_glDrawArraysInstanced;
+    s.m_gl.drawArraysInstancedBaseInstance = glad_glDrawArraysInstancedBaseInstance;
+    s.m_gl.drawElements = glad_glDrawElements;
+    s.m_gl.drawElementsIndirect = glad_glDrawElementsIndirect;
+    s.m_gl.drawElementsInstanced = glad_glDrawElementsInstanced;
+    s.m_gl.enable = glad_glEnable;
+    s.m_gl.enableVertexAttribArray = glad_glEnableVertexAttribArray;
+    s.m_gl.framebufferTexture2D = glad_glFramebufferTexture2D;
+    s.m_gl.genBuffers = glad_glGenBuffers;
+    s.m_gl.generateMipmap = glad_glGenerateMipmap;
+    s.m_gl.genFramebuffers = glad_glGenFramebuffers;
+    s.m_gl.genTextures = glad_glGenTextures;
+    s.m_gl.genVertexArrays = glad_glGenVertexArrays;
+    s.m_gl.getIntegerv = glad_glGetIntegerv;
+    s.m_gl.linkProgram = glad_glLinkProgram;
+    s.m_gl.mapBuffer = glad_glMapBuffer;
+    s.m_gl.mapBufferRange = glad_glMapBufferRange;
+    s.m_gl.memoryBarrier = glad_glMemoryBarrier;
+    s.m_gl.multiDrawArraysIndirect = glad_glMultiDrawArraysIndirect;
+    s.m_gl.pixelStorei = glad_glPixelStorei;
+    s.m_gl.polygonMode = glad_glPolygonMode;
+    s.m_gl.programBinary = glad_glProgramBinary;
+    s.m_gl.programParameteri = glad_glProgramParameteri;
+    s.m_gl.shaderSource = glad_glShaderSource;
+    s.m_gl.texImage2D = glad_glTexImage2D;
+    s.m_gl.texParameteri = glad_glTexParameteri;
+    s.m_gl.texStorage2D = glad_glTexStorage2D;
+    s.m_gl.texStorage3D = glad_glTexStorage3D;
+    s.m_gl.texSubImage2D = glad_glTexSubImage2D;
+    s.m_gl.texSubImage3D = glad_glTexSubImage3D;
+    s.m_gl.uniform1i = glad_glUniform1i;
+    s.m_gl.uniform4fv = glad_glUniform4fv;
+    s.m_gl.uniformMatrix4fv = glad_glUniformMatrix4fv;
+    s.m_gl.unmapBuffer = glad_glUnmapBuffer;
+    s.m_gl.useProgram = glad_glUseProgram;
+    s.m_gl.vertexAttribDivisor = glad_glVertexAttribDivisor;
+    s.m_gl.vertexAttribPointer = glad_glVertexAttribPointer;
+    s.m_gl.viewport = glad_glViewport;
+
+    // Wrap the entry points used by the engine
+    glad_glActiveTexture = &GLCapture::activeTexture;
+    glad_glAttachShader = &GLCapture::attachShader;
+    glad_glBindBuffer = &GLCapture::bindBuffer;
+    glad_glBindBufferRange = &GLCapture::bindBufferRange;
+    glad_glBindFramebuffer = &GLCapture::bindFramebuffer;
+    glad_glBindImageTexture = &GLCapture::bindImageTexture;
+    glad_glBindTexture = &GLCapture::bindTexture;
+    glad_glBindVertexArray = &GLCapture::bindVertexArray;
+    glad_glBlendFunc = &GLCapture::blendFunc;
+    glad_glBlitFramebuffer = &GLCapture::blitFramebuffer;
+    glad_glBufferData = &GLCapture::bufferData;
+    glad_glBufferStorage = &GLCapture::bufferStorage;
+    glad_glBufferSubData = &GLCapture::bufferSubData;
+    glad_glClear = &GLCapture::clear;
+    glad_glClearColor = &GLCapture::clearColor;
+    glad_glColorMask = &GLCapture::colorMask;
+    glad_glCompileShader = &GLCapture::compileShader;
+    glad_glCompressedTexImage2D = &GLCapture::compressedTexImage2D;
+    glad_glCopyBufferSubData = &GLCapture::copyBufferSubData;
+    glad_glCopyImageSubData = &GLCapture::copyImageSubData;
+    glad_glCreateProgram = &GLCapture::createProgram;
+    glad_glCreateShader = &GLCapture::createShader;
+    glad_glDeleteBuffers = &GLCapture::deleteBuffers;
+    glad_glDeleteFramebuffers = &GLCapture::deleteFramebuffers;
+    glad_glDeleteProgram = &GLCapture::deleteProgram;
+    glad_glDeleteShader = &GLCapture::deleteShader;
+    glad_glDeleteTextures = &GLCapture::deleteTextures;
+    glad_glDeleteVertexArrays = &GLCapture::deleteVertexArrays;
+    glad_glDepthFunc = &GLCapture::depthFunc;
+    glad_glDepthMask = &GLCapture::depthMask;
+    glad_glDisable = &GLCapture::disable;
+    glad_glDisableVertexAttribArray = &GLCapture::disableVertexAttribArray;
+    glad_glDispatchCompute = &GLCapture::dispatchCompute;
+    glad_glDrawArrays = &GLCapture::drawArrays;
+    glad_glDrawArraysIndirect = &GLCapture::drawArraysIndirect;
+    glad_glDrawArraysInstanced = &GLCapture::drawArraysInstanced;
+    glad_glDrawArraysInstancedBaseInstance = &GLCapture::drawArraysInstancedBaseInstance;
+    glad_glDrawElements = &GLCapture::drawElements;
+    glad_glDrawElementsIndirect = &GLCapture::drawElementsIndirect;
+    glad_glDrawElementsInstanced = &GLCapture::drawElementsInstanced;
+    glad_glEnable = &GLCapture::enable;
+    glad_glEnableVertexAttribArray = &GLCapture::enableVertexAttribArray;
+    glad_glFramebufferTexture2D = &GLCapture::framebufferTexture2D;
+    glad_glGenBuffers = &GLCapture::genBuffers;
+    glad_glGenerateMipmap = &GLCapture::generateMipmap;
+    glad_glGenFramebuffers = &GLCapture::genFramebuffers;
+    glad_glGenTextures = &GLCapture::genTextures;
+    glad_glGenVertexArrays = &GLCapture::genVertexArrays;
+    glad_glGetIntegerv = &GLCapture::getIntegerv;
+    glad_glLinkProgram = &GLCapture::linkProgram;
+    glad_glMapBuffer = &GLCapture::mapBuffer;
+    glad_glMapBufferRange = &GLCapture::mapBufferRange;
+    glad_glMemoryBarrier = &GLCapture::memoryBarrier;
+    glad_glMultiDrawArraysIndirect = &GLCapture::multiDrawArraysIndirect;
+    glad_glPixelStorei = &GLCapture::pixelStorei;
+    glad_glPolygonMode = &GLCapture::polygonMode;
+    glad_glProgramBinary = &GLCapture::programBinary;
+    glad_glProgramParameteri = &GLCapture::programParameteri;
+    glad_glShaderSource = &GLCapture::shaderSource;
+    glad_glTexImage2D = &GLCapture::texImage2D;
+    glad_glTexParameteri = &GLCapture::texParameteri;
+    glad_glTexStorage2D = &GLCapture::texStorage2D;
+    glad_glTexStorage3D = &GLCapture::texStorage3D;
+    glad_glTexSubImage2D = &GLCapture::texSubImage2D;
+    glad_glTexSubImage3D = &GLCapture::texSubImage3D;
+    glad_glUniform1i = &GLCapture::uniform1i;
+    glad_glUniform4fv = &GLCapture::uniform4fv;
+    glad_glUniformMatrix4fv = &GLCapture::uniformMatrix4fv;
+    glad_glUnmapBuffer = &GLCapture::unmapBuffer;
+    glad_glUseProgram = &GLCapture::useProgram;
+    glad_glVertexAttribDivisor = &GLCapture::vertexAttribDivisor;
+    glad_glVertexAttribPointer = &GLCapture::vertexAttribPointer;
+    glad_glViewport = &GLCapture::viewport;
+
+    s.m_installed = true;
+    LOG_INFO("Capturing {0} frames starting with frame {1} into '{2}'", s.m_frames, s.m_firstFrame, s.m_path);
+
+    if (s.m_firstFrame == 0)
+    {
+        s.start();
+    }
+}
+
+void GLCapture::shutdown()
+{
+    GLCapture& s = *ms_pInstance;
+    if (!s.m_installed)
+    {
+        return;
+    }
+
+    LOG_WARN("Capture stopped after {0} of {1} frames", s.m_captured, s.m_frames);
+    s.finish();
+}
+
+void GLCapture::present()
+{
+    GLCapture& s = *ms_pInstance;
+    if (!s.m_installed)
+    {
+        return;
+    }
+
+    s.m_frame++;
+
+    if (!s.m_capturing)
+    {
+        if (s.m_frame == s.m_firstFrame)
+        {
+            s.start();
+        }
+
+        return;
+    }
+
+    s.begin(CaptureOp::Frame);
+    s.end();
+
+    if (++s.m_captured == s.m_frames)
+    {
+        s.finish();
+    }
+}
+
+void GLCapture::begin(CaptureOp op)
+{
+    m_data.push_back((unsigned char)op);
+
+    // Size of the arguments is filled in when the record ends
+    m_record = m_data.size();
+    put((unsigned int)0);
+}
+
+template<typename T>
+void GLCapture::put(const T& value)
+{
+    size_t offset = m_data.size();
+    m_data.resize(offset + sizeof(T));
+    memcpy(m_data.data() + offset, &value, sizeof(T));
+}
+
+void GLCapture::putData(const void* pData, size_t size)
+{
+    put((GLsizeiptr)size);
+
+    if (size > 0)
+    {
+        const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+        m_data.insert(m_data.end(), pBytes, pBytes + size);
+    }
+}
+
+void GLCapture::putPixels(const void* pPixels, size_t size)
+{
+    // With a pixel buffer the pointer is an offset into it
+    GLboolean fromBuffer = boundBuffer(GL_PIXEL_UNPACK_BUFFER) != 0;
+    put(fromBuffer);
+
+    if (fromBuffer)
+    {
+        put((GLintptr)pPixels);
+    }
+    else
+    {
+        putData(pPixels, pPixels ? size : 0);
+    }
+}
+
+void GLCapture::end()
+{
+    unsigned int size = (unsigned int)(m_data.size() - m_record - sizeof(unsigned int));
+    memcpy(m_data.data() + m_record, &size, sizeof(unsigned int));
+
+    if (m_data.size() >= ms_chunkSize)
+    {
+        m_file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+        m_written += m_data.size();
+        m_data.clear();
+    }
+}
+
+bool GLCapture::output()
+{
+    if (!m_capturing)
+    {
+        return false;
+    }
+
+    writeMappings();
+    return true;
+}
+
+void GLCapture::writeMappings()
+{
+    for (Mapping& mapping : m_mappings)
+    {
+        if (!mapping.Persistent)
+        {
+            continue;
+        }
+
+        // Neighbouring changed blocks are written as one update
+        size_t length = (size_t)mapping.Length;
+        size_t block = 0;
+        while (block < length)
+        {
+            size_t size = std::min(ms_blockSize, length - block);
+            if (memcmp(mapping.pMemory + block, mapping.Written.data() + block, size) == 0)
+            {
+                block += size;
+                continue;
+            }
+
+            size_t first = block;
+            while (block < length)
+            {
+                size = std::min(ms_blockSize, length - block);
+                if (memcmp(mapping.pMemory + block, mapping.Written.data() + block, size) == 0)
+                {
+                    break;
+                }
+
+                block += size;
+            }
+
+            memcpy(mapping.Written.data() + first, mapping.pMemory + first, block - first);
+
+            begin(CaptureOp::BufferUpdate);
+            put(mapping.Buffer);
+            put((GLintptr)(mapping.Offset + first));
+            putData(mapping.pMemory + first, block - first);
+            end();
+        }
+    }
+}
+
+void GLCapture::unmap(GLuint buffer)
+{
+    auto it = std::find_if(m_mappings.begin(), m_mappings.end(), [buffer](const Mapping& mapping)
+    {
+        return mapping.Buffer == buffer;
+    });
+
+    if (it == m_mappings.end())
+    {
+        return;
+    }
+
+    // Changes to persistently mapped memory are written before the draws reading it
+    if (!it->Persistent)
+    {
+        begin(CaptureOp::BufferUpdate);
+        put(it->Buffer);
+        put(it->Offset);
+        putData(it->pMemory, (size_t)it->Length);
+        end();
+    }
+
+    m_mappings.erase(it);
+}
+
+void GLCapture::putNames(CaptureOp op, GLsizei n, const GLuint* pNames)
+{
+    begin(op);
+    put(n);
+    for (GLsizei i = 0; i < n; i++)
+    {
+        put(pNames[i]);
+    }
+    end();
+}
+
+void GLCapture::trackBuffer(GLenum target, GLuint buffer)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        m_elementBuffers[m_vertexArray] = buffer;
+    }
+    else
+    {
+        m_buffers[target] = buffer;
+    }
+}
+
+GLuint GLCapture::boundBuffer(GLenum target)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        return m_elementBuffers[m_vertexArray];
+    }
+
+    return m_buffers[target];
+}
+
+void GLCapture::start()
+{
+    begin(CaptureOp::Start);
+    end();
+
+    m_capturing = true;
+}
+
+void GLCapture::finish()
+{
+    m_file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+    m_written += m_data.size();
+    m_data.clear();
+
+    // Frame count in the header
+    unsigned int frames = (unsigned int)m_captured;
+    m_file.seekp(offsetof(CaptureHeader, Frames));
+    m_file.write(reinterpret_cast<const char*>(&frames), sizeof(unsigned int));
+    m_file.close();
+
+    // Restore the entry points
+    glad_glActiveTexture = m_gl.activeTexture;
+    glad_glAttachShader = m_gl.attachShader;
+    glad_glBindBuffer = m_gl.bindBuffer;
+    glad_glBindBufferRange = m_gl.bindBufferRange;
+    glad_glBindFramebuffer = m_gl.bindFramebuffer;
+    glad_glBindImageTexture = m_gl.bindImageTexture;
+    glad_glBindTexture = m_gl.bindTexture;
+    glad_glBindVertexArray = m_gl.bindVertexArray;
+    glad_glBlendFunc = m_gl.blendFunc;
+    glad_glBlitFramebuffer = m_gl.blitFramebuffer;
+    glad_glBufferData = m_gl.bufferData;
+    glad_glBufferStorage = m_gl.bufferStorage;
+    glad_glBufferSubData = m_gl.bufferSubData;
+    glad_glClear = m_gl.clear;
+    glad_glClearColor = m_gl.clearColor;
+    glad_glColorMask = m_gl.colorMask;
+    glad_glCompileShader = m_gl.compileShader;
+    glad_glCompressedTexImage2D = m_gl.compressedTexImage2D;
+    glad_glCopyBufferSubData = m_gl.copyBufferSubData;
+    glad_glCopyImageSubData = m_gl.copyImageSubData;
+    glad_glCreateProgram = m_gl.createProgram;
+    glad_glCreateShader = m_gl.createShader;
+    glad_glDeleteBuffers = m_gl.deleteBuffers;
+    glad_glDeleteFramebuffers = m_gl.deleteFramebuffers;
+    glad_glDeleteProgram = m_gl.deleteProgram;
+    glad_glDeleteShader = m_gl.deleteShader;
+    glad_glDeleteTextures = m_gl.deleteTextures;
+    glad_glDeleteVertexArrays = m_gl.deleteVertexArrays;
+    glad_glDepthFunc = m_gl.depthFunc;
+    glad_glDepthMask = m_gl.depthMask;
+    glad_glDisable = m_gl.disable;
+    glad_glDisableVertexAttribArray = m_gl.disableVertexAttribArray;
+    glad_glDispatchCompute = m_gl.dispatchCompute;
+    glad_glDrawArrays = m_gl.drawArrays;
+    glad_glDrawArraysIndirect = m_gl.drawArraysIndirect;
+    glad_glDrawArraysInstanced = m_gl.drawArraysInstanced;
+    glad_glDrawArraysInstancedBaseInstance = m_gl.drawArraysInstancedBaseInstance;
+    glad_glDrawElements = m_gl.drawElements;
+    glad_glDrawElementsIndirect = m_gl.drawElementsIndirect;
+    glad_glDrawElementsInstanced = m_gl.drawElementsInstanced;
+    glad_glEnable = m_gl.enable;
+    glad_glEnableVertexAttribArray = m_gl.enableVertexAttribArray;
+    glad_glFramebufferTexture2D = m_gl.framebufferTexture2D;
+    glad_glGenBuffers = m_gl.genBuffers;
+    glad_glGenerateMipmap = m_gl.generateMipmap;
+    glad_glGenFramebuffers = m_gl.genFramebuffers;
+    glad_glGenTextures = m_gl.genTextures;
+    glad_glGenVertexArrays = m_gl.genVertexArrays;
+    glad_glGetIntegerv = m_gl.getIntegerv;
+    glad_glLinkProgram = m_gl.linkProgram;
+    glad_glMapBuffer = m_gl.mapBuffer;
+    glad_glMapBufferRange = m_gl.mapBufferRange;
+    glad_glMemoryBarrier = m_gl.memoryBarrier;
+    glad_glMultiDrawArraysIndirect = m_gl.multiDrawArraysIndirect;
+    glad_glPixelStorei = m_gl.pixelStorei;
+    glad_glPolygonMode = m_gl.polygonMode;
+    glad_glProgramBinary = m_gl.programBinary;
+    glad_glProgramParameteri = m_gl.programParameteri;
+    glad_glShaderSource = m_gl.shaderSource;
+    glad_glTexImage2D = m_gl.texImage2D;
+    glad_glTexParameteri = m_gl.texParameteri;
+    glad_glTexStorage2D = m_gl.texStorage2D;
+    glad_glTexStorage3D = m_gl.texStorage3D;
+    glad_glTexSubImage2D = m_gl.texSubImage2D;
+    glad_glTexSubImage3D = m_gl.texSubImage3D;
+    glad_glUniform1i = m_gl.uniform1i;
+    glad_glUniform4fv = m_gl.uniform4fv;
+    glad_glUniformMatrix4fv = m_gl.uniformMatrix4fv;
+    glad_glUnmapBuffer = m_gl.unmapBuffer;
+    glad_glUseProgram = m_gl.useProgram;
+    glad_glVertexAttribDivisor = m_gl.vertexAttribDivisor;
+    glad_glVertexAttribPointer = m_gl.vertexAttribPointer;
+    glad_glViewport = m_gl.viewport;
+
+    m_installed = false;
+    m_capturing = false;
+    m_mappings.clear();
+
+    LOG_INFO("Captured {0} frames into '{1}', {2} KB", m_captured, m_path, m_written / 1024);
+}
+
+void APIENTRY GLCapture::activeTexture(GLenum texture)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.activeTexture(texture);
+
+    s.begin(CaptureOp::ActiveTexture);
+    s.put(texture);
+    s.end();
+}
+
+void APIENTRY GLCapture::attachShader(GLuint program, GLuint shader)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.attachShader(program, shader);
+
+    s.begin(CaptureOp::AttachShader);
+    s.put(program);
+    s.put(shader);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindBuffer(target, buffer);
+
+    // Mapped buffers are found through the bindings
+    s.trackBuffer(target, buffer);
+
+    s.begin(CaptureOp::BindBuffer);
+    s.put(target);
+    s.put(buffer);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindBufferRange(target, index, buffer, offset, size);
+
+    s.trackBuffer(target, buffer);
+
+    s.begin(CaptureOp::BindBufferRange);
+    s.put(target);
+    s.put(index);
+    s.put(buffer);
+    s.put(offset);
+    s.put(size);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindFramebuffer(target, framebuffer);
+
+    s.begin(CaptureOp::BindFramebuffer);
+    s.put(target);
+    s.put(framebuffer);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindImageTexture(unit, texture, level, layered, layer, access, format);
+
+    s.begin(CaptureOp::BindImageTexture);
+    s.put(unit);
+    s.put(texture);
+    s.put(level);
+    s.put(layered);
+    s.put(layer);
+    s.put(access);
+    s.put(format);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindTexture(GLenum target, GLuint texture)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindTexture(target, texture);
+
+    s.begin(CaptureOp::BindTexture);
+    s.put(target);
+    s.put(texture);
+    s.end();
+}
+
+void APIENTRY GLCapture::bindVertexArray(GLuint array)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bindVertexArray(array);
+
+    // The element buffer binding is part of the vertex array
+    s.m_vertexArray = array;
+
+    s.begin(CaptureOp::BindVertexArray);
+    s.put(array);
+    s.end();
+}
+
+void APIENTRY GLCapture::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.blendFunc(sfactor, dfactor);
+
+    s.begin(CaptureOp::BlendFunc);
+    s.put(sfactor);
+    s.put(dfactor);
+    s.end();
+}
+
+void APIENTRY GLCapture::blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.blitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::BlitFramebuffer);
+    s.put(srcX0);
+    s.put(srcY0);
+    s.put(srcX1);
+    s.put(srcY1);
+    s.put(dstX0);
+    s.put(dstY0);
+    s.put(dstX1);
+    s.put(dstY1);
+    s.put(mask);
+    s.put(filter);
+    s.end();
+}
+
+void APIENTRY GLCapture::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bufferData(target, size, data, usage);
+
+    s.m_bufferSizes[s.boundBuffer(target)] = size;
+
+    s.begin(CaptureOp::BufferData);
+    s.put(target);
+    s.put(size);
+    s.putData(data, data ? (size_t)size : 0);
+    s.put(usage);
+    s.end();
+}
+
+void APIENTRY GLCapture::bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    GLCapture& s = *ms_pInstance;
+
+    // Mapped memory is read back when it's written to the file
+    GLbitfield storageFlags = flags;
+    if (flags & GL_MAP_WRITE_BIT)
+    {
+        storageFlags |= GL_MAP_READ_BIT;
+    }
+
+    s.m_gl.bufferStorage(target, size, data, storageFlags);
+
+    s.m_bufferSizes[s.boundBuffer(target)] = size;
+
+    s.begin(CaptureOp::BufferStorage);
+    s.put(target);
+    s.put(size);
+    s.putData(data, data ? (size_t)size : 0);
+    s.put(flags);
+    s.end();
+}
+
+void APIENTRY GLCapture::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.bufferSubData(target, offset, size, data);
+
+    s.begin(CaptureOp::BufferSubData);
+    s.put(target);
+    s.put(offset);
+    s.putData(data, (size_t)size);
+    s.end();
+}
+
+void APIENTRY GLCapture::clear(GLbitfield mask)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.clear(mask);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::Clear);
+    s.put(mask);
+    s.end();
+}
+
+void APIENTRY GLCapture::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.clearColor(red, green, blue, alpha);
+
+    s.begin(CaptureOp::ClearColor);
+    s.put(red);
+    s.put(green);
+    s.put(blue);
+    s.put(alpha);
+    s.end();
+}
+
+void APIENTRY GLCapture::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.colorMask(red, green, blue, alpha);
+
+    s.begin(CaptureOp::ColorMask);
+    s.put(red);
+    s.put(green);
+    s.put(blue);
+    s.put(alpha);
+    s.end();
+}
+
+void APIENTRY GLCapture::compileShader(GLuint shader)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.compileShader(shader);
+
+    s.begin(CaptureOp::CompileShader);
+    s.put(shader);
+    s.end();
+}
+
+void APIENTRY GLCapture::compressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.compressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+
+    s.begin(CaptureOp::CompressedTexImage2D);
+    s.put(target);
+    s.put(level);
+    s.put(internalformat);
+    s.put(width);
+    s.put(height);
+    s.put(border);
+    s.put(imageSize);
+    s.putPixels(data, (size_t)imageSize);
+    s.end();
+}
+
+void APIENTRY GLCapture::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+
+    s.begin(CaptureOp::CopyBufferSubData);
+    s.put(readTarget);
+    s.put(writeTarget);
+    s.put(readOffset);
+    s.put(writeOffset);
+    s.put(size);
+    s.end();
+}
+
+void APIENTRY GLCapture::copyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.copyImageSubData(srcName, srcTarget, srcLevel, srcX, srcY, srcZ, dstName, dstTarget, dstLevel, dstX, dstY, dstZ, srcWidth, srcHeight, srcDepth);
+
+    s.begin(CaptureOp::CopyImageSubData);
+    s.put(srcName);
+    s.put(srcTarget);
+    s.put(srcLevel);
+    s.put(srcX);
+    s.put(srcY);
+    s.put(srcZ);
+    s.put(dstName);
+    s.put(dstTarget);
+    s.put(dstLevel);
+    s.put(dstX);
+    s.put(dstY);
+    s.put(dstZ);
+    s.put(srcWidth);
+    s.put(srcHeight);
+    s.put(srcDepth);
+    s.end();
+}
+
+GLuint APIENTRY GLCapture::createProgram()
+{
+    GLCapture& s = *ms_pInstance;
+    GLuint program = s.m_gl.createProgram();
+
+    s.begin(CaptureOp::CreateProgram);
+    s.put(program);
+    s.end();
+
+    return program;
+}
+
+GLuint APIENTRY GLCapture::createShader(GLenum type)
+{
+    GLCapture& s = *ms_pInstance;
+    GLuint shader = s.m_gl.createShader(type);
+
+    s.begin(CaptureOp::CreateShader);
+    s.put(type);
+    s.put(shader);
+    s.end();
+
+    return shader;
+}
+
+void APIENTRY GLCapture::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteBuffers(n, buffers);
+
+    s.putNames(CaptureOp::DeleteBuffers, n, buffers);
+
+    // Deleted buffers are unmapped and unbound
+    for (GLsizei i = 0; i < n; i++)
+    {
+        GLuint buffer = buffers[i];
+        s.m_mappings.erase(std::remove_if(s.m_mappings.begin(), s.m_mappings.end(), [buffer](const Mapping& mapping)
+        {
+            return mapping.Buffer == buffer;
+        }), s.m_mappings.end());
+
+        for (auto& binding : s.m_buffers)
+        {
+            binding.second = binding.second == buffer ? 0 : binding.second;
+        }
+
+        for (auto& binding : s.m_elementBuffers)
+        {
+            binding.second = binding.second == buffer ? 0 : binding.second;
+        }
+
+        s.m_bufferSizes.erase(buffer);
+    }
+}
+
+void APIENTRY GLCapture::deleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteFramebuffers(n, framebuffers);
+
+    s.putNames(CaptureOp::DeleteFramebuffers, n, framebuffers);
+}
+
+void APIENTRY GLCapture::deleteProgram(GLuint program)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteProgram(program);
+
+    s.begin(CaptureOp::DeleteProgram);
+    s.put(program);
+    s.end();
+}
+
+void APIENTRY GLCapture::deleteShader(GLuint shader)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteShader(shader);
+
+    s.begin(CaptureOp::DeleteShader);
+    s.put(shader);
+    s.end();
+}
+
+void APIENTRY GLCapture::deleteTextures(GLsizei n, const GLuint* textures)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteTextures(n, textures);
+
+    s.putNames(CaptureOp::DeleteTextures, n, textures);
+}
+
+void APIENTRY GLCapture::deleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.deleteVertexArrays(n, arrays);
+
+    s.putNames(CaptureOp::DeleteVertexArrays, n, arrays);
+
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.m_elementBuffers.erase(arrays[i]);
+        s.m_vertexArray = s.m_vertexArray == arrays[i] ? 0 : s.m_vertexArray;
+    }
+}
+
+void APIENTRY GLCapture::depthFunc(GLenum func)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.depthFunc(func);
+
+    s.begin(CaptureOp::DepthFunc);
+    s.put(func);
+    s.end();
+}
+
+void APIENTRY GLCapture::depthMask(GLboolean flag)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.depthMask(flag);
+
+    s.begin(CaptureOp::DepthMask);
+    s.put(flag);
+    s.end();
+}
+
+void APIENTRY GLCapture::disable(GLenum cap)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.disable(cap);
+
+    s.begin(CaptureOp::Disable);
+    s.put(cap);
+    s.end();
+}
+
+void APIENTRY GLCapture::disableVertexAttribArray(GLuint index)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.disableVertexAttribArray(index);
+
+    s.begin(CaptureOp::DisableVertexAttribArray);
+    s.put(index);
+    s.end();
+}
+
+void APIENTRY GLCapture::dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.dispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DispatchCompute);
+    s.put(num_groups_x);
+    s.put(num_groups_y);
+    s.put(num_groups_z);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawArrays(mode, first, count);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawArrays);
+    s.put(mode);
+    s.put(first);
+    s.put(count);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawArraysIndirect(GLenum mode, const void* indirect)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawArraysIndirect(mode, indirect);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawArraysIndirect);
+    s.put(mode);
+    s.put((GLintptr)indirect);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawArraysInstanced(mode, first, count, instancecount);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawArraysInstanced);
+    s.put(mode);
+    s.put(first);
+    s.put(count);
+    s.put(instancecount);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawArraysInstancedBaseInstance);
+    s.put(mode);
+    s.put(first);
+    s.put(count);
+    s.put(instancecount);
+    s.put(baseinstance);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawElements(mode, count, type, indices);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawElements);
+    s.put(mode);
+    s.put(count);
+    s.put(type);
+    s.put((GLintptr)indices);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawElementsIndirect(GLenum mode, GLenum type, const void* indirect)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawElementsIndirect(mode, type, indirect);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawElementsIndirect);
+    s.put(mode);
+    s.put(type);
+    s.put((GLintptr)indirect);
+    s.end();
+}
+
+void APIENTRY GLCapture::drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.drawElementsInstanced(mode, count, type, indices, instancecount);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::DrawElementsInstanced);
+    s.put(mode);
+    s.put(count);
+    s.put(type);
+    s.put((GLintptr)indices);
+    s.put(instancecount);
+    s.end();
+}
+
+void APIENTRY GLCapture::enable(GLenum cap)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.enable(cap);
+
+    s.begin(CaptureOp::Enable);
+    s.put(cap);
+    s.end();
+}
+
+void APIENTRY GLCapture::enableVertexAttribArray(GLuint index)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.enableVertexAttribArray(index);
+
+    s.begin(CaptureOp::EnableVertexAttribArray);
+    s.put(index);
+    s.end();
+}
+
+void APIENTRY GLCapture::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.framebufferTexture2D(target, attachment, textarget, texture, level);
+
+    s.begin(CaptureOp::FramebufferTexture2D);
+    s.put(target);
+    s.put(attachment);
+    s.put(textarget);
+    s.put(texture);
+    s.put(level);
+    s.end();
+}
+
+void APIENTRY GLCapture::genBuffers(GLsizei n, GLuint* buffers)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.genBuffers(n, buffers);
+
+    s.putNames(CaptureOp::GenBuffers, n, buffers);
+}
+
+void APIENTRY GLCapture::generateMipmap(GLenum target)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.generateMipmap(target);
+
+    s.begin(CaptureOp::GenerateMipmap);
+    s.put(target);
+    s.end();
+}
+
+void APIENTRY GLCapture::genFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.genFramebuffers(n, framebuffers);
+
+    s.putNames(CaptureOp::GenFramebuffers, n, framebuffers);
+}
+
+void APIENTRY GLCapture::genTextures(GLsizei n, GLuint* textures)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.genTextures(n, textures);
+
+    s.putNames(CaptureOp::GenTextures, n, textures);
+}
+
+void APIENTRY GLCapture::genVertexArrays(GLsizei n, GLuint* arrays)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.genVertexArrays(n, arrays);
+
+    s.putNames(CaptureOp::GenVertexArrays, n, arrays);
+}
+
+void APIENTRY GLCapture::getIntegerv(GLenum pname, GLint* data)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.getIntegerv(pname, data);
+
+    // Without binary formats the shader cache compiles every program from source
+    if (pname == GL_NUM_PROGRAM_BINARY_FORMATS)
+    {
+        *data = 0;
+    }
+}
+
+void APIENTRY GLCapture::linkProgram(GLuint program)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.linkProgram(program);
+
+    s.begin(CaptureOp::LinkProgram);
+    s.put(program);
+    s.end();
+}
+
+void* APIENTRY GLCapture::mapBuffer(GLenum target, GLenum access)
+{
+    GLCapture& s = *ms_pInstance;
+
+    // The memory is read back when the buffer is unmapped
+    void* pMemory = s.m_gl.mapBuffer(target, GL_READ_WRITE);
+
+    GLuint buffer = s.boundBuffer(target);
+    if (pMemory)
+    {
+        Mapping mapping;
+        mapping.Buffer = buffer;
+        mapping.Length = s.m_bufferSizes[buffer];
+        mapping.pMemory = static_cast<unsigned char*>(pMemory);
+        s.m_mappings.push_back(std::move(mapping));
+    }
+
+    return pMemory;
+}
+
+void* APIENTRY GLCapture::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    GLCapture& s = *ms_pInstance;
+
+    // The memory is read back, reading isn't allowed with invalidation or unsynchronized mapping
+    GLbitfield readAccess = (access | GL_MAP_READ_BIT) &
+        ~(GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    void* pMemory = s.m_gl.mapBufferRange(target, offset, length, readAccess);
+
+    GLuint buffer = s.boundBuffer(target);
+    if (pMemory)
+    {
+        Mapping mapping;
+        mapping.Buffer = buffer;
+        mapping.Offset = offset;
+        mapping.Length = length;
+        mapping.pMemory = static_cast<unsigned char*>(pMemory);
+        mapping.Persistent = (access & GL_MAP_PERSISTENT_BIT) != 0;
+
+        // Persistently mapped memory starts with the contents of the buffer
+        if (mapping.Persistent)
+        {
+            mapping.Written.assign(mapping.pMemory, mapping.pMemory + length);
+        }
+
+        s.m_mappings.push_back(std::move(mapping));
+    }
+
+    return pMemory;
+}
+
+void APIENTRY GLCapture::memoryBarrier(GLbitfield barriers)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.memoryBarrier(barriers);
+
+    s.begin(CaptureOp::Barrier);
+    s.put(barriers);
+    s.end();
+}
+
+void APIENTRY GLCapture::multiDrawArraysIndirect(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.multiDrawArraysIndirect(mode, indirect, drawcount, stride);
+
+    // Output of the frames before the captured ones isn't needed
+    if (!s.output())
+    {
+        return;
+    }
+
+    s.begin(CaptureOp::MultiDrawArraysIndirect);
+    s.put(mode);
+    s.put((GLintptr)indirect);
+    s.put(drawcount);
+    s.put(stride);
+    s.end();
+}
+
+void APIENTRY GLCapture::pixelStorei(GLenum pname, GLint param)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.pixelStorei(pname, param);
+
+    // Size of client pixel data depends on the row alignment
+    if (pname == GL_UNPACK_ALIGNMENT)
+    {
+        s.m_unpackAlignment = param;
+    }
+
+    s.begin(CaptureOp::PixelStorei);
+    s.put(pname);
+    s.put(param);
+    s.end();
+}
+
+void APIENTRY GLCapture::polygonMode(GLenum face, GLenum mode)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.polygonMode(face, mode);
+
+    s.begin(CaptureOp::PolygonMode);
+    s.put(face);
+    s.put(mode);
+    s.end();
+}
+
+void APIENTRY GLCapture::programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.programBinary(program, binaryFormat, binary, length);
+
+    s.begin(CaptureOp::ProgramBinary);
+    s.put(program);
+    s.put(binaryFormat);
+    s.putData(binary, (size_t)length);
+    s.end();
+}
+
+void APIENTRY GLCapture::programParameteri(GLuint program, GLenum pname, GLint value)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.programParameteri(program, pname, value);
+
+    s.begin(CaptureOp::ProgramParameteri);
+    s.put(program);
+    s.put(pname);
+    s.put(value);
+    s.end();
+}
+
+void APIENTRY GLCapture::shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.shaderSource(shader, count, string, length);
+
+    // Without lengths the strings are null terminated
+    std::string source;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (length && length[i] >= 0)
+        {
+            source.append(string[i], length[i]);
+        }
+        else
+        {
+            source.append(string[i]);
+        }
+    }
+
+    s.begin(CaptureOp::ShaderSource);
+    s.put(shader);
+    s.putData(source.data(), source.size());
+    s.end();
+}
+
+void APIENTRY GLCapture::texImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+
+    s.begin(CaptureOp::TexImage2D);
+    s.put(target);
+    s.put(level);
+    s.put(internalformat);
+    s.put(width);
+    s.put(height);
+    s.put(border);
+    s.put(format);
+    s.put(type);
+    s.putPixels(pixels, getImageSize(width, height, 1, format, type, s.m_unpackAlignment));
+    s.end();
+}
+
+void APIENTRY GLCapture::texParameteri(GLenum target, GLenum pname, GLint param)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texParameteri(target, pname, param);
+
+    s.begin(CaptureOp::TexParameteri);
+    s.put(target);
+    s.put(pname);
+    s.put(param);
+    s.end();
+}
+
+void APIENTRY GLCapture::texStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texStorage2D(target, levels, internalformat, width, height);
+
+    s.begin(CaptureOp::TexStorage2D);
+    s.put(target);
+    s.put(levels);
+    s.put(internalformat);
+    s.put(width);
+    s.put(height);
+    s.end();
+}
+
+void APIENTRY GLCapture::texStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texStorage3D(target, levels, internalformat, width, height, depth);
+
+    s.begin(CaptureOp::TexStorage3D);
+    s.put(target);
+    s.put(levels);
+    s.put(internalformat);
+    s.put(width);
+    s.put(height);
+    s.put(depth);
+    s.end();
+}
+
+void APIENTRY GLCapture::texSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+
+    s.begin(CaptureOp::TexSubImage2D);
+    s.put(target);
+    s.put(level);
+    s.put(xoffset);
+    s.put(yoffset);
+    s.put(width);
+    s.put(height);
+    s.put(format);
+    s.put(type);
+    s.putPixels(pixels, getImageSize(width, height, 1, format, type, s.m_unpackAlignment));
+    s.end();
+}
+
+void APIENTRY GLCapture::texSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.texSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+
+    s.begin(CaptureOp::TexSubImage3D);
+    s.put(target);
+    s.put(level);
+    s.put(xoffset);
+    s.put(yoffset);
+    s.put(zoffset);
+    s.put(width);
+    s.put(height);
+    s.put(depth);
+    s.put(format);
+    s.put(type);
+    s.putPixels(pixels, getImageSize(width, height, depth, format, type, s.m_unpackAlignment));
+    s.end();
+}
+
+void APIENTRY GLCapture::uniform1i(GLint location, GLint v0)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.uniform1i(location, v0);
+
+    s.begin(CaptureOp::Uniform1i);
+    s.put(location);
+    s.put(v0);
+    s.end();
+}
+
+void APIENTRY GLCapture::uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.uniform4fv(location, count, value);
+
+    s.begin(CaptureOp::Uniform4fv);
+    s.put(location);
+    s.put(count);
+    s.putData(value, (size_t)count * 4 * sizeof(GLfloat));
+    s.end();
+}
+
+void APIENTRY GLCapture::uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.uniformMatrix4fv(location, count, transpose, value);
+
+    s.begin(CaptureOp::UniformMatrix4fv);
+    s.put(location);
+    s.put(count);
+    s.put(transpose);
+    s.putData(value, (size_t)count * 16 * sizeof(GLfloat));
+    s.end();
+}
+
+GLboolean APIENTRY GLCapture::unmapBuffer(GLenum target)
+{
+    GLCapture& s = *ms_pInstance;
+
+    // The written memory is recorded while it's still mapped
+    s.unmap(s.boundBuffer(target));
+
+    return s.m_gl.unmapBuffer(target);
+}
+
+void APIENTRY GLCapture::useProgram(GLuint program)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.useProgram(program);
+
+    s.begin(CaptureOp::UseProgram);
+    s.put(program);
+    s.end();
+}
+
+void APIENTRY GLCapture::vertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.vertexAttribDivisor(index, divisor);
+
+    s.begin(CaptureOp::VertexAttribDivisor);
+    s.put(index);
+    s.put(divisor);
+    s.end();
+}
+
+void APIENTRY GLCapture::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.vertexAttribPointer(index, size, type, normalized, stride, pointer);
+
+    s.begin(CaptureOp::VertexAttribPointer);
+    s.put(index);
+    s.put(size);
+    s.put(type);
+    s.put(normalized);
+    s.put(stride);
+    s.put((GLintptr)pointer);
+    s.end();
+}
+
+void APIENTRY GLCapture::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLCapture& s = *ms_pInstance;
+    s.m_gl.viewport(x, y, width, height);
+
+    s.begin(CaptureOp::Viewport);
+    s.put(x);
+    s.put(y);
+    s.put(width);
+    s.put(height);
+    s.end();
+}
@@ -0,0 +1,365 @@
+#pragma once
+
+// Capture file
+#include <string>
+#include <fstream>
+
+// Recorded data and bindings
+#include <vector>
+#include <unordered_map>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+// Layout of the capture file
+#include "OpenGLModules/CaptureFormat.h"
+
+
+/**
+ * GL capture wraps the OpenGL entry points loaded by Glad and writes the calls
+ * of a range of frames to a binary file the replay tool executes without the
+ * engine. The calls are forwarded to the entry points that were installed
+ * before, so the capture works with a window and with the null backend.
+ *
+ * Everything from the creation of the context is recorded so the file holds
+ * the resources the frames use. Draws, clears, blits and dispatches of the
+ * frames before the captured ones are left out since their output is
+ * overwritten, the captured frames are recorded in full. Buffer uploads,
+ * texture uploads and shader sources are written with their data. Writes
+ * into mapped buffers are written when the buffer is unmapped, persistently
+ * mapped memory is compared to a copy before each draw and the changed blocks
+ * are written. Queries, fences and getters don't change what is drawn and
+ * aren't recorded.
+ *
+ * While capturing no program binary formats are reported so programs are
+ * compiled from source and the file can be replayed on any driver. Once the
+ * frames are captured the file is closed and the previous entry points are
+ * restored. The capture is installed and used on the thread executing render
+ * commands.
+ */
+class GLCapture
+{
+public:
+    GLCapture();
+
+    ~GLCapture();
+
+    /**
+     * Sets the options of the capture, must be called before it's installed
+     *
+     * @param path File the frames are written to, empty to not capture
+     * @param firstFrame Frame the capture starts with, frames are counted from the creation of the context
+     * @param frames Amount of frames to capture
+     * @param width Width of the window
+     * @param height Height of the window
+     */
+    static void configure(const std::string& path, size_t firstFrame, size_t frames, int width, int height);
+
+    /**
+     * Wraps the Glad entry points if a capture file was configured, must be called
+     * after the entry points are loaded and before any objects are created
+     */
+    static void install();
+
+    /**
+     * Finishes the capture if it's still running, the file then holds the
+     * frames captured so far
+     */
+    static void shutdown();
+
+    /**
+     * Ends the current frame, must be called before the window buffers are swapped
+     */
+    static void present();
+private:
+    /**
+     * Range of a mapped buffer
+     */
+    struct Mapping
+    {
+        GLuint Buffer = 0;
+        GLintptr Offset = 0;
+        GLsizeiptr Length = 0;
+
+        /// Mapped memory
+        unsigned char* pMemory = nullptr;
+
+        /// Contents written to the file for persistently mapped ranges
+        bool Persistent = false;
+        std::vector<unsigned char> Written;
+    };
+
+    /**
+     * Original entry points the calls are forwarded to
+     */
+    struct Functions
+    {
+        PFNGLACTIVETEXTUREPROC activeTexture = nullptr;
+        PFNGLATTACHSHADERPROC attachShader = nullptr;
+        PFNGLBINDBUFFERPROC bindBuffer = nullptr;
+        PFNGLBINDBUFFERRANGEPROC bindBufferRange = nullptr;
+        PFNGLBINDFRAMEBUFFERPROC bindFramebuffer = nullptr;
+        PFNGLBINDIMAGETEXTUREPROC bindImageTexture = nullptr;
+        PFNGLBINDTEXTUREPROC bindTexture = nullptr;
+        PFNGLBINDVERTEXARRAYPROC bindVertexArray = nullptr;
+        PFNGLBLENDFUNCPROC blendFunc = nullptr;
+        PFNGLBLITFRAMEBUFFERPROC blitFramebuffer = nullptr;
+        PFNGLBUFFERDATAPROC bufferData = nullptr;
+        PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+        PFNGLBUFFERSUBDATAPROC bufferSubData = nullptr;
+        PFNGLCLEARPROC clear = nullptr;
+        PFNGLCLEARCOLORPROC clearColor = nullptr;
+        PFNGLCOLORMASKPROC colorMask = nullptr;
+        PFNGLCOMPILESHADERPROC compileShader = nullptr;
+        PFNGLCOMPRESSEDTEXIMAGE2DPROC compressedTexImage2D = nullptr;
+        PFNGLCOPYBUFFERSUBDATAPROC copyBufferSubData = nullptr;
+        PFNGLCOPYIMAGESUBDATAPROC copyImageSubData = nullptr;
+        PFNGLCREATEPROGRAMPROC createProgram = nullptr;
+        PFNGLCREATESHADERPROC createShader = nullptr;
+        PFNGLDELETEBUFFERSPROC deleteBuffers = nullptr;
+        PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers = nullptr;
+        PFNGLDELETEPROGRAMPROC deleteProgram = nullptr;
+        PFNGLDELETESHADERPROC deleteShader = nullptr;
+        PFNGLDELETETEXTURESPROC deleteTextures = nullptr;
+        PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays = nullptr;
+        PFNGLDEPTHFUNCPROC depthFunc = nullptr;
+        PFNGLDEPTHMASKPROC depthMask = nullptr;
+        PFNGLDISABLEPROC disable = nullptr;
+        PFNGLDISABLEVERTEXATTRIBARRAYPROC disableVertexAttribArray = nullptr;
+        PFNGLDISPATCHCOMPUTEPROC dispatchCompute = nullptr;
+        PFNGLDRAWARRAYSPROC drawArrays = nullptr;
+        PFNGLDRAWARRAYSINDIRECTPROC drawArraysIndirect = nullptr;
+        PFNGLDRAWARRAYSINSTANCEDPROC drawArraysInstanced = nullptr;
+        PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC drawArraysInstancedBaseInstance = nullptr;
+        PFNGLDRAWELEMENTSPROC drawElements = nullptr;
+        PFNGLDRAWELEMENTSINDIRECTPROC drawElementsIndirect = nullptr;
+        PFNGLDRAWELEMENTSINSTANCEDPROC drawElementsInstanced = nullptr;
+        PFNGLENABLEPROC enable = nullptr;
+        PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray = nullptr;
+        PFNGLFRAMEBUFFERTEXTURE2DPROC framebufferTexture2D = nullptr;
+        PFNGLGENBUFFERSPROC genBuffers = nullptr;
+        PFNGLGENERATEMIPMAPPROC generateMipmap = nullptr;
+        PFNGLGENFRAMEBUFFERSPROC genFramebuffers = nullptr;
+        PFNGLGENTEXTURESPROC genTextures = nullptr;
+        PFNGLGENVERTEXARRAYSPROC genVertexArrays = nullptr;
+        PFNGLGETINTEGERVPROC getIntegerv = nullptr;
+        PFNGLLINKPROGRAMPROC linkProgram = nullptr;
+        PFNGLMAPBUFFERPROC mapBuffer = nullptr;
+        PFNGLMAPBUFFERRANGEPROC mapBufferRange = nullptr;
+        PFNGLMEMORYBARRIERPROC memoryBarrier = nullptr;
+        PFNGLMULTIDRAWARRAYSINDIRECTPROC multiDrawArraysIndirect = nullptr;
+        PFNGLPIXELSTOREIPROC pixelStorei = nullptr;
+        PFNGLPOLYGONMODEPROC polygonMode = nullptr;
+        PFNGLPROGRAMBINARYPROC programBinary = nullptr;
+        PFNGLPROGRAMPARAMETERIPROC programParameteri = nullptr;
+        PFNGLSHADERSOURCEPROC shaderSource = nullptr;
+        PFNGLTEXIMAGE2DPROC texImage2D = nullptr;
+        PFNGLTEXPARAMETERIPROC texParameteri = nullptr;
+        PFNGLTEXSTORAGE2DPROC texStorage2D = nullptr;
+        PFNGLTEXSTORAGE3DPROC texStorage3D = nullptr;
+        PFNGLTEXSUBIMAGE2DPROC texSubImage2D = nullptr;
+        PFNGLTEXSUBIMAGE3DPROC texSubImage3D = nullptr;
+        PFNGLUNIFORM1IPROC uniform1i = nullptr;
+        PFNGLUNIFORM4FVPROC uniform4fv = nullptr;
+        PFNGLUNIFORMMATRIX4FVPROC uniformMatrix4fv = nullptr;
+        PFNGLUNMAPBUFFERPROC unmapBuffer = nullptr;
+        PFNGLUSEPROGRAMPROC useProgram = nullptr;
+        PFNGLVERTEXATTRIBDIVISORPROC vertexAttribDivisor = nullptr;
+        PFNGLVERTEXATTRIBPOINTERPROC vertexAttribPointer = nullptr;
+        PFNGLVIEWPORTPROC viewport = nullptr;
+    };
+private:
+    /**
+     * Starts a record
+     */
+    void begin(CaptureOp op);
+
+    /**
+     * Writes an argument of the current record
+     */
+    template<typename T>
+    void put(const T& value);
+
+    /**
+     * Writes client memory as it's size followed by the bytes
+     */
+    void putData(const void* pData, size_t size);
+
+    /**
+     * Writes the pixels of a texture upload, either an offset into the bound
+     * pixel unpack buffer or the client memory
+     */
+    void putPixels(const void* pPixels, size_t size);
+
+    /**
+     * Ends the current record and writes the recorded data to the file once
+     * enough has been collected
+     */
+    void end();
+
+    /**
+     * Returns true if calls producing output are recorded, the persistently
+     * mapped memory they may read is written first
+     */
+    bool output();
+
+    /**
+     * Writes the changed blocks of persistently mapped memory
+     */
+    void writeMappings();
+
+    /**
+     * Writes the contents of a mapped range and stops tracking it
+     */
+    void unmap(GLuint buffer);
+
+    /**
+     * Writes the names of a generate or delete call
+     */
+    void putNames(CaptureOp op, GLsizei n, const GLuint* pNames);
+
+    /**
+     * Updates the buffer bound to the target, the element buffer is part of the vertex array
+     */
+    void trackBuffer(GLenum target, GLuint buffer);
+
+    /**
+     * Returns the buffer bound to the target
+     */
+    GLuint boundBuffer(GLenum target);
+
+    /**
+     * Ends the setup, the following frames are captured
+     */
+    void start();
+
+    /**
+     * Writes the rest of the file, closes it and restores the entry points
+     */
+    void finish();
+
+    // Entry points, named after the OpenGL function without the gl prefix
+    static void APIENTRY activeTexture(GLenum texture);
+    static void APIENTRY attachShader(GLuint program, GLuint shader);
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer);
+    static void APIENTRY bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    static void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer);
+    static void APIENTRY bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+    static void APIENTRY bindTexture(GLenum target, GLuint texture);
+    static void APIENTRY bindVertexArray(GLuint array);
+    static void APIENTRY blendFunc(GLenum sfactor, GLenum dfactor);
+    static void APIENTRY blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+    static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    static void APIENTRY bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+    static void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+    static void APIENTRY clear(GLbitfield mask);
+    static void APIENTRY clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    static void APIENTRY colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+    static void APIENTRY compileShader(GLuint shader);
+    static void APIENTRY compressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data);
+    static void APIENTRY copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+    static void APIENTRY copyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
+    static GLuint APIENTRY createProgram();
+    static GLuint APIENTRY createShader(GLenum type);
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers);
+    static void APIENTRY deleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+    static void APIENTRY deleteProgram(GLuint program);
+    static void APIENTRY deleteShader(GLuint shader);
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures);
+    static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays);
+    static void APIENTRY depthFunc(GLenum func);
+    static void APIENTRY depthMask(GLboolean flag);
+    static void APIENTRY disable(GLenum cap);
+    static void APIENTRY disableVertexAttribArray(GLuint index);
+    static void APIENTRY dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count);
+    static void APIENTRY drawArraysIndirect(GLenum mode, const void* indirect);
+    static void APIENTRY drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+    static void APIENTRY drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance);
+    static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+    static void APIENTRY drawElementsIndirect(GLenum mode, GLenum type, const void* indirect);
+    static void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+    static void APIENTRY enable(GLenum cap);
+    static void APIENTRY enableVertexAttribArray(GLuint index);
+    static void APIENTRY framebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    static void APIENTRY genBuffers(GLsizei n, GLuint* buffers);
+    static void APIENTRY generateMipmap(GLenum target);
+    static void APIENTRY genFramebuffers(GLsizei n, GLuint* framebuffers);
+    static void APIENTRY genTextures(GLsizei n, GLuint* textures);
+    static void APIENTRY genVertexArrays(GLsizei n, GLuint* arrays);
+    static void APIENTRY getIntegerv(GLenum pname, GLint* data);
+    static void APIENTRY linkProgram(GLuint program);
+    static void* APIENTRY mapBuffer(GLenum target, GLenum access);
+    static void* APIENTRY mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    static void APIENTRY memoryBarrier(GLbitfield barriers);
+    static void APIENTRY multiDrawArraysIndirect(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride);
+    static void APIENTRY pixelStorei(GLenum pname, GLint param);
+    static void APIENTRY polygonMode(GLenum face, GLenum mode);
+    static void APIENTRY programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    static void APIENTRY programParameteri(GLuint program, GLenum pname, GLint value);
+    static void APIENTRY shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+    static void APIENTRY texImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY texParameteri(GLenum target, GLenum pname, GLint param);
+    static void APIENTRY texStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+    static void APIENTRY texStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+    static void APIENTRY texSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY texSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY uniform1i(GLint location, GLint v0);
+    static void APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+    static void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    static GLboolean APIENTRY unmapBuffer(GLenum target);
+    static void APIENTRY useProgram(GLuint program);
+    static void APIENTRY vertexAttribDivisor(GLuint index, GLuint divisor);
+    static void APIENTRY vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    static void APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+private:
+    /// Instance used by the static interface
+    static GLCapture* ms_pInstance;
+
+    /// Recorded data is written to the file in chunks of this size
+    static constexpr size_t ms_chunkSize = 4 * 1024 * 1024;
+
+    /// Persistently mapped memory is compared in blocks of this size
+    static constexpr size_t ms_blockSize = 256;
+
+    /// Settings
+    std::string m_path;
+    size_t m_firstFrame = 0;
+    size_t m_frames = 1;
+    int m_width = 0;
+    int m_height = 0;
+
+    /// True while the entry points are wrapped
+    bool m_installed = false;
+
+    /// True once the setup has ended
+    bool m_capturing = false;
+
+    /// Frames presented since the capture was installed and frames captured
+    size_t m_frame = 0;
+    size_t m_captured = 0;
+
+    /// Capture file, recorded data not written to it yet and the start of the
+    /// arguments of the current record
+    std::ofstream m_file;
+    std::vector<unsigned char> m_data;
+    size_t m_record = 0;
+    size_t m_written = 0;
+
+    /// Entry points the calls are forwarded to
+    Functions m_gl;
+
+    /// Buffer bindings, the element buffers by vertex array
+    std::unordered_map<GLenum, GLuint> m_buffers;
+    std::unordered_map<GLuint, GLuint> m_elementBuffers;
+    GLuint m_vertexArray = 0;
+
+    /// Sizes of the buffer data stores, glMapBuffer maps the whole store
+    std::unordered_map<GLuint, GLsizeiptr> m_bufferSizes;
+
+    /// Row alignment of client pixel data
+    GLint m_unpackAlignment = 4;
+
+    /// Mapped buffer ranges
+    std::vector<Mapping> m_mappings;
+};
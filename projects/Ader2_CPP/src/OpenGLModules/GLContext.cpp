@@ -9,9 +9,31 @@
 // Reading shader sources and texture files
 #include "Utility/File.h"
 
+// Block compressed textures
+#include "Utility/TextureCompression.h"
+
+// Texture atlas packing
+#include "Utility/AtlasPacker.h"
+
 // Assert
 #include "Defs.h"
 
+// CPU scopes
+#include "Utility/Profiler.h"
+
+// Mapped mesh files
+#include "Utility/MappedFile.h"
+#include "Utility/MeshFile.h"
+
+// Mesh load times
+#include "Utility/Timer.h"
+
+// For FLT_MAX
+#include <cfloat>
+
+// Text numbers are formatted with snprintf
+#include <cstdio>
+
 #include <thread>
 
 GLContext::GLContext()
@@ -25,17 +47,45 @@ bool GLContext::canShutdown()
 
 void GLContext::shutdown()
 {
-    // Delete UBOs
-    if (m_pubMatrices)
+    // Delete uniform arena
+    if (m_pUniforms)
     {
-        delete m_pubMatrices;
+        delete m_pUniforms;
     }
 
-    if (m_pubTextureDetail)
+    // Delete texture arrays
+    for (Texture* pArray : m_textureArrays)
     {
-        delete m_pubTextureDetail;
+        delete pArray;
     }
 
+    m_textureArrays.clear();
+
+    // Drop the remaining texture requests
+    TextureStreamer::stop();
+
+    // Delete the programs and the streaming resources
+    RenderThread::run([]()
+    {
+        // A capture that hasn't finished keeps the frames captured so far
+        GLCapture::shutdown();
+
+        GlyphCache::shutdown();
+        ResolutionScaler::shutdown();
+        ShaderCache::shutdown();
+        TextureStreamer::shutdown();
+        GPUProfiler::shutdown();
+        GPUCuller::shutdown();
+        TextRenderer::shutdown();
+        SpriteRenderer::shutdown();
+    });
+
+    // Stop the render thread, after this commands are executed on this thread
+    m_renderThread.stop();
+
+    // Close the trace of a headless run
+    NullBackend::shutdown();
+
     // Destroy the context
     alcMakeContextCurrent(NULL);
     alcDestroyContext(m_pAudioContext);
@@ -50,6 +100,8 @@ int GLContext::onMessage(MessageBus::MessageType msg, MessageBus::DataType pData
     {
     case Messages::msg_WindowCreated:
         return initContext(static_cast<GLFWwindow*>(pData));
+    case Messages::msg_HeadlessWindowCreated:
+        return initContext(nullptr);
     case Messages::msg_StateBundleCreated:
     {
         const StateBundle* bndl = static_cast<const StateBundle*>(pData);
@@ -73,50 +125,197 @@ int GLContext::onMessage(MessageBus::MessageType msg, MessageBus::DataType pData
 
 void GLContext::toggleWireFrame(bool value)
 {
-    // Toggle Line and Fill modes
-    if (value)
+    RenderThread::record([value]()
+    {
+        // Toggle Line and Fill modes
+        GLState::setPolygonMode(value ? GL_LINE : GL_FILL);
+    });
+}
+
+void GLContext::toggleDepthPrePass(bool value)
+{
+    m_settings.DepthPrePass = value;
+}
+
+void GLContext::toggleGPUCulling(bool value)
+{
+    m_settings.GPUCulling = value;
+}
+
+void GLContext::toggleDynamicResolution(bool value)
+{
+    m_settings.DynamicResolution = value;
+    ResolutionScaler::configure(value, m_settings.TargetFrameTime, m_settings.MinResolutionScale, m_settings.MaxResolutionScale);
+}
+
+float GLContext::getOverdraw() const
+{
+    if (m_pWndState == nullptr || m_pWndState->width <= 0 || m_pWndState->height <= 0)
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        return 0.0f;
     }
-    else
+
+    // Scene passes are drawn at the scaled resolution
+    ResolutionScaler::Statistics resolution = ResolutionScaler::getStatistics();
+    size_t pixels = (size_t)resolution.Width * resolution.Height;
+    if (pixels == 0)
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        return 0.0f;
     }
+
+    return (float)GPUProfiler::getStatistics().SamplesPassed / (float)pixels;
+}
+
+RenderThread::Statistics GLContext::getRenderStatistics() const
+{
+    return m_renderThread.getStatistics();
+}
+
+GLState::Statistics GLContext::getStateStatistics() const
+{
+    return GLState::getStatistics();
+}
+
+ShaderCache::Statistics GLContext::getShaderStatistics() const
+{
+    return ShaderCache::getStatistics();
+}
+
+TextureStreamer::Statistics GLContext::getStreamingStatistics() const
+{
+    return TextureStreamer::getStatistics();
+}
+
+NullBackend::Statistics GLContext::getBackendStatistics() const
+{
+    return NullBackend::getStatistics();
+}
+
+GPUProfiler::Statistics GLContext::getGPUProfilerStatistics() const
+{
+    return GPUProfiler::getStatistics();
+}
+
+GPUCuller::Statistics GLContext::getCullingStatistics() const
+{
+    return GPUCuller::getStatistics();
+}
+
+GlyphCache::Statistics GLContext::getGlyphCacheStatistics() const
+{
+    return GlyphCache::getStatistics();
+}
+
+TextRenderer::Statistics GLContext::getTextStatistics() const
+{
+    return TextRenderer::getStatistics();
+}
+
+ResolutionScaler::Statistics GLContext::getResolutionStatistics() const
+{
+    return ResolutionScaler::getStatistics();
+}
+
+SpriteRenderer::Statistics GLContext::getSpriteStatistics() const
+{
+    return SpriteRenderer::getStatistics();
 }
 
 int GLContext::initContext(GLFWwindow* pWindow)
 {
-    // Set the context to the newly created window
-    glfwMakeContextCurrent(pWindow);
+    // Start executing commands, with a render thread it will own the context
+    m_renderThread.start(pWindow, m_settings.UseRenderThread);
 
-    // Initialize Glad after the context is set
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    // Glad and the debug callback need to be set up on the thread that owns the context
+    bool gladLoaded = false;
+    RenderThread::run([&]()
     {
-        LOG_ERROR("Failed to initialize Glad!");
-        return 1;
-    }
+        if (pWindow)
+        {
+            // Initialize Glad after the context is set
+            gladLoaded = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+        }
+        else
+        {
+            // Without a window the entry points are replaced by the recorder
+            NullBackend::install();
+            gladLoaded = true;
+        }
 
-    // OpenGL error callback
-    glEnable(GL_DEBUG_OUTPUT);
-    glDebugMessageCallback(
-        [](
-            GLenum source,
-            GLenum type,
-            GLuint id,
-            GLenum severity,
-            GLsizei length,
-            const GLchar* message,
-            const void* userParam)
-    {
+        if (!gladLoaded)
+        {
+            return;
+        }
+
+        // Calls are captured from the start so the file holds every resource
+        GLCapture::install();
+
+        // The context starts with the default state
+        GLState::reset();
+
+        // Query program binary and parallel compile support
+        ShaderCache::init();
+
+        // Placeholder texture and the streaming pixel buffer
+        TextureStreamer::init();
+
+        // Timer queries of the render passes
+        GPUProfiler::init();
+
+        // Compute culling programs
+        GPUCuller::init();
+
+        // Glyph instance buffer
+        TextRenderer::init();
 
-        if (type == GL_DEBUG_TYPE_ERROR)
+        // Glyph cache pages
+        GlyphCache::init();
+
+        // Framebuffer of the scaled scene
+        ResolutionScaler::init();
+
+        // Sprite instance buffer
+        SpriteRenderer::init();
+
+        // Compressed formats the driver can sample
+        Texture::querySupport();
+
+        // Arrays that reach the limit are split
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if (maxLayers > 0)
         {
-            LOG_ERROR("OpenGL error: \n\
-                Source: {0}\n\
-                Message: {1}", source, message);
+            m_maxArrayLayers = (unsigned int)maxLayers;
         }
 
-    }, 0);
+        // OpenGL error callback
+        glEnable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallback(
+            [](
+                GLenum source,
+                GLenum type,
+                GLuint id,
+                GLenum severity,
+                GLsizei length,
+                const GLchar* message,
+                const void* userParam)
+        {
+
+            if (type == GL_DEBUG_TYPE_ERROR)
+            {
+                LOG_ERROR("OpenGL error: \n\
+                    Source: {0}\n\
+                    Message: {1}", source, message);
+            }
+
+        }, 0);
+    });
+
+    if (!gladLoaded)
+    {
+        LOG_ERROR("Failed to initialize Glad!");
+        return 1;
+    }
 
     // Create OpenAL device
     m_pAudioDevice = alcOpenDevice(NULL);
@@ -150,9 +349,15 @@ int GLContext::initContext(GLFWwindow* pWindow)
     // Set the render target
     m_pRenderTarget = pWindow;
 
-    // We can now create our UBO's
-    m_pubMatrices = new UniformBuffer(UniformBuffer::bp_Mat);
-    m_pubTextureDetail = new UniformBuffer(UniformBuffer::bp_TexDetail);
+    // We can now create our uniform arena
+    m_pUniforms = new UniformArena();
+
+    // Start decoding streamed textures
+    TextureStreamer::start(m_settings.TextureUploadBudget);
+
+    // Frame time budget of dynamic resolution
+    ResolutionScaler::configure(m_settings.DynamicResolution, m_settings.TargetFrameTime,
+        m_settings.MinResolutionScale, m_settings.MaxResolutionScale);
 
     // Create new audio listener
     m_pAudioListener = new AudioListener();
@@ -174,7 +379,15 @@ int GLContext::wndStateUpdate()
 void GLContext::wndResized()
 {
     // Set the view port
-    glViewport(0, 0, m_pWndState->width, m_pWndState->height);
+    int width = m_pWndState->width;
+    int height = m_pWndState->height;
+    RenderThread::record([width, height]()
+    {
+        glViewport(0, 0, width, height);
+    });
+
+    // The scaled scene framebuffer follows the window
+    ResolutionScaler::resize(width, height);
 
     if (m_pWndState->width != 0 && m_pWndState->height != 0)
     {
@@ -193,644 +406,2430 @@ void GLContext::wndResized()
 
 int GLContext::render()
 {
-    //  Clear the color of the screen
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    // Construct matrices uniform buffer
-    m_pubMatrices->bind();
-
-    // Set the projection matrix
-    m_pubMatrices->setSubData(0, sizeof(glm::mat4), glm::value_ptr(m_projection));
+    PROFILE_SCOPE("GLContext::render");
 
-    // Set the view matrix
-    m_pubMatrices->setSubData(sizeof(glm::mat4), sizeof(glm::mat4), (void*)glm::value_ptr(m_activeScene->getActiveCamera()->getViewMatrix()));
+    // Pick the render resolution from the measured GPU time and draw the scene offscreen
+    ResolutionScaler::update();
+    ResolutionScaler::beginScene();
 
-    // Loop over each visual
-    for (Visual* visual : m_activeScene->getVisuals())
+    //  Clear the color and depth of the screen, depth writes must be enabled for the clear
+    RenderThread::record([]()
     {
-        // Bind the specific data
-        visual->VAO->bind();
-        visual->Shader->bind();
-
-        // Bind textures to their slots
-        for (auto& it : visual->Textures)
-        {
-            it.second->bind(it.first);
-        }
-
-        // Bing the texture detail UBO
-        m_pubTextureDetail->bind();
-        
-        // Set the atlas dimensions
-        m_pubTextureDetail->setSubData(0, sizeof(glm::vec2), (void*)glm::value_ptr(visual->AtlasDims));
+        GPUProfiler::begin("Clear");
+        GLState::setDepthMask(true);
+        GLState::setColorMask(true);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    });
 
-        // Create instance buffer
-        visual->VAO->createInstanceBuffer(visual->Transforms, true);
+    // Write all uniform blocks of the frame before any draw
+    m_pUniforms->beginFrame();
 
-        // Create offset buffer
-        visual->VAO->createOffsetBuffer(visual->Offsets, true);
+    // Scene matrices
+    glm::mat4 matrices[2] = { m_projection, m_activeScene->getActiveCamera()->getViewMatrix() };
+    size_t sceneMatrices = m_pUniforms->write(UniformArena::bp_Mat, matrices);
+    glm::mat4 viewProjection = matrices[0] * matrices[1];
 
-        // Render using instancing
-        visual->VAO->renderInstance(visual->RenderCount);
-    }
+    // UI matrices use the orthographic projection
+    matrices[0] = m_orthographic;
+    size_t uiMatrices = m_pUniforms->write(UniformArena::bp_Mat, matrices);
 
-    // Set the orthographic matrix
-    m_pubMatrices->bind();
-    m_pubMatrices->setSubData(0, sizeof(glm::mat4), glm::value_ptr(m_orthographic));
+    // Upload the next chunks of streamed textures before they are used
+    TextureStreamer::update();
 
-    // Enable blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Merge visuals into batches
+    buildBatches();
 
-    // Loop for each UI(Text) element
-    for (Text* text : m_activeScene->getUI())
+    // Atlas dimensions of each batch, these are the same for all visuals of a batch
+    for (size_t i = 0; i < m_batchCount; i++)
     {
-        text->render();
+        Batch& batch = m_batches[i];
+        batch.TexDetail = m_pUniforms->write(UniformArena::bp_TexDetail, glm::value_ptr(batch.Visuals[0]->AtlasDims));
     }
 
-    // Swap window buffers
-    glfwSwapBuffers(m_pRenderTarget);
-
-    return 0;
-}
-
-void GLContext::changeScene(MessageBus::DataType pData)
-{
-    // Get scene
-    m_activeScene = *static_cast<Memory::reference<AderScene>*>(pData);
-    m_pAudioListener = m_activeScene->getAudioListener();
-}
-
-void GLContext::update()
-{
-    if (m_pAudioListener && m_pAudioListener->Altered)
+    // Atlas dimensions of each particle emitter, emitters without a visual aren't drawn
+    m_emitterDetails.clear();
+    for (ParticleEmitter* pEmitter : m_activeScene->getEmitters())
     {
-        // Set listener position
-        alListener3f(AL_POSITION, 
-            m_pAudioListener->Position.x,
-            m_pAudioListener->Position.y,
-            m_pAudioListener->Position.z);
+        glm::vec2 atlasDims = pEmitter->getVisual() ? pEmitter->getVisual()->AtlasDims : glm::vec2(1.0f);
+        m_emitterDetails.push_back(m_pUniforms->write(UniformArena::bp_TexDetail, glm::value_ptr(atlasDims)));
+    }
 
-        // Set volume
-        alListeneri(AL_GAIN, 
-            m_pAudioListener->Volume);
+    // Upload the whole frame at once
+    m_pUniforms->upload();
 
-        // Set orientation
-        alListenerfv(AL_ORIENTATION, static_cast<float*>((void*)&m_pAudioListener->Orientation));
+    // Bind the scene matrices
+    m_pUniforms->bind(UniformArena::bp_Mat, sceneMatrices);
 
-        // Set flag
-        m_pAudioListener->Altered = false;
+    // Draw opaque batches front to back and transparent ones back to front,
+    // objects inside a batch are already in that order
+    m_opaqueOrder.clear();
+    m_transparentOrder.clear();
+    for (size_t i = 0; i < m_batchCount; i++)
+    {
+        (m_batches[i].Transparent ? m_transparentOrder : m_opaqueOrder).push_back(i);
     }
-}
 
-VAO::VAO()
-{
-    // Create vertex array
-    glGenVertexArrays(1, &m_idArray);
+    std::sort(m_opaqueOrder.begin(), m_opaqueOrder.end(), [this](size_t a, size_t b)
+    {
+        return m_batches[a].Depth < m_batches[b].Depth;
+    });
 
-    // Assign VBO types
-    m_idIndices.Type = GL_ELEMENT_ARRAY_BUFFER;
-    m_idVertices.Type = GL_ARRAY_BUFFER;
-    m_idTexCoords.Type = GL_ARRAY_BUFFER;
-    m_idInstance.Type = GL_ARRAY_BUFFER;
-    m_idOffsets.Type = GL_ARRAY_BUFFER;
-}
+    std::sort(m_transparentOrder.begin(), m_transparentOrder.end(), [this](size_t a, size_t b)
+    {
+        return m_batches[a].Depth > m_batches[b].Depth;
+    });
 
-VAO::~VAO()
-{
-    // Delete the array
-    glDeleteVertexArrays(1, &m_idArray);
+    // Opaque batches that can be culled on the GPU are culled before any of them is drawn
+    cullBatches(viewProjection);
 
-    // Delete buffers
-    deleteBuffer(m_idIndices);
-    deleteBuffer(m_idVertices);
-    deleteBuffer(m_idTexCoords);
-    deleteBuffer(m_idInstance);
-    deleteBuffer(m_idOffsets);
-}
+    Utility::Profiler::begin("Batches");
+    m_instanceOwners.clear();
 
-void VAO::render()
-{
-    // If indices array is set render with glDrawElements else glDrawArrays
-    if (m_idIndices.ID == 0)
-    {
-        glDrawArrays(GL_TRIANGLES, 0, m_renderCount);
-    }
-    else
+    // Depth pre-pass, fills the depth buffer so that only the visible fragment of
+    // each pixel is shaded by the opaque pass
+    bool prePass = m_settings.DepthPrePass;
+    if (prePass)
     {
-        glDrawElements(GL_TRIANGLES, m_renderCount, GL_UNSIGNED_INT, 0);
+        RenderThread::record([]()
+        {
+            GPUProfiler::begin("Depth pre-pass");
+            GLState::setEnabled(GL_DEPTH_TEST, true);
+            GLState::setEnabled(GL_BLEND, false);
+            GLState::setDepthFunc(GL_LESS);
+            GLState::setDepthMask(true);
+            GLState::setColorMask(false);
+        });
+
+        for (size_t i : m_opaqueOrder)
+        {
+            drawBatch(i);
+        }
     }
-}
 
-void VAO::renderInstance(unsigned int count)
-{
-    // If indices array is set render with glDrawElements else glDrawArrays
-    if (m_idIndices.ID == 0)
+    // Opaque pass, with a pre-pass the depth buffer is already complete
+    RenderThread::record([prePass]()
     {
-        glDrawArraysInstanced(GL_TRIANGLES, 0, m_renderCount, count);
-    }
-    else
+        GPUProfiler::begin("Opaque");
+        GPUProfiler::beginSamples();
+        GLState::setEnabled(GL_DEPTH_TEST, true);
+        GLState::setEnabled(GL_BLEND, false);
+        GLState::setDepthFunc(prePass ? GL_LEQUAL : GL_LESS);
+        GLState::setDepthMask(!prePass);
+        GLState::setColorMask(true);
+    });
+
+    for (size_t i : m_opaqueOrder)
     {
-        glDrawElementsInstanced(GL_TRIANGLES, m_renderCount, GL_UNSIGNED_INT, 0, count);
+        drawBatch(i);
     }
-}
 
-void VAO::createIndiceBuffer(std::vector<unsigned int>& indices, bool dynamic)
-{
-    if (setupBuffer(
-        m_idIndices,
-        dynamic,
-        sizeof(unsigned int),
-        indices.size(),
-        indices.data()))
+    // Transparent pass, tested against the opaque depth but doesn't write it
+    RenderThread::record([]()
     {
-        // No need for attributes
+        GPUProfiler::begin("Transparent");
+        GLState::setDepthFunc(GL_LESS);
+        GLState::setDepthMask(false);
+        GLState::setEnabled(GL_BLEND, true);
+        GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    });
+
+    for (size_t i : m_transparentOrder)
+    {
+        drawBatch(i);
     }
 
-    // Set render count
-    m_renderCount = indices.size();
-}
+    Utility::Profiler::end();
 
-void VAO::createVerticesBuffer(std::vector<float>& vertices, bool dynamic)
-{
-    if (setupBuffer(
-        m_idVertices,
-        dynamic,
-        sizeof(float),
-        vertices.size(),
-        vertices.data()))
+    // Particles blend like transparent batches, they are drawn after them
+    Utility::Profiler::begin("Particles");
+    RenderThread::record([]()
     {
-        // Assign attrib pointer
-        glVertexAttribPointer(
-            al_Vertices,
-            3,
-            GL_FLOAT,
-            false,
-            3 * sizeof(float),
-            (const void*)0
-        );
-    }
+        GPUProfiler::begin("Particles");
+    });
+
+    drawEmitters();
+    Utility::Profiler::end();
 
-    // Set render count but don't override it if there is an indices buffer
-    if (m_idVertices.ID != 0 && m_idIndices.ID == 0)
+    // Bind the orthographic matrices, sprites and the UI are in window coordinates
+    m_pUniforms->bind(UniformArena::bp_Mat, uiMatrices);
+
+    // Sprites are part of the scene and drawn over it in layer order
+    Utility::Profiler::begin("Sprites");
+    RenderThread::record([]()
     {
-        m_renderCount = vertices.size() / 3;
-    }
-}
+        GPUProfiler::begin("Sprites");
+        GLState::setEnabled(GL_DEPTH_TEST, false);
+        GLState::setEnabled(GL_BLEND, true);
+        GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    });
 
-void VAO::createUVBuffer(std::vector<float>& texCoords, bool dynamic)
-{
-    if (setupBuffer(
-        m_idTexCoords, 
-        dynamic, 
-        sizeof(float), 
-        texCoords.size(), 
-        texCoords.data()))
+    SpriteRenderer::flush();
+    Utility::Profiler::end();
+
+    // Upscale the scene into the window, the UI is drawn at the native resolution
+    ResolutionScaler::endScene();
+
+    // Enable blending, the UI pass starts here and is drawn over the scene
+    RenderThread::record([]()
     {
-        // Assign attrib pointer
-        glVertexAttribPointer(
-            al_TexCoord,
-            2,
-            GL_FLOAT,
-            false,
-            2 * sizeof(float),
-            (const void*)0
-        );
+        GPUProfiler::endSamples();
+        GPUProfiler::begin("UI");
+        GLState::setEnabled(GL_DEPTH_TEST, false);
+        GLState::setEnabled(GL_BLEND, true);
+        GLState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    });
+
+    // Loop for each UI(Text) element, pages used by them are the most recently used
+    Utility::Profiler::begin("Text");
+    GlyphCache::beginFrame();
+    for (Text* text : m_activeScene->getUI())
+    {
+        text->render();
     }
-}
 
-void VAO::createInstanceBuffer(std::vector<glm::mat4>& transforms, bool dynamic)
-{
-    if (setupBuffer(
-        m_idInstance,
-        dynamic,
-        sizeof(glm::mat4),
-        transforms.size(),
-        transforms.data()))
+    // All text sharing a font is drawn with one draw
+    TextRenderer::flush();
+    Utility::Profiler::end();
+
+    // The frame region can be reused once the GPU is done with it
+    m_pUniforms->endFrame();
+
+    // Swap window buffers
+    GLFWwindow* pWindow = m_pRenderTarget;
+    RenderThread::record([pWindow]()
     {
-        // Since OpenGL vertex attribute max size is vec4 in order
-        // to have a mat4 we need 4 attributes since a mat4 is just
-        // 4 vec4
+        // Timer queries of finished frames are read without waiting
+        GPUProfiler::endFrame();
 
-        glEnableVertexAttribArray(al_Instance0);
-        glVertexAttribPointer(al_Instance0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
-                                                                   
-        glEnableVertexAttribArray(al_Instance1);                   
-        glVertexAttribPointer(al_Instance1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4)));
-                                                                   
-        glEnableVertexAttribArray(al_Instance2);                   
-        glVertexAttribPointer(al_Instance2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4)));
-                                                                   
-        glEnableVertexAttribArray(al_Instance3);                   
-        glVertexAttribPointer(al_Instance3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4)));
+        // Ends the frame of a running capture
+        GLCapture::present();
 
-        // Since this is used for instancing we define their divisors
-        // to be 1 each meaning it will be incremented by 1 each instance draw
-        glVertexAttribDivisor(al_Instance0, 1);
-        glVertexAttribDivisor(al_Instance1, 1);
-        glVertexAttribDivisor(al_Instance2, 1);
-        glVertexAttribDivisor(al_Instance3, 1);
-    }
+        // Blocks when the GPU or vsync is behind
+        PROFILE_SCOPE("Swap");
+
+        if (pWindow)
+        {
+            glfwSwapBuffers(pWindow);
+        }
+        else
+        {
+            NullBackend::present();
+        }
+
+        GLState::endFrame();
+    });
+
+    // Hand the frame over to the render thread, waits if it's still executing the previous one
+    Utility::Profiler::begin("Submit");
+    m_renderThread.submit();
+    Utility::Profiler::end();
+
+    return 0;
 }
 
-void VAO::createOffsetBuffer(std::vector<glm::vec2>& offsets, bool dynamic)
+void GLContext::cullBatches(const glm::mat4& viewProjection)
 {
-    if (setupBuffer(
-        m_idOffsets,
-        dynamic,
-        sizeof(glm::vec2),
-        offsets.size(),
-        offsets.data()))
+    if (!m_settings.GPUCulling || !GPUCuller::isSupported())
     {
-        glEnableVertexAttribArray(al_TexOffset);
-        glVertexAttribPointer(al_TexOffset, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
-        
-        // Instances will change the texture atlas
-        glVertexAttribDivisor(al_TexOffset, 1);
+        return;
     }
-}
 
-void VAO::bind() const
-{
-    ADER_ASSERT(m_idArray != 0, "Trying to bind invalid vertex array");
+    PROFILE_SCOPE("GLContext::cullBatches");
 
-    // Binds the array
-    glBindVertexArray(m_idArray);
+    m_cullObjects.clear();
+    m_cullVAOs.clear();
+    m_cullBases.clear();
 
-    // Enable vertex attribute arrays
-    if (m_idVertices.ID)
+    // Transparent batches need their exact order and stay on the CPU, so do shaders
+    // without variants since the culled instances are read by the compact variant
+    for (size_t i : m_opaqueOrder)
     {
-        glEnableVertexAttribArray(al_Vertices);
-    }
+        Batch& batch = m_batches[i];
+        Visual* visual = batch.Visuals[0];
 
-    if (m_idTexCoords.ID)
-    {
-        glEnableVertexAttribArray(al_TexCoord);
+        if (!visual->Shader->hasVariants() || batch.InstanceCount == 0)
+        {
+            continue;
+        }
+
+        unsigned int base = (unsigned int)m_cullObjects.size();
+
+        batch.Culled = true;
+        batch.Command = m_cullVAOs.size();
+        m_cullVAOs.push_back(visual->VAO);
+        m_cullBases.push_back(base);
+
+        // Sphere around the bounds of the mesh, objects without bounds are never culled
+        glm::vec4 sphere(0.0f, 0.0f, 0.0f, -1.0f);
+        if (visual->VAO->hasBounds())
+        {
+            const glm::vec3& boundsMin = visual->VAO->getBoundsMin();
+            const glm::vec3& boundsMax = visual->VAO->getBoundsMax();
+            sphere = glm::vec4((boundsMin + boundsMax) * 0.5f, glm::length(boundsMax - boundsMin) * 0.5f);
+        }
+
+        for (Visual* merged : batch.Visuals)
+        {
+            float layer = batch.pArray ? (float)merged->Textures[0]->getLayer() : 0.0f;
+
+            for (unsigned int j : merged->Order)
+            {
+                m_cullObjects.emplace_back();
+                GPUCuller::Object& object = m_cullObjects.back();
+
+                const glm::mat4& m = merged->Transforms[j];
+                object.Data.Rows[0] = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+                object.Data.Rows[1] = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+                object.Data.Rows[2] = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+                object.Data.TexRect = merged->TexRects[j];
+                object.Data.TexOffset = merged->Offsets[j];
+                object.Data.Layer = layer;
+
+                object.Sphere = sphere;
+                object.Command = (unsigned int)batch.Command;
+                object.BaseInstance = base;
+            }
+        }
     }
 
-    if (m_idInstance.ID)
+    if (m_cullVAOs.empty())
     {
-        glEnableVertexAttribArray(al_Instance0);
-        glEnableVertexAttribArray(al_Instance1);
-        glEnableVertexAttribArray(al_Instance2);
-        glEnableVertexAttribArray(al_Instance3);
+        return;
     }
 
-    if (m_idOffsets.ID)
+    // Data must stay valid until the command is executed
+    const GPUCuller::Object* pObjects = RenderThread::copy(m_cullObjects.data(), m_cullObjects.size());
+    VAO* const* pVAOs = RenderThread::copy(m_cullVAOs.data(), m_cullVAOs.size());
+    const unsigned int* pBases = RenderThread::copy(m_cullBases.data(), m_cullBases.size());
+    size_t objectCount = m_cullObjects.size();
+    size_t commandCount = m_cullVAOs.size();
+
+    RenderThread::record([=]()
     {
-        glEnableVertexAttribArray(al_TexOffset);
-    }
+        GPUProfiler::begin("Cull");
+
+        // Index counts are only known on this thread
+        m_cullCommands.resize(commandCount);
+        for (size_t i = 0; i < commandCount; i++)
+        {
+            pVAOs[i]->getCulledCommand(m_cullCommands[i], pBases[i]);
+        }
+
+        GPUCuller::cull(pObjects, objectCount, m_cullCommands.data(), commandCount, viewProjection);
+    });
 }
 
-bool VAO::setupBuffer(VBO& buffer, bool dynamic, size_t eSize, size_t eCount, void* pData)
+void GLContext::drawBatch(size_t index)
 {
-    // Bind this VAO
-    bind();
+    Batch& batch = m_batches[index];
+    Visual* visual = batch.Visuals[0];
 
-    // Check if the buffer is created first
-    if (buffer.ID == 0)
+    // Pick the cheapest variant that matches the visual
+    unsigned int features = Shader::sf_None;
+    if (visual->Shader->hasVariants())
     {
-        // Create buffer
-        createBuffer(buffer);
+        features = Shader::sf_Instanced | Shader::sf_CompactInstance;
 
-        // Bind the buffer
-        glBindBuffer(buffer.Type, buffer.ID);
+        // Rectangles also cover atlas cells so they replace the offsets
+        if (visual->UseTexRects)
+        {
+            features |= Shader::sf_AtlasRect;
+        }
+        else if (visual->AtlasDims != glm::vec2(1.0f, 1.0f))
+        {
+            features |= Shader::sf_Atlas;
+        }
 
-        // Set the type of the buffer object
-        buffer.Dynamic = dynamic;
+        if (batch.pArray)
+        {
+            features |= Shader::sf_TextureArray;
+        }
+    }
+
+    // Bind the specific data
+    visual->VAO->bind();
+    visual->Shader->bind(features);
+
+    // Bind textures to their slots, slot 0 uses the array if the batch has one
+    for (auto& it : visual->Textures)
+    {
+        if (it.first == 0 && batch.pArray)
+        {
+            batch.pArray->bind(0);
+        }
+        else
+        {
+            it.second->bind(it.first);
+        }
+    }
+
+    // Bind the atlas dimensions of the batch
+    m_pUniforms->bind(UniformArena::bp_TexDetail, batch.TexDetail);
+
+    // Culled batches are drawn from the instances written by the cull pass, the next
+    // batch using the VAO has to upload its instance data again
+    if (batch.Culled)
+    {
+        m_instanceOwners.erase(visual->VAO);
+        visual->VAO->renderCulled(batch.Command);
+        return;
+    }
+
+    // The instance data is still in the buffers if the batch was drawn by the
+    // pre-pass and no other batch used the VAO since
+    auto owner = m_instanceOwners.find(visual->VAO);
+    if (owner != m_instanceOwners.end() && owner->second == index)
+    {
+        visual->VAO->renderInstance((unsigned int)batch.InstanceCount);
+        return;
+    }
+
+    m_instanceOwners[visual->VAO] = index;
+
+    if (features & Shader::sf_CompactInstance)
+    {
+        // Only the data the variant reads is uploaded
+        m_batchRows.clear();
+        m_batchOffsets.clear();
+        m_batchLayers.clear();
+        m_batchRects.clear();
+
+        for (Visual* merged : batch.Visuals)
+        {
+            // Game objects are gathered in their draw order
+            for (unsigned int j : merged->Order)
+            {
+                const glm::mat4& m = merged->Transforms[j];
+                m_batchRows.emplace_back(m[0][0], m[1][0], m[2][0], m[3][0]);
+                m_batchRows.emplace_back(m[0][1], m[1][1], m[2][1], m[3][1]);
+                m_batchRows.emplace_back(m[0][2], m[1][2], m[2][2], m[3][2]);
+
+                if (features & Shader::sf_Atlas)
+                {
+                    m_batchOffsets.push_back(merged->Offsets[j]);
+                }
+
+                if (features & Shader::sf_AtlasRect)
+                {
+                    m_batchRects.push_back(merged->TexRects[j]);
+                }
+            }
+
+            if (features & Shader::sf_TextureArray)
+            {
+                m_batchLayers.insert(m_batchLayers.end(), merged->Order.size(), (float)merged->Textures[0]->getLayer());
+            }
+        }
+
+        visual->VAO->createCompactInstanceBuffer(m_batchRows, true);
+
+        if (features & Shader::sf_Atlas)
+        {
+            visual->VAO->createOffsetBuffer(m_batchOffsets, true);
+        }
+
+        if (features & Shader::sf_AtlasRect)
+        {
+            visual->VAO->createTexRectBuffer(m_batchRects, true);
+        }
+
+        if (features & Shader::sf_TextureArray)
+        {
+            visual->VAO->createLayerBuffer(m_batchLayers, true);
+        }
+    }
+    else
+    {
+        // Merge the instance data of all visuals in the batch in their draw order
+        m_batchTransforms.clear();
+        m_batchOffsets.clear();
+        m_batchLayers.clear();
+
+        for (Visual* merged : batch.Visuals)
+        {
+            for (unsigned int j : merged->Order)
+            {
+                m_batchTransforms.push_back(merged->Transforms[j]);
+                m_batchOffsets.push_back(merged->Offsets[j]);
+            }
+
+            if (batch.pArray)
+            {
+                m_batchLayers.insert(m_batchLayers.end(), merged->Order.size(), (float)merged->Textures[0]->getLayer());
+            }
+        }
+
+        // Create instance buffers
+        visual->VAO->createInstanceBuffer(m_batchTransforms, true);
+        visual->VAO->createOffsetBuffer(m_batchOffsets, true);
+
+        if (batch.pArray)
+        {
+            visual->VAO->createLayerBuffer(m_batchLayers, true);
+        }
+    }
+
+    // Render using instancing
+    visual->VAO->renderInstance((unsigned int)batch.InstanceCount);
+}
+
+void GLContext::drawEmitters()
+{
+    const std::vector<ParticleEmitter*>& emitters = m_activeScene->getEmitters();
+
+    for (size_t i = 0; i < emitters.size(); i++)
+    {
+        ParticleEmitter* pEmitter = emitters[i];
+        Visual* visual = pEmitter->getVisual();
+
+        if (visual == nullptr || visual->VAO == nullptr || visual->Shader == nullptr || pEmitter->getAlive() == 0)
+        {
+            continue;
+        }
+
+        // Particles always animate through atlas cells and are tinted by their color
+        unsigned int features = Shader::sf_None;
+        if (visual->Shader->hasVariants())
+        {
+            features = Shader::sf_Instanced | Shader::sf_CompactInstance | Shader::sf_Atlas | Shader::sf_InstanceColor;
+        }
+
+        // Bind the specific data, particles sample the textures themselves instead of their arrays
+        visual->VAO->bind();
+        visual->Shader->bind(features);
+
+        for (auto& it : visual->Textures)
+        {
+            it.second->bind(it.first);
+        }
+
+        m_pUniforms->bind(UniformArena::bp_TexDetail, m_emitterDetails[i]);
+
+        // The next batch using the VAO has to upload its instance data again
+        m_instanceOwners.erase(visual->VAO);
+
+        if (features & Shader::sf_CompactInstance)
+        {
+            // The simulation wrote the instance data in the layout of the buffers
+            visual->VAO->createCompactInstanceBuffer(pEmitter->getRows(), true);
+            visual->VAO->createOffsetBuffer(pEmitter->getOffsets(), true);
+            visual->VAO->createColorBuffer(pEmitter->getColors(), true);
+        }
+        else
+        {
+            // Shaders without variants read full matrices and have no color
+            const std::vector<glm::vec4>& rows = pEmitter->getRows();
+
+            m_batchTransforms.clear();
+            for (size_t j = 0; j < rows.size(); j += 3)
+            {
+                m_batchTransforms.push_back(glm::transpose(glm::mat4(rows[j], rows[j + 1], rows[j + 2], glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))));
+            }
+
+            visual->VAO->createInstanceBuffer(m_batchTransforms, true);
+            visual->VAO->createOffsetBuffer(pEmitter->getOffsets(), true);
+        }
+
+        visual->VAO->renderInstance((unsigned int)pEmitter->getCount());
+    }
+}
+
+void GLContext::buildBatches()
+{
+    PROFILE_SCOPE("GLContext::buildBatches");
+
+    // Visuals can be merged if they only differ in the layer of their slot 0 texture,
+    // transparent visuals aren't merged since each one is sorted on its own
+    auto canMerge = [](const Visual* a, const Visual* b)
+    {
+        if (a->VAO != b->VAO || a->Shader != b->Shader || a->AtlasDims != b->AtlasDims ||
+            a->UseTexRects != b->UseTexRects || a->Transparent || b->Transparent ||
+            a->Textures.size() != b->Textures.size())
+        {
+            return false;
+        }
+
+        for (auto& it : a->Textures)
+        {
+            auto other = b->Textures.find(it.first);
+            if (other == b->Textures.end() || (it.first != 0 && other->second != it.second))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    m_batchCount = 0;
+
+    for (Visual* visual : m_activeScene->getVisuals())
+    {
+        // Find the array of the slot 0 texture
+        Texture* pArray = nullptr;
+        if (visual->Shader->usesTextureArrays())
+        {
+            auto it = visual->Textures.find(0);
+            if (it != visual->Textures.end() && it->second)
+            {
+                pArray = getTextureArray(it->second);
+            }
+        }
+
+        // Find a batch to merge into
+        Batch* pBatch = nullptr;
+        if (pArray)
+        {
+            for (size_t i = 0; i < m_batchCount; i++)
+            {
+                if (m_batches[i].pArray == pArray && canMerge(m_batches[i].Visuals[0], visual))
+                {
+                    pBatch = &m_batches[i];
+                    break;
+                }
+            }
+        }
+
+        // Start a new batch, batches are reused to keep their capacity
+        if (pBatch == nullptr)
+        {
+            if (m_batchCount == m_batches.size())
+            {
+                m_batches.emplace_back();
+            }
+
+            pBatch = &m_batches[m_batchCount++];
+            pBatch->Visuals.clear();
+            pBatch->pArray = pArray;
+            pBatch->InstanceCount = 0;
+            pBatch->Transparent = visual->Transparent;
+            pBatch->Depth = visual->Depth;
+            pBatch->Culled = false;
+        }
+
+        pBatch->Visuals.push_back(visual);
+        pBatch->InstanceCount += visual->RenderCount;
+        pBatch->Depth = std::min(pBatch->Depth, visual->Depth);
+    }
+
+    // Recreate the arrays that received new layers
+    for (Texture* pArray : m_dirtyArrays)
+    {
+        pArray->loadArray();
+    }
+
+    m_dirtyArrays.clear();
+}
+
+Texture* GLContext::getTextureArray(Texture* pTexture)
+{
+    if (pTexture->getArray())
+    {
+        return pTexture->getArray();
+    }
+
+    // Find an array with the same size and format that still has room
+    Texture* pArray = nullptr;
+    for (Texture* pCandidate : m_textureArrays)
+    {
+        if (pCandidate->isCompatible(pTexture) && pCandidate->hasFreeLayer(m_maxArrayLayers))
+        {
+            pArray = pCandidate;
+            break;
+        }
+    }
+
+    if (pArray == nullptr)
+    {
+        // Size is unknown until the texture has been loaded
+        if (!pTexture->isCompatible(pTexture))
+        {
+            return nullptr;
+        }
+
+        pArray = new Texture();
+        m_textureArrays.push_back(pArray);
+    }
+
+    pArray->addLayer(pTexture);
+
+    // Storage is recreated once per frame
+    if (std::find(m_dirtyArrays.begin(), m_dirtyArrays.end(), pArray) == m_dirtyArrays.end())
+    {
+        m_dirtyArrays.push_back(pArray);
+    }
+
+    return pArray;
+}
+
+void GLContext::changeScene(MessageBus::DataType pData)
+{
+    // Get scene
+    m_activeScene = *static_cast<Memory::reference<AderScene>*>(pData);
+    m_pAudioListener = m_activeScene->getAudioListener();
+}
+
+void GLContext::update()
+{
+    if (m_pAudioListener && m_pAudioListener->Altered)
+    {
+        // Set listener position
+        alListener3f(AL_POSITION, 
+            m_pAudioListener->Position.x,
+            m_pAudioListener->Position.y,
+            m_pAudioListener->Position.z);
+
+        // Set volume
+        alListeneri(AL_GAIN, 
+            m_pAudioListener->Volume);
+
+        // Set orientation
+        alListenerfv(AL_ORIENTATION, static_cast<float*>((void*)&m_pAudioListener->Orientation));
+
+        // Set flag
+        m_pAudioListener->Altered = false;
+    }
+}
+
+VAO::VAO()
+{
+    // Create vertex array
+    RenderThread::record([this]()
+    {
+        glGenVertexArrays(1, &m_idArray);
+    });
+
+    // Assign VBO types
+    m_idIndices.Type = GL_ELEMENT_ARRAY_BUFFER;
+    m_idVertices.Type = GL_ARRAY_BUFFER;
+    m_idTexCoords.Type = GL_ARRAY_BUFFER;
+    m_idInstance.Type = GL_ARRAY_BUFFER;
+    m_idCompactInstance.Type = GL_ARRAY_BUFFER;
+    m_idOffsets.Type = GL_ARRAY_BUFFER;
+    m_idLayers.Type = GL_ARRAY_BUFFER;
+    m_idTexRects.Type = GL_ARRAY_BUFFER;
+    m_idColors.Type = GL_ARRAY_BUFFER;
+    m_idInterleaved.Type = GL_ARRAY_BUFFER;
+}
+
+VAO::~VAO()
+{
+    // Wait for the deletion since the ids are part of this object
+    RenderThread::run([this]()
+    {
+        // Delete the array
+        GLState::deleteVertexArray(m_idArray);
+
+        // Delete buffers
+        deleteBuffer(m_idIndices);
+        deleteBuffer(m_idVertices);
+        deleteBuffer(m_idTexCoords);
+        deleteBuffer(m_idInstance);
+        deleteBuffer(m_idCompactInstance);
+        deleteBuffer(m_idOffsets);
+        deleteBuffer(m_idLayers);
+        deleteBuffer(m_idTexRects);
+        deleteBuffer(m_idColors);
+        deleteBuffer(m_idInterleaved);
+    });
+}
+
+void VAO::render()
+{
+    RenderThread::record([this]()
+    {
+        // If indices array is set render with glDrawElements else glDrawArrays
+        if (m_idIndices.ID == 0)
+        {
+            glDrawArrays(GL_TRIANGLES, 0, m_renderCount);
+        }
+        else
+        {
+            glDrawElements(GL_TRIANGLES, m_renderCount, m_indexType, 0);
+        }
+    });
+}
+
+void VAO::renderInstance(unsigned int count)
+{
+    RenderThread::record([this, count]()
+    {
+        // If indices array is set render with glDrawElements else glDrawArrays
+        if (m_idIndices.ID == 0)
+        {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, m_renderCount, count);
+        }
+        else
+        {
+            glDrawElementsInstanced(GL_TRIANGLES, m_renderCount, m_indexType, 0, count);
+        }
+    });
+}
+
+void VAO::renderCulled(size_t command)
+{
+    RenderThread::record([this, command]()
+    {
+        // Point the instance attributes at the culled instances
+        GLState::bindBuffer(GL_ARRAY_BUFFER, GPUCuller::getInstanceBuffer());
+
+        GLsizei stride = sizeof(GPUCuller::Instance);
+        for (GLuint i = 0; i < 3; i++)
+        {
+            glEnableVertexAttribArray(al_InstanceRow0 + i);
+            glVertexAttribPointer(al_InstanceRow0 + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(al_InstanceRow0 + i, 1);
+        }
+
+        glEnableVertexAttribArray(al_TexRect);
+        glVertexAttribPointer(al_TexRect, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GPUCuller::Instance, TexRect));
+        glVertexAttribDivisor(al_TexRect, 1);
+
+        glEnableVertexAttribArray(al_TexOffset);
+        glVertexAttribPointer(al_TexOffset, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GPUCuller::Instance, TexOffset));
+        glVertexAttribDivisor(al_TexOffset, 1);
+
+        glEnableVertexAttribArray(al_TexLayer);
+        glVertexAttribPointer(al_TexLayer, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GPUCuller::Instance, Layer));
+        glVertexAttribDivisor(al_TexLayer, 1);
+
+        // The instance count was written by the cull pass
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, GPUCuller::getCommandBuffer());
+        const void* pCommand = (const void*)(command * sizeof(GPUCuller::DrawCommand));
+
+        if (m_idIndices.ID == 0)
+        {
+            glDrawArraysIndirect(GL_TRIANGLES, pCommand);
+        }
+        else
+        {
+            glDrawElementsIndirect(GL_TRIANGLES, m_indexType, pCommand);
+        }
+
+        // The culled instances can be smaller than the instance buffers of this VAO, the
+        // attributes are disabled and the instance buffers set them up again when used
+        for (GLuint location = al_TexOffset; location <= al_TexRect; location++)
+        {
+            glDisableVertexAttribArray(location);
+            m_culledLocations |= 1u << location;
+        }
+    });
+}
+
+void VAO::getCulledCommand(GPUCuller::DrawCommand& command, unsigned int baseInstance) const
+{
+    command = GPUCuller::DrawCommand();
+    command.Count = m_renderCount;
+
+    // Draws without indices use DrawArraysIndirectCommand where the base instance is the 4th value
+    if (m_idIndices.ID == 0)
+    {
+        command.BaseVertex = baseInstance;
+    }
+    else
+    {
+        command.BaseInstance = baseInstance;
+    }
+}
+
+void VAO::createIndiceBuffer(std::vector<unsigned int>& indices, bool dynamic)
+{
+    size_t count = indices.size();
+
+    // Indices that fit into 16 bits are stored as such, halving the index data
+    unsigned int maxIndex = 0;
+    for (unsigned int index : indices)
+    {
+        maxIndex = std::max(maxIndex, index);
+    }
+
+    bool narrow = maxIndex <= 0xFFFF;
+    std::vector<unsigned short> shortIndices;
+    if (narrow)
+    {
+        shortIndices.assign(indices.begin(), indices.end());
+    }
+
+    // Data must stay valid until the command is executed
+    const void* pIndices = narrow ?
+        (const void*)RenderThread::copy(shortIndices.data(), count) :
+        (const void*)RenderThread::copy(indices.data(), count);
+
+    RenderThread::record([=]()
+    {
+        if (setupBuffer(
+            m_idIndices,
+            dynamic,
+            narrow ? sizeof(unsigned short) : sizeof(unsigned int),
+            count,
+            pIndices))
+        {
+            // No need for attributes
+        }
+
+        // Set render count and type
+        m_renderCount = count;
+        m_indexType = narrow ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    });
+}
+
+void VAO::createVerticesBuffer(std::vector<float>& vertices, bool dynamic)
+{
+    // Bounds of the positions are used for culling
+    setBounds(reinterpret_cast<const unsigned char*>(vertices.data()), 3 * sizeof(float), vertices.size() / 3);
+
+    // Data must stay valid until the command is executed
+    const float* pVertices = RenderThread::copy(vertices.data(), vertices.size());
+    size_t count = vertices.size();
+
+    RenderThread::record([=]()
+    {
+        if (setupBuffer(
+            m_idVertices,
+            dynamic,
+            sizeof(float),
+            count,
+            pVertices))
+        {
+            VertexAttribute attribute;
+            attribute.Location = al_Vertices;
+            attribute.Components = 3;
+            attribute.Type = vat_Float;
+            setupAttributes(&attribute, 1, 3 * sizeof(float));
+        }
+
+        // Set render count but don't override it if there is an indices buffer
+        if (m_idVertices.ID != 0 && m_idIndices.ID == 0)
+        {
+            m_renderCount = count / 3;
+        }
+    });
+}
+
+void VAO::createUVBuffer(std::vector<float>& texCoords, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const float* pTexCoords = RenderThread::copy(texCoords.data(), texCoords.size());
+    size_t count = texCoords.size();
+
+    RenderThread::record([=]()
+    {
+        if (setupBuffer(
+            m_idTexCoords, 
+            dynamic, 
+            sizeof(float), 
+            count, 
+            pTexCoords))
+        {
+            VertexAttribute attribute;
+            attribute.Location = al_TexCoord;
+            attribute.Components = 2;
+            attribute.Type = vat_Float;
+            setupAttributes(&attribute, 1, 2 * sizeof(float));
+        }
+    });
+}
+
+void VAO::createInterleavedBuffer(const VertexLayout& layout, const void* pData, size_t vertexCount, bool dynamic)
+{
+    // Attributes are read from every vertex of the data
+    if (!isValidLayout(layout.Attributes.data(), layout.Attributes.size(), layout.Stride))
+    {
+        LOG_ERROR("Invalid vertex layout, attributes must have 1 to 4 components of a known type inside the stride");
+        return;
+    }
+
+    if (!checkLocations(layout.Attributes.data(), layout.Attributes.size()))
+    {
+        LOG_WARN("Vertex layout uses attribute locations reserved for instancing");
+        return;
+    }
+
+    // Bounds are only known for float positions
+    const VertexAttribute* pPosition = layout.find(al_Vertices);
+    if (pPosition && pPosition->Type == vat_Float && pPosition->Components >= 3)
+    {
+        setBounds(static_cast<const unsigned char*>(pData) + pPosition->Offset, layout.Stride, vertexCount);
+    }
+    else
+    {
+        m_hasBounds = false;
+    }
+
+    // Data must stay valid until the command is executed
+    const unsigned char* pVertices = RenderThread::copy(static_cast<const unsigned char*>(pData), vertexCount * layout.Stride);
+    const VertexAttribute* pAttributes = RenderThread::copy(layout.Attributes.data(), layout.Attributes.size());
+    size_t attributeCount = layout.Attributes.size();
+    unsigned int stride = layout.Stride;
+
+    RenderThread::record([=]()
+    {
+        setupInterleaved(pVertices, vertexCount, dynamic, pAttributes, attributeCount, stride);
+    });
+}
+
+void VAO::createInstanceBuffer(std::vector<glm::mat4>& transforms, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const glm::mat4* pTransforms = RenderThread::copy(transforms.data(), transforms.size());
+    size_t count = transforms.size();
+
+    RenderThread::record([=]()
+    {
+        if (setupBuffer(
+            m_idInstance,
+            dynamic,
+            sizeof(glm::mat4),
+            count,
+            pTransforms))
+        {
+            // Since OpenGL vertex attribute max size is vec4 in order
+            // to have a mat4 we need 4 attributes since a mat4 is just
+            // 4 vec4
+
+            glEnableVertexAttribArray(al_Instance0);
+            glVertexAttribPointer(al_Instance0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
+                                                                   
+            glEnableVertexAttribArray(al_Instance1);                   
+            glVertexAttribPointer(al_Instance1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4)));
+                                                                   
+            glEnableVertexAttribArray(al_Instance2);                   
+            glVertexAttribPointer(al_Instance2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4)));
+                                                                   
+            glEnableVertexAttribArray(al_Instance3);                   
+            glVertexAttribPointer(al_Instance3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4)));
+
+            // Since this is used for instancing we define their divisors
+            // to be 1 each meaning it will be incremented by 1 each instance draw
+            glVertexAttribDivisor(al_Instance0, 1);
+            glVertexAttribDivisor(al_Instance1, 1);
+            glVertexAttribDivisor(al_Instance2, 1);
+            glVertexAttribDivisor(al_Instance3, 1);
+        }
+    });
+}
+
+void VAO::createCompactInstanceBuffer(std::vector<glm::vec4>& rows, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const glm::vec4* pRows = RenderThread::copy(rows.data(), rows.size());
+    size_t count = rows.size() / 3;
+
+    RenderThread::record([=]()
+    {
+        // Attributes used by a culled draw have to be set up again
+        bool culled = takeCulledLocations(al_InstanceRow0, al_InstanceRow2);
+
+        if (setupBuffer(
+            m_idCompactInstance,
+            dynamic,
+            3 * sizeof(glm::vec4),
+            count,
+            pRows) || culled)
+        {
+            // The last row of an affine matrix is always (0, 0, 0, 1) so
+            // only the first 3 rows are stored
+            GLsizei stride = 3 * sizeof(glm::vec4);
+
+            glEnableVertexAttribArray(al_InstanceRow0);
+            glVertexAttribPointer(al_InstanceRow0, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+
+            glEnableVertexAttribArray(al_InstanceRow1);
+            glVertexAttribPointer(al_InstanceRow1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(glm::vec4)));
+
+            glEnableVertexAttribArray(al_InstanceRow2);
+            glVertexAttribPointer(al_InstanceRow2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(glm::vec4)));
+
+            // Incremented by 1 each instance draw
+            glVertexAttribDivisor(al_InstanceRow0, 1);
+            glVertexAttribDivisor(al_InstanceRow1, 1);
+            glVertexAttribDivisor(al_InstanceRow2, 1);
+        }
+    });
+}
+
+void VAO::createOffsetBuffer(std::vector<glm::vec2>& offsets, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const glm::vec2* pOffsets = RenderThread::copy(offsets.data(), offsets.size());
+    size_t count = offsets.size();
+
+    RenderThread::record([=]()
+    {
+        // Attributes used by a culled draw have to be set up again
+        bool culled = takeCulledLocations(al_TexOffset, al_TexOffset);
+
+        if (setupBuffer(
+            m_idOffsets,
+            dynamic,
+            sizeof(glm::vec2),
+            count,
+            pOffsets) || culled)
+        {
+            glEnableVertexAttribArray(al_TexOffset);
+            glVertexAttribPointer(al_TexOffset, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+            
+            // Instances will change the texture atlas
+            glVertexAttribDivisor(al_TexOffset, 1);
+        }
+    });
+}
+
+void VAO::createLayerBuffer(std::vector<float>& layers, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const float* pLayers = RenderThread::copy(layers.data(), layers.size());
+    size_t count = layers.size();
+
+    RenderThread::record([=]()
+    {
+        // Attributes used by a culled draw have to be set up again
+        bool culled = takeCulledLocations(al_TexLayer, al_TexLayer);
+
+        if (setupBuffer(
+            m_idLayers,
+            dynamic,
+            sizeof(float),
+            count,
+            pLayers) || culled)
+        {
+            glEnableVertexAttribArray(al_TexLayer);
+            glVertexAttribPointer(al_TexLayer, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+
+            // Instances will change the texture array layer
+            glVertexAttribDivisor(al_TexLayer, 1);
+        }
+    });
+}
+
+void VAO::createTexRectBuffer(std::vector<glm::vec4>& rects, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const glm::vec4* pRects = RenderThread::copy(rects.data(), rects.size());
+    size_t count = rects.size();
+
+    RenderThread::record([=]()
+    {
+        // Attributes used by a culled draw have to be set up again
+        bool culled = takeCulledLocations(al_TexRect, al_TexRect);
+
+        if (setupBuffer(
+            m_idTexRects,
+            dynamic,
+            sizeof(glm::vec4),
+            count,
+            pRects) || culled)
+        {
+            glEnableVertexAttribArray(al_TexRect);
+            glVertexAttribPointer(al_TexRect, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+
+            // Instances will change the texture rectangle
+            glVertexAttribDivisor(al_TexRect, 1);
+        }
+    });
+}
+
+void VAO::createColorBuffer(std::vector<glm::u8vec4>& colors, bool dynamic)
+{
+    // Data must stay valid until the command is executed
+    const glm::u8vec4* pColors = RenderThread::copy(colors.data(), colors.size());
+    size_t count = colors.size();
+
+    RenderThread::record([=]()
+    {
+        if (setupBuffer(
+            m_idColors,
+            dynamic,
+            sizeof(glm::u8vec4),
+            count,
+            pColors))
+        {
+            glEnableVertexAttribArray(al_Color);
+            glVertexAttribPointer(al_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(glm::u8vec4), (void*)0);
+
+            // Instances will change the color
+            glVertexAttribDivisor(al_Color, 1);
+        }
+    });
+}
+
+bool VAO::load(const std::string& path)
+{
+    PROFILE_FUNCTION();
+    Utility::Timer timer(true);
+
+    // The mapping is kept alive by the upload command
+    Memory::reference<MappedFile> file = new MappedFile();
+    MeshView mesh;
+
+    if (!file->open(path) || !parseMesh(file->data(), file->size(), mesh))
+    {
+        LOG_WARN("'{0}' is not a valid mesh file", path);
+        return false;
+    }
+
+    const MeshHeader& header = *mesh.pHeader;
+
+    // Instance attributes come after the mesh attributes and can't be overridden
+    if (!checkLocations(mesh.pAttributes, header.AttributeCount))
+    {
+        LOG_WARN("'{0}' uses attribute locations reserved for instancing", path);
+        return false;
+    }
+
+    m_boundsMin = glm::vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]);
+    m_boundsMax = glm::vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]);
+    m_hasBounds = true;
+
+    RenderThread::record([this, file, mesh]()
+    {
+        const MeshHeader& header = *mesh.pHeader;
+
+        // Upload straight from the mapping
+        setupInterleaved(mesh.pVertices, header.VertexCount, false, mesh.pAttributes, header.AttributeCount, header.Stride);
+
+        if (header.IndexCount > 0)
+        {
+            setupBuffer(m_idIndices, false, header.IndexSize, header.IndexCount, mesh.pIndices);
+            m_indexType = header.IndexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            m_renderCount = header.IndexCount;
+        }
+        else
+        {
+            deleteBuffer(m_idIndices);
+            m_renderCount = header.VertexCount;
+        }
+    });
+
+    timer.end();
+    LOG_INFO("Mapped mesh '{0}', {1} vertices and {2} indices in {3} ms",
+        path, header.VertexCount, header.IndexCount, timer.microseconds() / 1000.0);
+
+    return true;
+}
+
+const glm::vec3& VAO::getBoundsMin() const
+{
+    return m_boundsMin;
+}
+
+const glm::vec3& VAO::getBoundsMax() const
+{
+    return m_boundsMax;
+}
+
+bool VAO::hasBounds() const
+{
+    return m_hasBounds;
+}
+
+void VAO::bind() const
+{
+    RenderThread::record([this]()
+    {
+        ADER_ASSERT(m_idArray != 0, "Trying to bind invalid vertex array");
+
+        // Binds the array, enabled attributes are part of the array state
+        GLState::bindVertexArray(m_idArray);
+    });
+}
+
+bool VAO::setupBuffer(VBO& buffer, bool dynamic, size_t eSize, size_t eCount, const void* pData)
+{
+    // Make sure this VAO is bound, attributes are set up for the bound array
+    GLState::bindVertexArray(m_idArray);
+
+    // Check if the buffer is created first
+    if (buffer.ID == 0)
+    {
+        // Create buffer
+        createBuffer(buffer);
+
+        // Bind the buffer
+        GLState::bindBuffer(buffer.Type, buffer.ID);
+
+        // Set the type of the buffer object
+        buffer.Dynamic = dynamic;
+
+        // Allocate buffer
+        allocBuffer(buffer, eSize, eCount, pData);
+
+        // Set up attributes
+        return true;
+    }
+    else
+    {
+        // Bind the buffer
+        GLState::bindBuffer(buffer.Type, buffer.ID);
+    }
+
+    // If there is mismatch between dynamic and static buffer we
+    // have to reallocate it with the correct format
+    if (buffer.Dynamic != dynamic)
+    {
+        // Set the type of the buffer object
+        buffer.Dynamic = dynamic;
+
+        // Allocate buffer
+        allocBuffer(buffer, eSize, eCount, pData);
+
+        // VBO was created so attributes should have been created already
+        return false;
+    }
+
+    // Check if the buffer was dynamic or not if it was we don't
+    // want to delete the buffer but just change it's data
+    if (buffer.Dynamic)
+    {
+        // This will modify the data of the buffer or reallocate it
+        // if it is too small
+        modifyBuffer(buffer, eSize, eCount, pData);
+
+        // VBO was created so attributes should have been created already
+        return false;
+    }
+    else
+    {
+        // Allocate new static buffer memory
+        allocBuffer(buffer, eSize, eCount, pData);
+
+        // VBO was created so attributes should have been created already
+        return false;
+    }
+
+    // Should not reach this point
+    return false;
+}
+
+void VAO::deleteBuffer(VBO& buffer)
+{
+    // Check that the buffer is valid and then delete it
+    if (buffer.ID != 0)
+    {
+        GLState::deleteBuffer(buffer.ID);
+        buffer.ID = 0;
+        buffer.Size = 0;
+    }
+}
+
+void VAO::createBuffer(VBO& vbo)
+{
+    // Create buffer and add to buffers vector
+    glGenBuffers(1, &vbo.ID);
+}
+
+void VAO::allocBuffer(VBO& vbo, size_t eSize, size_t eCount, const void* pInitData)
+{
+    // Add buffer data
+    glBufferData(vbo.Type, eCount * eSize, pInitData, vbo.Dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW);
+    vbo.Size = eCount * eSize;
+}
+
+void VAO::modifyBuffer(VBO& vbo, size_t eSize, size_t eCount, const void* pData)
+{
+    // Check size of buffer
+    if (vbo.Size < eSize * eCount)
+    {
+        // Allocate buffer since the previous one was too small
+        allocBuffer(vbo, eSize, eCount, pData);
+
+        // Do nothing else
+        return;
+    }
+
+    // Map buffer and get it's contents pointer
+    void* ptr = glMapBuffer(vbo.Type, GL_WRITE_ONLY);
+
+    // Copy new data and don't change the size variable
+    memcpy(ptr, pData, eSize * eCount);
+
+    // Unmap the buffer
+    glUnmapBuffer(vbo.Type);
+}
+
+void VAO::setupAttributes(const VertexAttribute* pAttributes, size_t count, unsigned int stride)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const VertexAttribute& attribute = pAttributes[i];
+
+        // Enabled state is stored in the VAO, packed formats always have 4 components
+        glEnableVertexAttribArray(attribute.Location);
+        glVertexAttribPointer(
+            attribute.Location,
+            attribute.Type == vat_Int2101010 ? 4 : attribute.Components,
+            getAttributeType(attribute.Type),
+            attribute.Normalized != 0,
+            stride,
+            (const void*)(size_t)attribute.Offset
+        );
+    }
+}
+
+void VAO::setupInterleaved(const void* pData, size_t vertexCount, bool dynamic,
+    const VertexAttribute* pAttributes, size_t count, unsigned int stride)
+{
+    // The interleaved buffer replaces the separate ones
+    deleteBuffer(m_idVertices);
+    deleteBuffer(m_idTexCoords);
+
+    setupBuffer(m_idInterleaved, dynamic, stride, vertexCount, pData);
+
+    // The layout can differ from the previous one so the attributes are always set up
+    for (GLuint location = 0; location < al_Instance0; location++)
+    {
+        glDisableVertexAttribArray(location);
+    }
+
+    setupAttributes(pAttributes, count, stride);
+
+    // Don't override the render count if there is an indices buffer
+    if (m_idIndices.ID == 0)
+    {
+        m_renderCount = vertexCount;
+    }
+}
+
+bool VAO::takeCulledLocations(GLuint first, GLuint last)
+{
+    unsigned int mask = ((1u << (last - first + 1)) - 1) << first;
+    bool culled = (m_culledLocations & mask) != 0;
+    m_culledLocations &= ~mask;
+    return culled;
+}
+
+void VAO::setBounds(const unsigned char* pPositions, size_t stride, size_t count)
+{
+    m_boundsMin = glm::vec3(FLT_MAX);
+    m_boundsMax = glm::vec3(-FLT_MAX);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 position;
+        memcpy(&position, pPositions + i * stride, sizeof(glm::vec3));
+
+        m_boundsMin = glm::min(m_boundsMin, position);
+        m_boundsMax = glm::max(m_boundsMax, position);
+    }
+
+    m_hasBounds = count > 0;
+}
+
+bool VAO::checkLocations(const VertexAttribute* pAttributes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pAttributes[i].Location >= al_Instance0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+GLenum VAO::getAttributeType(unsigned int type)
+{
+    switch (type)
+    {
+    case vat_Float:
+        return GL_FLOAT;
+    case vat_HalfFloat:
+        return GL_HALF_FLOAT;
+    case vat_Byte:
+        return GL_BYTE;
+    case vat_UnsignedByte:
+        return GL_UNSIGNED_BYTE;
+    case vat_Short:
+        return GL_SHORT;
+    case vat_UnsignedShort:
+        return GL_UNSIGNED_SHORT;
+    case vat_Int2101010:
+        return GL_INT_2_10_10_10_REV;
+    default:
+        return 0;
+    }
+}
+
+Shader::Shader()
+{
+}
+
+Shader::~Shader()
+{
+    // Programs are owned by the shader cache, wait until commands using the maps are done
+    RenderThread::run([this]()
+    {
+        for (auto& it : m_variants)
+        {
+            ShaderCache::release(it.second);
+        }
+
+        for (auto& it : m_previous)
+        {
+            ShaderCache::release(it.second);
+        }
+
+        m_variants.clear();
+        m_previous.clear();
+    });
+}
+
+void Shader::bind(unsigned int features)
+{
+    // Shaders without variants always use the base program
+    if (!m_variantsEnabled)
+    {
+        features = sf_None;
+    }
+
+    RenderThread::record([this, features]()
+    {
+        GLuint program = ShaderCache::resolve(getVariant(features));
+
+        // Keep using the variant of the previous sources until the new one is ready
+        auto it = m_previous.find(features);
+        if (it != m_previous.end())
+        {
+            if (program == 0)
+            {
+                program = ShaderCache::resolve(it->second);
+            }
+            else
+            {
+                ShaderCache::release(it->second);
+                m_previous.erase(it);
+            }
+        }
+
+        // Use the fallback program of the same features until the shader is ready
+        GLState::useProgram(program != 0 ? program : ShaderCache::getFallback(features));
+    });
+}
+
+void Shader::load()
+{
+    // Read the sources on this thread, compilation is done by the render thread
+    std::string vertexSource = expandIncludes(VertexSource, 0);
+    std::string fragmentSource = expandIncludes(FragmentSource, 0);
+
+    // Visuals using array samplers get their textures grouped into arrays
+    m_textureArrays = fragmentSource.find("sampler2DArray") != std::string::npos;
+
+    // Variant shaders select the sampler with TEXTURE_ARRAY
+    m_variantsEnabled = vertexSource.find("#pragma variants") != std::string::npos ||
+        fragmentSource.find("#pragma variants") != std::string::npos;
+
+    if (m_variantsEnabled)
+    {
+        m_textureArrays = true;
+    }
+
+    bool variants = m_variantsEnabled;
+    RenderThread::record([this, vertexSource, fragmentSource, variants]()
+    {
+        // The current variants stay in use until the new ones are ready, older ones are released
+        if (!m_variants.empty())
+        {
+            for (auto& it : m_previous)
+            {
+                ShaderCache::release(it.second);
+            }
+
+            m_previous = std::move(m_variants);
+            m_variants.clear();
+        }
+
+        m_vertexCode = vertexSource;
+        m_fragmentCode = fragmentSource;
+
+        // Variants are created when they are first bound, a single program can be started right away
+        if (!variants)
+        {
+            getVariant(sf_None);
+        }
+    });
+}
+
+bool Shader::usesTextureArrays() const
+{
+    return m_textureArrays;
+}
+
+bool Shader::hasVariants() const
+{
+    return m_variantsEnabled;
+}
+
+ShaderCache::Program* Shader::getVariant(unsigned int features)
+{
+    auto it = m_variants.find(features);
+    if (it != m_variants.end())
+    {
+        return it->second;
+    }
+
+    // Variants with the same sources share the program
+    ShaderCache::Program* pProgram = ShaderCache::getProgram(
+        addDefines(m_vertexCode, features), 
+        addDefines(m_fragmentCode, features));
+
+    m_variants[features] = pProgram;
+    return pProgram;
+}
+
+std::string Shader::expandIncludes(const std::string& path, int depth)
+{
+    // Guards against files including each other
+    if (depth > 16)
+    {
+        LOG_ERROR("Shader include depth exceeded in '{0}'!", path);
+        return "";
+    }
+
+    std::string source = readFile(path);
+
+    // Included paths are relative to the including file
+    std::string directory;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos)
+    {
+        directory = path.substr(0, slash + 1);
+    }
+
+    std::string result;
+    result.reserve(source.size());
+
+    size_t lineStart = 0;
+    while (lineStart < source.size())
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+        {
+            lineEnd = source.size();
+        }
+
+        // #include "file"
+        size_t first = source.find_first_not_of(" \t", lineStart);
+        if (first != std::string::npos && first < lineEnd && source.compare(first, 8, "#include") == 0)
+        {
+            size_t open = source.find('"', first);
+            size_t close = open != std::string::npos ? source.find('"', open + 1) : std::string::npos;
+
+            if (close != std::string::npos && close < lineEnd)
+            {
+                result += expandIncludes(directory + source.substr(open + 1, close - open - 1), depth + 1);
+                result += '\n';
+            }
+            else
+            {
+                LOG_WARN("Malformed #include in '{0}'!", path);
+            }
+        }
+        else
+        {
+            result.append(source, lineStart, lineEnd - lineStart);
+            result += '\n';
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    return result;
+}
+
+std::string Shader::addDefines(const std::string& source, unsigned int features)
+{
+    if (features == sf_None)
+    {
+        return source;
+    }
+
+    std::string defines;
+    if (features & sf_Instanced)
+    {
+        defines += "#define INSTANCED\n";
+    }
+
+    if (features & sf_Atlas)
+    {
+        defines += "#define ATLAS\n";
+    }
+
+    if (features & sf_CompactInstance)
+    {
+        defines += "#define COMPACT_INSTANCE\n";
+    }
+
+    if (features & sf_TextureArray)
+    {
+        defines += "#define TEXTURE_ARRAY\n";
+    }
+
+    if (features & sf_AtlasRect)
+    {
+        defines += "#define ATLAS_RECT\n";
+    }
+
+    if (features & sf_InstanceColor)
+    {
+        defines += "#define INSTANCE_COLOR\n";
+    }
+
+    // #version has to stay the first directive
+    size_t version = source.find("#version");
+    size_t insert = 0;
+    if (version != std::string::npos)
+    {
+        insert = source.find('\n', version);
+        insert = insert == std::string::npos ? source.size() : insert + 1;
+    }
+
+    std::string result = source;
+    result.insert(insert, defines);
+    return result;
+}
+
+bool Texture::ms_s3tcSupported = true;
+bool Texture::ms_bptcSupported = true;
+
+Texture::Texture()
+{
+    
+}
+
+Texture::~Texture()
+{
+    // Uploads that are already recorded finish before the deletion
+    TextureStreamer::cancel(this);
+
+    // Remove from the array or release the layers of this array
+    detach();
+
+    // Wait for the deletion since the id is part of this object
+    RenderThread::run([this]()
+    {
+        deleteTexture();
+    });
+}
 
-        // Allocate buffer
-        allocBuffer(buffer, eSize, eCount, pData);
+void Texture::bind(unsigned int slot)
+{
+    RenderThread::record([this, slot]()
+    {
+        // Textures that are still streaming or failed to load use the placeholder
+        if (m_idTexture == 0 || !m_hasLevels)
+        {
+            GLState::bindTexture(slot, GL_TEXTURE_2D, TextureStreamer::getPlaceholder());
+            return;
+        }
 
-        // Set up attributes
-        return true;
+        GLState::bindTexture(slot, m_target, m_idTexture);
+    });
+}
+
+void Texture::load()
+{
+    // Compressed textures contain their mip chain and are uploaded as is
+    if (isCompressedImagePath(Source))
+    {
+        loadCompressed();
+        return;
     }
-    else
+
+    // Decode the image on this thread, the upload is done by the render thread
+    Memory::reference<ImageFileContents> image = readImage(Source);
+
+    // Replaces a texture that is still streaming
+    TextureStreamer::cancel(this);
+
+    // The array layer has old contents, the texture is added to an array again when used
+    detach();
+
+    m_loaded = image.valid();
+    if (image.valid())
     {
-        // Bind the buffer
-        glBindBuffer(buffer.Type, buffer.ID);
+        GLenum internalFormat = image->BPP == 3 ? GL_RGB8 : GL_RGBA8;
+        setFormat(image->Width, image->Height, image->BPP, internalFormat, 
+            getLevelCount(image->Width, image->Height), 
+            getUncompressedSize(image->Width, image->Height, image->BPP));
     }
 
-    // If there is mismatch between dynamic and static buffer we
-    // have to reallocate it with the correct format
-    if (buffer.Dynamic != dynamic)
+    RenderThread::record([this, image]()
     {
-        // Set the type of the buffer object
-        buffer.Dynamic = dynamic;
+        // Delete current texture if it exists
+        deleteTexture();
 
-        // Allocate buffer
-        allocBuffer(buffer, eSize, eCount, pData);
+        // Load the texture
+        loadTexture(image);
+    });
+}
 
-        // VBO was created so attributes should have been created already
-        return false;
+void Texture::load(unsigned int width, unsigned int height, unsigned int BPP, std::vector<unsigned char>& data)
+{
+    if (width * height * BPP != data.size())
+    {
+        LOG_ERROR("Texture data and specified parameters do not match!");
+        return;
     }
 
-    // Check if the buffer was dynamic or not if it was we don't
-    // want to delete the buffer but just change it's data
-    if (buffer.Dynamic)
+    // Replaces a texture that is still streaming
+    TextureStreamer::cancel(this);
+
+    // The array layer has old contents, the texture is added to an array again when used
+    detach();
+
+    GLenum internalFormat = BPP == 1 ? GL_R8 : BPP == 3 ? GL_RGB8 : GL_RGBA8;
+    setFormat(width, height, BPP, internalFormat, getLevelCount(width, height), getUncompressedSize(width, height, BPP));
+    m_loaded = true;
+
+    // Data must stay valid until the command is executed
+    const unsigned char* pData = RenderThread::copy(data.data(), data.size());
+
+    RenderThread::record([=]()
     {
-        // This will modify the data of the buffer or reallocate it
-        // if it is too small
-        modifyBuffer(buffer, eSize, eCount, pData);
+        deleteTexture();
 
-        // VBO was created so attributes should have been created already
-        return false;
+        // Generate texture
+        glGenTextures(1, &m_idTexture);
+
+        // Bind the texture
+        GLState::bindTexture(0, GL_TEXTURE_2D, m_idTexture);
+
+        // Texture parameters
+
+        // Repeat textures when the object is to big
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        // Interpolate final color
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Create texture
+        if (BPP == 1)
+        {
+            // Set unpack alignment
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            // Create ALPHA texture
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pData);
+        }
+        else if (BPP == 3)
+        {
+            // Create RGB texture
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, pData);
+        }
+        else if (BPP == 4)
+        {
+            // Create RGBA texture
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pData);
+        }
+
+        // Generate mip maps
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        m_target = GL_TEXTURE_2D;
+        m_hasLevels = true;
+    });
+}
+
+void Texture::loadAsync()
+{
+    // Compressed textures don't need decoding, reading them doesn't block for long
+    if (isCompressedImagePath(Source))
+    {
+        loadCompressed();
+        return;
+    }
+
+    // The array layer has old contents, the texture is added to an array again when used
+    detach();
+
+    // Texture arrays only group textures that have been completely loaded
+    m_width = 0;
+    m_height = 0;
+    m_BPP = 0;
+    m_internalFormat = 0;
+    m_levels = 0;
+    m_loaded = false;
+
+    TextureStreamer::request(this, Source);
+}
+
+bool Texture::isLoaded() const
+{
+    return m_loaded;
+}
+
+unsigned int Texture::addLayer(Texture* pTexture)
+{
+    ADER_ASSERT(m_layers.empty() || isCompatible(pTexture), "Texture array layers must have the same size and format");
+
+    // The array takes the size and format of it's first layer
+    if (m_layers.empty())
+    {
+        m_width = pTexture->m_width;
+        m_height = pTexture->m_height;
+        m_BPP = pTexture->m_BPP;
+        m_internalFormat = pTexture->m_internalFormat;
+        m_levels = pTexture->m_levels;
+    }
+
+    pTexture->m_pArray = this;
+
+    // Reuse the layer of a detached texture
+    auto it = std::find(m_layers.begin(), m_layers.end(), nullptr);
+    if (it != m_layers.end())
+    {
+        pTexture->m_layer = (unsigned int)(it - m_layers.begin());
+        *it = pTexture;
     }
     else
     {
-        // Allocate new static buffer memory
-        allocBuffer(buffer, eSize, eCount, pData);
+        pTexture->m_layer = (unsigned int)m_layers.size();
+        m_layers.push_back(pTexture);
+    }
 
-        // VBO was created so attributes should have been created already
-        return false;
+    return pTexture->m_layer;
+}
+
+bool Texture::hasFreeLayer(unsigned int maxLayers) const
+{
+    return m_layers.size() < maxLayers || std::find(m_layers.begin(), m_layers.end(), nullptr) != m_layers.end();
+}
+
+void Texture::loadArray()
+{
+    m_target = GL_TEXTURE_2D_ARRAY;
+
+    // Layers are read when the command is executed, a layer that is deleted before
+    // that waits for the command since deletion is synchronous
+    std::vector<Texture*> layers = m_layers;
+    unsigned int width = m_width;
+    unsigned int height = m_height;
+    GLenum internalFormat = m_internalFormat;
+    GLsizei levels = m_levels;
+
+    // Memory of all layers, layers can be detached so the size comes from the array format
+    m_memorySize = m_layers.size() * getLevelsSize();
+
+    RenderThread::record([this, layers, width, height, internalFormat, levels]()
+    {
+        deleteTexture();
+
+        // Generate texture
+        glGenTextures(1, &m_idTexture);
+
+        // Bind the texture
+        GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, m_idTexture);
+
+        // Same parameters as 2D textures
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        m_hasLevels = true;
+
+        // Allocate all layers
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internalFormat, width, height, (GLsizei)layers.size());
+
+        // Copy every mip level of the layers on the GPU
+        for (size_t layer = 0; layer < layers.size(); layer++)
+        {
+            if (layers[layer] == nullptr || layers[layer]->m_idTexture == 0)
+            {
+                continue;
+            }
+
+            for (GLsizei level = 0; level < levels; level++)
+            {
+                GLsizei levelWidth = std::max(1u, width >> level);
+                GLsizei levelHeight = std::max(1u, height >> level);
+
+                glCopyImageSubData(
+                    layers[layer]->m_idTexture, GL_TEXTURE_2D, level, 0, 0, 0,
+                    m_idTexture, GL_TEXTURE_2D_ARRAY, level, 0, 0, (GLint)layer,
+                    levelWidth, levelHeight, 1);
+            }
+        }
+    });
+}
+
+bool Texture::isCompatible(const Texture* pTexture) const
+{
+    return m_width != 0 &&
+        m_width == pTexture->m_width &&
+        m_height == pTexture->m_height &&
+        m_BPP == pTexture->m_BPP &&
+        m_internalFormat == pTexture->m_internalFormat &&
+        m_levels == pTexture->m_levels;
+}
+
+Texture* Texture::getArray() const
+{
+    return m_pArray;
+}
+
+unsigned int Texture::getLayer() const
+{
+    return m_layer;
+}
+
+const std::vector<Texture*>& Texture::getLayers() const
+{
+    return m_layers;
+}
+
+size_t Texture::getMemorySize() const
+{
+    return m_memorySize;
+}
+
+void Texture::querySupport()
+{
+    // Without a window the null backend accepts every format
+    if (glfwGetCurrentContext() == nullptr)
+    {
+        return;
     }
 
-    // Should not reach this point
-    return false;
+    ms_s3tcSupported = glfwExtensionSupported("GL_EXT_texture_compression_s3tc") == GLFW_TRUE;
+    ms_bptcSupported = GLAD_GL_VERSION_4_2 || glfwExtensionSupported("GL_ARB_texture_compression_bptc") == GLFW_TRUE;
+
+    LOG_INFO("Compressed textures: S3TC {0}, BPTC {1}",
+        ms_s3tcSupported ? "supported" : "not supported",
+        ms_bptcSupported ? "supported" : "not supported");
 }
 
-void VAO::deleteBuffer(VBO& buffer)
+void Texture::detach()
 {
-    // Check that the buffer is valid and then delete it
-    if (buffer.ID != 0)
+    // Leave the layer empty, the array keeps it's contents
+    if (m_pArray)
     {
-        glDeleteBuffers(1, &buffer.ID);
-        buffer.Size = 0;
+        m_pArray->m_layers[m_layer] = nullptr;
+        m_pArray = nullptr;
+        m_layer = 0;
+    }
+
+    for (Texture* pLayer : m_layers)
+    {
+        if (pLayer)
+        {
+            pLayer->m_pArray = nullptr;
+            pLayer->m_layer = 0;
+        }
     }
+
+    m_layers.clear();
 }
 
-void VAO::createBuffer(VBO& vbo)
+void Texture::deleteTexture()
 {
-    // Create buffer and add to buffers vector
-    glGenBuffers(1, &vbo.ID);
+    // Check that the texture is valid and then delete it
+    if (m_idTexture != 0)
+    {
+        GLState::deleteTexture(m_idTexture);
+        m_idTexture = 0;
+    }
+
+    m_hasLevels = false;
 }
 
-void VAO::allocBuffer(VBO& vbo, size_t eSize, size_t eCount, void* pInitData)
+void Texture::loadTexture(const Memory::reference<ImageFileContents>& image)
 {
-    // Add buffer data
-    glBufferData(vbo.Type, eCount * eSize, pInitData, vbo.Dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW);
-    vbo.Size = eCount * eSize;
+    if (!image.valid())
+    {
+        LOG_WARN("Texture couldn't be created!");
+        return;
+    }
+
+    // Generate texture
+    glGenTextures(1, &m_idTexture);
+
+    // Bind the texture
+    GLState::bindTexture(0, GL_TEXTURE_2D, m_idTexture);
+
+    // Texture parameters
+
+    // Repeat textures when the object is to big
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // Interpolate final color
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Create texture
+    if (image->BPP == 3)
+    {
+        // Create RGB texture
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image->Width, image->Height, 0, GL_RGB, GL_UNSIGNED_BYTE, image->Buffer);
+    }
+    else if (image->BPP == 4)
+    {
+        // Create RGBA texture
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->Width, image->Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->Buffer);
+    }
+
+    // Generate mip maps
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    m_target = GL_TEXTURE_2D;
+    m_hasLevels = true;
 }
 
-void VAO::modifyBuffer(VBO& vbo, size_t eSize, size_t eCount, void* pData)
+void Texture::loadCompressed()
 {
-    // Check size of buffer
-    if (vbo.Size < eSize * eCount)
+    // Reading the file is the only work left, the levels are uploaded as they are
+    Memory::reference<CompressedImageContents> image = readCompressedImage(Source);
+
+    // Replaces a texture that is still streaming
+    TextureStreamer::cancel(this);
+
+    // The array layer has old contents, the texture is added to an array again when used
+    detach();
+
+    m_loaded = image.valid();
+    if (!image.valid())
     {
-        // Allocate buffer since the previous one was too small
-        allocBuffer(vbo, eSize, eCount, pData);
+        return;
+    }
 
-        // Do nothing else
+    // Formats the driver can't sample take the uncompressed path
+    bool supported = ((image->Format != cf_BC1 && image->Format != cf_BC3) || ms_s3tcSupported) &&
+        (image->Format != cf_BC7 || ms_bptcSupported);
+
+    if (!supported)
+    {
+        std::vector<unsigned char> pixels;
+        if (!decompressImage(*image, pixels))
+        {
+            LOG_ERROR("Texture '{0}' uses a compressed format the driver doesn't support!", Source);
+            m_loaded = false;
+            return;
+        }
+
+        LOG_WARN("Texture '{0}' uses a compressed format the driver doesn't support, uploading it uncompressed", Source);
+        load(image->Width, image->Height, 4, pixels);
         return;
     }
 
-    // Map buffer and get it's contents pointer
-    void* ptr = glMapBuffer(vbo.Type, GL_WRITE_ONLY);
+    // BPP is left 0, compressed textures only match textures with the same format
+    setFormat(image->Width, image->Height, 0, getGLInternalFormat(image->Format),
+        (unsigned int)image->Levels.size(), image->Data.size());
 
-    // Copy new data and don't change the size variable
-    memcpy(ptr, pData, eSize * eCount);
+    RenderThread::record([this, image]()
+    {
+        deleteTexture();
 
-    // Unmap the buffer
-    glUnmapBuffer(vbo.Type);
+        GLenum internalFormat = getGLInternalFormat(image->Format);
+
+        // Generate texture
+        glGenTextures(1, &m_idTexture);
+
+        // Bind the texture
+        GLState::bindTexture(0, GL_TEXTURE_2D, m_idTexture);
+
+        // Same parameters as uncompressed textures
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Files don't always contain the full mip chain
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image->Levels.size() - 1);
+
+        // Upload the precomputed levels
+        for (size_t i = 0; i < image->Levels.size(); i++)
+        {
+            const CompressedLevel& level = image->Levels[i];
+
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.Width, level.Height, 0,
+                (GLsizei)level.Size, image->Data.data() + level.Offset);
+        }
+
+        m_target = GL_TEXTURE_2D;
+        m_hasLevels = true;
+    });
 }
 
-Shader::Shader()
+void Texture::setFormat(unsigned int width, unsigned int height, unsigned int BPP, GLenum internalFormat, unsigned int levels, size_t memorySize)
 {
+    m_width = width;
+    m_height = height;
+    m_BPP = BPP;
+    m_internalFormat = internalFormat;
+    m_levels = levels;
+    m_memorySize = memorySize;
+
+    // Compare against the same image as uncompressed RGBA with a full mip chain
+    LOG_INFO("Texture '{0}' {1}x{2}: {3} KB, {4} KB uncompressed", 
+        Source, width, height, memorySize / 1024, getUncompressedSize(width, height, 4) / 1024);
 }
 
-Shader::~Shader()
+unsigned int Texture::getLevelCount(unsigned int width, unsigned int height)
 {
-    deleteShader();
+    unsigned int levels = 1;
+    while ((width >> levels) > 0 || (height >> levels) > 0)
+    {
+        levels++;
+    }
+
+    return levels;
 }
 
-void Shader::bind()
+size_t Texture::getUncompressedSize(unsigned int width, unsigned int height, unsigned int BPP)
 {
-    ADER_ASSERT(m_idShader != 0, "Trying to bind invalid shader");
-    glUseProgram(m_idShader);
+    size_t size = 0;
+    for (unsigned int level = 0; level < getLevelCount(width, height); level++)
+    {
+        size += (size_t)std::max(width >> level, 1u) * std::max(height >> level, 1u) * BPP;
+    }
+
+    return size;
 }
 
-void Shader::load()
+size_t Texture::getLevelsSize() const
+{
+    // Uncompressed textures have a full mip chain
+    if (m_BPP != 0)
+    {
+        return getUncompressedSize(m_width, m_height, m_BPP);
+    }
+
+    // Compressed textures are matched by their internal format
+    for (CompressedFormat format : { cf_BC1, cf_BC3, cf_BC4, cf_BC5, cf_BC7 })
+    {
+        if (getGLInternalFormat(format) != m_internalFormat)
+        {
+            continue;
+        }
+
+        size_t size = 0;
+        for (unsigned int level = 0; level < m_levels; level++)
+        {
+            size += getLevelSize(format, std::max(m_width >> level, 1u), std::max(m_height >> level, 1u));
+        }
+
+        return size;
+    }
+
+    return 0;
+}
+
+TextureAtlas::TextureAtlas()
 {
-    // Unbind the shader
-    glUseProgram(0);
+}
 
-    // Delete shader and the reload the shader
-    deleteShader();
-    loadShader();
+TextureAtlas::~TextureAtlas()
+{
+    deletePages();
 }
 
-void Shader::deleteShader()
+void TextureAtlas::addSource(const std::string& source)
 {
-    glDeleteProgram(m_idShader);
+    m_sources.push_back(source);
 }
 
-void Shader::loadShader()
+size_t TextureAtlas::build(unsigned int maxSize, unsigned int padding)
 {
-    // Info about shader compilation
-    int success;
-    char infoLog[512];
+    deletePages();
+    m_regions.clear();
 
-    // Vertex shader
-
-    // Read vertex file
-    std::string vertexSource = readFile(VertexSource).c_str();
-    const char* vSource = vertexSource.c_str();
-
-    // Create vertex shader
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    // Decode all images, converted to RGBA so every page has the same format
+    struct Image
+    {
+        const std::string* pSource = nullptr;
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+        std::vector<unsigned char> Pixels;
 
-    // Compile vertex shader
-    glShaderSource(vertexShader, 1, &vSource, NULL);
-    glCompileShader(vertexShader);
+        /// Page and bottom left corner of the padded image
+        size_t Page = 0;
+        unsigned int X = 0;
+        unsigned int Y = 0;
+    };
 
-    // Fragment shader
+    std::vector<Image> images;
+    images.reserve(m_sources.size());
 
-    // Read fragment file
-    std::string fragmentSource = readFile(FragmentSource).c_str();
-    const char* fSource = fragmentSource.c_str();
+    for (const std::string& source : m_sources)
+    {
+        // Sources added more than once are packed once
+        if (!m_regions.emplace(source, Region()).second)
+        {
+            continue;
+        }
 
-    // Create fragment shader
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        Memory::reference<ImageFileContents> file = readImage(source);
+        if (!file.valid())
+        {
+            continue;
+        }
 
-    // Compile fragment shader
-    glShaderSource(fragmentShader, 1, &fSource, NULL);
-    glCompileShader(fragmentShader);
+        if (file->Width + 2 * padding > maxSize || file->Height + 2 * padding > maxSize)
+        {
+            LOG_WARN("Image '{0}' doesn't fit into a {1}x{1} atlas page!", source, maxSize);
+            continue;
+        }
 
-    // Check compilation results of shaders
+        Image image;
+        image.pSource = &source;
+        image.Width = file->Width;
+        image.Height = file->Height;
+        image.Pixels.resize((size_t)image.Width * image.Height * 4);
 
-    // Get compilation results
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+        for (size_t i = 0; i < (size_t)image.Width * image.Height; i++)
+        {
+            const unsigned char* pIn = file->Buffer + i * file->BPP;
+            unsigned char* pOut = image.Pixels.data() + i * 4;
+
+            // Grey and grey alpha images are expanded to RGB
+            bool grey = file->BPP < 3;
+            pOut[0] = pIn[0];
+            pOut[1] = grey ? pIn[0] : pIn[1];
+            pOut[2] = grey ? pIn[0] : pIn[2];
+            pOut[3] = file->BPP == 2 ? pIn[1] : file->BPP == 4 ? pIn[3] : 255;
+        }
 
-    // If it failed get detailed info
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        LOG_ERROR("Failed to compile vertex shader:\n {0}", infoLog);
+        images.push_back(std::move(image));
     }
 
-    // Get compilation results
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    // Only packed images get a region
+    m_regions.clear();
 
-    // If it failed get detailed info
-    if (!success)
+    // Packing the tallest images first keeps the skyline flat
+    std::vector<Image*> remaining;
+    for (Image& image : images)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        LOG_ERROR("Failed to compile fragment shader:\n {0}", infoLog);
+        remaining.push_back(&image);
     }
 
-    // Create shader program
-    m_idShader = glCreateProgram();
-
-    // Add shaders and link them
-    glAttachShader(m_idShader, vertexShader);
-    glAttachShader(m_idShader, fragmentShader);
-    glLinkProgram(m_idShader);
-
-    // Check if it linked correctly
-    glGetProgramiv(m_idShader, GL_LINK_STATUS, &success);
-
-    // If it failed get detailed info
-    if (!success) 
+    std::sort(remaining.begin(), remaining.end(), [](const Image* a, const Image* b)
     {
-        glGetProgramInfoLog(m_idShader, 512, NULL, infoLog);
-        LOG_ERROR("Failed to link shader:\n {0}", infoLog);
-    }
-
-    // Delete shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-}
+        return a->Height != b->Height ? a->Height > b->Height : a->Width > b->Width;
+    });
 
-Texture::Texture()
-{
-    
-}
+    // Fill pages until every image is placed
+    std::vector<Image*> next;
+    std::vector<glm::uvec2> pageSizes;
+    while (!remaining.empty())
+    {
+        Utility::AtlasPacker packer(maxSize, maxSize);
+        next.clear();
 
-Texture::~Texture()
-{
-    // Delete the texture
-    deleteTexture();
-}
+        for (Image* pImage : remaining)
+        {
+            pImage->Page = pageSizes.size();
+            if (!packer.insert(pImage->Width + 2 * padding, pImage->Height + 2 * padding, pImage->X, pImage->Y))
+            {
+                next.push_back(pImage);
+            }
+        }
 
-void Texture::bind(unsigned int slot)
-{
-    ADER_ASSERT(m_idTexture != 0, "Trying to bind invalid texture");
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_idTexture);
-}
+        // Shrink the page to the smallest power of two that covers the images
+        glm::uvec2 size(1, 1);
+        while (size.x < packer.getUsedWidth())
+        {
+            size.x *= 2;
+        }
 
-void Texture::load()
-{
-    // Delete current texture if it exists
-    deleteTexture();
+        while (size.y < packer.getUsedHeight())
+        {
+            size.y *= 2;
+        }
 
-    // Load the texture
-    loadTexture();
-}
+        pageSizes.push_back(glm::min(size, glm::uvec2(maxSize)));
+        remaining.swap(next);
+    }
 
-void Texture::load(unsigned int width, unsigned int height, unsigned int BPP, std::vector<unsigned char>& data)
-{
-    if (width * height * BPP != data.size())
+    // Compose the pages
+    std::vector<std::vector<unsigned char>> pages(pageSizes.size());
+    for (size_t i = 0; i < pages.size(); i++)
     {
-        LOG_ERROR("Texture data and specified parameters do not match!");
-        return;
+        pages[i].resize((size_t)pageSizes[i].x * pageSizes[i].y * 4, 0);
     }
 
-    deleteTexture();
-
-    // Generate texture
-    glGenTextures(1, &m_idTexture);
-
-    // Bind the texture
-    glBindTexture(GL_TEXTURE_2D, m_idTexture);
-
-    // Texture parameters
+    for (Image& image : images)
+    {
+        glm::uvec2 pageSize = pageSizes[image.Page];
+        unsigned char* pPage = pages[image.Page].data();
 
-    // Repeat textures when the object is to big
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // The padding repeats the edge pixels of the image
+        for (unsigned int y = 0; y < image.Height + 2 * padding; y++)
+        {
+            unsigned int sourceY = (unsigned int)glm::clamp((int)y - (int)padding, 0, (int)image.Height - 1);
 
-    // Interpolate final color
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            for (unsigned int x = 0; x < image.Width + 2 * padding; x++)
+            {
+                unsigned int sourceX = (unsigned int)glm::clamp((int)x - (int)padding, 0, (int)image.Width - 1);
 
-    // Create texture
-    if (BPP == 1)
-    {
-        // Set unpack alignment
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                memcpy(pPage + ((size_t)(image.Y + y) * pageSize.x + image.X + x) * 4,
+                    image.Pixels.data() + ((size_t)sourceY * image.Width + sourceX) * 4, 4);
+            }
+        }
 
-        // Create ALPHA texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, data.data());
-    }
-    else if (BPP == 3)
-    {
-        // Create RGB texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data());
+        Region& region = m_regions[*image.pSource];
+        region.Page = image.Page;
+        region.Width = image.Width;
+        region.Height = image.Height;
+        region.Rect = glm::vec4(
+            (float)(image.X + padding) / pageSize.x,
+            (float)(image.Y + padding) / pageSize.y,
+            (float)image.Width / pageSize.x,
+            (float)image.Height / pageSize.y);
     }
-    else if (BPP == 4)
+
+    // Upload the pages
+    for (size_t i = 0; i < pages.size(); i++)
     {
-        // Create RGBA texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+        Texture* pPage = new Texture();
+        pPage->Source = "atlas page " + std::to_string(i);
+        pPage->load(pageSizes[i].x, pageSizes[i].y, 4, pages[i]);
+        m_pages.push_back(pPage);
     }
 
-    // Generate mip maps
-    glGenerateMipmap(GL_TEXTURE_2D);
+    LOG_INFO("Packed {0} images into {1} atlas pages", images.size(), m_pages.size());
+    return images.size();
 }
 
-void Texture::deleteTexture()
+const TextureAtlas::Region* TextureAtlas::getRegion(const std::string& source) const
 {
-    // Check that the texture is valid and then delete it
-    if (m_idTexture != 0)
+    auto it = m_regions.find(source);
+    if (it == m_regions.end())
     {
-        glDeleteTextures(1, &m_idTexture);
+        return nullptr;
     }
+
+    return &it->second;
 }
 
-void Texture::loadTexture()
+size_t TextureAtlas::getPageCount() const
 {
-    // Load texture
-    Memory::reference<ImageFileContents> image = readImage(Source);
+    return m_pages.size();
+}
 
-    if (!image.valid())
+Texture* TextureAtlas::getPage(size_t index) const
+{
+    if (index >= m_pages.size())
     {
-        LOG_WARN("Texture couldn't be created!");
-        return;
+        return nullptr;
     }
 
-    // Generate texture
-    glGenTextures(1, &m_idTexture);
-
-    // Bind the texture
-    glBindTexture(GL_TEXTURE_2D, m_idTexture);
-
-    // Texture parameters
-
-    // Repeat textures when the object is to big
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    // Interpolate final color
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return m_pages[index];
+}
 
-    // Create texture
-    if (image->BPP == 3)
-    {
-        // Create RGB texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image->Width, image->Height, 0, GL_RGB, GL_UNSIGNED_BYTE, image->Buffer);
-    }
-    else if (image->BPP == 4)
+void TextureAtlas::deletePages()
+{
+    for (Texture* pPage : m_pages)
     {
-        // Create RGBA texture
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->Width, image->Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->Buffer);
+        delete pPage;
     }
 
-    // Generate mip maps
-    glGenerateMipmap(GL_TEXTURE_2D);
+    m_pages.clear();
 }
 
 Audio::Audio()
@@ -1009,71 +3008,129 @@ void Audio::loadBuffer()
     }
 }
 
-UniformBuffer::UniformBuffer()
+UniformArena::UniformArena()
 {
-    glGenBuffers(1, &m_idUBO);
+    RenderThread::run([this]()
+    {
+        // Ranges must start at multiples of the driver alignment
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment > 0)
+        {
+            m_alignment = alignment;
+        }
+
+        createBuffer(ms_initialRegionSize);
+    });
+
+    m_regionSize = ms_initialRegionSize;
 }
 
-UniformBuffer::UniformBuffer(BoundPoints bp)
-    : UniformBuffer()
+UniformArena::~UniformArena()
 {
-    // Bind first
-    bind();
+    // Wait for the deletion since the id is part of this object
+    RenderThread::run([this]()
+    {
+        deleteBuffer();
+    });
+}
 
-    // Allocate
-    allocBP(bp);
+void UniformArena::beginFrame()
+{
+    // Keeps the capacity so writing doesn't allocate in steady state
+    m_staging.clear();
 }
 
-void UniformBuffer::bind()
+size_t UniformArena::write(BoundPoints bp, const void* pData)
 {
-    // Bind the buffer
-    glBindBuffer(GL_UNIFORM_BUFFER, m_idUBO);
+    size_t size = getBPSize(bp);
+
+    // Align the block
+    size_t offset = (m_staging.size() + m_alignment - 1) / m_alignment * m_alignment;
+    m_staging.resize(offset + size);
+
+    memcpy(m_staging.data() + offset, pData, size);
+    return offset;
 }
 
-void UniformBuffer::allocBP(BoundPoints bp)
+void UniformArena::upload()
 {
-    // Get the size of the bound point
-    m_size = getBPSize(bp);
+    size_t size = m_staging.size();
+    if (size == 0)
+    {
+        return;
+    }
 
-    // Check if size is 0
-    if (m_size == 0)
+    // Grow the ring if the frame doesn't fit into a region
+    if (size > m_regionSize)
     {
-        LOG_WARN("Allocating 0 size uniform buffer!");
+        while (m_regionSize < size)
+        {
+            m_regionSize *= 2;
+        }
+
+        size_t regionSize = m_regionSize;
+        RenderThread::record([this, regionSize]()
+        {
+            deleteBuffer();
+            createBuffer(regionSize);
+        });
     }
 
-    // Allocate data
-    glBufferData(GL_UNIFORM_BUFFER, m_size, NULL, GL_STATIC_DRAW);
+    // Data must stay valid until the command is executed
+    const unsigned char* pData = RenderThread::copy(m_staging.data(), size);
+    unsigned int region = m_frame % ms_regionCount;
+    size_t base = region * m_regionSize;
 
-    // Bind buffer range
-    glBindBufferRange(GL_UNIFORM_BUFFER, bp, m_idUBO, 0, m_size);
+    RenderThread::record([this, pData, size, region, base]()
+    {
+        if (m_pMapped)
+        {
+            // The GPU might still be reading the region from a previous frame
+            waitRegion(region);
+            memcpy(m_pMapped + base, pData, size);
+        }
+        else
+        {
+            GLState::bindBuffer(GL_UNIFORM_BUFFER, m_idBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, base, size, pData);
+        }
+    });
 }
 
-void UniformBuffer::setSubData(const size_t& offset, const size_t& size, void* pValue)
+void UniformArena::bind(BoundPoints bp, size_t offset)
 {
-    // Check if the buffer is large enough
-    if (m_size < offset + size)
-    {
-        LOG_ERROR("UBO overflow caught, no updates applied!");
-        return;
-    }
+    size_t base = (m_frame % ms_regionCount) * m_regionSize;
+    size_t size = getBPSize(bp);
 
-    // Set sub data
-    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, pValue);
+    RenderThread::record([this, bp, base, offset, size]()
+    {
+        GLState::bindBufferRange(GL_UNIFORM_BUFFER, bp, m_idBuffer, base + offset, size);
+    });
 }
 
-void UniformBuffer::mapData(void* pData)
+void UniformArena::endFrame()
 {
-    // Map buffer and get it's contents pointer
-    void* ptr = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
+    unsigned int region = m_frame % ms_regionCount;
+
+    RenderThread::record([this, region]()
+    {
+        // Fence after the last draw that reads the region
+        if (m_pMapped)
+        {
+            if (m_fences[region])
+            {
+                glDeleteSync(m_fences[region]);
+            }
 
-    // Copy new data
-    memcpy(ptr, pData, m_size);
+            m_fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    });
 
-    // Unmap the buffer
-    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    m_frame++;
 }
 
-size_t UniformBuffer::getBPSize(BoundPoints bp)
+size_t UniformArena::getBPSize(BoundPoints bp)
 {
     switch (bp)
     {
@@ -1086,8 +3143,74 @@ size_t UniformBuffer::getBPSize(BoundPoints bp)
     return 0;
 }
 
+void UniformArena::createBuffer(size_t regionSize)
+{
+    size_t size = regionSize * ms_regionCount;
+
+    glGenBuffers(1, &m_idBuffer);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, m_idBuffer);
+
+    // Persistent mapping requires buffer storage (GL 4.4)
+    if (GLAD_GL_VERSION_4_4)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+        m_pMapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+    }
+    else
+    {
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        m_pMapped = nullptr;
+    }
+}
+
+void UniformArena::deleteBuffer()
+{
+    for (unsigned int i = 0; i < ms_regionCount; i++)
+    {
+        waitRegion(i);
+    }
+
+    if (m_pMapped)
+    {
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, m_idBuffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        m_pMapped = nullptr;
+    }
+
+    if (m_idBuffer != 0)
+    {
+        GLState::deleteBuffer(m_idBuffer);
+        m_idBuffer = 0;
+    }
+}
+
+void UniformArena::waitRegion(unsigned int region)
+{
+    GLsync& fence = m_fences[region];
+    if (!fence)
+    {
+        return;
+    }
+
+    // Wait in 1 ms steps, flushing the first time so the fence is guaranteed to signal
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        GLenum result = glClientWaitSync(fence, flags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+        {
+            break;
+        }
+
+        flags = 0;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
 Text::Text()
-    : m_pTexture(new Texture())
 {
 }
 
@@ -1095,62 +3218,82 @@ Text::~Text()
 {
     for (auto& it : m_slots)
     {
-        if (it.second.pVAO)
-        {
-            delete it.second.pVAO;
-        }
+        TextRenderer::release(it.second.Range);
     }
 }
 
 void Text::render()
 {
-    // Bind texture and shader
-    m_pShader->bind();
-    m_pTexture->bind();
+    if (m_font < 0)
+    {
+        return;
+    }
+
+    // Glyphs were evicted from the cache, their texture rectangles are no longer valid
+    unsigned int generation = GlyphCache::getGeneration();
+    bool evicted = generation != m_generation;
+    m_generation = generation;
 
     for (auto& it : m_slots)
     {
         Slot& slot = it.second;
 
+        // Evicted glyphs can be anywhere in the slot, the whole slot is laid out again
+        if (evicted)
+        {
+            slot.Layout.clear();
+        }
+
         // Check if the slot is visible 
         if (slot.Visible)
         {
-            // If needed regenerate the slot VAO
-            if (slot.Regenerate)
+            // If needed regenerate the slot glyphs
+            if (slot.Regenerate || evicted)
             {
                 // Update slot
                 updateSlot(slot);
                 slot.Regenerate = false;
             }
-            
-            // Bind and render
-            slot.pVAO->bind();
-            slot.pVAO->render();
+            else
+            {
+                // Keep the pages of the glyphs from being evicted
+                GlyphCache::touchPages(slot.Pages);
+            }
+
+            // Moving the slot keeps the glyphs
+            if (slot.Position != slot.Offset)
+            {
+                TextRenderer::setOffset(slot.Range, slot.Position);
+                slot.Offset = slot.Position;
+            }
+
+            // Drawn by the text renderer together with the rest of the UI
+            TextRenderer::submit(GlyphCache::getTexture(), m_pShader, slot.Range, slot.Glyphs.size());
+        }
+        else if (evicted)
+        {
+            slot.Regenerate = true;
         }
     }
 }
 
 void Text::load()
 {
-    // Load font
-    Memory::reference<FontFileContents> font = readFont(FontSource);
+    // Faces are shared with other text using the same source
+    m_font = GlyphCache::getFont(FontSource, Size, DistanceField);
 
-    if (!font.valid())
+    if (m_font < 0)
     {
         LOG_WARN("Font couldn't be created!");
         return;
     }
 
-    // Text BPP is 1
-    unsigned int BPP = 1;
-
-    // Create texture
-    m_pTexture->load(font->Width, font->Height, BPP, font->Buffer);
-
-    // Save metrics for later use
-    m_metrics = font->Metrics;
-    m_width = font->Width;
-    m_height = font->Height;
+    // Lay out the slots with the new font
+    for (auto& it : m_slots)
+    {
+        it.second.Layout.clear();
+        it.second.Regenerate = true;
+    }
 }
 
 void Text::setShader(Shader* pShader)
@@ -1165,102 +3308,203 @@ Text::Slot& Text::getSlot(const std::string& name)
 
 void Text::updateSlot(Slot& slot)
 {
-    // Final buffers
-    std::vector<float> vertices;
-    std::vector<float> texCoord;
+    // Bitmap glyphs are rasterized at the size of the text, distance fields are scaled to it
+    float scale = (float)Size / (float)GlyphCache::getSize(m_font);
+
+    glm::u8vec4 color = glm::u8vec4(glm::clamp(slot.Color, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+    // All glyphs share the color, a new color changes every glyph
+    if (!slot.Glyphs.empty() && slot.Glyphs[0].Color != color)
+    {
+        slot.Layout.clear();
+    }
+
+    // Decode the content, the content is UTF-8
+    m_codepoints.clear();
+    size_t i = 0;
+    while (i < slot.Content.length())
+    {
+        m_codepoints.push_back(decodeUTF8(slot.Content, i));
+    }
 
-    // Reserve sizes
-    vertices.reserve((slot.Content.length() * 6 * 3));
-    texCoord.reserve((slot.Content.length() * 6 * 2));
+    // Characters before the first change keep their layout, the last character
+    // of the layout only holds the end pen
+    size_t laidOut = slot.Layout.empty() ? 0 : slot.Layout.size() - 1;
+    size_t start = 0;
+    while (start < laidOut && start < m_codepoints.size() && slot.Layout[start].Codepoint == m_codepoints[start])
+    {
+        start++;
+    }
 
-    // The height of a single character this must match the one
-    // that was used to load the font file
-    unsigned int charHeight = 32;
+    Character resume;
+    if (start < slot.Layout.size())
+    {
+        resume = slot.Layout[start];
+    }
 
-    // Initialize the index to the vertex array.
-    int index = 0;
-    float scale = 1;
+    slot.Layout.resize(start);
+    m_glyphs.clear();
 
-    // Copy since we use these variables for controlling the pen
-    float x = slot.Position.x;
-    float y = slot.Position.y;
+    // Copy since we use this for controlling the pen, positions are relative to the slot
+    glm::vec2 pen = resume.Pen;
 
-    // Iterate over each text character
-    std::string::const_iterator c;
-    for (c = slot.Content.begin(); c != slot.Content.end(); c++)
+    for (size_t c = start; c < m_codepoints.size(); c++)
     {
-        // Calculate additional information needed to generate data
-        CharMetric& metrics = m_metrics[*c];
+        unsigned int codepoint = m_codepoints[c];
 
-        float xSize = metrics.End.x - metrics.Start.x;
-        float ySize = metrics.End.y - metrics.Start.y;
+        Character character;
+        character.Codepoint = codepoint;
+        character.Pen = pen;
+        character.Glyph = resume.Glyph + (unsigned int)m_glyphs.size();
+        slot.Layout.push_back(character);
 
-        float xpos = x + metrics.Offset.x * scale;
-        float ypos = y - (ySize - metrics.Offset.y) * scale;
+        // New lines move the pen down
+        if (codepoint == '\n')
+        {
+            pen.x = 0.0f;
+            pen.y -= GlyphCache::getLineHeight(m_font) * scale;
+            continue;
+        }
+
+        // Glyphs are rasterized by the cache the first time they are used
+        const GlyphCache::Glyph* pGlyph = GlyphCache::getGlyph(m_font, codepoint);
+        if (pGlyph == nullptr)
+        {
+            continue;
+        }
 
-        float w = xSize * scale;
-        float h = ySize * scale;
+        // Characters without an image (spaces) only move the pen
+        if (pGlyph->Size.x > 0.0f && pGlyph->Size.y > 0.0f)
+        {
+            TextRenderer::Glyph glyph;
 
+            float xpos = pen.x + pGlyph->Bearing.x * scale;
+            float ypos = pen.y - (pGlyph->Size.y - pGlyph->Bearing.y) * scale;
 
-        // First triangle
-        vertices.push_back(xpos);
-        vertices.push_back(ypos + h);
-        vertices.push_back(1.0f);
+            glyph.Rect = glm::vec4(xpos, ypos, pGlyph->Size.x * scale, pGlyph->Size.y * scale);
+            glyph.TexRect = pGlyph->TexRect;
+            glyph.Color = color;
+            glyph.Layer = (float)pGlyph->Page;
 
-        texCoord.push_back(metrics.Start.x / m_width);
-        texCoord.push_back(metrics.Start.y / m_height);
+            m_glyphs.push_back(glyph);
+        }
 
+        pen.x += pGlyph->Advance * scale;
+    }
 
-        vertices.push_back(xpos + w);
-        vertices.push_back(ypos);
-        vertices.push_back(1.0f);
+    Character end;
+    end.Pen = pen;
+    end.Glyph = resume.Glyph + (unsigned int)m_glyphs.size();
+    slot.Layout.push_back(end);
 
-        texCoord.push_back(metrics.End.x / m_width);
-        texCoord.push_back(metrics.End.y / m_height);
+    // Only the glyphs that differ from the previous layout are written, an FPS
+    // counter changing two digits writes two glyphs
+    size_t first = resume.Glyph;
+    size_t count = first + m_glyphs.size();
+    size_t changedBegin = count;
+    size_t changedEnd = first;
 
+    for (size_t g = 0; g < m_glyphs.size(); g++)
+    {
+        size_t index = first + g;
+        if (index >= slot.Glyphs.size() || memcmp(&slot.Glyphs[index], &m_glyphs[g], sizeof(TextRenderer::Glyph)) != 0)
+        {
+            changedBegin = std::min(changedBegin, index);
+            changedEnd = index + 1;
+        }
+    }
 
-        vertices.push_back(xpos);
-        vertices.push_back(ypos);
-        vertices.push_back(1.0f);
+    slot.Glyphs.resize(count);
+    std::copy(m_glyphs.begin(), m_glyphs.end(), slot.Glyphs.begin() + first);
 
-        texCoord.push_back(metrics.Start.x / m_width);
-        texCoord.push_back(metrics.End.y / m_height);
+    // A range too small for the glyphs is replaced and written completely
+    if (count > slot.Range.Capacity)
+    {
+        TextRenderer::release(slot.Range);
+        slot.Range = TextRenderer::allocate(count);
 
+        changedBegin = 0;
+        changedEnd = count;
 
-        // Second triangle in quad.
-        vertices.push_back(xpos);
-        vertices.push_back(ypos + h);
-        vertices.push_back(1.0f);
+        TextRenderer::setOffset(slot.Range, slot.Position);
+        slot.Offset = slot.Position;
+    }
 
-        texCoord.push_back(metrics.Start.x / m_width);
-        texCoord.push_back(metrics.Start.y / m_height);
+    if (changedBegin < changedEnd)
+    {
+        TextRenderer::write(slot.Range, changedBegin, slot.Glyphs.data() + changedBegin, changedEnd - changedBegin);
+    }
 
+    // Pages of the kept glyphs are still used
+    slot.Pages = 0;
+    for (const TextRenderer::Glyph& glyph : slot.Glyphs)
+    {
+        slot.Pages |= 1u << (unsigned int)glyph.Layer;
+    }
+}
 
-        vertices.push_back(xpos + w);
-        vertices.push_back(ypos + h);
-        vertices.push_back(1.0f);
+void Text::Slot::setContent(const char* pText, size_t length)
+{
+    if (Content.length() == length && Content.compare(0, length, pText, length) == 0)
+    {
+        return;
+    }
 
-        texCoord.push_back(metrics.End.x / m_width);
-        texCoord.push_back(metrics.Start.y / m_height);
+    // Assigning keeps the capacity of the string
+    Content.assign(pText, length);
+    Regenerate = true;
+}
 
+void Text::Slot::setNumber(double value, int decimals)
+{
+    // Formatted on the stack, the content only allocates if it grows past its capacity
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%.*f", glm::clamp(decimals, 0, 9), value);
+    if (length < 0)
+    {
+        return;
+    }
 
-        vertices.push_back(xpos + w);
-        vertices.push_back(ypos);
-        vertices.push_back(1.0f);
+    setContent(buffer, std::min<size_t>((size_t)length, sizeof(buffer) - 1));
+}
 
-        texCoord.push_back(metrics.End.x / m_width);
-        texCoord.push_back(metrics.End.y / m_height);
+unsigned int Text::decodeUTF8(const std::string& text, size_t& index)
+{
+    unsigned char lead = (unsigned char)text[index++];
 
-        x += metrics.Advance * scale;
+    // Length of the sequence from the lead byte
+    unsigned int codepoint = lead;
+    size_t continuation = 0;
+    if (lead >= 0xF0)
+    {
+        codepoint = lead & 0x07;
+        continuation = 3;
+    }
+    else if (lead >= 0xE0)
+    {
+        codepoint = lead & 0x0F;
+        continuation = 2;
+    }
+    else if (lead >= 0xC0)
+    {
+        codepoint = lead & 0x1F;
+        continuation = 1;
+    }
+    else if (lead >= 0x80)
+    {
+        // Stray continuation byte
+        return 0xFFFD;
     }
 
-    // Update VAO or create and update if needed
-    if (slot.pVAO == nullptr)
+    for (size_t i = 0; i < continuation; i++)
     {
-        slot.pVAO = new VAO();
+        if (index >= text.length() || ((unsigned char)text[index] & 0xC0) != 0x80)
+        {
+            return 0xFFFD;
+        }
+
+        codepoint = (codepoint << 6) | ((unsigned char)text[index++] & 0x3F);
     }
 
-    slot.pVAO->bind();
-    slot.pVAO->createVerticesBuffer(vertices, true);
-    slot.pVAO->createUVBuffer(texCoord, true);
+    return codepoint;
 }
@@ -4,13 +4,19 @@
 class VAO;
 class Shader;
 class Texture;
+class TextureAtlas;
 class Audio;
 class Text;
-class UniformBuffer;
+class UniformArena;
 struct AderScene;
+struct Visual;
 struct GameObject;
 struct AudioListener;
-struct CharMetric;
+class ParticleEmitter;
+class ImageFileContents;
+struct CompressedImageContents;
+struct VertexAttribute;
+struct VertexLayout;
 
 // GLM
 #include <glm/glm.hpp>
@@ -40,6 +46,42 @@ struct CharMetric;
 // Audio listener
 #include "GameCore/AudioListener.h"
 
+// Render thread and command recording
+#include "OpenGLModules/RenderThread.h"
+
+// GL state cache
+#include "OpenGLModules/GLState.h"
+
+// Program binary cache
+#include "OpenGLModules/ShaderCache.h"
+
+// Asynchronous texture loading
+#include "OpenGLModules/TextureStreamer.h"
+
+// Recording backend for headless runs
+#include "OpenGLModules/NullBackend.h"
+
+// GPU pass timings
+#include "OpenGLModules/GPUProfiler.h"
+
+// Compute culling and indirect draws
+#include "OpenGLModules/GPUCuller.h"
+
+// Instanced glyph drawing
+#include "OpenGLModules/TextRenderer.h"
+
+// Glyphs rasterized on demand
+#include "OpenGLModules/GlyphCache.h"
+
+// Scene rendered at a scaled resolution
+#include "OpenGLModules/ResolutionScaler.h"
+
+// Batched 2D sprites
+#include "OpenGLModules/SpriteRenderer.h"
+
+// Frames written to a file for the replay tool
+#include "OpenGLModules/GLCapture.h"
+
 
 /**
  * Rendering settings containing, FoV, near and far plane
@@ -54,6 +96,30 @@ struct RenderSettings
 
     /// Far rendering plane
     float FarPlane = 100.0f;
+
+    /// If true OpenGL commands are executed on a dedicated render thread
+    bool UseRenderThread = true;
+
+    /// Bytes of streamed textures that are uploaded per frame
+    size_t TextureUploadBudget = 4 * 1024 * 1024;
+
+    /// If true opaque batches are drawn into the depth buffer before they are shaded
+    bool DepthPrePass = false;
+
+    /// If true opaque batches are culled by a compute pass and drawn with indirect
+    /// draws, requires OpenGL 4.3 and falls back to the CPU path without it
+    bool GPUCulling = false;
+
+    /// If true the scene is rendered offscreen at a resolution that holds the
+    /// frame time budget and upscaled, the UI stays at the window resolution
+    bool DynamicResolution = false;
+
+    /// GPU time of a frame in milliseconds dynamic resolution aims for
+    float TargetFrameTime = 16.0f;
+
+    /// Bounds of the dynamic resolution scale per axis
+    float MinResolutionScale = 0.5f;
+    float MaxResolutionScale = 1.0f;
 };
 
 
@@ -65,6 +131,7 @@ struct RenderSettings
  *  - StateBundleCreated
  *  - WndStateUpdated
  *  - WindowCreated
+ *  - HeadlessWindowCreated
  *  - SystemUpdate
  *  - SystemRender
  *  - SceneChanged
@@ -87,11 +154,84 @@ public:
 
     // Toggle wire frame mode
     void toggleWireFrame(bool value);
+
+    // Toggle the depth pre-pass
+    void toggleDepthPrePass(bool value);
+
+    // Toggle culling on the GPU
+    void toggleGPUCulling(bool value);
+
+    // Toggle dynamic resolution scaling
+    void toggleDynamicResolution(bool value);
+
+    /**
+     * Returns the average number of times each pixel was shaded by the scene
+     * passes, measured a few frames late with a samples passed query
+     */
+    float getOverdraw() const;
+
+    /**
+     * Returns the render thread statistics of the last submitted frame
+     */
+    RenderThread::Statistics getRenderStatistics() const;
+
+    /**
+     * Returns the state cache statistics of the last executed frame
+     */
+    GLState::Statistics getStateStatistics() const;
+
+    /**
+     * Returns the shader cache statistics
+     */
+    ShaderCache::Statistics getShaderStatistics() const;
+
+    /**
+     * Returns the texture streaming statistics
+     */
+    TextureStreamer::Statistics getStreamingStatistics() const;
+
+    /**
+     * Returns the statistics of the null backend, only set when running headless
+     */
+    NullBackend::Statistics getBackendStatistics() const;
+
+    /**
+     * Returns the statistics of the GPU pass timer queries
+     */
+    GPUProfiler::Statistics getGPUProfilerStatistics() const;
+
+    /**
+     * Returns the statistics of the GPU culling pass
+     */
+    GPUCuller::Statistics getCullingStatistics() const;
+
+    /**
+     * Returns the statistics of the glyph cache, must be called on the thread
+     * recording render commands
+     */
+    GlyphCache::Statistics getGlyphCacheStatistics() const;
+
+    /**
+     * Returns the statistics of the text renderer, must be called on the thread
+     * recording render commands
+     */
+    TextRenderer::Statistics getTextStatistics() const;
+
+    /**
+     * Returns the statistics of dynamic resolution scaling
+     */
+    ResolutionScaler::Statistics getResolutionStatistics() const;
+
+    /**
+     * Returns the statistics of the sprite renderer, must be called on the
+     * thread recording render commands
+     */
+    SpriteRenderer::Statistics getSpriteStatistics() const;
 private:
     /**
      * Initialize OpenGL context with the provided GLFWWindow
      *
-     * @param pWindow Pointer to GLFWwindow structure
+     * @param pWindow Pointer to GLFWwindow structure, nullptr to use the null backend
      *
      * @return 0 if there were no errors, otherwise error code
      */
@@ -125,6 +265,69 @@ private:
      * Update the context
      */
     void update();
+
+    /**
+     * Groups the visuals of the active scene into draw batches
+     */
+    void buildBatches();
+
+    /**
+     * Uploads the instance data of the opaque batches that can be culled on the
+     * GPU and runs the cull pass, the batches are then drawn with indirect draws
+     *
+     * @param viewProjection Matrix the scene is drawn with
+     */
+    void cullBatches(const glm::mat4& viewProjection);
+
+    /**
+     * Uploads the instance data of the batch and draws it
+     *
+     * @param index Index of the batch in m_batches
+     */
+    void drawBatch(size_t index);
+
+    /**
+     * Uploads the instance data written by the particle simulation and draws
+     * the particles of every emitter in the scene, one draw per emitter
+     */
+    void drawEmitters();
+
+    /**
+     * Returns the texture array that contains the texture, the texture is added
+     * to an array with the same size and format if it isn't in one yet
+     */
+    Texture* getTextureArray(Texture* pTexture);
+private:
+    /**
+     * Visuals that are rendered with a single instanced draw, visuals are merged when
+     * they only differ in the layer of their slot 0 texture
+     */
+    struct Batch
+    {
+        /// Visuals of the batch, the first one provides the VAO, shader and textures
+        std::vector<Visual*> Visuals;
+
+        /// Texture array bound to slot 0 or nullptr if the visual isn't using arrays
+        Texture* pArray = nullptr;
+
+        /// Instances of the batch
+        size_t InstanceCount = 0;
+
+        /// Offset of the texture detail block
+        size_t TexDetail = 0;
+
+        /// True if the batch has a single transparent visual
+        bool Transparent = false;
+
+        /// View depth of the batch, the nearest object if opaque and the farthest if transparent
+        float Depth = 0.0f;
+
+        /// True if the batch was culled on the GPU and is drawn from the draw command
+        bool Culled = false;
+
+        /// Draw command of a culled batch
+        size_t Command = 0;
+    };
 private:
     /// Pointer to the window that the context is rendering to
     GLFWwindow* m_pRenderTarget;
@@ -136,7 +339,7 @@ private:
     ALCdevice* m_pAudioDevice;
 
     /// Window state received from the InputInterface
-    const WindowState* m_pWndState;
+    const WindowState* m_pWndState = nullptr;
 
     /// Reference to the current active scene
     Memory::reference<AderScene> m_activeScene;
@@ -150,14 +353,87 @@ private:
     /// Current rendering settings of the engine
     RenderSettings m_settings;
 
-    /// Matrices uniform buffer
-    UniformBuffer* m_pubMatrices = nullptr;
+    /// Uniform blocks of the frame
+    UniformArena* m_pUniforms = nullptr;
+
+    /// Draw batches of the current frame, only the first m_batchCount are used
+    std::vector<Batch> m_batches;
+    size_t m_batchCount = 0;
+
+    /// Instance data of merged batches
+    std::vector<glm::mat4> m_batchTransforms;
+    std::vector<glm::vec4> m_batchRows;
+    std::vector<glm::vec2> m_batchOffsets;
+    std::vector<float> m_batchLayers;
+    std::vector<glm::vec4> m_batchRects;
+
+    /// Atlas dimensions of each particle emitter in the uniform arena
+    std::vector<size_t> m_emitterDetails;
+
+    /// Opaque batches in front to back order
+    std::vector<size_t> m_opaqueOrder;
+
+    /// Transparent batches in back to front order
+    std::vector<size_t> m_transparentOrder;
+
+    /// Objects tested by the cull pass, and the VAO and first instance of each culled batch
+    std::vector<GPUCuller::Object> m_cullObjects;
+    std::vector<VAO*> m_cullVAOs;
+    std::vector<unsigned int> m_cullBases;
+
+    /// Draw commands of the culled batches, only accessed from the render thread
+    std::vector<GPUCuller::DrawCommand> m_cullCommands;
+
+    /// Batch whose instance data was last uploaded to each VAO this frame
+    std::unordered_map<VAO*, size_t> m_instanceOwners;
+
+    /// Texture arrays that group same size and format textures
+    std::vector<Texture*> m_textureArrays;
+
+    /// Texture arrays that received new layers this frame
+    std::vector<Texture*> m_dirtyArrays;
 
-    /// Texture detail uniform buffer
-    UniformBuffer* m_pubTextureDetail = nullptr;
+    /// Most layers a texture array can have, queried once the context exists
+    unsigned int m_maxArrayLayers = 2048;
 
     /// Current audio listener
     AudioListener* m_pAudioListener = nullptr;
+
+    /// State cache used by the OpenGL wrappers, must outlive the render thread
+    GLState m_glState;
+
+    /// Program binary cache, must outlive the render thread
+    ShaderCache m_shaderCache;
+
+    /// Texture streamer, must outlive the render thread
+    TextureStreamer m_textureStreamer;
+
+    /// Recording backend used without a window, must outlive the render thread
+    NullBackend m_nullBackend;
+
+    /// GPU pass timer queries, must outlive the render thread
+    GPUProfiler m_gpuProfiler;
+
+    /// Compute culling, must outlive the render thread
+    GPUCuller m_gpuCuller;
+
+    /// Glyph instance renderer, must outlive the render thread
+    TextRenderer m_textRenderer;
+
+    /// Glyph cache shared by all text, must outlive the render thread
+    GlyphCache m_glyphCache;
+
+    /// Offscreen scene target and its scale, must outlive the render thread
+    ResolutionScaler m_resolutionScaler;
+
+    /// Sprite batcher, must outlive the render thread
+    SpriteRenderer m_spriteRenderer;
+
+    /// Capture of frames for the replay tool, must outlive the render thread
+    GLCapture m_glCapture;
+
+    /// Render thread executing the recorded OpenGL commands
+    RenderThread m_renderThread;
 };
 
 
@@ -172,6 +448,7 @@ private:
     {
         al_Vertices = 0,
         al_TexCoord = 1,
+        al_Normal = 2,
 
         // For storing transformation matrices during instance rendering
         al_Instance0 = 3,
@@ -181,6 +458,20 @@ private:
 
         // For storing the texture index in an atlas
         al_TexOffset = 7,
+
+        // For storing the texture array layer
+        al_TexLayer = 8,
+
+        // For storing affine transformation rows during compact instance rendering
+        al_InstanceRow0 = 9,
+        al_InstanceRow1 = 10,
+        al_InstanceRow2 = 11,
+
+        // For storing the texture rectangle of a packed atlas
+        al_TexRect = 12,
+
+        // For storing the color instances are multiplied with
+        al_Color = 13,
     };
 
     struct VBO
@@ -215,6 +506,23 @@ public:
      */
     void renderInstance(unsigned int count);
 
+    /**
+     * Render the instances written by the GPU cull pass, the instance count is
+     * read from the draw command so the CPU never waits for the pass
+     *
+     * @param command Index of the draw command in the command buffer
+     */
+    void renderCulled(size_t command);
+
+    /**
+     * Fills the draw command that renders this VAO from the culled instances,
+     * must be called from the thread executing render commands
+     *
+     * @param command Command to fill, the instance count is set to 0
+     * @param baseInstance First instance of the batch in the culled instances
+     */
+    void getCulledCommand(GPUCuller::DrawCommand& command, unsigned int baseInstance) const;
+
     /**
      * Create indices array for this array with the specified indices buffer
      *
@@ -242,6 +550,20 @@ public:
      */
     void createUVBuffer(std::vector<float>& texCoords, bool dynamic);
 
+    /**
+     * Create a single vertex buffer holding interleaved attributes, the attributes
+     * are set up from the layout and replace the vertices and texture coordinates
+     * set through the buffers above
+     *
+     * @param layout Layout of a vertex, locations must be below the instance attributes
+     *               and every attribute must be inside the stride
+     * @param pData Vertex data, vertexCount * layout.Stride bytes
+     * @param vertexCount Number of vertices in the data
+     * @param dynamic Boolean specifying if the vertices buffer will be changed
+     *                during runtime
+     */
+    void createInterleavedBuffer(const VertexLayout& layout, const void* pData, size_t vertexCount, bool dynamic);
+
     /**
      * Create transformation matrix instance buffer from the specified data
      *
@@ -251,6 +573,16 @@ public:
      */
     void createInstanceBuffer(std::vector<glm::mat4>& transforms, bool dynamic);
 
+    /**
+     * Create compact transformation instance buffer from the specified data, each
+     * instance uses 3 consecutive rows of the affine transformation matrix
+     *
+     * @param rows Vector containing 3 transformation rows per instance
+     * @param dynamic Boolean specifying if the vertices buffer will be changed
+     *                during runtime
+     */
+    void createCompactInstanceBuffer(std::vector<glm::vec4>& rows, bool dynamic);
+
     /**
      * Create texture offset data buffer from the specified data
      *
@@ -260,6 +592,63 @@ public:
      */
     void createOffsetBuffer(std::vector<glm::vec2>& offsets, bool dynamic);
 
+    /**
+     * Create texture array layer buffer from the specified data
+     *
+     * @param layers Vector containing the layer of each instance
+     * @param dynamic Boolean specifying if the vertices buffer will be changed
+     *                during runtime
+     */
+    void createLayerBuffer(std::vector<float>& layers, bool dynamic);
+
+    /**
+     * Create texture rectangle buffer from the specified data
+     *
+     * @param rects Vector containing the texture offset (xy) and scale (zw)
+     *              of each instance
+     * @param dynamic Boolean specifying if the vertices buffer will be changed
+     *                during runtime
+     */
+    void createTexRectBuffer(std::vector<glm::vec4>& rects, bool dynamic);
+
+    /**
+     * Create instance color buffer from the specified data, the components
+     * are normalized to the range of 0 to 1
+     *
+     * @param colors Vector containing the color of each instance
+     * @param dynamic Boolean specifying if the vertices buffer will be changed
+     *                during runtime
+     */
+    void createColorBuffer(std::vector<glm::u8vec4>& colors, bool dynamic);
+
+    /**
+     * Load the vertices and indices of this VAO from a mesh file. The file is
+     * mapped and its interleaved vertex and index data is uploaded straight
+     * from the mapping, the mapping is released once the upload has executed.
+     * Replaces the vertices and texture coordinates set through the buffers above
+     *
+     * @param path Path to the mesh file
+     *
+     * @return True if the file contains a valid mesh, false otherwise
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Returns the minimum corner of the bounds of the loaded mesh
+     */
+    const glm::vec3& getBoundsMin() const;
+
+    /**
+     * Returns the maximum corner of the bounds of the loaded mesh
+     */
+    const glm::vec3& getBoundsMax() const;
+
+    /**
+     * Returns true if the bounds are known, they are taken from mesh files and
+     * float vertex positions
+     */
+    bool hasBounds() const;
+
     /**
      * Bind this VAO to the current OpenGL state machine.
      */
@@ -278,7 +667,7 @@ private:
      *
      * @return True if buffer attributes need to be setup, false otherwise
      */
-    bool setupBuffer(VBO& buffer, bool dynamic, size_t eSize, size_t eCount, void* pData);
+    bool setupBuffer(VBO& buffer, bool dynamic, size_t eSize, size_t eCount, const void* pData);
 
     /**
      * Deletes the specified buffer
@@ -298,7 +687,7 @@ private:
      * @param eCount Count of elements
      * @param pInitData Data to init the buffer with
      */
-    void allocBuffer(VBO& vbo, size_t eSize, size_t eCount, void* pInitData);
+    void allocBuffer(VBO& vbo, size_t eSize, size_t eCount, const void* pInitData);
 
     /**
      * Change buffer contents with the specified data
@@ -308,7 +697,52 @@ private:
      * @param eCount Count of elements
      * @param pData Data to of the buffer
      */
-    void modifyBuffer(VBO& vbo, size_t eSize, size_t eCount, void* pData);
+    void modifyBuffer(VBO& vbo, size_t eSize, size_t eCount, const void* pData);
+
+    /**
+     * Points the attributes at the bound array buffer
+     *
+     * @param pAttributes Attributes to set up
+     * @param count Number of attributes
+     * @param stride Distance between two vertices in bytes
+     */
+    void setupAttributes(const VertexAttribute* pAttributes, size_t count, unsigned int stride);
+
+    /**
+     * Replaces the separate vertex buffers with the interleaved one and sets up
+     * its attributes, attributes of the previous layout are disabled
+     *
+     * @param pData Vertex data
+     * @param vertexCount Number of vertices in the data
+     * @param dynamic Is the buffer dynamic or not
+     * @param pAttributes Layout of the interleaved vertices
+     * @param count Number of attributes
+     * @param stride Distance between two vertices in bytes
+     */
+    void setupInterleaved(const void* pData, size_t vertexCount, bool dynamic,
+        const VertexAttribute* pAttributes, size_t count, unsigned int stride);
+
+    /**
+     * Forgets that the attributes in the range were pointed at the culled instances
+     *
+     * @return True if any of them was, the attributes then need to be set up again
+     */
+    bool takeCulledLocations(GLuint first, GLuint last);
+
+    /**
+     * Computes the bounds of float vertex positions
+     */
+    void setBounds(const unsigned char* pPositions, size_t stride, size_t count);
+
+    /**
+     * Returns true if every attribute has a location below the instance attributes
+     */
+    static bool checkLocations(const VertexAttribute* pAttributes, size_t count);
+
+    /**
+     * Returns the OpenGL type of a mesh file VertexAttributeType or 0 if it's unknown
+     */
+    static GLenum getAttributeType(unsigned int type);
 private:
     unsigned int m_idArray = 0;
 
@@ -316,9 +750,27 @@ private:
     VBO m_idVertices;
     VBO m_idTexCoords;
     VBO m_idInstance;
+    VBO m_idCompactInstance;
     VBO m_idOffsets;
+    VBO m_idLayers;
+    VBO m_idTexRects;
+    VBO m_idColors;
+
+    /// Interleaved vertices of a loaded mesh
+    VBO m_idInterleaved;
 
     unsigned int m_renderCount = 0;
+
+    /// Type of the indices, loaded meshes may use 16 bit indices
+    GLenum m_indexType = GL_UNSIGNED_INT;
+
+    /// Bounds of the loaded mesh
+    glm::vec3 m_boundsMin = glm::vec3(0.0f);
+    glm::vec3 m_boundsMax = glm::vec3(0.0f);
+    bool m_hasBounds = false;
+
+    /// Bit per instance attribute location that was last pointed at the culled instances
+    unsigned int m_culledLocations = 0;
 };
 
 
@@ -327,6 +779,33 @@ private:
  */
 class Shader : public Asset
 {
+public:
+    /**
+     * Features of a shader variant, each feature defines the preprocessor
+     * symbol with the same name (without the prefix) in both sources
+     */
+    enum Features
+    {
+        sf_None = 0,
+
+        /// Transforms are read from the instance buffer
+        sf_Instanced = 1 << 0,
+
+        /// Texture coordinates are offset into an atlas
+        sf_Atlas = 1 << 1,
+
+        /// Instance transforms are 3 affine rows instead of a full matrix
+        sf_CompactInstance = 1 << 2,
+
+        /// Textures are sampled from a texture array
+        sf_TextureArray = 1 << 3,
+
+        /// Texture coordinates are offset and scaled by a per instance rectangle
+        sf_AtlasRect = 1 << 4,
+
+        /// Textures are multiplied by a per instance color
+        sf_InstanceColor = 1 << 5,
+    };
 public:
     /// Source(path to the file) of the vertex shader
     std::string VertexSource;
@@ -342,21 +821,54 @@ public:
 
     /**
      * Bind this shader to the current OpenGL state machine.
+     *
+     * @param features Features of the variant to bind, ignored if the shader has no variants
      */
-    void bind();
+    void bind(unsigned int features = sf_None);
 
     /**
      * Load the shader with the specified paths
      */
     void load();
+
+    /**
+     * Returns true if the shader samples texture arrays, textures in slot 0
+     * of visuals using this shader are grouped into arrays
+     */
+    bool usesTextureArrays() const;
+
+    /**
+     * Returns true if one of the sources contains "#pragma variants", the
+     * renderer then binds the variant matching the visual
+     */
+    bool hasVariants() const;
+
+    /**
+     * Adds a define for each feature after the #version directive
+     */
+    static std::string addDefines(const std::string& source, unsigned int features);
 private:
-    // Deletes the shader
-    void deleteShader();
+    // Returns the program of the variant, the variant is created if it doesn't exist yet
+    ShaderCache::Program* getVariant(unsigned int features);
 
-    // Loads the shader
-    void loadShader();
+    // Reads the file and expands #include directives relative to it
+    static std::string expandIncludes(const std::string& path, int depth);
 private:
-    unsigned int m_idShader = 0;
+    /// Expanded sources, only accessed from the render thread
+    std::string m_vertexCode;
+    std::string m_fragmentCode;
+
+    /// Variants of the current sources, each holds a reference to it's program in the shader cache
+    std::unordered_map<unsigned int, ShaderCache::Program*> m_variants;
+
+    /// Variants of the previous sources, used and referenced until the new variant is ready
+    std::unordered_map<unsigned int, ShaderCache::Program*> m_previous;
+
+    /// True if the fragment shader declares a sampler2DArray
+    bool m_textureArrays = false;
+
+    /// True if the sources contain "#pragma variants"
+    bool m_variantsEnabled = false;
 };
 
 
@@ -392,14 +904,209 @@ public:
      * Loads the texture from memory
      */
     void load(unsigned int width, unsigned int height, unsigned int BPP, std::vector<unsigned char>& data);
+
+    /**
+     * Starts streaming the texture from the source without blocking, a
+     * placeholder is bound until the first mip level has been uploaded
+     */
+    void loadAsync();
+
+    /**
+     * Returns true if the texture has been completely loaded
+     */
+    bool isLoaded() const;
+
+    /**
+     * Adds a texture to the first empty layer of this array or as the next
+     * layer, the texture must have the same size and format as the other
+     * layers. Array storage is recreated on the next loadArray call.
+     *
+     * @return Layer of the texture
+     */
+    unsigned int addLayer(Texture* pTexture);
+
+    /**
+     * Returns true if a layer can be added without exceeding the specified
+     * amount of layers
+     */
+    bool hasFreeLayer(unsigned int maxLayers) const;
+
+    /**
+     * Creates the texture array storage and copies all layers into it
+     */
+    void loadArray();
+
+    /**
+     * Returns true if the texture has the same size and format as this one
+     */
+    bool isCompatible(const Texture* pTexture) const;
+
+    /**
+     * Returns the array this texture is a layer of or nullptr
+     */
+    Texture* getArray() const;
+
+    /**
+     * Returns the layer of this texture in it's array
+     */
+    unsigned int getLayer() const;
+
+    /**
+     * Returns the textures that are layers of this array
+     */
+    const std::vector<Texture*>& getLayers() const;
+
+    /**
+     * Returns the video memory used by all mip levels of the texture in bytes
+     */
+    size_t getMemorySize() const;
+
+    /**
+     * Queries the block compressed formats the driver can sample, must be
+     * called on the thread that owns the context
+     */
+    static void querySupport();
 private:
     // Deletes the texture
     void deleteTexture();
 
-    // Loads the texture
-    void loadTexture();
+    // Uploads the decoded image to a new texture
+    void loadTexture(const Memory::reference<ImageFileContents>& image);
+
+    // Loads a block compressed texture from a DDS or KTX2 file
+    void loadCompressed();
+
+    // Sets the size and format of the loaded texture and reports it's memory usage
+    void setFormat(unsigned int width, unsigned int height, unsigned int BPP, GLenum internalFormat, unsigned int levels, size_t memorySize);
+
+    // Returns the amount of levels in a full mip chain
+    static unsigned int getLevelCount(unsigned int width, unsigned int height);
+
+    // Returns the size of an uncompressed full mip chain
+    static size_t getUncompressedSize(unsigned int width, unsigned int height, unsigned int BPP);
+
+    // Returns the size of all mip levels of the texture from it's size and format
+    size_t getLevelsSize() const;
+
+    // Removes this texture from it's array or the layers from this array
+    void detach();
+
+    // Streamed textures are created and uploaded by the texture streamer
+    friend class TextureStreamer;
+
+    // The glyph cache creates and updates it's page array directly
+    friend class GlyphCache;
 private:
     unsigned int m_idTexture = 0;
+
+    /// True once at least one mip level can be sampled, render thread only
+    bool m_hasLevels = false;
+
+    /// True once the texture has been completely loaded
+    bool m_loaded = false;
+
+    /// GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+    GLenum m_target = GL_TEXTURE_2D;
+
+    /// Size and bytes per pixel, known once the texture has been loaded
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    unsigned int m_BPP = 0;
+
+    /// Internal format and mip levels of the texture
+    GLenum m_internalFormat = 0;
+    unsigned int m_levels = 0;
+
+    /// Video memory used by the texture
+    size_t m_memorySize = 0;
+
+    /// Array this texture is a layer of
+    Texture* m_pArray = nullptr;
+
+    /// Layer in the array
+    unsigned int m_layer = 0;
+
+    /// Textures that are layers of this array
+    std::vector<Texture*> m_layers;
+
+    /// True if the driver can sample BC1 and BC3 (S3TC) or BC7 (BPTC) textures,
+    /// unsupported formats are decoded and uploaded uncompressed
+    static bool ms_s3tcSupported;
+    static bool ms_bptcSupported;
+};
+
+
+/**
+ * Texture atlas packs many small images into a few large textures (pages) so
+ * that sprites from separate files can share a texture bind and a batch. Each
+ * image is surrounded by padding filled with its edge pixels, so filtering
+ * doesn't bleed the neighbouring images in.
+ */
+class TextureAtlas : public Asset
+{
+public:
+    /**
+     * Location of a packed image
+     */
+    struct Region
+    {
+        /// Page the image was packed into
+        size_t Page = 0;
+
+        /// Texture coordinate offset in xy and scale in zw
+        glm::vec4 Rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        /// Size of the image in pixels
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+    };
+public:
+    TextureAtlas();
+
+    ~TextureAtlas();
+
+    /**
+     * Adds an image file that is packed on the next build
+     */
+    void addSource(const std::string& source);
+
+    /**
+     * Packs all added images into pages, existing pages are replaced
+     *
+     * @param maxSize Maximum width and height of a page
+     * @param padding Pixels around each image, each level of mip mapping
+     *                halves the padding that is left
+     *
+     * @return Amount of packed images
+     */
+    size_t build(unsigned int maxSize, unsigned int padding);
+
+    /**
+     * Returns the region of the image or nullptr if it wasn't packed
+     */
+    const Region* getRegion(const std::string& source) const;
+
+    /**
+     * Returns the amount of pages
+     */
+    size_t getPageCount() const;
+
+    /**
+     * Returns the page texture at the specified index or nullptr
+     */
+    Texture* getPage(size_t index) const;
+private:
+    // Deletes the page textures
+    void deletePages();
+private:
+    /// Image files that are packed
+    std::vector<std::string> m_sources;
+
+    /// Regions of the packed images
+    std::unordered_map<std::string, Region> m_regions;
+
+    /// Page textures, owned by the atlas
+    std::vector<Texture*> m_pages;
 };
 
 
@@ -538,6 +1245,28 @@ public:
     /// Source(path to the file) of the font file
     std::string FontSource;
 
+    /// Size of the font in points at 96 DPI
+    unsigned int Size = 32;
+
+    /// If true the glyphs are signed distance fields that are scaled to the size,
+    /// must be drawn with a distance field shader (res/fragment_text_sdf.txt)
+    bool DistanceField = false;
+
+    /**
+     * Laid out character of a slot
+     */
+    struct Character
+    {
+        /// Decoded codepoint
+        unsigned int Codepoint = 0;
+
+        /// Pen position before the character, relative to the slot position
+        glm::vec2 Pen = glm::vec2(0.0f);
+
+        /// Glyph instances before the character
+        unsigned int Glyph = 0;
+    };
+
     /**
      * Slot structure is used to specify a single
      * text area with it's own content and position
@@ -550,14 +1279,45 @@ public:
         /// Position of this text area
         glm::vec2 Position;
 
+        /// Color of the text
+        glm::vec4 Color = glm::vec4(1.0f);
+
         /// If false then the Slot will not regenerate and will not be rendered
         bool Visible = true;
 
-        /// Vertex array generated for this slot
-        VAO* pVAO = nullptr;
+        /// Characters of the last layout followed by one holding the end pen
+        std::vector<Character> Layout;
+
+        /// Glyph instances of the last layout, relative to the slot position
+        std::vector<TextRenderer::Glyph> Glyphs;
 
-        /// If true then this slot VAO will be generated anew
+        /// Range of the text renderer instance buffer holding the glyphs
+        TextRenderer::Range Range;
+
+        /// Bit mask of the glyph cache pages used by the glyphs
+        unsigned int Pages = 0;
+
+        /// If true then this slot glyphs will be generated anew, only glyphs
+        /// that changed are written to the text renderer
         bool Regenerate = false;
+
+        /// Position the offset of the range was written with, moving the slot
+        /// only writes the offset and keeps the glyphs
+        glm::vec2 Offset = glm::vec2(0.0f);
+
+        /**
+         * Sets the content, the slot is only regenerated if it differs
+         */
+        void setContent(const char* pText, size_t length);
+
+        /**
+         * Sets the content to a number without allocating, meant for labels
+         * that change every frame
+         *
+         * @param value Number to show
+         * @param decimals Digits after the decimal point, clamped to [0, 9]
+         */
+        void setNumber(double value, int decimals = 0);
     };    
 
     /**
@@ -568,12 +1328,14 @@ public:
     ~Text();
 
     /**
-     * Renders the text to the screen
+     * Submits the glyphs of the visible slots to the text renderer, they are
+     * drawn together with the other text using the same font when it's flushed
      */
     void render();
 
     /**
-     * Loads the text from the specified sources
+     * Opens the font source at the current size or as a distance field, glyphs
+     * are rasterized by the glyph cache when they are first used
      */
     void load();
 
@@ -588,21 +1350,40 @@ public:
      */
     Slot& getSlot(const std::string& name);
 private:
+    /**
+     * Lays out the content of a slot starting at the first character that
+     * changed and writes the glyphs that differ from the previous layout,
+     * clearing the layout lays out the whole slot
+     */
     void updateSlot(Slot& slot);
+
+    // Decodes the UTF-8 sequence at the index and moves the index past it,
+    // invalid sequences decode to U+FFFD
+    static unsigned int decodeUTF8(const std::string& text, size_t& index);
 private:
-    Texture* m_pTexture = nullptr;
     Shader* m_pShader = nullptr;
     std::unordered_map<std::string, Slot> m_slots;
-    std::unordered_map<char, CharMetric> m_metrics;
-    unsigned int m_width;
-    unsigned int m_height;
+
+    /// Glyph cache font of the source and size
+    int m_font = -1;
+
+    /// Glyph cache generation the slots were laid out with
+    unsigned int m_generation = 0;
+
+    /// Scratch buffers of updateSlot, reused so layouts don't allocate
+    std::vector<unsigned int> m_codepoints;
+    std::vector<TextRenderer::Glyph> m_glyphs;
 };
 
 
 /**
- * Uniform buffer is used to provide uniform data to shaders
+ * Uniform arena holds all uniform blocks of a frame. Blocks are written into a
+ * CPU staging area, uploaded once per frame into a ring of buffer regions and
+ * bound with glBindBufferRange at their offsets. When persistent mapping is
+ * supported the ring is mapped once and written directly, fences make sure a
+ * region isn't overwritten while the GPU is still reading it.
  */
-class UniformBuffer
+class UniformArena
 {
 public:
     enum BoundPoints
@@ -612,46 +1393,87 @@ public:
     };
 public:
     /**
-     * Creates empty uniform buffer
+     * Creates the ring buffer, must be called after the context is created
      */
-    UniformBuffer();
+    UniformArena();
+
+    ~UniformArena();
 
     /**
-     * Creates empty uniform buffer for the specified bound point
+     * Starts writing the blocks of a new frame
      */
-    UniformBuffer(BoundPoints bp);
+    void beginFrame();
 
     /**
-     * Binds this uniform buffer object, must be called before editing it's data
+     * Writes a uniform block into the frame, the data must be the size
+     * of the bound point
+     *
+     * @return Offset of the block that is used for binding it
      */
-    void bind();
+    size_t write(BoundPoints bp, const void* pData);
 
     /**
-     * Allocates memory for the uniform buffer with the size of the 
-     * bounding point
+     * Uploads all blocks written this frame, must be called after all blocks
+     * have been written and before any of them is bound
      */
-    void allocBP(BoundPoints bp);
+    void upload();
 
     /**
-     * Sets the sub data of the buffer from the offset to the specified value
+     * Binds a block written this frame to it's bound point
      */
-    void setSubData(const size_t& offset, const size_t& size, void* pValue);
+    void bind(BoundPoints bp, size_t offset);
 
     /**
-     * Copies the specified data into the uniform buffer, this is the same as
-     * calling setSubData with offset 0, size being the size of the entire data
-     * structure and value being our data
+     * Ends the frame, the frame region will be reused once the GPU is done with it
      */
-    void mapData(void* pData);
+    void endFrame();
 
     /**
      * Returns the size in bytes of a buffer bound point
      */
     static size_t getBPSize(BoundPoints bp);
 private:
-    /// ID of the uniform buffer
-    unsigned int m_idUBO = 0;
+    /**
+     * Creates the ring buffer with the specified region size, must be called
+     * from the thread executing commands
+     */
+    void createBuffer(size_t regionSize);
+
+    /**
+     * Waits for the GPU to finish with all regions and deletes the ring buffer,
+     * must be called from the thread executing commands
+     */
+    void deleteBuffer();
+
+    /**
+     * Waits until the GPU has finished reading the specified region
+     */
+    void waitRegion(unsigned int region);
+private:
+    /// Number of frames that can be in flight
+    static constexpr unsigned int ms_regionCount = 3;
+
+    /// Initial size of a single region
+    static constexpr size_t ms_initialRegionSize = 64 * 1024;
+
+    /// Staging memory of the frame that is being written
+    std::vector<unsigned char> m_staging;
+
+    /// Required offset alignment of the uniform buffer ranges
+    size_t m_alignment = 256;
+
+    /// Size of a single region in the ring
+    size_t m_regionSize = 0;
+
+    /// Frame counter, frame n uses region n % ms_regionCount
+    size_t m_frame = 0;
+
+    /// ID of the ring buffer
+    unsigned int m_idBuffer = 0;
+
+    /// Persistently mapped ring or nullptr if persistent mapping is not supported
+    unsigned char* m_pMapped = nullptr;
 
-    /// Size allocated for this buffer
-    size_t m_size = 0;
+    /// Fences of the frames that use the regions
+    GLsync m_fences[ms_regionCount] = {};
 };
@@ -0,0 +1,404 @@
+#include "GLState.h"
+
+// Assert
+#include "Defs.h"
+
+GLState* GLState::ms_pInstance = nullptr;
+
+GLState::GLState()
+{
+    ms_pInstance = this;
+}
+
+GLState::~GLState()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void GLState::reset()
+{
+    GLState& s = *ms_pInstance;
+
+    s.m_program = 0;
+    s.m_vertexArray = 0;
+    s.m_activeUnit = 0;
+    s.m_blendSrc = GL_ONE;
+    s.m_blendDst = GL_ZERO;
+    s.m_polygonMode = GL_FILL;
+    s.m_depthFunc = GL_LESS;
+    s.m_depthMask = true;
+    s.m_colorMask = true;
+
+    for (GLuint& buffer : s.m_buffers)
+    {
+        buffer = 0;
+    }
+
+    for (auto& ranges : s.m_ranges)
+    {
+        for (BufferRange& range : ranges)
+        {
+            range = BufferRange();
+        }
+    }
+
+    for (TextureBinding& texture : s.m_textures)
+    {
+        texture = TextureBinding();
+    }
+
+    for (bool& capability : s.m_capabilities)
+    {
+        capability = false;
+    }
+}
+
+void GLState::useProgram(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_program != id))
+    {
+        glUseProgram(id);
+        s.m_program = id;
+    }
+}
+
+void GLState::bindVertexArray(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_vertexArray != id))
+    {
+        glBindVertexArray(id);
+        s.m_vertexArray = id;
+
+        // Element array binding is part of the vertex array state
+        s.m_buffers[targetIndex(GL_ELEMENT_ARRAY_BUFFER)] = ms_unknown;
+    }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint id)
+{
+    GLState& s = *ms_pInstance;
+    int index = targetIndex(target);
+
+    // Untracked target
+    if (index < 0)
+    {
+        s.change(true);
+        glBindBuffer(target, id);
+        return;
+    }
+
+    if (s.change(s.m_buffers[index] != id))
+    {
+        glBindBuffer(target, id);
+        s.m_buffers[index] = id;
+    }
+}
+
+void GLState::bindBufferRange(GLenum target, GLuint index, GLuint id, GLintptr offset, GLsizeiptr size)
+{
+    GLState& s = *ms_pInstance;
+    int rangeSet = target == GL_UNIFORM_BUFFER ? 0 : target == GL_SHADER_STORAGE_BUFFER ? 1 : -1;
+
+    // Untracked target or index
+    if (rangeSet < 0 || index >= ms_indexCount)
+    {
+        s.change(true);
+        glBindBufferRange(target, index, id, offset, size);
+
+        int generic = targetIndex(target);
+        if (generic >= 0)
+        {
+            s.m_buffers[generic] = id;
+        }
+        return;
+    }
+
+    BufferRange& range = s.m_ranges[rangeSet][index];
+    if (s.change(range.ID != id || range.Offset != offset || range.Size != size))
+    {
+        glBindBufferRange(target, index, id, offset, size);
+        range.ID = id;
+        range.Offset = offset;
+        range.Size = size;
+
+        // Indexed binding also changes the generic binding
+        s.m_buffers[targetIndex(target)] = id;
+    }
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, GLuint id)
+{
+    GLState& s = *ms_pInstance;
+    ADER_ASSERT(unit < ms_unitCount, "Texture unit is not tracked by the state cache");
+
+    TextureBinding& binding = s.m_textures[unit];
+    if (!s.change(binding.ID != id || binding.Target != target))
+    {
+        return;
+    }
+
+    // Select the unit
+    if (s.change(s.m_activeUnit != unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        s.m_activeUnit = unit;
+    }
+
+    glBindTexture(target, id);
+    binding.Target = target;
+    binding.ID = id;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+    GLState& s = *ms_pInstance;
+    int index = capabilityIndex(capability);
+
+    if (index >= 0 && !s.change(s.m_capabilities[index] != enabled))
+    {
+        return;
+    }
+
+    if (index < 0)
+    {
+        s.change(true);
+    }
+
+    if (enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+
+    if (index >= 0)
+    {
+        s.m_capabilities[index] = enabled;
+    }
+}
+
+void GLState::setBlendFunc(GLenum src, GLenum dst)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_blendSrc != src || s.m_blendDst != dst))
+    {
+        glBlendFunc(src, dst);
+        s.m_blendSrc = src;
+        s.m_blendDst = dst;
+    }
+}
+
+void GLState::setPolygonMode(GLenum mode)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_polygonMode != mode))
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+        s.m_polygonMode = mode;
+    }
+}
+
+void GLState::setDepthFunc(GLenum func)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_depthFunc != func))
+    {
+        glDepthFunc(func);
+        s.m_depthFunc = func;
+    }
+}
+
+void GLState::setDepthMask(bool enabled)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_depthMask != enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        s.m_depthMask = enabled;
+    }
+}
+
+void GLState::setColorMask(bool enabled)
+{
+    GLState& s = *ms_pInstance;
+
+    if (s.change(s.m_colorMask != enabled))
+    {
+        GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+        s.m_colorMask = enabled;
+    }
+}
+
+void GLState::deleteProgram(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    // A deleted program stays in use until another one is bound, so unbind it first
+    // to make sure a program created later with the same id isn't skipped
+    if (id != 0 && s.m_program == id)
+    {
+        glUseProgram(0);
+        s.m_program = 0;
+    }
+
+    glDeleteProgram(id);
+}
+
+void GLState::deleteVertexArray(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    glDeleteVertexArrays(1, &id);
+
+    // Deleting a bound vertex array reverts the binding to 0
+    if (id != 0 && s.m_vertexArray == id)
+    {
+        s.m_vertexArray = 0;
+        s.m_buffers[targetIndex(GL_ELEMENT_ARRAY_BUFFER)] = ms_unknown;
+    }
+}
+
+void GLState::deleteBuffer(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    glDeleteBuffers(1, &id);
+
+    if (id == 0)
+    {
+        return;
+    }
+
+    // Deleting a bound buffer reverts the bindings to 0
+    for (GLuint& buffer : s.m_buffers)
+    {
+        if (buffer == id)
+        {
+            buffer = 0;
+        }
+    }
+
+    for (auto& ranges : s.m_ranges)
+    {
+        for (BufferRange& range : ranges)
+        {
+            if (range.ID == id)
+            {
+                range = BufferRange();
+            }
+        }
+    }
+}
+
+void GLState::deleteTexture(GLuint id)
+{
+    GLState& s = *ms_pInstance;
+
+    glDeleteTextures(1, &id);
+
+    if (id == 0)
+    {
+        return;
+    }
+
+    // Deleting a bound texture reverts the bindings to 0
+    for (TextureBinding& texture : s.m_textures)
+    {
+        if (texture.ID == id)
+        {
+            texture.ID = 0;
+        }
+    }
+}
+
+void GLState::endFrame()
+{
+    GLState& s = *ms_pInstance;
+
+    s.m_lastIssued = s.m_issued;
+    s.m_lastAvoided = s.m_avoided;
+    s.m_issued = 0;
+    s.m_avoided = 0;
+}
+
+GLState::Statistics GLState::getStatistics()
+{
+    Statistics stats;
+    stats.Issued = ms_pInstance->m_lastIssued;
+    stats.Avoided = ms_pInstance->m_lastAvoided;
+    return stats;
+}
+
+int GLState::targetIndex(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return 0;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return 1;
+    case GL_UNIFORM_BUFFER:
+        return 2;
+    case GL_SHADER_STORAGE_BUFFER:
+        return 3;
+    case GL_PIXEL_UNPACK_BUFFER:
+        return 4;
+    case GL_PIXEL_PACK_BUFFER:
+        return 5;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return 6;
+    case GL_DISPATCH_INDIRECT_BUFFER:
+        return 7;
+    case GL_COPY_READ_BUFFER:
+        return 8;
+    case GL_COPY_WRITE_BUFFER:
+        return 9;
+    }
+
+    return -1;
+}
+
+int GLState::capabilityIndex(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_BLEND:
+        return 0;
+    case GL_DEPTH_TEST:
+        return 1;
+    case GL_CULL_FACE:
+        return 2;
+    case GL_SCISSOR_TEST:
+        return 3;
+    }
+
+    return -1;
+}
+
+bool GLState::change(bool changed)
+{
+    if (changed)
+    {
+        m_issued++;
+    }
+    else
+    {
+        m_avoided++;
+    }
+
+    return changed;
+}
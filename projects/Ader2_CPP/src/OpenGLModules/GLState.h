@@ -0,0 +1,241 @@
+#pragma once
+
+// Statistics are read from the game thread
+#include <atomic>
+
+// For size_t
+#include <cstddef>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * GL state cache tracks the bindings and fixed function state of the context
+ * and skips calls that would not change it. All GL wrappers go through it,
+ * which means the cache is only valid as long as nothing else changes the
+ * tracked state directly.
+ *
+ * The cache is only accessed from the thread executing render commands.
+ */
+class GLState
+{
+public:
+    /**
+     * Statistics of the state cache
+     */
+    struct Statistics
+    {
+        /// State changes issued to the driver in the last frame
+        size_t Issued = 0;
+
+        /// Redundant state changes skipped in the last frame
+        size_t Avoided = 0;
+    };
+public:
+    GLState();
+
+    ~GLState();
+
+    /**
+     * Resets the cache to the default OpenGL state, must be called when
+     * the context is created
+     */
+    static void reset();
+
+    /**
+     * Binds the specified program
+     */
+    static void useProgram(GLuint id);
+
+    /**
+     * Binds the specified vertex array
+     */
+    static void bindVertexArray(GLuint id);
+
+    /**
+     * Binds the buffer to the specified target, element array buffer
+     * bindings are tracked per bound vertex array
+     */
+    static void bindBuffer(GLenum target, GLuint id);
+
+    /**
+     * Binds a range of the buffer to an indexed target, this also changes
+     * the generic binding of the target
+     */
+    static void bindBufferRange(GLenum target, GLuint index, GLuint id, GLintptr offset, GLsizeiptr size);
+
+    /**
+     * Binds the texture to the specified texture unit
+     */
+    static void bindTexture(unsigned int unit, GLenum target, GLuint id);
+
+    /**
+     * Enables or disables the specified capability
+     */
+    static void setEnabled(GLenum capability, bool enabled);
+
+    /**
+     * Sets the blend function
+     */
+    static void setBlendFunc(GLenum src, GLenum dst);
+
+    /**
+     * Sets the polygon mode for front and back faces
+     */
+    static void setPolygonMode(GLenum mode);
+
+    /**
+     * Sets the depth comparison function
+     */
+    static void setDepthFunc(GLenum func);
+
+    /**
+     * Enables or disables writing to the depth buffer
+     */
+    static void setDepthMask(bool enabled);
+
+    /**
+     * Enables or disables writing to all color channels
+     */
+    static void setColorMask(bool enabled);
+
+    /**
+     * Deletes the program and removes it from the cache
+     */
+    static void deleteProgram(GLuint id);
+
+    /**
+     * Deletes the vertex array and removes it from the cache
+     */
+    static void deleteVertexArray(GLuint id);
+
+    /**
+     * Deletes the buffer and removes it from the cache
+     */
+    static void deleteBuffer(GLuint id);
+
+    /**
+     * Deletes the texture and removes it from the cache
+     */
+    static void deleteTexture(GLuint id);
+
+    /**
+     * Ends the current frame and publishes it's statistics
+     */
+    static void endFrame();
+
+    /**
+     * Returns the statistics of the last frame
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Returns the cache slot of the buffer target or -1 if it isn't tracked
+     */
+    static int targetIndex(GLenum target);
+
+    /**
+     * Returns the cache slot of the capability or -1 if it isn't tracked
+     */
+    static int capabilityIndex(GLenum capability);
+
+    /**
+     * Counts a state change, returns true if the change has to be issued
+     */
+    bool change(bool changed);
+private:
+    /// Value used for bindings whose state is unknown
+    static constexpr GLuint ms_unknown = ~0u;
+
+    /// Number of tracked buffer targets
+    static constexpr size_t ms_targetCount = 10;
+
+    /// Number of tracked indexed buffer bindings per target
+    static constexpr size_t ms_indexCount = 16;
+
+    /// Number of tracked texture units
+    static constexpr size_t ms_unitCount = 32;
+
+    /// Number of tracked capabilities
+    static constexpr size_t ms_capabilityCount = 4;
+
+    /**
+     * Range bound to an indexed buffer target
+     */
+    struct BufferRange
+    {
+        /// Bound buffer
+        GLuint ID = 0;
+
+        /// Offset of the range
+        GLintptr Offset = 0;
+
+        /// Size of the range
+        GLsizeiptr Size = 0;
+    };
+
+    /**
+     * Texture bound to a texture unit
+     */
+    struct TextureBinding
+    {
+        /// Target of the texture
+        GLenum Target = GL_TEXTURE_2D;
+
+        /// Bound texture
+        GLuint ID = 0;
+    };
+
+    /// Instance used by the static interface
+    static GLState* ms_pInstance;
+
+    /// Bound program
+    GLuint m_program = 0;
+
+    /// Bound vertex array
+    GLuint m_vertexArray = 0;
+
+    /// Bound buffers per target
+    GLuint m_buffers[ms_targetCount] = {};
+
+    /// Indexed buffer ranges, only uniform and shader storage targets are tracked
+    BufferRange m_ranges[2][ms_indexCount] = {};
+
+    /// Active texture unit
+    unsigned int m_activeUnit = 0;
+
+    /// Bound textures per unit
+    TextureBinding m_textures[ms_unitCount] = {};
+
+    /// Enabled capabilities
+    bool m_capabilities[ms_capabilityCount] = {};
+
+    /// Blend source factor
+    GLenum m_blendSrc = GL_ONE;
+
+    /// Blend destination factor
+    GLenum m_blendDst = GL_ZERO;
+
+    /// Polygon mode
+    GLenum m_polygonMode = GL_FILL;
+
+    /// Depth comparison function
+    GLenum m_depthFunc = GL_LESS;
+
+    /// Depth and color write masks
+    bool m_depthMask = true;
+    bool m_colorMask = true;
+
+    /// State changes issued in the current frame
+    size_t m_issued = 0;
+
+    /// State changes avoided in the current frame
+    size_t m_avoided = 0;
+
+    /// Issued state changes of the last frame
+    std::atomic<size_t> m_lastIssued{ 0 };
+
+    /// Avoided state changes of the last frame
+    std::atomic<size_t> m_lastAvoided{ 0 };
+};
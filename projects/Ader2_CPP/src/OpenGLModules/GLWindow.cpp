@@ -26,7 +26,12 @@ int GLWindow::onMessage(MessageBus::MessageType msg, MessageBus::DataType pData)
 		return setup();
 
 	case Messages::msg_CreateWindow:
-		const CreateWindowParams* params = static_cast<const CreateWindowParams*>(pData);
+		CreateWindowParams* params = static_cast<CreateWindowParams*>(pData);
+		if (params->headless)
+		{
+			return createHeadlessWindow(params);
+		}
+
 		return createWindow(params->width, params->height, params->title);
 	}
 
@@ -59,6 +64,9 @@ int GLWindow::setup()
 	// Core profile
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+	// Depth buffer of the default framebuffer, opaque geometry is depth tested
+	glfwWindowHint(GLFW_DEPTH_BITS, 24);
+
 	return 0;
 }
 
@@ -78,3 +86,13 @@ int GLWindow::createWindow(const unsigned int& width, const unsigned int& height
 
 	return 0;
 }
+
+int GLWindow::createHeadlessWindow(CreateWindowParams* params)
+{
+	LOG_INFO("Running headless at {0}x{1}", params->width, params->height);
+
+	// Post message that the headless window was created
+	this->postMessage(Messages::msg_HeadlessWindowCreated, params);
+
+	return 0;
+}
\ No newline at end of file
@@ -18,6 +18,7 @@
  *
  * Posts:
  *  - WindowCreated, sends GLFWWindow pointer
+ *  - HeadlessWindowCreated, sends CreateWindowParams pointer
  */
 class GLWindow : public Module
 {
@@ -36,6 +37,9 @@ public:
 
         /// Title of the window
         std::string title;
+
+        /// If true no window is created and rendering uses the null backend
+        bool headless = false;
     };
 
 public:
@@ -67,7 +71,17 @@ private:
      */
     int createWindow(const unsigned int& width, const unsigned int& height, const std::string& title);
 
+    /**
+     * Notify the engine of a window that only exists as a size, used for
+     * running the engine without a display or a GPU
+     *
+     * @param params Parameters of the window
+     *
+     * @return 0 if there were no errors, otherwise error code
+     */
+    int createHeadlessWindow(CreateWindowParams* params);
+
 private:
-    /// Window pointer
-    GLFWwindow* m_pWindow;
+    /// Window pointer, nullptr for headless windows
+    GLFWwindow* m_pWindow = nullptr;
 };
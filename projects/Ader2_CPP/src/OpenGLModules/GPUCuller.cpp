@@ -0,0 +1,486 @@
+#include "GPUCuller.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Programs, buffers and textures go through the state cache
+#include "OpenGLModules/GLState.h"
+
+// Uniform values
+#include <glm/gtc/type_ptr.hpp>
+
+// For std::max
+#include <algorithm>
+
+GPUCuller* GPUCuller::ms_pInstance = nullptr;
+
+// The structures are read by the shaders with the std430 layout
+static_assert(sizeof(GPUCuller::Instance) == 80, "Instance doesn't match the shader layout");
+static_assert(sizeof(GPUCuller::Object) == 112, "Object doesn't match the shader layout");
+static_assert(sizeof(GPUCuller::DrawCommand) == 20, "DrawCommand doesn't match DrawElementsIndirectCommand");
+
+namespace
+{
+    /// Cull pass, one thread per object
+    const char* c_cullSource = R"(#version 430 core
+layout (local_size_x = 64) in;
+
+struct Instance
+{
+    vec4 Rows[3];
+    vec4 TexRect;
+    vec4 Extra;
+};
+
+struct Object
+{
+    Instance Data;
+    vec4 Sphere;
+    uvec4 Batch;
+};
+
+struct DrawCommand
+{
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    uint BaseVertex;
+    uint BaseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Objects
+{
+    Object objects[];
+};
+
+layout (std430, binding = 1) buffer Commands
+{
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 2) writeonly buffer Instances
+{
+    Instance instances[];
+};
+
+layout (location = 0) uniform int objectCount;
+layout (location = 1) uniform vec4 planes[6];
+layout (location = 7) uniform int occlusion;
+layout (location = 8) uniform mat4 pyramidViewProjection;
+layout (location = 9) uniform vec4 pyramidSize;
+layout (binding = 0) uniform sampler2D pyramid;
+
+// Tests the screen rectangle of the box around the sphere against the farthest
+// depth of the pyramid texels it covers
+bool occluded(vec3 center, float radius)
+{
+    vec2 lo = vec2(1.0);
+    vec2 hi = vec2(0.0);
+    float nearest = 1.0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = center + radius * vec3(
+            (i & 1) != 0 ? 1.0 : -1.0,
+            (i & 2) != 0 ? 1.0 : -1.0,
+            (i & 4) != 0 ? 1.0 : -1.0);
+
+        vec4 clip = pyramidViewProjection * vec4(corner, 1.0);
+
+        // Boxes crossing the near plane are always visible
+        if (clip.w <= 0.0)
+        {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        lo = min(lo, ndc.xy * 0.5 + 0.5);
+        hi = max(hi, ndc.xy * 0.5 + 0.5);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+
+    lo = clamp(lo, 0.0, 1.0);
+    hi = clamp(hi, 0.0, 1.0);
+
+    // Level where the rectangle covers at most 2x2 texels
+    vec2 size = (hi - lo) * pyramidSize.xy;
+    float level = clamp(ceil(log2(max(max(size.x, size.y), 1.0))), 0.0, pyramidSize.z - 1.0);
+
+    float farthest = max(
+        max(textureLod(pyramid, lo, level).r, textureLod(pyramid, vec2(hi.x, lo.y), level).r),
+        max(textureLod(pyramid, vec2(lo.x, hi.y), level).r, textureLod(pyramid, hi, level).r));
+
+    return nearest > farthest;
+}
+
+void main()
+{
+    int index = int(gl_GlobalInvocationID.x);
+    if (index >= objectCount)
+    {
+        return;
+    }
+
+    Object object = objects[index];
+
+    if (object.Sphere.w >= 0.0)
+    {
+        // World space sphere, the radius is scaled by the largest axis scale
+        vec4 center = vec4(object.Sphere.xyz, 1.0);
+        vec3 world = vec3(dot(object.Data.Rows[0], center), dot(object.Data.Rows[1], center), dot(object.Data.Rows[2], center));
+
+        vec3 axisX = vec3(object.Data.Rows[0].x, object.Data.Rows[1].x, object.Data.Rows[2].x);
+        vec3 axisY = vec3(object.Data.Rows[0].y, object.Data.Rows[1].y, object.Data.Rows[2].y);
+        vec3 axisZ = vec3(object.Data.Rows[0].z, object.Data.Rows[1].z, object.Data.Rows[2].z);
+        float radius = object.Sphere.w * sqrt(max(max(dot(axisX, axisX), dot(axisY, axisY)), dot(axisZ, axisZ)));
+
+        for (int i = 0; i < 6; i++)
+        {
+            if (dot(planes[i].xyz, world) + planes[i].w < -radius)
+            {
+                return;
+            }
+        }
+
+        if (occlusion != 0 && occluded(world, radius))
+        {
+            return;
+        }
+    }
+
+    // Append to the instances of the batch
+    uint slot = atomicAdd(commands[object.Batch.x].InstanceCount, 1u);
+    instances[object.Batch.y + slot] = object.Data;
+})";
+
+    /// Depth pyramid, level 0 is copied from the depth texture and every other
+    /// level keeps the farthest depth of the previous one
+    const char* c_pyramidSource = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (binding = 0) uniform sampler2D depth;
+layout (r32f, binding = 0) uniform readonly image2D source;
+layout (r32f, binding = 1) uniform writeonly image2D target;
+
+layout (location = 0) uniform int level;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(target);
+    if (any(greaterThanEqual(texel, size)))
+    {
+        return;
+    }
+
+    if (level == 0)
+    {
+        imageStore(target, texel, vec4(texelFetch(depth, texel, 0).r));
+        return;
+    }
+
+    // Odd sizes fold the last row and column of the source into the edge texels
+    ivec2 sourceSize = imageSize(source);
+    ivec2 first = texel * 2;
+    ivec2 last = min(first + 1 + ivec2(equal(texel, size - 1)) * (sourceSize & 1), sourceSize - 1);
+
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; y++)
+    {
+        for (int x = first.x; x <= last.x; x++)
+        {
+            farthest = max(farthest, imageLoad(source, ivec2(x, y)).r);
+        }
+    }
+
+    imageStore(target, texel, vec4(farthest));
+})";
+}
+
+GPUCuller::GPUCuller()
+{
+    ms_pInstance = this;
+}
+
+GPUCuller::~GPUCuller()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void GPUCuller::init()
+{
+    GPUCuller& s = *ms_pInstance;
+
+    // Compute shaders and storage buffers are core since 4.3
+    if (!GLAD_GL_VERSION_4_3)
+    {
+        LOG_INFO("GPU culling: not supported, objects are culled on the CPU");
+        return;
+    }
+
+    s.m_cullProgram = createProgram(c_cullSource);
+    s.m_pyramidProgram = createProgram(c_pyramidSource);
+    s.m_supported = s.m_cullProgram != 0 && s.m_pyramidProgram != 0;
+
+    LOG_INFO("GPU culling: {0}", s.m_supported ? "supported" : "failed to create programs");
+}
+
+void GPUCuller::shutdown()
+{
+    GPUCuller& s = *ms_pInstance;
+
+    clearDepthPyramid();
+
+    GLState::deleteProgram(s.m_cullProgram);
+    GLState::deleteProgram(s.m_pyramidProgram);
+    GLState::deleteBuffer(s.m_objects);
+    GLState::deleteBuffer(s.m_instances);
+    GLState::deleteBuffer(s.m_commands);
+
+    s.m_cullProgram = 0;
+    s.m_pyramidProgram = 0;
+    s.m_objects = 0;
+    s.m_instances = 0;
+    s.m_commands = 0;
+    s.m_objectsSize = 0;
+    s.m_instancesSize = 0;
+    s.m_commandsSize = 0;
+    s.m_supported = false;
+}
+
+bool GPUCuller::isSupported()
+{
+    return ms_pInstance->m_supported;
+}
+
+void GPUCuller::cull(const Object* pObjects, size_t objectCount, const DrawCommand* pCommands, size_t commandCount, const glm::mat4& viewProjection)
+{
+    GPUCuller& s = *ms_pInstance;
+
+    if (!s.m_supported || commandCount == 0)
+    {
+        return;
+    }
+
+    // Commands are uploaded with their instance counts at 0, the pass fills them in
+    size_t commandsSize = commandCount * sizeof(DrawCommand);
+    reserve(s.m_commands, s.m_commandsSize, commandsSize, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commandsSize, pCommands);
+
+    s.m_passes++;
+    s.m_objectCount = objectCount;
+    s.m_commandCount = commandCount;
+    s.m_occlusion = s.m_pyramid != 0;
+
+    if (objectCount == 0)
+    {
+        return;
+    }
+
+    size_t objectsSize = objectCount * sizeof(Object);
+    reserve(s.m_objects, s.m_objectsSize, objectsSize, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objectsSize, pObjects);
+
+    // Every object can be visible
+    size_t instancesSize = objectCount * sizeof(Instance);
+    reserve(s.m_instances, s.m_instancesSize, instancesSize, GL_DYNAMIC_COPY);
+
+    GLState::bindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, s.m_objects, 0, objectsSize);
+    GLState::bindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, s.m_commands, 0, commandsSize);
+    GLState::bindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, s.m_instances, 0, instancesSize);
+
+    // Frustum planes from the rows of the matrix, normalized so the distance
+    // to a plane can be compared with the radius
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    glm::vec4 planes[6] =
+    {
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2],
+    };
+
+    for (glm::vec4& plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    GLState::useProgram(s.m_cullProgram);
+    glUniform1i(0, (GLint)objectCount);
+    glUniform4fv(1, 6, glm::value_ptr(planes[0]));
+    glUniform1i(7, s.m_pyramid != 0);
+
+    if (s.m_pyramid != 0)
+    {
+        glm::vec4 pyramidSize((float)s.m_pyramidWidth, (float)s.m_pyramidHeight, (float)s.m_pyramidLevels, 0.0f);
+        glUniformMatrix4fv(8, 1, GL_FALSE, glm::value_ptr(s.m_pyramidViewProjection));
+        glUniform4fv(9, 1, glm::value_ptr(pyramidSize));
+        GLState::bindTexture(0, GL_TEXTURE_2D, s.m_pyramid);
+    }
+
+    glDispatchCompute((GLuint)((objectCount + ms_cullGroupSize - 1) / ms_cullGroupSize), 1, 1);
+
+    // Draws read the counts as commands and the instances as vertex attributes
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void GPUCuller::buildDepthPyramid(GLuint depthTexture, unsigned int width, unsigned int height, const glm::mat4& viewProjection)
+{
+    GPUCuller& s = *ms_pInstance;
+
+    if (!s.m_supported || width == 0 || height == 0)
+    {
+        return;
+    }
+
+    // The pyramid is recreated when the size of the depth buffer changes
+    if (s.m_pyramid == 0 || s.m_pyramidWidth != width || s.m_pyramidHeight != height)
+    {
+        clearDepthPyramid();
+
+        s.m_pyramidWidth = width;
+        s.m_pyramidHeight = height;
+        s.m_pyramidLevels = 1;
+        for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+        {
+            s.m_pyramidLevels++;
+        }
+
+        glGenTextures(1, &s.m_pyramid);
+        GLState::bindTexture(0, GL_TEXTURE_2D, s.m_pyramid);
+        glTexStorage2D(GL_TEXTURE_2D, s.m_pyramidLevels, GL_R32F, width, height);
+
+        // Levels are selected explicitly, texels are never filtered
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    GLState::useProgram(s.m_pyramidProgram);
+    GLState::bindTexture(0, GL_TEXTURE_2D, depthTexture);
+
+    unsigned int levelWidth = width;
+    unsigned int levelHeight = height;
+
+    for (unsigned int level = 0; level < s.m_pyramidLevels; level++)
+    {
+        if (level > 0)
+        {
+            glBindImageTexture(0, s.m_pyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+            levelWidth = std::max(levelWidth / 2, 1u);
+            levelHeight = std::max(levelHeight / 2, 1u);
+        }
+
+        glBindImageTexture(1, s.m_pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glUniform1i(0, (GLint)level);
+        glDispatchCompute((levelWidth + ms_pyramidGroupSize - 1) / ms_pyramidGroupSize, (levelHeight + ms_pyramidGroupSize - 1) / ms_pyramidGroupSize, 1);
+
+        // The next level reads this one
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // The cull pass samples the pyramid
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    s.m_pyramidViewProjection = viewProjection;
+}
+
+void GPUCuller::clearDepthPyramid()
+{
+    GPUCuller& s = *ms_pInstance;
+
+    if (s.m_pyramid != 0)
+    {
+        GLState::deleteTexture(s.m_pyramid);
+    }
+
+    s.m_pyramid = 0;
+    s.m_pyramidWidth = 0;
+    s.m_pyramidHeight = 0;
+    s.m_pyramidLevels = 0;
+}
+
+GLuint GPUCuller::getInstanceBuffer()
+{
+    return ms_pInstance->m_instances;
+}
+
+GLuint GPUCuller::getCommandBuffer()
+{
+    return ms_pInstance->m_commands;
+}
+
+GPUCuller::Statistics GPUCuller::getStatistics()
+{
+    Statistics stats;
+    stats.Passes = ms_pInstance->m_passes;
+    stats.Objects = ms_pInstance->m_objectCount;
+    stats.Commands = ms_pInstance->m_commandCount;
+    stats.Occlusion = ms_pInstance->m_occlusion;
+    return stats;
+}
+
+GLuint GPUCuller::createProgram(const char* pSource)
+{
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &pSource, NULL);
+    glCompileShader(shader);
+
+    GLint success = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512] = {};
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        LOG_ERROR("Failed to compile compute shader:\n {0}", infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512] = {};
+        glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+        LOG_ERROR("Failed to link compute program:\n {0}", infoLog);
+        GLState::deleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void GPUCuller::reserve(GLuint& buffer, size_t& capacity, size_t size, GLenum usage)
+{
+    if (buffer == 0)
+    {
+        glGenBuffers(1, &buffer);
+    }
+
+    GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+    // Grow to the next power of two so the buffer isn't reallocated every time an object is added,
+    // streamed buffers are orphaned so the previous frame can still read the old storage
+    if (size > capacity || usage == GL_STREAM_DRAW)
+    {
+        while (capacity < size)
+        {
+            capacity = std::max<size_t>(capacity * 2, 1024);
+        }
+
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, usage);
+    }
+}
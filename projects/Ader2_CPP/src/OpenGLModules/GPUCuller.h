@@ -0,0 +1,219 @@
+#pragma once
+
+// Statistics are read from the game thread
+#include <atomic>
+#include <cstddef>
+
+// Instance data and view projection
+#include <glm/glm.hpp>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * GPU culler tests objects against the view frustum in a compute pass and
+ * writes the visible ones into a compacted instance buffer. Every batch has a
+ * DrawElementsIndirectCommand whose instance count is incremented by the pass,
+ * so batches are drawn with indirect draws and the CPU never reads the result.
+ *
+ * When a depth pyramid has been built from the depth buffer of a previous frame
+ * objects are also tested against it (Hi-Z occlusion culling), the pyramid
+ * stores the farthest depth of each texel so a test can only be conservative.
+ *
+ * Requires OpenGL 4.3 for compute shaders and storage buffers, without it the
+ * culler reports that it isn't supported and the renderer keeps culling on the
+ * CPU. Everything except the statistics is accessed from the thread executing
+ * render commands.
+ */
+class GPUCuller
+{
+public:
+    /**
+     * Instance data read by the instance attributes of the compact variant,
+     * the visible instance buffer is an array of these
+     */
+    struct Instance
+    {
+        /// First 3 rows of the affine transformation
+        glm::vec4 Rows[3];
+
+        /// Texture rectangle, offset in xy and scale in zw
+        glm::vec4 TexRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        /// Texture atlas offset
+        glm::vec2 TexOffset = glm::vec2(0.0f);
+
+        /// Texture array layer
+        float Layer = 0.0f;
+
+        float Padding = 0.0f;
+    };
+
+    /**
+     * Object tested by the cull pass, std430 layout
+     */
+    struct Object
+    {
+        Instance Data;
+
+        /// Bounding sphere in object space, objects with a negative radius are never culled
+        glm::vec4 Sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+
+        /// Draw command of the batch the object belongs to
+        unsigned int Command = 0;
+
+        /// First instance of the batch in the visible instance buffer
+        unsigned int BaseInstance = 0;
+
+        unsigned int Padding[2] = {};
+    };
+
+    /**
+     * Layout of DrawElementsIndirectCommand, commands of draws without indices use
+     * the first 4 values as a DrawArraysIndirectCommand (count, instance count,
+     * first and base instance)
+     */
+    struct DrawCommand
+    {
+        unsigned int Count = 0;
+        unsigned int InstanceCount = 0;
+        unsigned int FirstIndex = 0;
+        unsigned int BaseVertex = 0;
+        unsigned int BaseInstance = 0;
+    };
+
+    /**
+     * Statistics of the GPU culler
+     */
+    struct Statistics
+    {
+        /// Frames culled on the GPU
+        size_t Passes = 0;
+
+        /// Objects tested by the last pass
+        size_t Objects = 0;
+
+        /// Draw commands written by the last pass
+        size_t Commands = 0;
+
+        /// True if the last pass tested against a depth pyramid
+        bool Occlusion = false;
+    };
+public:
+    GPUCuller();
+
+    ~GPUCuller();
+
+    /**
+     * Compiles the compute programs if the context supports them, must be called
+     * after the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the programs, buffers and the depth pyramid, must be called before
+     * the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Returns true if the context supports culling on the GPU, valid after init
+     */
+    static bool isSupported();
+
+    /**
+     * Uploads the objects and the draw commands and runs the cull pass. The instance
+     * counts of the commands are reset, the pass adds every visible object to the
+     * command of its batch and copies its instance data to the visible instance buffer
+     *
+     * @param pObjects Objects to test
+     * @param objectCount Number of objects
+     * @param pCommands Draw commands of the batches
+     * @param commandCount Number of draw commands
+     * @param viewProjection Matrix the objects are drawn with
+     */
+    static void cull(const Object* pObjects, size_t objectCount, const DrawCommand* pCommands, size_t commandCount, const glm::mat4& viewProjection);
+
+    /**
+     * Builds the depth pyramid from a depth texture, the next passes test objects
+     * against it until it's cleared
+     *
+     * @param depthTexture Texture containing the depth buffer of a rendered frame
+     * @param width Width of the depth texture
+     * @param height Height of the depth texture
+     * @param viewProjection Matrix the frame was rendered with
+     */
+    static void buildDepthPyramid(GLuint depthTexture, unsigned int width, unsigned int height, const glm::mat4& viewProjection);
+
+    /**
+     * Deletes the depth pyramid, the next passes only test against the frustum
+     */
+    static void clearDepthPyramid();
+
+    /**
+     * Returns the buffer the visible instances are written to
+     */
+    static GLuint getInstanceBuffer();
+
+    /**
+     * Returns the buffer containing the draw commands
+     */
+    static GLuint getCommandBuffer();
+
+    /**
+     * Returns the statistics of the culler
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Compiles and links a compute program
+     *
+     * @return Program id or 0 if it failed
+     */
+    static GLuint createProgram(const char* pSource);
+
+    /**
+     * Creates and binds the storage buffer and makes sure it can hold the specified
+     * amount of bytes. The contents aren't kept when it grows, streamed buffers are
+     * orphaned every time so the previous frame can still read the old storage
+     */
+    static void reserve(GLuint& buffer, size_t& capacity, size_t size, GLenum usage);
+private:
+    /// Instance used by the static interface
+    static GPUCuller* ms_pInstance;
+
+    /// Threads of a cull and a pyramid work group
+    static constexpr unsigned int ms_cullGroupSize = 64;
+    static constexpr unsigned int ms_pyramidGroupSize = 8;
+
+    /// Compute programs
+    GLuint m_cullProgram = 0;
+    GLuint m_pyramidProgram = 0;
+
+    /// Objects, visible instances and draw commands, with their allocated sizes
+    GLuint m_objects = 0;
+    GLuint m_instances = 0;
+    GLuint m_commands = 0;
+    size_t m_objectsSize = 0;
+    size_t m_instancesSize = 0;
+    size_t m_commandsSize = 0;
+
+    /// Depth pyramid, farthest depth of each texel
+    GLuint m_pyramid = 0;
+    unsigned int m_pyramidWidth = 0;
+    unsigned int m_pyramidHeight = 0;
+    unsigned int m_pyramidLevels = 0;
+
+    /// Matrix the pyramid was rendered with
+    glm::mat4 m_pyramidViewProjection = glm::mat4(1.0f);
+
+    /// True after init if compute shaders are supported
+    bool m_supported = false;
+
+    /// Statistics
+    std::atomic<size_t> m_passes{ 0 };
+    std::atomic<size_t> m_objectCount{ 0 };
+    std::atomic<size_t> m_commandCount{ 0 };
+    std::atomic<bool> m_occlusion{ false };
+};
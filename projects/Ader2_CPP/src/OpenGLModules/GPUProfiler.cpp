@@ -0,0 +1,222 @@
+#include "GPUProfiler.h"
+
+// Resolved passes are reported to the frame profiler
+#include "Utility/Profiler.h"
+
+GPUProfiler* GPUProfiler::ms_pInstance = nullptr;
+
+GPUProfiler::GPUProfiler()
+{
+    ms_pInstance = this;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void GPUProfiler::init()
+{
+    // Timer queries are core since 3.3
+    ms_pInstance->m_enabled = GLAD_GL_VERSION_3_3 != 0;
+}
+
+void GPUProfiler::shutdown()
+{
+    GPUProfiler& s = *ms_pInstance;
+
+    for (Frame& frame : s.m_frames)
+    {
+        if (!frame.Queries.empty())
+        {
+            glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data());
+        }
+
+        if (frame.Samples != 0)
+        {
+            glDeleteQueries(1, &frame.Samples);
+        }
+
+        frame.Queries.clear();
+        frame.Names.clear();
+        frame.Used = 0;
+        frame.Samples = 0;
+        frame.SamplesUsed = false;
+        frame.Pending = false;
+    }
+
+    s.m_open = false;
+    s.m_counting = false;
+    s.m_enabled = false;
+}
+
+void GPUProfiler::begin(const char* name)
+{
+    GPUProfiler& s = *ms_pInstance;
+
+    if (!s.m_enabled)
+    {
+        return;
+    }
+
+    // Elapsed time queries can't be nested
+    if (s.m_open)
+    {
+        end();
+    }
+
+    Frame& frame = s.m_frames[s.m_frame];
+
+    // Query objects are created the first time a frame needs them
+    if (frame.Used == frame.Queries.size())
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.Queries.push_back(query);
+        frame.Names.push_back(name);
+    }
+
+    frame.Names[frame.Used] = name;
+    glBeginQuery(GL_TIME_ELAPSED, frame.Queries[frame.Used]);
+    frame.Used++;
+
+    s.m_open = true;
+}
+
+void GPUProfiler::end()
+{
+    GPUProfiler& s = *ms_pInstance;
+
+    if (s.m_open)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        s.m_open = false;
+    }
+}
+
+void GPUProfiler::beginSamples()
+{
+    GPUProfiler& s = *ms_pInstance;
+    Frame& frame = s.m_frames[s.m_frame];
+
+    if (!s.m_enabled || s.m_counting || frame.SamplesUsed)
+    {
+        return;
+    }
+
+    if (frame.Samples == 0)
+    {
+        glGenQueries(1, &frame.Samples);
+    }
+
+    glBeginQuery(GL_SAMPLES_PASSED, frame.Samples);
+    frame.SamplesUsed = true;
+    s.m_counting = true;
+}
+
+void GPUProfiler::endSamples()
+{
+    GPUProfiler& s = *ms_pInstance;
+
+    if (s.m_counting)
+    {
+        glEndQuery(GL_SAMPLES_PASSED);
+        s.m_counting = false;
+    }
+}
+
+void GPUProfiler::endFrame()
+{
+    GPUProfiler& s = *ms_pInstance;
+
+    if (!s.m_enabled)
+    {
+        return;
+    }
+
+    end();
+    endSamples();
+
+    Frame& current = s.m_frames[s.m_frame];
+    current.Pending = current.Used > 0 || current.SamplesUsed;
+
+    // Read finished frames from the oldest one, the GPU finishes them in order
+    for (size_t i = 1; i < ms_frameCount; i++)
+    {
+        Frame& frame = s.m_frames[(s.m_frame + i) % ms_frameCount];
+        if (frame.Pending && !s.resolve(frame))
+        {
+            break;
+        }
+    }
+
+    // Move to the next frame, its queries are reused so results that are still
+    // missing are dropped instead of waiting for them
+    s.m_frame = (s.m_frame + 1) % ms_frameCount;
+
+    Frame& next = s.m_frames[s.m_frame];
+    if (next.Pending)
+    {
+        next.Pending = false;
+        s.m_dropped++;
+    }
+
+    next.Used = 0;
+    next.SamplesUsed = false;
+}
+
+GPUProfiler::Statistics GPUProfiler::getStatistics()
+{
+    Statistics stats;
+    stats.Resolved = ms_pInstance->m_resolved;
+    stats.Dropped = ms_pInstance->m_dropped;
+    stats.SamplesPassed = ms_pInstance->m_samplesPassed;
+    stats.FrameTime = ms_pInstance->m_frameTime;
+    return stats;
+}
+
+bool GPUProfiler::resolve(Frame& frame)
+{
+    // Queries complete in order, if the last one is available all of them are
+    GLint available = GL_TRUE;
+    if (frame.Used > 0)
+    {
+        glGetQueryObjectiv(frame.Queries[frame.Used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+
+    if (available != GL_FALSE && frame.SamplesUsed)
+    {
+        glGetQueryObjectiv(frame.Samples, GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+
+    if (available == GL_FALSE)
+    {
+        return false;
+    }
+
+    // Passes don't overlap, together they are the GPU time of the frame
+    double frameTime = 0.0;
+    for (size_t i = 0; i < frame.Used; i++)
+    {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &nanoseconds);
+        Utility::Profiler::sample("GPU", frame.Names[i], (double)nanoseconds / 1000000.0);
+        frameTime += (double)nanoseconds / 1000000.0;
+    }
+
+    m_frameTime = frameTime;
+
+    if (frame.SamplesUsed)
+    {
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(frame.Samples, GL_QUERY_RESULT, &samples);
+        m_samplesPassed = (size_t)samples;
+    }
+
+    frame.Pending = false;
+    m_resolved++;
+    return true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// Query objects of each frame
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * GPU profiler measures render passes with GL_TIME_ELAPSED queries. The query
+ * objects of each frame are kept in a ring of ms_frameCount frames, results are
+ * read a few frames later once the GPU has reported them available, so the CPU
+ * never waits for the GPU. If the GPU falls further behind than the ring the
+ * results of the oldest frame are dropped. Resolved passes are added to the
+ * Utility::Profiler under the "GPU" scope.
+ *
+ * Each frame can also count the samples that passed the depth test with a
+ * GL_SAMPLES_PASSED query, which measures overdraw of the enclosed passes.
+ *
+ * Elapsed time queries can't be nested, opening a pass closes the previous one.
+ * Everything except the statistics is accessed from the thread executing render
+ * commands.
+ */
+class GPUProfiler
+{
+public:
+    /**
+     * Statistics of the GPU profiler
+     */
+    struct Statistics
+    {
+        /// Frames whose results were read
+        size_t Resolved = 0;
+
+        /// Frames whose results weren't available before their queries were reused
+        size_t Dropped = 0;
+
+        /// Samples counted in the last resolved frame
+        size_t SamplesPassed = 0;
+
+        /// Milliseconds of all passes of the last resolved frame
+        double FrameTime = 0.0;
+    };
+public:
+    GPUProfiler();
+
+    ~GPUProfiler();
+
+    /**
+     * Enables the profiler, must be called after the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the query objects, must be called before the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Starts timing a pass
+     *
+     * @param name Name of the pass, must outlive the profiler
+     */
+    static void begin(const char* name);
+
+    /**
+     * Stops timing the current pass
+     */
+    static void end();
+
+    /**
+     * Starts counting the samples that pass the depth test, only one range is
+     * counted per frame
+     */
+    static void beginSamples();
+
+    /**
+     * Stops counting samples
+     */
+    static void endSamples();
+
+    /**
+     * Ends the frame and reads the results of the finished frames, must be called
+     * before swapping buffers
+     */
+    static void endFrame();
+
+    /**
+     * Returns the statistics of the profiler
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Queries of a single frame
+     */
+    struct Frame
+    {
+        /// Query objects, reused every time the frame comes around
+        std::vector<GLuint> Queries;
+
+        /// Pass names of the used queries
+        std::vector<const char*> Names;
+
+        /// Queries used by the frame
+        size_t Used = 0;
+
+        /// Samples passed query, created the first time samples are counted
+        GLuint Samples = 0;
+
+        /// True if the frame counted samples
+        bool SamplesUsed = false;
+
+        /// True if the frame has results that weren't read yet
+        bool Pending = false;
+    };
+
+    /**
+     * Reads the results of the frame if they are available
+     *
+     * @return True if the results were read, false if the GPU hasn't finished yet
+     */
+    bool resolve(Frame& frame);
+private:
+    /// Instance used by the static interface
+    static GPUProfiler* ms_pInstance;
+
+    /// Frames in the query ring, results are read at most ms_frameCount - 1 frames late
+    static constexpr size_t ms_frameCount = 4;
+
+    /// Query ring
+    Frame m_frames[ms_frameCount];
+
+    /// Frame currently being recorded
+    size_t m_frame = 0;
+
+    /// True while a pass is being timed
+    bool m_open = false;
+
+    /// True while samples are being counted
+    bool m_counting = false;
+
+    /// True after init
+    bool m_enabled = false;
+
+    /// Statistics
+    std::atomic<size_t> m_resolved{ 0 };
+    std::atomic<size_t> m_dropped{ 0 };
+    std::atomic<size_t> m_samplesPassed{ 0 };
+    std::atomic<double> m_frameTime{ 0.0 };
+};
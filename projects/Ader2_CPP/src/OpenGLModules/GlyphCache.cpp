@@ -0,0 +1,437 @@
+#include "GlyphCache.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Font faces and glyph rendering
+#include "Utility/File.h"
+
+// Distance field glyphs
+#include "Utility/DistanceField.h"
+
+// Page texture
+#include "OpenGLModules/GLContext.h"
+
+// Textures go through the state cache
+#include "OpenGLModules/GLState.h"
+
+// Page updates are recorded for the render thread
+#include "OpenGLModules/RenderThread.h"
+
+// For memcpy
+#include <cstring>
+
+GlyphCache* GlyphCache::ms_pInstance = nullptr;
+
+GlyphCache::GlyphCache()
+{
+    ms_pInstance = this;
+}
+
+GlyphCache::~GlyphCache()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void GlyphCache::init()
+{
+    GlyphCache& s = *ms_pInstance;
+
+    static_assert(ms_maxPages <= 32, "Pages must fit in a bit mask");
+
+    s.m_pTexture = new Texture();
+    s.m_pTexture->Source = "Glyph cache";
+
+    Texture& texture = *s.m_pTexture;
+
+    // All pages are allocated up front, the cache never uses more memory than this
+    glGenTextures(1, &texture.m_idTexture);
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, texture.m_idTexture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, ms_pageSize, ms_pageSize, ms_maxPages);
+
+    // Glyphs are surrounded by padding, filtering never reads past it
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    texture.m_target = GL_TEXTURE_2D_ARRAY;
+    texture.m_hasLevels = true;
+    texture.m_loaded = true;
+    texture.setFormat(ms_pageSize, ms_pageSize, 1, GL_R8, 1, (size_t)ms_pageSize * ms_pageSize * ms_maxPages);
+}
+
+void GlyphCache::shutdown()
+{
+    GlyphCache& s = *ms_pInstance;
+
+    // Executed on the render thread so the texture is deleted immediately
+    delete s.m_pTexture;
+    s.m_pTexture = nullptr;
+
+    for (Face& face : s.m_faces)
+    {
+        closeFont(face.pFace);
+    }
+
+    s.m_faces.clear();
+    s.m_fonts.clear();
+    s.m_pages.clear();
+}
+
+int GlyphCache::getFont(const std::string& path, unsigned int size, bool distanceField)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    // Distance fields are scaled, all sizes share the glyphs of the reference size
+    if (distanceField)
+    {
+        size = ms_distanceFieldSize;
+    }
+
+    // Faces are opened once for all sizes
+    size_t face = 0;
+    while (face < s.m_faces.size() && s.m_faces[face].Path != path)
+    {
+        face++;
+    }
+
+    if (face == s.m_faces.size())
+    {
+        FontFace* pFace = openFont(path);
+        if (pFace == nullptr)
+        {
+            return -1;
+        }
+
+        s.m_faces.push_back({ path, pFace });
+    }
+
+    for (size_t i = 0; i < s.m_fonts.size(); i++)
+    {
+        if (s.m_fonts[i].Face == face && s.m_fonts[i].Size == size && s.m_fonts[i].DistanceField == distanceField)
+        {
+            return (int)i;
+        }
+    }
+
+    Font font;
+    font.Face = face;
+    font.Size = size;
+    font.DistanceField = distanceField;
+    font.LineHeight = (float)::getLineHeight(s.m_faces[face].pFace, size);
+    font.Flat.resize(ms_flatRange);
+    s.m_fonts.push_back(std::move(font));
+
+    return (int)s.m_fonts.size() - 1;
+}
+
+const GlyphCache::Glyph* GlyphCache::getGlyph(int font, unsigned int codepoint)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    if (font < 0 || (size_t)font >= s.m_fonts.size())
+    {
+        return nullptr;
+    }
+
+    Font& f = s.m_fonts[font];
+
+    // Most text only uses the flat range
+    Glyph& glyph = codepoint < ms_flatRange ? f.Flat[codepoint] : f.Other[codepoint];
+
+    if (!glyph.Cached && !rasterize(f, codepoint, glyph))
+    {
+        return nullptr;
+    }
+
+    if (glyph.Size.x > 0.0f)
+    {
+        s.m_pages[glyph.Page].LastUsed = s.m_frame;
+    }
+
+    return &glyph;
+}
+
+unsigned int GlyphCache::getSize(int font)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    if (font < 0 || (size_t)font >= s.m_fonts.size())
+    {
+        return 0;
+    }
+
+    return s.m_fonts[font].Size;
+}
+
+float GlyphCache::getLineHeight(int font)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    if (font < 0 || (size_t)font >= s.m_fonts.size())
+    {
+        return 0.0f;
+    }
+
+    return s.m_fonts[font].LineHeight;
+}
+
+Texture* GlyphCache::getTexture()
+{
+    return ms_pInstance->m_pTexture;
+}
+
+unsigned int GlyphCache::getGeneration()
+{
+    return ms_pInstance->m_generation;
+}
+
+void GlyphCache::beginFrame()
+{
+    ms_pInstance->m_frame++;
+}
+
+void GlyphCache::touchPages(unsigned int pages)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    for (size_t i = 0; i < s.m_pages.size(); i++)
+    {
+        if (pages & (1u << i))
+        {
+            s.m_pages[i].LastUsed = s.m_frame;
+        }
+    }
+}
+
+GlyphCache::Statistics GlyphCache::getStatistics()
+{
+    GlyphCache& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Rasterized = s.m_rasterized;
+    stats.Evictions = s.m_evictions;
+    stats.Fonts = s.m_fonts.size();
+
+    for (const Page& page : s.m_pages)
+    {
+        stats.Pages += page.Used ? 1 : 0;
+    }
+
+    return stats;
+}
+
+bool GlyphCache::rasterize(Font& font, unsigned int codepoint, Glyph& glyph)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    GlyphBitmap bitmap;
+    unsigned int size = font.DistanceField ? font.Size * ms_distanceFieldDownscale : font.Size;
+    if (!renderGlyph(s.m_faces[font.Face].pFace, size, codepoint, bitmap))
+    {
+        return false;
+    }
+
+    glm::vec2 bearing = glm::vec2((float)bitmap.Left, (float)bitmap.Top);
+    float advance = (float)bitmap.Advance;
+
+    // Replace the coverage with the distance field, it's larger than the glyph by the spread
+    if (font.DistanceField)
+    {
+        float downscale = (float)ms_distanceFieldDownscale;
+        bearing = bearing / downscale + glm::vec2(-1.0f, 1.0f) * (float)ms_distanceFieldSpread;
+        advance /= downscale;
+
+        if (bitmap.Width > 0 && bitmap.Height > 0)
+        {
+            std::vector<unsigned char> field;
+            unsigned int width = 0;
+            unsigned int height = 0;
+            Utility::buildDistanceField(bitmap.Buffer.data(), bitmap.Width, bitmap.Height,
+                ms_distanceFieldSpread, ms_distanceFieldDownscale, field, width, height);
+
+            bitmap.Width = width;
+            bitmap.Height = height;
+            bitmap.Buffer = std::move(field);
+        }
+    }
+
+    Glyph result;
+    result.Size = glm::vec2((float)bitmap.Width, (float)bitmap.Height);
+    result.Bearing = bearing;
+    result.Advance = advance;
+    result.Cached = true;
+
+    s.m_rasterized++;
+
+    // Characters without an image (spaces) only move the pen
+    if (bitmap.Width == 0 || bitmap.Height == 0)
+    {
+        glyph = result;
+        return true;
+    }
+
+    unsigned int width = bitmap.Width + 2 * ms_padding;
+    unsigned int height = bitmap.Height + 2 * ms_padding;
+    unsigned int page = 0;
+    unsigned int x = 0;
+    unsigned int y = 0;
+
+    // The glyph isn't cached yet so an eviction doesn't touch it
+    if (!allocate(width, height, page, x, y))
+    {
+        LOG_WARN("Glyph {0} of size {1} doesn't fit into the glyph cache", codepoint, font.Size);
+        return false;
+    }
+
+    result.Page = page;
+    result.TexRect = glm::vec4(
+        (float)(x + ms_padding) / ms_pageSize, (float)(y + ms_padding) / ms_pageSize,
+        (float)bitmap.Width / ms_pageSize, (float)bitmap.Height / ms_pageSize);
+
+    glyph = result;
+
+    // The padding is uploaded with the glyph, it overwrites whatever an evicted glyph left there
+    std::vector<unsigned char> image(width * height, 0);
+    for (unsigned int row = 0; row < bitmap.Height; row++)
+    {
+        memcpy(image.data() + (row + ms_padding) * width + ms_padding, bitmap.Buffer.data() + row * bitmap.Width, bitmap.Width);
+    }
+
+    const unsigned char* pData = RenderThread::copy(image.data(), image.size());
+    Texture* pTexture = s.m_pTexture;
+
+    RenderThread::record([pTexture, pData, page, x, y, width, height]()
+    {
+        GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, pTexture->m_idTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, page, width, height, 1, GL_RED, GL_UNSIGNED_BYTE, pData);
+    });
+
+    return true;
+}
+
+bool GlyphCache::allocate(unsigned int width, unsigned int height, unsigned int& page, unsigned int& x, unsigned int& y)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    if (width > ms_pageSize || height > ms_pageSize)
+    {
+        return false;
+    }
+
+    // Pages that already contain glyphs
+    for (size_t i = 0; i < s.m_pages.size(); i++)
+    {
+        if (allocateInPage(s.m_pages[i], width, height, x, y))
+        {
+            page = (unsigned int)i;
+            return true;
+        }
+    }
+
+    // Start a new page
+    if (s.m_pages.size() < ms_maxPages)
+    {
+        s.m_pages.emplace_back();
+        page = (unsigned int)s.m_pages.size() - 1;
+        return allocateInPage(s.m_pages.back(), width, height, x, y);
+    }
+
+    // Evict the least recently used page, if it was used this frame the text that
+    // was already submitted shows the new glyphs for a frame
+    page = 0;
+    for (size_t i = 1; i < s.m_pages.size(); i++)
+    {
+        if (s.m_pages[i].LastUsed < s.m_pages[page].LastUsed)
+        {
+            page = (unsigned int)i;
+        }
+    }
+
+    evict(page);
+    return allocateInPage(s.m_pages[page], width, height, x, y);
+}
+
+bool GlyphCache::allocateInPage(Page& page, unsigned int width, unsigned int height, unsigned int& x, unsigned int& y)
+{
+    // Shelf that wastes the least height, shelves much taller than the glyph are only
+    // used when a new shelf doesn't fit
+    Shelf* pBest = nullptr;
+    Shelf* pFallback = nullptr;
+    for (Shelf& shelf : page.Shelves)
+    {
+        if (shelf.Height < height || ms_pageSize - shelf.Width < width)
+        {
+            continue;
+        }
+
+        Shelf*& pCandidate = shelf.Height <= height + height / 2 ? pBest : pFallback;
+        if (pCandidate == nullptr || shelf.Height < pCandidate->Height)
+        {
+            pCandidate = &shelf;
+        }
+    }
+
+    // Open a new shelf below the others
+    if (pBest == nullptr && ms_pageSize - page.Height >= height)
+    {
+        page.Shelves.push_back({ page.Height, height, 0 });
+        page.Height += height;
+        pBest = &page.Shelves.back();
+    }
+
+    if (pBest == nullptr)
+    {
+        pBest = pFallback;
+    }
+
+    if (pBest == nullptr)
+    {
+        return false;
+    }
+
+    x = pBest->Width;
+    y = pBest->Y;
+    pBest->Width += width;
+    page.Used = true;
+
+    return true;
+}
+
+void GlyphCache::evict(unsigned int page)
+{
+    GlyphCache& s = *ms_pInstance;
+
+    // Glyphs without an image don't live in a page
+    auto inPage = [page](const Glyph& glyph)
+    {
+        return glyph.Cached && glyph.Size.x > 0.0f && glyph.Page == page;
+    };
+
+    for (Font& font : s.m_fonts)
+    {
+        for (Glyph& glyph : font.Flat)
+        {
+            if (inPage(glyph))
+            {
+                glyph = Glyph();
+            }
+        }
+
+        for (auto it = font.Other.begin(); it != font.Other.end();)
+        {
+            it = inPage(it->second) ? font.Other.erase(it) : std::next(it);
+        }
+    }
+
+    s.m_pages[page] = Page();
+    s.m_generation++;
+    s.m_evictions++;
+
+    LOG_INFO("Glyph cache: evicted page {0}", page);
+}
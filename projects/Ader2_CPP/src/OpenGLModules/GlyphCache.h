@@ -0,0 +1,282 @@
+#pragma once
+
+// For glyph tables
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+
+// Texture rectangles
+#include <glm/glm.hpp>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+class Texture;
+struct FontFace;
+
+
+/**
+ * Glyph cache shared by all Text assets. Glyphs are identified by their face,
+ * size and codepoint and are only rasterized the first time they are used.
+ * The images are shelf packed into the pages of a single texture array so all
+ * text can be drawn with one texture, pages are updated with glTexSubImage3D
+ * as glyphs are added.
+ *
+ * The amount of pages is fixed, when they are full the least recently used
+ * page is evicted and its glyphs are rasterized again the next time they are
+ * used. Every eviction increments the cache generation, text laid out with an
+ * older generation must be laid out again.
+ *
+ * Fonts can store signed distance fields instead of coverage. Distance field
+ * glyphs are rasterized once at a reference size and scaled by the text, so
+ * one set of glyphs serves every size.
+ *
+ * Everything except init and shutdown is accessed from the thread recording
+ * render commands.
+ */
+class GlyphCache
+{
+public:
+    /**
+     * Cached glyph
+     */
+    struct Glyph
+    {
+        /// Texture coordinate of the top left corner in xy and the size in zw
+        glm::vec4 TexRect = glm::vec4(0.0f);
+
+        /// Size of the image in pixels
+        glm::vec2 Size = glm::vec2(0.0f);
+
+        /// Offset of the top left corner of the image from the pen position
+        glm::vec2 Bearing = glm::vec2(0.0f);
+
+        /// Offset to next glyph
+        float Advance = 0.0f;
+
+        /// Texture array layer containing the image
+        unsigned int Page = 0;
+
+        /// True if the glyph has been rasterized
+        bool Cached = false;
+    };
+
+    /**
+     * Statistics of the glyph cache
+     */
+    struct Statistics
+    {
+        /// Glyphs rasterized since the cache was created
+        size_t Rasterized = 0;
+
+        /// Pages evicted since the cache was created
+        size_t Evictions = 0;
+
+        /// Pages containing glyphs
+        size_t Pages = 0;
+
+        /// Faces and sizes in use
+        size_t Fonts = 0;
+    };
+public:
+    GlyphCache();
+
+    ~GlyphCache();
+
+    /**
+     * Creates the page texture array, must be called after the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the page texture array and closes all faces, must be called before
+     * the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Returns the font for a face and size, faces are opened once and shared
+     * between sizes
+     *
+     * @param path Path to the font file
+     * @param size Size of the font in points at 96 DPI, ignored by distance fields
+     * @param distanceField If true the glyphs are signed distance fields rasterized
+     *                      at the reference size
+     *
+     * @return Font index or -1 if the face couldn't be opened
+     */
+    static int getFont(const std::string& path, unsigned int size, bool distanceField = false);
+
+    /**
+     * Returns the size the glyphs of the font were rasterized at, text is scaled
+     * by its size divided by this
+     */
+    static unsigned int getSize(int font);
+
+    /**
+     * Returns a glyph of the font, rasterizing it if it isn't cached. The
+     * pointer is valid until the next glyph is requested
+     *
+     * @return Glyph or nullptr if it couldn't be rasterized or packed
+     */
+    static const Glyph* getGlyph(int font, unsigned int codepoint);
+
+    /**
+     * Returns the line height of the font in pixels
+     */
+    static float getLineHeight(int font);
+
+    /**
+     * Returns the texture array containing the pages
+     */
+    static Texture* getTexture();
+
+    /**
+     * Returns the generation of the cache, incremented every time a page is evicted
+     */
+    static unsigned int getGeneration();
+
+    /**
+     * Starts a new frame, pages used during the frame become the most recently used
+     */
+    static void beginFrame();
+
+    /**
+     * Marks pages as used this frame, text that isn't laid out again each frame
+     * uses this to keep the pages of its glyphs from being evicted
+     *
+     * @param pages Bit mask of page indices
+     */
+    static void touchPages(unsigned int pages);
+
+    /**
+     * Returns the statistics of the cache
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Row of glyphs with the same height limit
+     */
+    struct Shelf
+    {
+        unsigned int Y = 0;
+        unsigned int Height = 0;
+        unsigned int Width = 0;
+    };
+
+    /**
+     * Layer of the texture array
+     */
+    struct Page
+    {
+        std::vector<Shelf> Shelves;
+
+        /// Height used by the shelves
+        unsigned int Height = 0;
+
+        /// Frame the page was last used in
+        size_t LastUsed = 0;
+
+        /// True once a glyph has been packed into the page
+        bool Used = false;
+    };
+
+    /**
+     * Face at a specific size
+     */
+    struct Font
+    {
+        /// Face index
+        size_t Face = 0;
+
+        /// Size in points
+        unsigned int Size = 0;
+
+        /// True if the glyphs are signed distance fields
+        bool DistanceField = false;
+
+        /// Line height in pixels
+        float LineHeight = 0.0f;
+
+        /// Glyphs of the first ms_flatRange codepoints, looked up without hashing
+        std::vector<Glyph> Flat;
+
+        /// Glyphs of the other codepoints
+        std::unordered_map<unsigned int, Glyph> Other;
+    };
+
+    /**
+     * Opened face
+     */
+    struct Face
+    {
+        std::string Path;
+        FontFace* pFace = nullptr;
+    };
+private:
+    /**
+     * Rasterizes a glyph and packs it into a page
+     */
+    static bool rasterize(Font& font, unsigned int codepoint, Glyph& glyph);
+
+    /**
+     * Finds space for an image in the pages, evicting the least recently used
+     * page when all of them are full
+     *
+     * @return True if space was found
+     */
+    static bool allocate(unsigned int width, unsigned int height, unsigned int& page, unsigned int& x, unsigned int& y);
+
+    /**
+     * Packs an image into a shelf of the page
+     *
+     * @return True if the page had space for it
+     */
+    static bool allocateInPage(Page& page, unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+
+    /**
+     * Removes all glyphs of the page, their space is overwritten by new glyphs
+     */
+    static void evict(unsigned int page);
+private:
+    /// Instance used by the static interface
+    static GlyphCache* ms_pInstance;
+
+    /// Width and height of a page
+    static constexpr unsigned int ms_pageSize = 1024;
+
+    /// Maximum amount of pages, the texture array is created with all of them.
+    /// Pages are passed around as bit masks so there can be at most 32
+    static constexpr unsigned int ms_maxPages = 4;
+
+    /// Codepoints below this are stored in the flat table of a font
+    static constexpr unsigned int ms_flatRange = 256;
+
+    /// Empty pixels around every glyph so filtering doesn't read the neighbours
+    static constexpr unsigned int ms_padding = 1;
+
+    /// Reference size of distance field glyphs in points
+    static constexpr unsigned int ms_distanceFieldSize = 32;
+
+    /// Texels covered by the distance field on both sides of the edge
+    static constexpr unsigned int ms_distanceFieldSpread = 4;
+
+    /// Distance field glyphs are rendered this many times larger and averaged
+    static constexpr unsigned int ms_distanceFieldDownscale = 4;
+
+    /// Texture array holding the pages, created on the render thread
+    Texture* m_pTexture = nullptr;
+
+    std::vector<Page> m_pages;
+    std::vector<Font> m_fonts;
+    std::vector<Face> m_faces;
+
+    /// Current frame and cache generation
+    size_t m_frame = 1;
+    unsigned int m_generation = 0;
+
+    /// Statistics
+    size_t m_rasterized = 0;
+    size_t m_evictions = 0;
+};
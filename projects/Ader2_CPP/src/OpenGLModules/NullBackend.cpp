@@ -0,0 +1,1415 @@
+#include "NullBackend.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Copying info logs
+#include <algorithm>
+#include <cstring>
+
+// Parallel shader compile query, not part of the loaded Glad profile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+NullBackend* NullBackend::ms_pInstance = nullptr;
+
+namespace
+{
+    /**
+     * Returns the size of a pixel with the specified format and type in bytes
+     */
+    size_t getPixelSize(GLenum format, GLenum type)
+    {
+        size_t components = 4;
+        switch (format)
+        {
+        case GL_RED:
+            components = 1;
+            break;
+        case GL_RG:
+            components = 2;
+            break;
+        case GL_RGB:
+            components = 3;
+            break;
+        }
+
+        switch (type)
+        {
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_FLOAT:
+            return components * 4;
+        }
+
+        return components;
+    }
+}
+
+NullBackend::NullBackend()
+{
+    ms_pInstance = this;
+}
+
+NullBackend::~NullBackend()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void NullBackend::configure(const std::string& tracePath, bool validate)
+{
+    NullBackend& s = *ms_pInstance;
+    s.m_tracePath = tracePath;
+    s.m_validate = validate;
+}
+
+void NullBackend::install()
+{
+    NullBackend& s = *ms_pInstance;
+
+    if (!s.m_tracePath.empty())
+    {
+        s.m_trace.open(s.m_tracePath, std::ios::out | std::ios::trunc);
+        if (!s.m_trace.is_open())
+        {
+            LOG_WARN("Can't open trace file '{0}'!", s.m_tracePath);
+        }
+    }
+
+    // Every version is reported as available so the newest code paths run
+    GLAD_GL_VERSION_1_0 = GLAD_GL_VERSION_1_1 = GLAD_GL_VERSION_1_2 = GLAD_GL_VERSION_1_3 = 1;
+    GLAD_GL_VERSION_1_4 = GLAD_GL_VERSION_1_5 = GLAD_GL_VERSION_2_0 = GLAD_GL_VERSION_2_1 = 1;
+    GLAD_GL_VERSION_3_0 = GLAD_GL_VERSION_3_1 = GLAD_GL_VERSION_3_2 = GLAD_GL_VERSION_3_3 = 1;
+    GLAD_GL_VERSION_4_0 = GLAD_GL_VERSION_4_1 = GLAD_GL_VERSION_4_2 = GLAD_GL_VERSION_4_3 = 1;
+    GLAD_GL_VERSION_4_4 = GLAD_GL_VERSION_4_5 = GLAD_GL_VERSION_4_6 = 1;
+
+    // Replace the entry points used by the engine
+    glad_glActiveTexture = &NullBackend::activeTexture;
+    glad_glAttachShader = &NullBackend::attachShader;
+    glad_glBeginQuery = &NullBackend::beginQuery;
+    glad_glBindBuffer = &NullBackend::bindBuffer;
+    glad_glBindBufferRange = &NullBackend::bindBufferRange;
+    glad_glBindFramebuffer = &NullBackend::bindFramebuffer;
+    glad_glBindImageTexture = &NullBackend::bindImageTexture;
+    glad_glBindTexture = &NullBackend::bindTexture;
+    glad_glBindVertexArray = &NullBackend::bindVertexArray;
+    glad_glBlendFunc = &NullBackend::blendFunc;
+    glad_glBlitFramebuffer = &NullBackend::blitFramebuffer;
+    glad_glBufferData = &NullBackend::bufferData;
+    glad_glBufferStorage = &NullBackend::bufferStorage;
+    glad_glBufferSubData = &NullBackend::bufferSubData;
+    glad_glCheckFramebufferStatus = &NullBackend::checkFramebufferStatus;
+    glad_glClear = &NullBackend::clear;
+    glad_glClearColor = &NullBackend::clearColor;
+    glad_glClientWaitSync = &NullBackend::clientWaitSync;
+    glad_glColorMask = &NullBackend::colorMask;
+    glad_glCompileShader = &NullBackend::compileShader;
+    glad_glCompressedTexImage2D = &NullBackend::compressedTexImage2D;
+    glad_glCopyBufferSubData = &NullBackend::copyBufferSubData;
+    glad_glCopyImageSubData = &NullBackend::copyImageSubData;
+    glad_glCreateProgram = &NullBackend::createProgram;
+    glad_glCreateShader = &NullBackend::createShader;
+    glad_glDebugMessageCallback = &NullBackend::debugMessageCallback;
+    glad_glDeleteBuffers = &NullBackend::deleteBuffers;
+    glad_glDeleteFramebuffers = &NullBackend::deleteFramebuffers;
+    glad_glDeleteProgram = &NullBackend::deleteProgram;
+    glad_glDeleteQueries = &NullBackend::deleteQueries;
+    glad_glDeleteShader = &NullBackend::deleteShader;
+    glad_glDeleteSync = &NullBackend::deleteSync;
+    glad_glDeleteTextures = &NullBackend::deleteTextures;
+    glad_glDeleteVertexArrays = &NullBackend::deleteVertexArrays;
+    glad_glDepthFunc = &NullBackend::depthFunc;
+    glad_glDepthMask = &NullBackend::depthMask;
+    glad_glDisable = &NullBackend::disable;
+    glad_glDisableVertexAttribArray = &NullBackend::disableVertexAttribArray;
+    glad_glDispatchCompute = &NullBackend::dispatchCompute;
+    glad_glDrawArrays = &NullBackend::drawArrays;
+    glad_glDrawArraysIndirect = &NullBackend::drawArraysIndirect;
+    glad_glDrawArraysInstanced = &NullBackend::drawArraysInstanced;
+    glad_glDrawArraysInstancedBaseInstance = &NullBackend::drawArraysInstancedBaseInstance;
+    glad_glDrawElements = &NullBackend::drawElements;
+    glad_glDrawElementsIndirect = &NullBackend::drawElementsIndirect;
+    glad_glDrawElementsInstanced = &NullBackend::drawElementsInstanced;
+    glad_glEnable = &NullBackend::enable;
+    glad_glEnableVertexAttribArray = &NullBackend::enableVertexAttribArray;
+    glad_glEndQuery = &NullBackend::endQuery;
+    glad_glFenceSync = &NullBackend::fenceSync;
+    glad_glFramebufferTexture2D = &NullBackend::framebufferTexture2D;
+    glad_glGenBuffers = &NullBackend::genBuffers;
+    glad_glGenerateMipmap = &NullBackend::generateMipmap;
+    glad_glGenFramebuffers = &NullBackend::genFramebuffers;
+    glad_glGenQueries = &NullBackend::genQueries;
+    glad_glGenTextures = &NullBackend::genTextures;
+    glad_glGenVertexArrays = &NullBackend::genVertexArrays;
+    glad_glGetIntegerv = &NullBackend::getIntegerv;
+    glad_glGetProgramBinary = &NullBackend::getProgramBinary;
+    glad_glGetProgramInfoLog = &NullBackend::getProgramInfoLog;
+    glad_glGetProgramiv = &NullBackend::getProgramiv;
+    glad_glGetQueryObjectiv = &NullBackend::getQueryObjectiv;
+    glad_glGetQueryObjectui64v = &NullBackend::getQueryObjectui64v;
+    glad_glGetShaderInfoLog = &NullBackend::getShaderInfoLog;
+    glad_glGetShaderiv = &NullBackend::getShaderiv;
+    glad_glGetString = &NullBackend::getString;
+    glad_glLinkProgram = &NullBackend::linkProgram;
+    glad_glMapBuffer = &NullBackend::mapBuffer;
+    glad_glMapBufferRange = &NullBackend::mapBufferRange;
+    glad_glMemoryBarrier = &NullBackend::memoryBarrier;
+    glad_glMultiDrawArraysIndirect = &NullBackend::multiDrawArraysIndirect;
+    glad_glPixelStorei = &NullBackend::pixelStorei;
+    glad_glPolygonMode = &NullBackend::polygonMode;
+    glad_glProgramBinary = &NullBackend::programBinary;
+    glad_glProgramParameteri = &NullBackend::programParameteri;
+    glad_glShaderSource = &NullBackend::shaderSource;
+    glad_glTexImage2D = &NullBackend::texImage2D;
+    glad_glTexParameteri = &NullBackend::texParameteri;
+    glad_glTexStorage2D = &NullBackend::texStorage2D;
+    glad_glTexStorage3D = &NullBackend::texStorage3D;
+    glad_glTexSubImage2D = &NullBackend::texSubImage2D;
+    glad_glTexSubImage3D = &NullBackend::texSubImage3D;
+    glad_glUniform1i = &NullBackend::uniform1i;
+    glad_glUniform4fv = &NullBackend::uniform4fv;
+    glad_glUniformMatrix4fv = &NullBackend::uniformMatrix4fv;
+    glad_glUnmapBuffer = &NullBackend::unmapBuffer;
+    glad_glUseProgram = &NullBackend::useProgram;
+    glad_glVertexAttribDivisor = &NullBackend::vertexAttribDivisor;
+    glad_glVertexAttribPointer = &NullBackend::vertexAttribPointer;
+    glad_glViewport = &NullBackend::viewport;
+
+    s.m_installed = true;
+    LOG_INFO("Null render backend installed{0}", s.m_validate ? " with validation" : "");
+}
+
+void NullBackend::shutdown()
+{
+    NullBackend& s = *ms_pInstance;
+    if (!s.m_installed)
+    {
+        return;
+    }
+
+    if (s.m_trace.is_open())
+    {
+        s.m_trace.close();
+    }
+
+    Statistics stats = getStatistics();
+    LOG_INFO("Null render backend: {0} frames, {1} calls, {2} draws, {3} binds, {4} KB uploaded, {5} errors",
+        stats.Frames, stats.Calls, stats.Draws, stats.Binds, stats.UploadedBytes / 1024, stats.Errors);
+}
+
+bool NullBackend::isInstalled()
+{
+    return ms_pInstance->m_installed;
+}
+
+void NullBackend::present()
+{
+    NullBackend& s = *ms_pInstance;
+    size_t frame = s.m_frames++;
+
+    if (s.m_trace.is_open())
+    {
+        s.m_trace << "# frame " << frame << '\n';
+    }
+}
+
+NullBackend::Statistics NullBackend::getStatistics()
+{
+    NullBackend& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Frames = s.m_frames;
+    stats.Calls = s.m_calls;
+    stats.Draws = s.m_draws;
+    stats.Instances = s.m_instances;
+    stats.Binds = s.m_binds;
+    stats.UploadedBytes = s.m_uploadedBytes;
+    stats.Errors = s.m_errors;
+    return stats;
+}
+
+void NullBackend::record(const char* name, std::initializer_list<long long> args)
+{
+    m_calls++;
+
+    if (!m_trace.is_open())
+    {
+        return;
+    }
+
+    m_trace << name << '(';
+
+    bool first = true;
+    for (long long arg : args)
+    {
+        if (!first)
+        {
+            m_trace << ", ";
+        }
+
+        m_trace << arg;
+        first = false;
+    }
+
+    m_trace << ")\n";
+}
+
+void NullBackend::error(const std::string& message)
+{
+    if (m_errors++ < ms_loggedErrors)
+    {
+        LOG_WARN("Null backend validation: {0}", message);
+    }
+
+    if (m_trace.is_open())
+    {
+        m_trace << "# error: " << message << '\n';
+    }
+}
+
+GLuint NullBackend::newName()
+{
+    return ++m_lastName;
+}
+
+GLuint& NullBackend::boundBuffer(GLenum target)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        // Without a vertex array the binding goes nowhere, it's kept at name 0
+        return m_vertexArrays[m_vertexArray];
+    }
+
+    return m_boundBuffers[target];
+}
+
+GLuint& NullBackend::boundTexture(GLenum target)
+{
+    return m_boundTextures[((unsigned long long)m_activeUnit << 32) | target];
+}
+
+void NullBackend::draw(const char* name, bool indexed, GLsizei instances)
+{
+    m_draws++;
+    m_instances += instances;
+
+    if (!m_validate)
+    {
+        return;
+    }
+
+    if (m_program == 0)
+    {
+        error(std::string(name) + " without a program");
+    }
+    else if (m_programs.count(m_program) == 0 || !m_programs[m_program])
+    {
+        error(std::string(name) + " with program " + std::to_string(m_program) + " that isn't linked");
+    }
+
+    if (m_vertexArray == 0)
+    {
+        error(std::string(name) + " without a vertex array");
+    }
+    else if (indexed && boundBuffer(GL_ELEMENT_ARRAY_BUFFER) == 0)
+    {
+        error(std::string(name) + " without an element buffer");
+    }
+}
+
+GLsizei NullBackend::indirectInstances(const char* name, size_t offset, size_t size)
+{
+    auto it = m_buffers.find(boundBuffer(GL_DRAW_INDIRECT_BUFFER));
+    if (it == m_buffers.end())
+    {
+        error(std::string(name) + " without an indirect buffer");
+        return 0;
+    }
+
+    if (offset + size > it->second.size())
+    {
+        error(std::string(name) + " outside of buffer " + std::to_string(it->first));
+        return 0;
+    }
+
+    // Instance count is the second value of both command layouts, compute passes
+    // aren't executed so it's whatever was uploaded
+    GLuint instances = 0;
+    memcpy(&instances, it->second.data() + offset + sizeof(GLuint), sizeof(GLuint));
+    return (GLsizei)instances;
+}
+
+void NullBackend::uniform(const char* name)
+{
+    if (m_validate && m_program == 0)
+    {
+        error(std::string(name) + " without a program");
+    }
+}
+
+void NullBackend::uploadPixels(GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pPixels)
+{
+    // With a pixel buffer the data was already counted when the buffer was written
+    if (pPixels && boundBuffer(GL_PIXEL_UNPACK_BUFFER) == 0)
+    {
+        m_uploadedBytes += (size_t)width * height * getPixelSize(format, type);
+    }
+}
+
+void* NullBackend::map(const char* name, GLenum target, GLintptr offset, GLsizeiptr length, bool write)
+{
+    auto it = m_buffers.find(boundBuffer(target));
+    if (it == m_buffers.end())
+    {
+        error(std::string(name) + " without a buffer");
+        return nullptr;
+    }
+
+    if (offset + length > (GLsizeiptr)it->second.size())
+    {
+        error(std::string(name) + " outside of buffer " + std::to_string(it->first));
+        return nullptr;
+    }
+
+    if (write)
+    {
+        m_uploadedBytes += (size_t)length;
+    }
+
+    return it->second.data() + offset;
+}
+
+void APIENTRY NullBackend::activeTexture(GLenum texture)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glActiveTexture", { texture });
+    s.m_activeUnit = texture - GL_TEXTURE0;
+}
+
+void APIENTRY NullBackend::attachShader(GLuint program, GLuint shader)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glAttachShader", { program, shader });
+
+    if (s.m_validate && (s.m_programs.count(program) == 0 || s.m_shaders.count(shader) == 0))
+    {
+        s.error("glAttachShader with unknown program " + std::to_string(program) + " or shader " + std::to_string(shader));
+    }
+}
+
+void APIENTRY NullBackend::beginQuery(GLenum target, GLuint id)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBeginQuery", { target, id });
+
+    if (s.m_validate)
+    {
+        if (s.m_queries.count(id) == 0)
+        {
+            s.error("glBeginQuery with unknown query " + std::to_string(id));
+        }
+        else if (s.m_activeQueries[target] != 0)
+        {
+            s.error("glBeginQuery while query " + std::to_string(s.m_activeQueries[target]) + " is active");
+        }
+    }
+
+    s.m_activeQueries[target] = id;
+}
+
+void APIENTRY NullBackend::bindBuffer(GLenum target, GLuint buffer)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindBuffer", { target, buffer });
+    s.m_binds++;
+
+    if (s.m_validate && buffer != 0 && s.m_buffers.count(buffer) == 0)
+    {
+        s.error("glBindBuffer with unknown buffer " + std::to_string(buffer));
+    }
+
+    s.boundBuffer(target) = buffer;
+}
+
+void APIENTRY NullBackend::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindBufferRange", { target, index, buffer, offset, size });
+    s.m_binds++;
+
+    if (s.m_validate)
+    {
+        auto it = s.m_buffers.find(buffer);
+        if (it == s.m_buffers.end())
+        {
+            s.error("glBindBufferRange with unknown buffer " + std::to_string(buffer));
+        }
+        else if (offset + size > (GLsizeiptr)it->second.size())
+        {
+            s.error("glBindBufferRange outside of buffer " + std::to_string(buffer));
+        }
+    }
+
+    // Also binds the generic binding point
+    s.boundBuffer(target) = buffer;
+}
+
+void APIENTRY NullBackend::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindFramebuffer", { target, framebuffer });
+    s.m_binds++;
+
+    if (s.m_validate && framebuffer != 0 && s.m_framebuffers.count(framebuffer) == 0)
+    {
+        s.error("glBindFramebuffer with unknown framebuffer " + std::to_string(framebuffer));
+    }
+
+    // GL_FRAMEBUFFER binds both the draw and the read framebuffer
+    if (target != GL_READ_FRAMEBUFFER)
+    {
+        s.m_drawFramebuffer = framebuffer;
+    }
+
+    if (target != GL_DRAW_FRAMEBUFFER)
+    {
+        s.m_readFramebuffer = framebuffer;
+    }
+}
+
+void APIENTRY NullBackend::bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindImageTexture", { unit, texture, level, layered, layer, access, format });
+    s.m_binds++;
+
+    if (s.m_validate && texture != 0 && s.m_textures.count(texture) == 0)
+    {
+        s.error("glBindImageTexture with unknown texture " + std::to_string(texture));
+    }
+}
+
+void APIENTRY NullBackend::bindTexture(GLenum target, GLuint texture)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindTexture", { target, texture });
+    s.m_binds++;
+
+    if (s.m_validate && texture != 0)
+    {
+        auto it = s.m_textures.find(texture);
+        if (it == s.m_textures.end())
+        {
+            s.error("glBindTexture with unknown texture " + std::to_string(texture));
+        }
+        else if (it->second != 0 && it->second != target)
+        {
+            s.error("glBindTexture of texture " + std::to_string(texture) + " to a different target");
+        }
+    }
+
+    // The first bind decides the target of the texture
+    auto it = s.m_textures.find(texture);
+    if (it != s.m_textures.end() && it->second == 0)
+    {
+        it->second = target;
+    }
+
+    s.boundTexture(target) = texture;
+}
+
+void APIENTRY NullBackend::bindVertexArray(GLuint array)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBindVertexArray", { array });
+    s.m_binds++;
+
+    if (s.m_validate && array != 0 && s.m_vertexArrays.count(array) == 0)
+    {
+        s.error("glBindVertexArray with unknown vertex array " + std::to_string(array));
+    }
+
+    s.m_vertexArray = array;
+}
+
+void APIENTRY NullBackend::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+    ms_pInstance->record("glBlendFunc", { sfactor, dfactor });
+}
+
+void APIENTRY NullBackend::blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBlitFramebuffer", { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter });
+
+    if (s.m_validate && s.m_readFramebuffer == s.m_drawFramebuffer)
+    {
+        s.error("glBlitFramebuffer from framebuffer " + std::to_string(s.m_readFramebuffer) + " to itself");
+    }
+}
+
+void APIENTRY NullBackend::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBufferData", { target, size, data != nullptr, usage });
+
+    auto it = s.m_buffers.find(s.boundBuffer(target));
+    if (it == s.m_buffers.end())
+    {
+        s.error("glBufferData without a buffer");
+        return;
+    }
+
+    // Buffers have real memory so they can be mapped
+    it->second.assign((size_t)size, 0);
+    if (data)
+    {
+        memcpy(it->second.data(), data, (size_t)size);
+        s.m_uploadedBytes += (size_t)size;
+    }
+}
+
+void APIENTRY NullBackend::bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBufferStorage", { target, size, data != nullptr, flags });
+
+    auto it = s.m_buffers.find(s.boundBuffer(target));
+    if (it == s.m_buffers.end())
+    {
+        s.error("glBufferStorage without a buffer");
+        return;
+    }
+
+    it->second.assign((size_t)size, 0);
+    if (data)
+    {
+        memcpy(it->second.data(), data, (size_t)size);
+        s.m_uploadedBytes += (size_t)size;
+    }
+}
+
+void APIENTRY NullBackend::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glBufferSubData", { target, offset, size });
+
+    void* pDestination = s.map("glBufferSubData", target, offset, size, true);
+    if (pDestination && data)
+    {
+        memcpy(pDestination, data, (size_t)size);
+    }
+}
+
+GLenum APIENTRY NullBackend::checkFramebufferStatus(GLenum target)
+{
+    ms_pInstance->record("glCheckFramebufferStatus", { target });
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void APIENTRY NullBackend::clear(GLbitfield mask)
+{
+    ms_pInstance->record("glClear", { mask });
+}
+
+void APIENTRY NullBackend::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    // Colors are traced in 1/255 steps
+    ms_pInstance->record("glClearColor", { (long long)(red * 255), (long long)(green * 255), (long long)(blue * 255), (long long)(alpha * 255) });
+}
+
+GLenum APIENTRY NullBackend::clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    ms_pInstance->record("glClientWaitSync", { (long long)(size_t)sync, flags, (long long)timeout });
+
+    // There is no GPU to wait for
+    return GL_ALREADY_SIGNALED;
+}
+
+void APIENTRY NullBackend::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    ms_pInstance->record("glColorMask", { red, green, blue, alpha });
+}
+
+void APIENTRY NullBackend::compileShader(GLuint shader)
+{
+    ms_pInstance->record("glCompileShader", { shader });
+}
+
+void APIENTRY NullBackend::compressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glCompressedTexImage2D", { target, level, internalformat, width, height, border, imageSize });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glCompressedTexImage2D without a texture");
+    }
+
+    if (data && s.boundBuffer(GL_PIXEL_UNPACK_BUFFER) == 0)
+    {
+        s.m_uploadedBytes += (size_t)imageSize;
+    }
+}
+
+void APIENTRY NullBackend::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glCopyBufferSubData", { readTarget, writeTarget, readOffset, writeOffset, size });
+
+    // Copies stay on the device, they don't count as uploaded
+    void* pSource = s.map("glCopyBufferSubData", readTarget, readOffset, size, false);
+    void* pDestination = s.map("glCopyBufferSubData", writeTarget, writeOffset, size, false);
+    if (pSource && pDestination)
+    {
+        memmove(pDestination, pSource, (size_t)size);
+    }
+}
+
+void APIENTRY NullBackend::copyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glCopyImageSubData", { srcName, srcTarget, srcLevel, srcX, srcY, srcZ, dstName, dstTarget, dstLevel, dstX, dstY, dstZ, srcWidth, srcHeight, srcDepth });
+
+    if (s.m_validate && (s.m_textures.count(srcName) == 0 || s.m_textures.count(dstName) == 0))
+    {
+        s.error("glCopyImageSubData with unknown texture " + std::to_string(srcName) + " or " + std::to_string(dstName));
+    }
+}
+
+GLuint APIENTRY NullBackend::createProgram()
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glCreateProgram", {});
+
+    GLuint name = s.newName();
+    s.m_programs[name] = false;
+    return name;
+}
+
+GLuint APIENTRY NullBackend::createShader(GLenum type)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glCreateShader", { type });
+
+    GLuint name = s.newName();
+    s.m_shaders[name] = type;
+    return name;
+}
+
+void APIENTRY NullBackend::debugMessageCallback(GLDEBUGPROC callback, const void* userParam)
+{
+    // Validation errors are reported through the log instead
+    ms_pInstance->record("glDebugMessageCallback", {});
+}
+
+void APIENTRY NullBackend::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.record("glDeleteBuffers", { 1, buffers[i] });
+
+        if (s.m_buffers.erase(buffers[i]) == 0 && s.m_validate && buffers[i] != 0)
+        {
+            s.error("glDeleteBuffers with unknown buffer " + std::to_string(buffers[i]));
+        }
+
+        // Deleted buffers are unbound
+        for (auto& it : s.m_boundBuffers)
+        {
+            if (it.second == buffers[i])
+            {
+                it.second = 0;
+            }
+        }
+    }
+}
+
+void APIENTRY NullBackend::deleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.record("glDeleteFramebuffers", { 1, framebuffers[i] });
+
+        if (s.m_framebuffers.erase(framebuffers[i]) == 0 && s.m_validate && framebuffers[i] != 0)
+        {
+            s.error("glDeleteFramebuffers with unknown framebuffer " + std::to_string(framebuffers[i]));
+        }
+
+        // Deleting a bound framebuffer binds the default one
+        if (s.m_drawFramebuffer == framebuffers[i])
+        {
+            s.m_drawFramebuffer = 0;
+        }
+
+        if (s.m_readFramebuffer == framebuffers[i])
+        {
+            s.m_readFramebuffer = 0;
+        }
+    }
+}
+
+void APIENTRY NullBackend::deleteProgram(GLuint program)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDeleteProgram", { program });
+
+    if (s.m_programs.erase(program) == 0 && s.m_validate && program != 0)
+    {
+        s.error("glDeleteProgram with unknown program " + std::to_string(program));
+    }
+
+    if (s.m_program == program)
+    {
+        s.m_program = 0;
+    }
+}
+
+void APIENTRY NullBackend::deleteQueries(GLsizei n, const GLuint* ids)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.record("glDeleteQueries", { 1, ids[i] });
+
+        if (s.m_queries.erase(ids[i]) == 0 && s.m_validate && ids[i] != 0)
+        {
+            s.error("glDeleteQueries with unknown query " + std::to_string(ids[i]));
+        }
+    }
+}
+
+void APIENTRY NullBackend::deleteShader(GLuint shader)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDeleteShader", { shader });
+
+    if (s.m_shaders.erase(shader) == 0 && s.m_validate && shader != 0)
+    {
+        s.error("glDeleteShader with unknown shader " + std::to_string(shader));
+    }
+}
+
+void APIENTRY NullBackend::deleteSync(GLsync sync)
+{
+    ms_pInstance->record("glDeleteSync", { (long long)(size_t)sync });
+}
+
+void APIENTRY NullBackend::deleteTextures(GLsizei n, const GLuint* textures)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.record("glDeleteTextures", { 1, textures[i] });
+
+        if (s.m_textures.erase(textures[i]) == 0 && s.m_validate && textures[i] != 0)
+        {
+            s.error("glDeleteTextures with unknown texture " + std::to_string(textures[i]));
+        }
+
+        for (auto& it : s.m_boundTextures)
+        {
+            if (it.second == textures[i])
+            {
+                it.second = 0;
+            }
+        }
+    }
+}
+
+void APIENTRY NullBackend::deleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        s.record("glDeleteVertexArrays", { 1, arrays[i] });
+
+        if (arrays[i] != 0 && s.m_vertexArrays.erase(arrays[i]) == 0 && s.m_validate)
+        {
+            s.error("glDeleteVertexArrays with unknown vertex array " + std::to_string(arrays[i]));
+        }
+
+        if (s.m_vertexArray == arrays[i])
+        {
+            s.m_vertexArray = 0;
+        }
+    }
+}
+
+void APIENTRY NullBackend::depthFunc(GLenum func)
+{
+    ms_pInstance->record("glDepthFunc", { func });
+}
+
+void APIENTRY NullBackend::depthMask(GLboolean flag)
+{
+    ms_pInstance->record("glDepthMask", { flag });
+}
+
+void APIENTRY NullBackend::disable(GLenum cap)
+{
+    ms_pInstance->record("glDisable", { cap });
+}
+
+void APIENTRY NullBackend::disableVertexAttribArray(GLuint index)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDisableVertexAttribArray", { index });
+
+    if (s.m_validate && s.m_vertexArray == 0)
+    {
+        s.error("glDisableVertexAttribArray without a vertex array");
+    }
+}
+
+void APIENTRY NullBackend::dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDispatchCompute", { num_groups_x, num_groups_y, num_groups_z });
+
+    // Nothing is executed, buffers written by the dispatch keep their contents
+    if (s.m_validate && s.m_program == 0)
+    {
+        s.error("glDispatchCompute without a program");
+    }
+}
+
+void APIENTRY NullBackend::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawArrays", { mode, first, count });
+    s.draw("glDrawArrays", false, 1);
+}
+
+void APIENTRY NullBackend::drawArraysIndirect(GLenum mode, const void* indirect)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawArraysIndirect", { mode, (long long)(size_t)indirect });
+    s.draw("glDrawArraysIndirect", false, s.indirectInstances("glDrawArraysIndirect", (size_t)indirect, 4 * sizeof(GLuint)));
+}
+
+void APIENTRY NullBackend::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawArraysInstanced", { mode, first, count, instancecount });
+    s.draw("glDrawArraysInstanced", false, instancecount);
+}
+
+void APIENTRY NullBackend::drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawArraysInstancedBaseInstance", { mode, first, count, instancecount, baseinstance });
+    s.draw("glDrawArraysInstancedBaseInstance", false, instancecount);
+}
+
+void APIENTRY NullBackend::drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawElements", { mode, count, type, (long long)(size_t)indices });
+    s.draw("glDrawElements", true, 1);
+}
+
+void APIENTRY NullBackend::drawElementsIndirect(GLenum mode, GLenum type, const void* indirect)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawElementsIndirect", { mode, type, (long long)(size_t)indirect });
+    s.draw("glDrawElementsIndirect", true, s.indirectInstances("glDrawElementsIndirect", (size_t)indirect, 5 * sizeof(GLuint)));
+}
+
+void APIENTRY NullBackend::drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glDrawElementsInstanced", { mode, count, type, (long long)(size_t)indices, instancecount });
+    s.draw("glDrawElementsInstanced", true, instancecount);
+}
+
+void APIENTRY NullBackend::enable(GLenum cap)
+{
+    ms_pInstance->record("glEnable", { cap });
+}
+
+void APIENTRY NullBackend::enableVertexAttribArray(GLuint index)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glEnableVertexAttribArray", { index });
+
+    if (s.m_validate && s.m_vertexArray == 0)
+    {
+        s.error("glEnableVertexAttribArray without a vertex array");
+    }
+}
+
+void APIENTRY NullBackend::endQuery(GLenum target)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glEndQuery", { target });
+
+    if (s.m_validate && s.m_activeQueries[target] == 0)
+    {
+        s.error("glEndQuery without an active query");
+    }
+
+    s.m_activeQueries[target] = 0;
+}
+
+GLsync APIENTRY NullBackend::fenceSync(GLenum condition, GLbitfield flags)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glFenceSync", { condition, flags });
+
+    // Fences only have to be unique and not null
+    return reinterpret_cast<GLsync>(++s.m_lastFence);
+}
+
+void APIENTRY NullBackend::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glFramebufferTexture2D", { target, attachment, textarget, texture, level });
+
+    if (!s.m_validate)
+    {
+        return;
+    }
+
+    if ((target == GL_READ_FRAMEBUFFER ? s.m_readFramebuffer : s.m_drawFramebuffer) == 0)
+    {
+        s.error("glFramebufferTexture2D on the default framebuffer");
+    }
+
+    if (texture != 0 && s.m_textures.count(texture) == 0)
+    {
+        s.error("glFramebufferTexture2D with unknown texture " + std::to_string(texture));
+    }
+}
+
+void APIENTRY NullBackend::genBuffers(GLsizei n, GLuint* buffers)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        buffers[i] = s.newName();
+        s.m_buffers[buffers[i]];
+        s.record("glGenBuffers", { 1, buffers[i] });
+    }
+}
+
+void APIENTRY NullBackend::generateMipmap(GLenum target)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glGenerateMipmap", { target });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glGenerateMipmap without a texture");
+    }
+}
+
+void APIENTRY NullBackend::genFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        framebuffers[i] = s.newName();
+        s.m_framebuffers.insert(framebuffers[i]);
+        s.record("glGenFramebuffers", { 1, framebuffers[i] });
+    }
+}
+
+void APIENTRY NullBackend::genQueries(GLsizei n, GLuint* ids)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        ids[i] = s.newName();
+        s.m_queries.insert(ids[i]);
+        s.record("glGenQueries", { 1, ids[i] });
+    }
+}
+
+void APIENTRY NullBackend::genTextures(GLsizei n, GLuint* textures)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        textures[i] = s.newName();
+        s.m_textures[textures[i]] = 0;
+        s.record("glGenTextures", { 1, textures[i] });
+    }
+}
+
+void APIENTRY NullBackend::genVertexArrays(GLsizei n, GLuint* arrays)
+{
+    NullBackend& s = *ms_pInstance;
+    for (GLsizei i = 0; i < n; i++)
+    {
+        arrays[i] = s.newName();
+        s.m_vertexArrays[arrays[i]] = 0;
+        s.record("glGenVertexArrays", { 1, arrays[i] });
+    }
+}
+
+void APIENTRY NullBackend::getIntegerv(GLenum pname, GLint* data)
+{
+    ms_pInstance->record("glGetIntegerv", { pname });
+
+    // Limits of a typical desktop driver, program binaries aren't supported
+    switch (pname)
+    {
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+        *data = 256;
+        break;
+    case GL_MAX_TEXTURE_SIZE:
+        *data = 16384;
+        break;
+    case GL_MAX_ARRAY_TEXTURE_LAYERS:
+        *data = 2048;
+        break;
+    default:
+        *data = 0;
+        break;
+    }
+}
+
+void APIENTRY NullBackend::getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+    ms_pInstance->record("glGetProgramBinary", { program, bufSize });
+
+    if (length)
+    {
+        *length = 0;
+    }
+}
+
+void APIENTRY NullBackend::getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    ms_pInstance->record("glGetProgramInfoLog", { program, bufSize });
+
+    if (length)
+    {
+        *length = 0;
+    }
+
+    if (infoLog && bufSize > 0)
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void APIENTRY NullBackend::getProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glGetProgramiv", { program, pname });
+
+    switch (pname)
+    {
+    case GL_LINK_STATUS:
+    {
+        auto it = s.m_programs.find(program);
+        *params = it != s.m_programs.end() && it->second ? GL_TRUE : GL_FALSE;
+        break;
+    }
+    case GL_COMPLETION_STATUS_KHR:
+        *params = GL_TRUE;
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+}
+
+void APIENTRY NullBackend::getQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+    ms_pInstance->record("glGetQueryObjectiv", { id, pname });
+
+    // Nothing is executed so results are available immediately and take no time
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void APIENTRY NullBackend::getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+    ms_pInstance->record("glGetQueryObjectui64v", { id, pname });
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void APIENTRY NullBackend::getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+    ms_pInstance->record("glGetShaderInfoLog", { shader, bufSize });
+
+    if (length)
+    {
+        *length = 0;
+    }
+
+    if (infoLog && bufSize > 0)
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void APIENTRY NullBackend::getShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    ms_pInstance->record("glGetShaderiv", { shader, pname });
+
+    // Every shader compiles
+    *params = pname == GL_COMPILE_STATUS || pname == GL_COMPLETION_STATUS_KHR ? GL_TRUE : 0;
+}
+
+const GLubyte* APIENTRY NullBackend::getString(GLenum name)
+{
+    ms_pInstance->record("glGetString", { name });
+
+    const char* pValue = "";
+    switch (name)
+    {
+    case GL_VENDOR:
+        pValue = "Ader";
+        break;
+    case GL_RENDERER:
+        pValue = "Null backend";
+        break;
+    case GL_VERSION:
+        pValue = "4.6.0 Null";
+        break;
+    case GL_SHADING_LANGUAGE_VERSION:
+        pValue = "4.60";
+        break;
+    }
+
+    return reinterpret_cast<const GLubyte*>(pValue);
+}
+
+void APIENTRY NullBackend::linkProgram(GLuint program)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glLinkProgram", { program });
+
+    auto it = s.m_programs.find(program);
+    if (it == s.m_programs.end())
+    {
+        s.error("glLinkProgram with unknown program " + std::to_string(program));
+        return;
+    }
+
+    it->second = true;
+}
+
+void* APIENTRY NullBackend::mapBuffer(GLenum target, GLenum access)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glMapBuffer", { target, access });
+
+    auto it = s.m_buffers.find(s.boundBuffer(target));
+    GLsizeiptr size = it != s.m_buffers.end() ? (GLsizeiptr)it->second.size() : 0;
+    return s.map("glMapBuffer", target, 0, size, access != GL_READ_ONLY);
+}
+
+void* APIENTRY NullBackend::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glMapBufferRange", { target, offset, length, access });
+
+    // Writes through persistent mappings can't be seen, only the mapping is counted
+    bool write = (access & GL_MAP_WRITE_BIT) && !(access & GL_MAP_PERSISTENT_BIT);
+    return s.map("glMapBufferRange", target, offset, length, write);
+}
+
+void APIENTRY NullBackend::memoryBarrier(GLbitfield barriers)
+{
+    ms_pInstance->record("glMemoryBarrier", { barriers });
+}
+
+void APIENTRY NullBackend::multiDrawArraysIndirect(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glMultiDrawArraysIndirect", { mode, (long long)(size_t)indirect, drawcount, stride });
+
+    // Every command is counted as a draw, a stride of 0 means tightly packed
+    size_t commandSize = 4 * sizeof(GLuint);
+    size_t step = stride == 0 ? commandSize : (size_t)stride;
+    for (GLsizei i = 0; i < drawcount; i++)
+    {
+        size_t offset = (size_t)indirect + i * step;
+        s.draw("glMultiDrawArraysIndirect", false, s.indirectInstances("glMultiDrawArraysIndirect", offset, commandSize));
+    }
+}
+
+void APIENTRY NullBackend::pixelStorei(GLenum pname, GLint param)
+{
+    ms_pInstance->record("glPixelStorei", { pname, param });
+}
+
+void APIENTRY NullBackend::polygonMode(GLenum face, GLenum mode)
+{
+    ms_pInstance->record("glPolygonMode", { face, mode });
+}
+
+void APIENTRY NullBackend::programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glProgramBinary", { program, binaryFormat, length });
+
+    // No binary formats are reported, so a binary is never valid
+    s.m_programs[program] = false;
+}
+
+void APIENTRY NullBackend::programParameteri(GLuint program, GLenum pname, GLint value)
+{
+    ms_pInstance->record("glProgramParameteri", { program, pname, value });
+}
+
+void APIENTRY NullBackend::shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glShaderSource", { shader, count });
+
+    if (s.m_validate && s.m_shaders.count(shader) == 0)
+    {
+        s.error("glShaderSource with unknown shader " + std::to_string(shader));
+    }
+}
+
+void APIENTRY NullBackend::texImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexImage2D", { target, level, internalformat, width, height, border, format, type, pixels != nullptr });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexImage2D without a texture");
+    }
+
+    s.uploadPixels(width, height, format, type, pixels);
+}
+
+void APIENTRY NullBackend::texParameteri(GLenum target, GLenum pname, GLint param)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexParameteri", { target, pname, param });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexParameteri without a texture");
+    }
+}
+
+void APIENTRY NullBackend::texStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexStorage2D", { target, levels, internalformat, width, height });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexStorage2D without a texture");
+    }
+}
+
+void APIENTRY NullBackend::texStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexStorage3D", { target, levels, internalformat, width, height, depth });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexStorage3D without a texture");
+    }
+}
+
+void APIENTRY NullBackend::texSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexSubImage2D", { target, level, xoffset, yoffset, width, height, format, type, (long long)(size_t)pixels });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexSubImage2D without a texture");
+    }
+
+    s.uploadPixels(width, height, format, type, pixels);
+}
+
+void APIENTRY NullBackend::texSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glTexSubImage3D", { target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, (long long)(size_t)pixels });
+
+    if (s.m_validate && s.boundTexture(target) == 0)
+    {
+        s.error("glTexSubImage3D without a texture");
+    }
+}
+
+void APIENTRY NullBackend::uniform1i(GLint location, GLint v0)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glUniform1i", { location, v0 });
+    s.uniform("glUniform1i");
+}
+
+void APIENTRY NullBackend::uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glUniform4fv", { location, count });
+    s.uniform("glUniform4fv");
+}
+
+void APIENTRY NullBackend::uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glUniformMatrix4fv", { location, count, transpose });
+    s.uniform("glUniformMatrix4fv");
+}
+
+GLboolean APIENTRY NullBackend::unmapBuffer(GLenum target)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glUnmapBuffer", { target });
+
+    if (s.m_validate && s.boundBuffer(target) == 0)
+    {
+        s.error("glUnmapBuffer without a buffer");
+    }
+
+    return GL_TRUE;
+}
+
+void APIENTRY NullBackend::useProgram(GLuint program)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glUseProgram", { program });
+    s.m_binds++;
+
+    if (s.m_validate && program != 0 && s.m_programs.count(program) == 0)
+    {
+        s.error("glUseProgram with unknown program " + std::to_string(program));
+    }
+
+    s.m_program = program;
+}
+
+void APIENTRY NullBackend::vertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    ms_pInstance->record("glVertexAttribDivisor", { index, divisor });
+}
+
+void APIENTRY NullBackend::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    NullBackend& s = *ms_pInstance;
+    s.record("glVertexAttribPointer", { index, size, type, normalized, stride, (long long)(size_t)pointer });
+
+    if (s.m_validate && (s.m_vertexArray == 0 || s.boundBuffer(GL_ARRAY_BUFFER) == 0))
+    {
+        s.error("glVertexAttribPointer without a vertex array or an array buffer");
+    }
+}
+
+void APIENTRY NullBackend::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    ms_pInstance->record("glViewport", { x, y, width, height });
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+// Trace file
+#include <string>
+#include <fstream>
+
+// Object names and buffer memory
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// Statistics are read from the game thread
+#include <atomic>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * Null backend replaces the OpenGL entry points loaded by Glad with a recorder,
+ * so the renderer runs without a GPU or a window. Nothing is drawn, but every
+ * call is counted and can be written to a trace file, and the recorder can
+ * validate the state the calls are made with (unknown names, missing bindings,
+ * draws without a program or a vertex array). Buffers get real memory so
+ * mapping and persistent mapping keep working.
+ *
+ * Only the entry points used by the engine are replaced, anything else stays
+ * unloaded. The backend is installed and used on the thread executing render
+ * commands, statistics can be read from any thread.
+ */
+class NullBackend
+{
+public:
+    /**
+     * Statistics of the recorded calls since the backend was installed
+     */
+    struct Statistics
+    {
+        /// Presented frames
+        size_t Frames = 0;
+
+        /// Recorded calls
+        size_t Calls = 0;
+
+        /// Draw calls and the instances they drew
+        size_t Draws = 0;
+        size_t Instances = 0;
+
+        /// Program, vertex array, buffer and texture binds
+        size_t Binds = 0;
+
+        /// Bytes uploaded from client memory to buffers and textures
+        size_t UploadedBytes = 0;
+
+        /// Calls that failed validation
+        size_t Errors = 0;
+    };
+public:
+    NullBackend();
+
+    ~NullBackend();
+
+    /**
+     * Sets the options of the backend, must be called before it's installed
+     *
+     * @param tracePath File the calls are written to, empty to not write a trace
+     * @param validate If true the state of each call is validated
+     */
+    static void configure(const std::string& tracePath, bool validate);
+
+    /**
+     * Replaces the Glad entry points with the recorder
+     */
+    static void install();
+
+    /**
+     * Closes the trace and reports the statistics
+     */
+    static void shutdown();
+
+    /**
+     * Returns true if the backend has been installed
+     */
+    static bool isInstalled();
+
+    /**
+     * Ends the current frame, used instead of swapping window buffers
+     */
+    static void present();
+
+    /**
+     * Returns the statistics of the recorder
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Writes a call to the trace and counts it
+     */
+    void record(const char* name, std::initializer_list<long long> args);
+
+    /**
+     * Reports a call that failed validation
+     */
+    void error(const std::string& message);
+
+    /**
+     * Returns a new object name
+     */
+    GLuint newName();
+
+    /**
+     * Returns the buffer bound to the target, the element buffer is part of the vertex array
+     */
+    GLuint& boundBuffer(GLenum target);
+
+    /**
+     * Returns the texture bound to the target of the active unit
+     */
+    GLuint& boundTexture(GLenum target);
+
+    /**
+     * Validates a draw call and counts it
+     */
+    void draw(const char* name, bool indexed, GLsizei instances);
+
+    /**
+     * Returns the instance count of an indirect draw command, commands are read
+     * from the memory of the bound draw indirect buffer
+     *
+     * @param name Name of the draw call
+     * @param offset Offset of the command in the buffer
+     * @param size Size of the command
+     */
+    GLsizei indirectInstances(const char* name, size_t offset, size_t size);
+
+    /**
+     * Validates that a uniform is set with a program in use
+     */
+    void uniform(const char* name);
+
+    /**
+     * Counts a texture upload from client memory
+     */
+    void uploadPixels(GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pPixels);
+
+    /**
+     * Returns the memory of a mapped range of the buffer bound to the target
+     */
+    void* map(const char* name, GLenum target, GLintptr offset, GLsizeiptr length, bool write);
+
+    // Entry points, named after the OpenGL function without the gl prefix
+    static void APIENTRY activeTexture(GLenum texture);
+    static void APIENTRY attachShader(GLuint program, GLuint shader);
+    static void APIENTRY beginQuery(GLenum target, GLuint id);
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer);
+    static void APIENTRY bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    static void APIENTRY bindFramebuffer(GLenum target, GLuint framebuffer);
+    static void APIENTRY bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+    static void APIENTRY bindTexture(GLenum target, GLuint texture);
+    static void APIENTRY bindVertexArray(GLuint array);
+    static void APIENTRY blendFunc(GLenum sfactor, GLenum dfactor);
+    static void APIENTRY blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+    static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    static void APIENTRY bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+    static void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+    static GLenum APIENTRY checkFramebufferStatus(GLenum target);
+    static void APIENTRY clear(GLbitfield mask);
+    static void APIENTRY clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    static GLenum APIENTRY clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+    static void APIENTRY colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+    static void APIENTRY compileShader(GLuint shader);
+    static void APIENTRY compressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data);
+    static void APIENTRY copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+    static void APIENTRY copyImageSubData(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ, GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ, GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
+    static GLuint APIENTRY createProgram();
+    static GLuint APIENTRY createShader(GLenum type);
+    static void APIENTRY debugMessageCallback(GLDEBUGPROC callback, const void* userParam);
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers);
+    static void APIENTRY deleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+    static void APIENTRY deleteProgram(GLuint program);
+    static void APIENTRY deleteQueries(GLsizei n, const GLuint* ids);
+    static void APIENTRY deleteShader(GLuint shader);
+    static void APIENTRY deleteSync(GLsync sync);
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures);
+    static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays);
+    static void APIENTRY depthFunc(GLenum func);
+    static void APIENTRY depthMask(GLboolean flag);
+    static void APIENTRY disable(GLenum cap);
+    static void APIENTRY disableVertexAttribArray(GLuint index);
+    static void APIENTRY dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count);
+    static void APIENTRY drawArraysIndirect(GLenum mode, const void* indirect);
+    static void APIENTRY drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+    static void APIENTRY drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance);
+    static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+    static void APIENTRY drawElementsIndirect(GLenum mode, GLenum type, const void* indirect);
+    static void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+    static void APIENTRY enable(GLenum cap);
+    static void APIENTRY enableVertexAttribArray(GLuint index);
+    static void APIENTRY endQuery(GLenum target);
+    static GLsync APIENTRY fenceSync(GLenum condition, GLbitfield flags);
+    static void APIENTRY framebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    static void APIENTRY genBuffers(GLsizei n, GLuint* buffers);
+    static void APIENTRY generateMipmap(GLenum target);
+    static void APIENTRY genFramebuffers(GLsizei n, GLuint* framebuffers);
+    static void APIENTRY genQueries(GLsizei n, GLuint* ids);
+    static void APIENTRY genTextures(GLsizei n, GLuint* textures);
+    static void APIENTRY genVertexArrays(GLsizei n, GLuint* arrays);
+    static void APIENTRY getIntegerv(GLenum pname, GLint* data);
+    static void APIENTRY getProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    static void APIENTRY getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    static void APIENTRY getProgramiv(GLuint program, GLenum pname, GLint* params);
+    static void APIENTRY getQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+    static void APIENTRY getQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+    static void APIENTRY getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    static void APIENTRY getShaderiv(GLuint shader, GLenum pname, GLint* params);
+    static const GLubyte* APIENTRY getString(GLenum name);
+    static void APIENTRY linkProgram(GLuint program);
+    static void* APIENTRY mapBuffer(GLenum target, GLenum access);
+    static void* APIENTRY mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    static void APIENTRY memoryBarrier(GLbitfield barriers);
+    static void APIENTRY multiDrawArraysIndirect(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride);
+    static void APIENTRY pixelStorei(GLenum pname, GLint param);
+    static void APIENTRY polygonMode(GLenum face, GLenum mode);
+    static void APIENTRY programBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    static void APIENTRY programParameteri(GLuint program, GLenum pname, GLint value);
+    static void APIENTRY shaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+    static void APIENTRY texImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY texParameteri(GLenum target, GLenum pname, GLint param);
+    static void APIENTRY texStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+    static void APIENTRY texStorage3D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+    static void APIENTRY texSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY texSubImage3D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels);
+    static void APIENTRY uniform1i(GLint location, GLint v0);
+    static void APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+    static void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    static GLboolean APIENTRY unmapBuffer(GLenum target);
+    static void APIENTRY useProgram(GLuint program);
+    static void APIENTRY vertexAttribDivisor(GLuint index, GLuint divisor);
+    static void APIENTRY vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    static void APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+private:
+    /// Instance used by the static interface and the entry points
+    static NullBackend* ms_pInstance;
+
+    /// Errors that are logged, the rest are only counted
+    static constexpr size_t ms_loggedErrors = 16;
+
+    /// Options
+    std::string m_tracePath;
+    bool m_validate = false;
+
+    /// True once the entry points have been replaced
+    bool m_installed = false;
+
+    /// Trace file, written on the thread executing render commands
+    std::ofstream m_trace;
+
+    /// Last object name, names are unique across all object types
+    GLuint m_lastName = 0;
+
+    /// Existing objects
+    std::unordered_map<GLuint, std::vector<unsigned char>> m_buffers;
+    std::unordered_map<GLuint, GLuint> m_vertexArrays;
+    std::unordered_map<GLuint, bool> m_programs;
+    std::unordered_map<GLuint, GLenum> m_shaders;
+    std::unordered_map<GLuint, GLenum> m_textures;
+    std::unordered_set<GLuint> m_queries;
+    std::unordered_set<GLuint> m_framebuffers;
+
+    /// Current bindings, textures are keyed by unit and target
+    GLuint m_program = 0;
+    GLuint m_vertexArray = 0;
+    GLuint m_drawFramebuffer = 0;
+    GLuint m_readFramebuffer = 0;
+    GLuint m_activeUnit = 0;
+    std::unordered_map<GLenum, GLuint> m_boundBuffers;
+    std::unordered_map<unsigned long long, GLuint> m_boundTextures;
+    std::unordered_map<GLenum, GLuint> m_activeQueries;
+
+    /// Last fence handed out
+    size_t m_lastFence = 0;
+
+    /// Statistics
+    std::atomic<size_t> m_frames{ 0 };
+    std::atomic<size_t> m_calls{ 0 };
+    std::atomic<size_t> m_draws{ 0 };
+    std::atomic<size_t> m_instances{ 0 };
+    std::atomic<size_t> m_binds{ 0 };
+    std::atomic<size_t> m_uploadedBytes{ 0 };
+    std::atomic<size_t> m_errors{ 0 };
+};
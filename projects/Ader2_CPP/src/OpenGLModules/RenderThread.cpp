@@ -0,0 +1,271 @@
+#include "RenderThread.h"
+
+// Measuring render thread utilization
+#include <chrono>
+
+// CPU scopes
+#include "Utility/Profiler.h"
+
+RenderThread* RenderThread::ms_pInstance = nullptr;
+
+CommandBuffer::CommandBuffer()
+{
+}
+
+CommandBuffer::~CommandBuffer()
+{
+}
+
+void* CommandBuffer::allocate(size_t size, size_t alignment)
+{
+    // Try to fit the allocation in the current or one of the following pages
+    while (m_page < m_pages.size())
+    {
+        Page& page = m_pages[m_page];
+
+        // Align the offset
+        size_t offset = (page.Used + alignment - 1) & ~(alignment - 1);
+
+        if (offset + size <= page.Size)
+        {
+            page.Used = offset + size;
+            m_bytes += size;
+            return page.Memory.get() + offset;
+        }
+
+        m_page++;
+    }
+
+    // No page has enough space so create a new one, large allocations get their own page
+    Page page;
+    page.Size = std::max(ms_pageSize, size + alignment);
+    page.Memory.reset(new unsigned char[page.Size]);
+    m_pages.push_back(std::move(page));
+
+    return allocate(size, alignment);
+}
+
+void CommandBuffer::execute()
+{
+    // Execute commands in recorded order
+    for (Command* pCommand = m_pFirst; pCommand != nullptr; pCommand = pCommand->pNext)
+    {
+        pCommand->Execute(pCommand->pFn);
+    }
+
+    // Reset the buffer but keep the pages
+    for (Page& page : m_pages)
+    {
+        page.Used = 0;
+    }
+
+    m_page = 0;
+    m_pFirst = nullptr;
+    m_pLast = nullptr;
+    m_count = 0;
+    m_bytes = 0;
+}
+
+size_t CommandBuffer::count() const
+{
+    return m_count;
+}
+
+size_t CommandBuffer::bytes() const
+{
+    return m_bytes;
+}
+
+RenderThread::RenderThread()
+{
+    ms_pInstance = this;
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::start(GLFWwindow* pWindow, bool threaded)
+{
+    m_pWindow = pWindow;
+    m_threaded = threaded;
+
+    if (!m_threaded)
+    {
+        // Commands will be executed on this thread
+        glfwMakeContextCurrent(m_pWindow);
+        return;
+    }
+
+    // The context can only be current on one thread
+    glfwMakeContextCurrent(nullptr);
+
+    // Start the render thread
+    m_running = true;
+    m_thread = std::thread(&RenderThread::loop, this);
+    m_executorId = m_thread.get_id();
+}
+
+void RenderThread::stop()
+{
+    if (!m_threaded)
+    {
+        return;
+    }
+
+    // Execute everything that has been recorded so far
+    sync();
+
+    // Stop the thread
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+
+    m_submittedCondition.notify_one();
+    m_thread.join();
+
+    // From now on commands are executed on this thread
+    m_threaded = false;
+    m_executorId = std::thread::id();
+    glfwMakeContextCurrent(m_pWindow);
+}
+
+void RenderThread::submit()
+{
+    CommandBuffer& buffer = m_buffers[recordIndex()];
+
+    // Save the statistics of the frame
+    m_queueDepth = buffer.count();
+    m_queueBytes = buffer.bytes();
+
+    if (!m_threaded)
+    {
+        // Execute the frame on this thread
+        m_executorId = std::this_thread::get_id();
+        buffer.execute();
+        m_executorId = std::thread::id();
+
+        m_submitted++;
+        m_completed++;
+        return;
+    }
+
+    // The other buffer is free once the render thread has finished the previous frame
+    waitIdle();
+
+    // Hand over the frame, the release makes the recorded commands visible to the render thread
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_submitted.fetch_add(1, std::memory_order_release);
+    }
+
+    m_submittedCondition.notify_one();
+}
+
+RenderThread::Statistics RenderThread::getStatistics() const
+{
+    Statistics stats;
+    stats.QueueDepth = m_queueDepth;
+    stats.QueueBytes = m_queueBytes;
+    stats.Utilization = m_threaded ? m_utilization.load() : 1.0f;
+    return stats;
+}
+
+void RenderThread::sync()
+{
+    // Executing thread has nothing to wait for
+    if (ms_pInstance->isExecutor())
+    {
+        return;
+    }
+
+    ms_pInstance->submit();
+    ms_pInstance->waitIdle();
+}
+
+bool RenderThread::isExecutor() const
+{
+    return std::this_thread::get_id() == m_executorId;
+}
+
+size_t RenderThread::recordIndex() const
+{
+    return m_submitted.load(std::memory_order_relaxed) % 2;
+}
+
+void RenderThread::waitIdle() const
+{
+    // Nothing is being executed
+    if (m_completed.load(std::memory_order_acquire) == m_submitted.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Block until the render thread has executed the submitted frames
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_completedCondition.wait(lock, [this]()
+    {
+        return m_completed.load(std::memory_order_acquire) == m_submitted.load(std::memory_order_relaxed);
+    });
+}
+
+void RenderThread::loop()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Take the context
+    glfwMakeContextCurrent(m_pWindow);
+
+    // Time spent executing and waiting since the last utilization update
+    Clock::duration busy = Clock::duration::zero();
+    Clock::time_point windowStart = Clock::now();
+
+    while (true)
+    {
+        size_t completed = m_completed.load(std::memory_order_relaxed);
+
+        // Wait for a frame to be handed over, a frame that is already there is taken without locking
+        if (m_submitted.load(std::memory_order_acquire) == completed)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_submittedCondition.wait(lock, [this, completed]()
+            {
+                return m_submitted.load(std::memory_order_acquire) != completed || !m_running;
+            });
+
+            if (m_submitted.load(std::memory_order_acquire) == completed)
+            {
+                break;
+            }
+        }
+
+        // Execute the frame
+        Clock::time_point start = Clock::now();
+        Utility::Profiler::begin("Render thread");
+        m_buffers[completed % 2].execute();
+        Utility::Profiler::end();
+        Clock::time_point end = Clock::now();
+
+        // Hand the buffer back to the game thread
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.store(completed + 1, std::memory_order_release);
+        }
+
+        m_completedCondition.notify_all();
+
+        // Update utilization roughly every half a second
+        busy += end - start;
+        if (end - windowStart > std::chrono::milliseconds(500))
+        {
+            m_utilization = (float)busy.count() / (float)(end - windowStart).count();
+            busy = Clock::duration::zero();
+            windowStart = end;
+        }
+    }
+
+    // Release the context so that it can be made current on another thread
+    glfwMakeContextCurrent(nullptr);
+}
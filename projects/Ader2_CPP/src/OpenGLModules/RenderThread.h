@@ -0,0 +1,340 @@
+#pragma once
+
+// Render thread and the lock-free handoff
+#include <thread>
+#include <atomic>
+
+// Blocking while the other thread is busy
+#include <mutex>
+#include <condition_variable>
+
+// Command memory pages
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+
+// OpenGL and GLFW includes
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+
+/**
+ * Command buffer is a linear memory arena that stores render commands and the
+ * data they reference. Commands are recorded on the game thread and executed
+ * in the same order on the render thread, after execution the memory is kept
+ * and reused for the next frame so recording doesn't allocate in steady state.
+ */
+class CommandBuffer
+{
+public:
+    CommandBuffer();
+
+    ~CommandBuffer();
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    /**
+     * Records a command into the buffer, the callable is stored inside the
+     * buffer memory and destroyed after it has been executed
+     *
+     * @param fn Callable taking no arguments
+     */
+    template<typename Fn>
+    void record(Fn&& fn)
+    {
+        using FnType = typename std::decay<Fn>::type;
+
+        // Store the callable
+        void* pFn = allocate(sizeof(FnType), alignof(FnType));
+        new (pFn) FnType(std::forward<Fn>(fn));
+
+        // Store the command header
+        Command* pCommand = static_cast<Command*>(allocate(sizeof(Command), alignof(Command)));
+        pCommand->Execute = [](void* p)
+        {
+            FnType* pCallable = static_cast<FnType*>(p);
+            (*pCallable)();
+            pCallable->~FnType();
+        };
+        pCommand->pFn = pFn;
+        pCommand->pNext = nullptr;
+
+        // Link the command
+        if (m_pLast)
+        {
+            m_pLast->pNext = pCommand;
+        }
+        else
+        {
+            m_pFirst = pCommand;
+        }
+
+        m_pLast = pCommand;
+        m_count++;
+    }
+
+    /**
+     * Allocates memory inside the buffer, the memory is valid until the
+     * buffer has been executed
+     *
+     * @param size Size in bytes
+     * @param alignment Alignment of the memory
+     *
+     * @return Pointer to the allocated memory
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Executes all recorded commands in order and resets the buffer
+     */
+    void execute();
+
+    /**
+     * Returns the number of commands currently recorded
+     */
+    size_t count() const;
+
+    /**
+     * Returns the amount of bytes currently used by commands and their data
+     */
+    size_t bytes() const;
+private:
+    /**
+     * Header of a single recorded command
+     */
+    struct Command
+    {
+        /// Invokes and destroys the callable
+        void(*Execute)(void*);
+
+        /// Callable stored in the buffer
+        void* pFn;
+
+        /// Next command in the buffer
+        Command* pNext;
+    };
+
+    /**
+     * Single memory page of the buffer
+     */
+    struct Page
+    {
+        /// Memory of the page
+        std::unique_ptr<unsigned char[]> Memory;
+
+        /// Size of the page in bytes
+        size_t Size = 0;
+
+        /// Used bytes of the page
+        size_t Used = 0;
+    };
+
+    /// Size of a default page, larger allocations get their own page
+    static constexpr size_t ms_pageSize = 1024 * 1024;
+private:
+    /// Memory pages of the buffer
+    std::vector<Page> m_pages;
+
+    /// Page that is currently being allocated from
+    size_t m_page = 0;
+
+    /// First recorded command
+    Command* m_pFirst = nullptr;
+
+    /// Last recorded command
+    Command* m_pLast = nullptr;
+
+    /// Number of recorded commands
+    size_t m_count = 0;
+
+    /// Number of used bytes
+    size_t m_bytes = 0;
+};
+
+
+/**
+ * Render thread owns the OpenGL context and executes the command stream
+ * recorded by the game thread. Two command buffers are used, while one is
+ * being executed the game thread records the next frame into the other one.
+ * The handoff between threads is done with two atomic frame counters, a thread
+ * that has to wait for the other one blocks on a condition variable instead of
+ * spinning.
+ *
+ * When the render thread is disabled the recorded commands are executed
+ * on the calling thread during submit.
+ */
+class RenderThread
+{
+public:
+    /**
+     * Statistics of the render thread
+     */
+    struct Statistics
+    {
+        /// Amount of commands in the last submitted frame
+        size_t QueueDepth = 0;
+
+        /// Amount of bytes recorded in the last submitted frame
+        size_t QueueBytes = 0;
+
+        /// Fraction of time the render thread spent executing commands [0, 1]
+        float Utilization = 0.0f;
+    };
+public:
+    RenderThread();
+
+    ~RenderThread();
+
+    /**
+     * Starts executing commands for the specified window
+     *
+     * @param pWindow Window whose context will be used for executing commands
+     * @param threaded If true a dedicated render thread will own the context,
+     *                 otherwise commands will be executed on the submitting thread
+     */
+    void start(GLFWwindow* pWindow, bool threaded);
+
+    /**
+     * Executes all pending commands, stops the render thread and makes the
+     * context current on the calling thread
+     */
+    void stop();
+
+    /**
+     * Hands the recorded frame over to the render thread, waits if the
+     * render thread hasn't finished the previous frame yet
+     */
+    void submit();
+
+    /**
+     * Returns the statistics of the render thread
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Records a command to the current frame, if called from the thread that is
+     * executing commands the callable is invoked immediately
+     *
+     * @param fn Callable taking no arguments
+     */
+    template<typename Fn>
+    static void record(Fn&& fn)
+    {
+        if (ms_pInstance->isExecutor())
+        {
+            fn();
+            return;
+        }
+
+        ms_pInstance->m_buffers[ms_pInstance->recordIndex()].record(std::forward<Fn>(fn));
+    }
+
+    /**
+     * Records a command and blocks until it has been executed
+     *
+     * @param fn Callable taking no arguments
+     */
+    template<typename Fn>
+    static void run(Fn&& fn)
+    {
+        record(std::forward<Fn>(fn));
+        sync();
+    }
+
+    /**
+     * Copies the specified data into the current frame, the returned pointer can
+     * be used by recorded commands. If called from the executing thread no copy is
+     * made and the original pointer is returned.
+     *
+     * @param pData Data to copy
+     * @param count Number of elements
+     *
+     * @return Pointer to the data that is valid until the command is executed
+     */
+    template<typename T>
+    static const T* copy(const T* pData, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable data can be recorded");
+
+        if (ms_pInstance->isExecutor() || count == 0)
+        {
+            return pData;
+        }
+
+        void* pCopy = ms_pInstance->m_buffers[ms_pInstance->recordIndex()].allocate(sizeof(T) * count, alignof(T));
+        memcpy(pCopy, pData, sizeof(T) * count);
+        return static_cast<const T*>(pCopy);
+    }
+
+    /**
+     * Submits the current frame and waits until the render thread has executed it
+     */
+    static void sync();
+private:
+    /**
+     * Returns true if the calling thread is the one executing commands
+     */
+    bool isExecutor() const;
+
+    /**
+     * Index of the buffer that is currently recorded into
+     */
+    size_t recordIndex() const;
+
+    /**
+     * Waits until all submitted frames have been executed
+     */
+    void waitIdle() const;
+
+    /**
+     * Render thread loop
+     */
+    void loop();
+private:
+    /// Instance used by the static recording interface
+    static RenderThread* ms_pInstance;
+
+    /// Command buffers, frame n is recorded into buffer n % 2
+    CommandBuffer m_buffers[2];
+
+    /// Number of frames handed over to the render thread
+    std::atomic<size_t> m_submitted{ 0 };
+
+    /// Number of frames executed by the render thread
+    std::atomic<size_t> m_completed{ 0 };
+
+    /// True while the render thread should keep running
+    std::atomic<bool> m_running{ false };
+
+    /// Guards the waits on the frame counters, only taken when a thread has to block
+    mutable std::mutex m_mutex;
+
+    /// Signaled when a frame is handed over or the thread is stopped
+    std::condition_variable m_submittedCondition;
+
+    /// Signaled when the render thread has executed a frame
+    mutable std::condition_variable m_completedCondition;
+
+    /// Thread that is currently allowed to execute commands
+    std::thread::id m_executorId;
+
+    /// The render thread
+    std::thread m_thread;
+
+    /// Window of the context
+    GLFWwindow* m_pWindow = nullptr;
+
+    /// True if commands are executed on the render thread
+    bool m_threaded = false;
+
+    /// Queue depth of the last submitted frame
+    size_t m_queueDepth = 0;
+
+    /// Queue size in bytes of the last submitted frame
+    size_t m_queueBytes = 0;
+
+    /// Render thread utilization
+    std::atomic<float> m_utilization{ 0.0f };
+};
@@ -0,0 +1,283 @@
+#include "ResolutionScaler.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Textures go through the state cache
+#include "OpenGLModules/GLState.h"
+
+// Commands are recorded for the render thread
+#include "OpenGLModules/RenderThread.h"
+
+// Frame times of the resolved frames
+#include "OpenGLModules/GPUProfiler.h"
+
+// For std::min, std::max and std::sqrt
+#include <algorithm>
+#include <cmath>
+
+ResolutionScaler* ResolutionScaler::ms_pInstance = nullptr;
+
+ResolutionScaler::ResolutionScaler()
+{
+    ms_pInstance = this;
+}
+
+ResolutionScaler::~ResolutionScaler()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void ResolutionScaler::init()
+{
+    // The attachments are created the first time the scene is drawn offscreen
+    glGenFramebuffers(1, &ms_pInstance->m_framebuffer);
+}
+
+void ResolutionScaler::shutdown()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    deleteTargets();
+    glDeleteFramebuffers(1, &s.m_framebuffer);
+
+    s.m_framebuffer = 0;
+    s.m_targetWidth = 0;
+    s.m_targetHeight = 0;
+}
+
+void ResolutionScaler::configure(bool enabled, float targetFrameTime, float minScale, float maxScale)
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    // The attachments are window sized, the scene can't be rendered larger
+    s.m_enabled = enabled;
+    s.m_targetFrameTime = std::max(targetFrameTime, 0.1f);
+    s.m_minScale = std::min(std::max(minScale, 0.1f), 1.0f);
+    s.m_maxScale = std::min(std::max(maxScale, s.m_minScale), 1.0f);
+    s.m_scale = std::min(std::max(s.m_scale, s.m_minScale), s.m_maxScale);
+
+    // Measurements of the previous settings don't apply
+    s.m_frameTime = 0.0;
+    s.m_cooldown = ms_cooldown;
+
+    // The offscreen framebuffer isn't needed when drawing straight into the window
+    if (!enabled && s.m_targetWidth != 0)
+    {
+        RenderThread::record([]()
+        {
+            deleteTargets();
+        });
+
+        s.m_targetWidth = 0;
+        s.m_targetHeight = 0;
+    }
+}
+
+void ResolutionScaler::resize(int width, int height)
+{
+    ResolutionScaler& s = *ms_pInstance;
+    s.m_width = width;
+    s.m_height = height;
+}
+
+void ResolutionScaler::update()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    if (!s.m_enabled)
+    {
+        return;
+    }
+
+    // Only frames measured since the last update are used
+    GPUProfiler::Statistics stats = GPUProfiler::getStatistics();
+    if (stats.Resolved == s.m_lastResolved)
+    {
+        return;
+    }
+
+    s.m_lastResolved = stats.Resolved;
+
+    // Without timer queries there is nothing to go by
+    if (stats.FrameTime <= 0.0)
+    {
+        return;
+    }
+
+    s.m_frameTime = s.m_frameTime <= 0.0 ? stats.FrameTime : s.m_frameTime + (stats.FrameTime - s.m_frameTime) * ms_smoothing;
+
+    // Frames rendered before the last adjustment are still being measured
+    if (s.m_cooldown > 0)
+    {
+        s.m_cooldown--;
+        return;
+    }
+
+    // Inside the band between the headroom and the budget the scale is kept
+    double target = s.m_targetFrameTime;
+    if (s.m_frameTime <= target && s.m_frameTime >= target * ms_headroom)
+    {
+        return;
+    }
+
+    // GPU time follows the pixel count, the scale per axis that reaches the middle
+    // of the band is the square root of the time ratio
+    double goal = target * (1.0 + ms_headroom) * 0.5;
+    float scale = s.m_scale * (float)std::sqrt(goal / s.m_frameTime);
+
+    scale = std::min(std::max(scale, s.m_scale - ms_maxStep), s.m_scale + ms_maxStep);
+    scale = std::min(std::max(scale, s.m_minScale), s.m_maxScale);
+
+    // Small changes aren't worth the blurrier image, except when reaching a bound
+    if (std::abs(scale - s.m_scale) < ms_minStep && scale != s.m_minScale && scale != s.m_maxScale)
+    {
+        return;
+    }
+
+    if (scale == s.m_scale)
+    {
+        return;
+    }
+
+    // Predict the new frame time until the frames at the new scale are measured
+    s.m_frameTime *= (double)(scale * scale) / (double)(s.m_scale * s.m_scale);
+    s.m_scale = scale;
+    s.m_cooldown = ms_cooldown;
+    s.m_changes++;
+}
+
+void ResolutionScaler::beginScene()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    if (!active())
+    {
+        return;
+    }
+
+    int width = s.m_width;
+    int height = s.m_height;
+
+    // Attachments are window sized so the scale can change without reallocating
+    if (s.m_targetWidth != width || s.m_targetHeight != height)
+    {
+        RenderThread::record([width, height]()
+        {
+            createTargets(width, height);
+        });
+
+        s.m_targetWidth = width;
+        s.m_targetHeight = height;
+    }
+
+    s.m_renderWidth = std::max(1, (int)(width * s.m_scale + 0.5f));
+    s.m_renderHeight = std::max(1, (int)(height * s.m_scale + 0.5f));
+
+    int renderWidth = s.m_renderWidth;
+    int renderHeight = s.m_renderHeight;
+    RenderThread::record([renderWidth, renderHeight]()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, ms_pInstance->m_framebuffer);
+        glViewport(0, 0, renderWidth, renderHeight);
+    });
+}
+
+void ResolutionScaler::endScene()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    if (!active())
+    {
+        return;
+    }
+
+    int width = s.m_width;
+    int height = s.m_height;
+    int renderWidth = s.m_renderWidth;
+    int renderHeight = s.m_renderHeight;
+
+    RenderThread::record([width, height, renderWidth, renderHeight]()
+    {
+        GPUProfiler::begin("Upscale");
+
+        // Linear filtering when stretching the scene over the window
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, ms_pInstance->m_framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+        // The UI is drawn into the window at the native resolution
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+    });
+}
+
+ResolutionScaler::Statistics ResolutionScaler::getStatistics()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.FrameTime = s.m_frameTime;
+    stats.Changes = s.m_changes;
+
+    if (active())
+    {
+        stats.Scale = s.m_scale;
+        stats.Width = std::max(1, (int)(s.m_width * s.m_scale + 0.5f));
+        stats.Height = std::max(1, (int)(s.m_height * s.m_scale + 0.5f));
+    }
+    else
+    {
+        stats.Width = s.m_width;
+        stats.Height = s.m_height;
+    }
+
+    return stats;
+}
+
+bool ResolutionScaler::active()
+{
+    // Minimized windows have no size
+    ResolutionScaler& s = *ms_pInstance;
+    return s.m_enabled && s.m_width > 0 && s.m_height > 0;
+}
+
+void ResolutionScaler::createTargets(int width, int height)
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    deleteTargets();
+
+    glGenTextures(1, &s.m_color);
+    GLState::bindTexture(0, GL_TEXTURE_2D, s.m_color);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+
+    glGenTextures(1, &s.m_depth);
+    GLState::bindTexture(0, GL_TEXTURE_2D, s.m_depth);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, s.m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s.m_color, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, s.m_depth, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR("Scaled scene framebuffer {0}x{1} is incomplete!", width, height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ResolutionScaler::deleteTargets()
+{
+    ResolutionScaler& s = *ms_pInstance;
+
+    GLState::deleteTexture(s.m_color);
+    GLState::deleteTexture(s.m_depth);
+
+    s.m_color = 0;
+    s.m_depth = 0;
+}
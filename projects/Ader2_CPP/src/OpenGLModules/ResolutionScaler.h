@@ -0,0 +1,168 @@
+#pragma once
+
+// For statistics
+#include <cstddef>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * Resolution scaler renders the scene into an offscreen framebuffer at a lower
+ * resolution when the GPU can't hold the frame time budget. The framebuffer is
+ * allocated at the window size and the scene is drawn into the bottom left
+ * part of it, so changing the scale doesn't reallocate anything. After the
+ * scene passes the image is upscaled into the window with a linear blit and
+ * the UI is drawn over it at the native resolution.
+ *
+ * The scale is chosen from the GPU time of the frames resolved by the GPU
+ * profiler. The time is smoothed and the scale is changed by at most
+ * ms_maxStep per adjustment, after an adjustment the scaler waits until the
+ * frames rendered with the new scale are measured. GPU time is assumed to be
+ * proportional to the pixel count, the scale is per axis.
+ *
+ * Everything except init, shutdown and the framebuffer is accessed from the
+ * thread recording render commands.
+ */
+class ResolutionScaler
+{
+public:
+    /**
+     * Statistics of the resolution scaler
+     */
+    struct Statistics
+    {
+        /// Scale of the render resolution per axis
+        float Scale = 1.0f;
+
+        /// Resolution the scene is rendered at
+        int Width = 0;
+        int Height = 0;
+
+        /// Smoothed GPU time of a frame in milliseconds
+        double FrameTime = 0.0;
+
+        /// Times the scale was changed
+        size_t Changes = 0;
+    };
+public:
+    ResolutionScaler();
+
+    ~ResolutionScaler();
+
+    /**
+     * Creates the framebuffer object, must be called after the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the framebuffer and its attachments, must be called before the
+     * context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Sets the frame time budget and the bounds of the scale, a disabled scaler
+     * renders straight into the window and releases the offscreen framebuffer
+     *
+     * @param enabled If true the scene is rendered offscreen and scaled
+     * @param targetFrameTime GPU time of a frame in milliseconds the scale aims for
+     * @param minScale Smallest scale per axis
+     * @param maxScale Largest scale per axis, 1 is the window resolution
+     */
+    static void configure(bool enabled, float targetFrameTime, float minScale, float maxScale);
+
+    /**
+     * Sets the window size, the framebuffer is resized the next time the scene is drawn
+     */
+    static void resize(int width, int height);
+
+    /**
+     * Adjusts the scale to the GPU time of the frames measured since the last update
+     */
+    static void update();
+
+    /**
+     * Binds the offscreen framebuffer and sets the viewport to the render resolution,
+     * does nothing if the scaler is disabled
+     */
+    static void beginScene();
+
+    /**
+     * Upscales the scene into the window and binds it for the UI, does nothing
+     * if the scaler is disabled
+     */
+    static void endScene();
+
+    /**
+     * Returns the statistics of the scaler
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Returns true if the scene is rendered offscreen this frame
+     */
+    static bool active();
+
+    /**
+     * Creates the attachments at the window size, must be called from the thread
+     * executing commands
+     */
+    static void createTargets(int width, int height);
+
+    /**
+     * Deletes the attachments, must be called from the thread executing commands
+     */
+    static void deleteTargets();
+private:
+    /// Instance used by the static interface
+    static ResolutionScaler* ms_pInstance;
+
+    /// The scale is increased once the frame time is below this part of the budget
+    static constexpr double ms_headroom = 0.85;
+
+    /// Largest change of the scale per adjustment
+    static constexpr float ms_maxStep = 0.1f;
+
+    /// Scale changes smaller than this are ignored
+    static constexpr float ms_minStep = 0.02f;
+
+    /// Weight of a new frame time in the smoothed frame time
+    static constexpr double ms_smoothing = 0.2;
+
+    /// Frames measured after an adjustment before the next one, the profiler
+    /// reads results up to 3 frames late
+    static constexpr unsigned int ms_cooldown = 4;
+
+    /// Settings
+    bool m_enabled = false;
+    float m_targetFrameTime = 16.0f;
+    float m_minScale = 0.5f;
+    float m_maxScale = 1.0f;
+
+    /// Current scale per axis
+    float m_scale = 1.0f;
+
+    /// Window size and the size the attachments were created with
+    int m_width = 0;
+    int m_height = 0;
+    int m_targetWidth = 0;
+    int m_targetHeight = 0;
+
+    /// Controller state
+    size_t m_lastResolved = 0;
+    double m_frameTime = 0.0;
+    unsigned int m_cooldown = 0;
+
+    /// Render resolution of the frame being recorded
+    int m_renderWidth = 0;
+    int m_renderHeight = 0;
+
+    /// Statistics
+    size_t m_changes = 0;
+
+    /// Framebuffer and it's attachments, render thread only
+    GLuint m_framebuffer = 0;
+    GLuint m_color = 0;
+    GLuint m_depth = 0;
+};
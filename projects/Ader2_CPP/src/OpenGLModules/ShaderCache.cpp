@@ -0,0 +1,520 @@
+#include "ShaderCache.h"
+
+// Cache files
+#include "Utility/File.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Parallel compile extension is loaded through GLFW
+#include <GLFW/glfw3.h>
+
+// Formatting cache file names
+#include <cstdio>
+
+// Deleting programs that might be bound
+#include "OpenGLModules/GLState.h"
+
+// Fallback variants use the shader defines
+#include "OpenGLModules/GLContext.h"
+
+// Not part of the loaded GL version
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+ShaderCache* ShaderCache::ms_pInstance = nullptr;
+
+namespace
+{
+    /// Header of a cache file
+    struct CacheHeader
+    {
+        /// Identifies the file as a program binary
+        unsigned int Magic;
+
+        /// Binary format returned by the driver
+        GLenum Format;
+
+        /// Size of the binary that follows the header
+        GLsizei Length;
+    };
+
+    /// "ASPB"
+    constexpr unsigned int c_cacheMagic = 0x42505341;
+
+    /// Fallback program, renders instanced geometry with a flat color
+    const char* c_fallbackVertex = R"(#version 420 core
+layout (location = 0) in vec3 aPos;
+
+#ifdef COMPACT_INSTANCE
+layout (location = 9) in vec4 aTransformRow0;
+layout (location = 10) in vec4 aTransformRow1;
+layout (location = 11) in vec4 aTransformRow2;
+#else
+layout (location = 3) in mat4 aTransform;
+#endif
+
+layout (std140, binding = 0) uniform Matrices
+{
+	uniform mat4 projection;
+	uniform mat4 view;
+};
+
+void main()
+{
+#ifdef COMPACT_INSTANCE
+	mat4 transform = transpose(mat4(aTransformRow0, aTransformRow1, aTransformRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+#else
+	mat4 transform = aTransform;
+#endif
+	gl_Position = projection * view * transform * vec4(aPos, 1.0);
+})";
+
+    const char* c_fallbackFragment = R"(#version 420 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+})";
+
+    /**
+     * FNV-1a hash
+     */
+    unsigned long long fnv1a(const void* pData, size_t size, unsigned long long hash)
+    {
+        const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+}
+
+ShaderCache::ShaderCache()
+{
+    ms_pInstance = this;
+}
+
+ShaderCache::~ShaderCache()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void ShaderCache::init()
+{
+    ShaderCache& s = *ms_pInstance;
+
+    // Driver string is part of the cache key
+    s.m_driver.clear();
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const GLubyte* pValue = glGetString(name);
+        if (pValue)
+        {
+            s.m_driver += reinterpret_cast<const char*>(pValue);
+        }
+
+        s.m_driver += '\n';
+    }
+
+    // Some drivers don't support any binary formats
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    s.m_binarySupported = formats > 0;
+
+    // Let the driver compile shaders in parallel
+    typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+    PFNGLMAXSHADERCOMPILERTHREADSPROC pMaxThreads = nullptr;
+
+    // Extensions can only be queried with a current window context
+    bool hasContext = glfwGetCurrentContext() != nullptr;
+
+    if (hasContext && glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+    {
+        pMaxThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    }
+    else if (hasContext && glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+    {
+        pMaxThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+    }
+
+    if (pMaxThreads)
+    {
+        // Implementation specific amount of threads
+        pMaxThreads(0xFFFFFFFF);
+        s.m_parallel = true;
+    }
+
+    LOG_INFO("Shader cache: program binaries {0}, parallel compile {1}",
+        s.m_binarySupported ? "supported" : "not supported",
+        s.m_parallel ? "supported" : "not supported");
+
+    // Fallback of shaders without variants, the other fallbacks are created when needed
+    s.m_fallbacks[Shader::sf_None] = s.createFallback(Shader::sf_None);
+}
+
+void ShaderCache::shutdown()
+{
+    ShaderCache& s = *ms_pInstance;
+
+    // Shaders can outlive the context, their programs are freed when they are released
+    for (auto& it : s.m_programs)
+    {
+        s.deleteProgram(*it.second);
+    }
+
+    for (auto& it : s.m_fallbacks)
+    {
+        GLState::deleteProgram(it.second);
+    }
+
+    s.m_fallbacks.clear();
+}
+
+ShaderCache::Program* ShaderCache::getProgram(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    ShaderCache& s = *ms_pInstance;
+    unsigned long long key = s.hash(vertexSource, fragmentSource);
+
+    // Each program is created only once per run
+    auto it = s.m_programs.find(key);
+    if (it != s.m_programs.end())
+    {
+        s.m_reused++;
+        it->second->References++;
+        return it->second.get();
+    }
+
+    Program& program = *(s.m_programs[key] = std::make_unique<Program>());
+    program.Key = key;
+    program.References = 1;
+    program.LoadStart = glfwGetTime();
+
+    // Try the disk cache first
+    program.ID = s.loadBinary(key);
+    if (program.ID != 0)
+    {
+        s.addProgram(true, (glfwGetTime() - program.LoadStart) * 1000.0);
+        return &program;
+    }
+
+    s.compile(program, vertexSource, fragmentSource);
+    return &program;
+}
+
+void ShaderCache::release(Program* pProgram)
+{
+    // Programs are destroyed with the cache
+    if (ms_pInstance == nullptr)
+    {
+        return;
+    }
+
+    ShaderCache& s = *ms_pInstance;
+
+    if (--pProgram->References > 0)
+    {
+        return;
+    }
+
+    // Reloaded sources are loaded from the disk cache if they are used again
+    s.deleteProgram(*pProgram);
+    s.m_programs.erase(pProgram->Key);
+}
+
+GLuint ShaderCache::resolve(Program* pProgram)
+{
+    ShaderCache& s = *ms_pInstance;
+
+    if (pProgram->Pending != 0)
+    {
+        // Querying the status before the driver is done would block
+        GLint completed = GL_TRUE;
+        if (s.m_parallel)
+        {
+            glGetProgramiv(pProgram->Pending, GL_COMPLETION_STATUS_KHR, &completed);
+        }
+
+        if (completed == GL_TRUE)
+        {
+            s.finish(*pProgram);
+        }
+    }
+
+    return pProgram->ID;
+}
+
+GLuint ShaderCache::getFallback(unsigned int features)
+{
+    ShaderCache& s = *ms_pInstance;
+
+    auto it = s.m_fallbacks.find(features);
+    if (it != s.m_fallbacks.end())
+    {
+        return it->second;
+    }
+
+    GLuint program = s.createFallback(features);
+    s.m_fallbacks[features] = program;
+    return program;
+}
+
+ShaderCache::Statistics ShaderCache::getStatistics()
+{
+    ShaderCache& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Hits = s.m_hits;
+    stats.Misses = s.m_misses;
+    stats.Reused = s.m_reused;
+    stats.Milliseconds = s.m_microseconds / 1000.0;
+    return stats;
+}
+
+std::string ShaderCache::getPath(unsigned long long key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", key);
+    return std::string(ms_directory) + name;
+}
+
+unsigned long long ShaderCache::hash(const std::string& vertexSource, const std::string& fragmentSource) const
+{
+    // Separators make sure moving text between the sources changes the key
+    unsigned long long result = 14695981039346656037ull;
+    result = fnv1a(m_driver.data(), m_driver.size(), result);
+    result = fnv1a("\0", 1, result);
+    result = fnv1a(vertexSource.data(), vertexSource.size(), result);
+    result = fnv1a("\0", 1, result);
+    result = fnv1a(fragmentSource.data(), fragmentSource.size(), result);
+
+    return result;
+}
+
+GLuint ShaderCache::loadBinary(unsigned long long key)
+{
+    if (!m_binarySupported)
+    {
+        return 0;
+    }
+
+    // Read the cache file
+    std::vector<unsigned char> data;
+    if (!readBinaryFile(getPath(key), data) || data.size() < sizeof(CacheHeader))
+    {
+        return 0;
+    }
+
+    CacheHeader header;
+    memcpy(&header, data.data(), sizeof(CacheHeader));
+
+    if (header.Magic != c_cacheMagic || header.Length <= 0 || data.size() - sizeof(CacheHeader) < (size_t)header.Length)
+    {
+        LOG_WARN("Corrupted shader cache file '{0}'!", getPath(key));
+        return 0;
+    }
+
+    // Create the program from the binary
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.Format, data.data() + sizeof(CacheHeader), header.Length);
+
+    // The driver can reject binaries at any time, in that case the program is compiled again
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void ShaderCache::storeBinary(unsigned long long key, GLuint program)
+{
+    if (!m_binarySupported)
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    // Header followed by the binary
+    std::vector<unsigned char> data(sizeof(CacheHeader) + length);
+
+    CacheHeader header;
+    header.Magic = c_cacheMagic;
+    header.Format = 0;
+    header.Length = 0;
+    glGetProgramBinary(program, length, &header.Length, &header.Format, data.data() + sizeof(CacheHeader));
+    memcpy(data.data(), &header, sizeof(CacheHeader));
+
+    if (header.Length > 0)
+    {
+        writeBinaryFile(getPath(key), data.data(), sizeof(CacheHeader) + header.Length);
+    }
+}
+
+void ShaderCache::compile(Program& program, const std::string& vertexSource, const std::string& fragmentSource)
+{
+    // Vertex shader
+    const char* vSource = vertexSource.c_str();
+
+    // Create and compile vertex shader
+    program.VertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(program.VertexShader, 1, &vSource, NULL);
+    glCompileShader(program.VertexShader);
+
+    // Fragment shader
+    const char* fSource = fragmentSource.c_str();
+
+    // Create and compile fragment shader
+    program.FragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(program.FragmentShader, 1, &fSource, NULL);
+    glCompileShader(program.FragmentShader);
+
+    // Create shader program, the binary is needed for the disk cache
+    program.Pending = glCreateProgram();
+    glProgramParameteri(program.Pending, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // Add shaders and link them
+    glAttachShader(program.Pending, program.VertexShader);
+    glAttachShader(program.Pending, program.FragmentShader);
+    glLinkProgram(program.Pending);
+
+    // With parallel compilation the status is polled when the program is used
+    if (!m_parallel)
+    {
+        finish(program);
+    }
+}
+
+void ShaderCache::finish(Program& program)
+{
+    // Info about shader compilation
+    int success;
+    char infoLog[512];
+
+    // Get compilation results
+    glGetShaderiv(program.VertexShader, GL_COMPILE_STATUS, &success);
+
+    // If it failed get detailed info
+    if (!success)
+    {
+        glGetShaderInfoLog(program.VertexShader, 512, NULL, infoLog);
+        LOG_ERROR("Failed to compile vertex shader:\n {0}", infoLog);
+    }
+
+    // Get compilation results
+    glGetShaderiv(program.FragmentShader, GL_COMPILE_STATUS, &success);
+
+    // If it failed get detailed info
+    if (!success)
+    {
+        glGetShaderInfoLog(program.FragmentShader, 512, NULL, infoLog);
+        LOG_ERROR("Failed to compile fragment shader:\n {0}", infoLog);
+    }
+
+    // Delete shaders
+    glDeleteShader(program.VertexShader);
+    glDeleteShader(program.FragmentShader);
+    program.VertexShader = 0;
+    program.FragmentShader = 0;
+
+    // Check if it linked correctly
+    glGetProgramiv(program.Pending, GL_LINK_STATUS, &success);
+
+    // If it failed get detailed info
+    if (!success)
+    {
+        glGetProgramInfoLog(program.Pending, 512, NULL, infoLog);
+        LOG_ERROR("Failed to link shader:\n {0}", infoLog);
+
+        glDeleteProgram(program.Pending);
+        program.Pending = 0;
+        program.Failed = true;
+        return;
+    }
+
+    // Store the program for the next run
+    storeBinary(program.Key, program.Pending);
+
+    program.ID = program.Pending;
+    program.Pending = 0;
+
+    addProgram(false, (glfwGetTime() - program.LoadStart) * 1000.0);
+}
+
+void ShaderCache::deleteProgram(Program& program)
+{
+    // Program that is still being compiled
+    if (program.Pending != 0)
+    {
+        glDeleteShader(program.VertexShader);
+        glDeleteShader(program.FragmentShader);
+        glDeleteProgram(program.Pending);
+
+        program.VertexShader = 0;
+        program.FragmentShader = 0;
+        program.Pending = 0;
+    }
+
+    // Nothing is left to delete once the cache has been shut down
+    if (program.ID != 0)
+    {
+        GLState::deleteProgram(program.ID);
+        program.ID = 0;
+    }
+}
+
+void ShaderCache::addProgram(bool hit, double milliseconds)
+{
+    if (hit)
+    {
+        m_hits++;
+    }
+    else
+    {
+        m_misses++;
+    }
+
+    m_microseconds += (long long)(milliseconds * 1000.0);
+}
+
+GLuint ShaderCache::createFallback(unsigned int features)
+{
+    // Same defines as the variant so the transform is read from the same attributes
+    std::string vertexSource = Shader::addDefines(c_fallbackVertex, features);
+    const char* vSource = vertexSource.c_str();
+
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vSource, NULL);
+    glCompileShader(vertexShader);
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &c_fallbackFragment, NULL);
+    glCompileShader(fragmentShader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+// Cache keys and driver string
+#include <string>
+
+// Statistics are read from the game thread
+#include <atomic>
+
+// Programs of the current run
+#include <unordered_map>
+#include <memory>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+
+/**
+ * Shader cache owns all shader programs. Programs are keyed by a hash of their
+ * sources and the driver string, a program is compiled at most once while it's
+ * in use and shared by all shaders (and shader variants) with the same sources.
+ * Programs are reference counted and deleted once the last user releases them.
+ * Linked programs are also stored on disk with glGetProgramBinary and loaded
+ * back with glProgramBinary, a driver update invalidates the disk cache
+ * automatically.
+ *
+ * It also enables parallel shader compilation when the driver supports
+ * GL_KHR_parallel_shader_compile (or the ARB version) and provides the fallback
+ * program that is used while a shader is still compiling.
+ *
+ * The cache is only accessed from the thread executing render commands.
+ */
+class ShaderCache
+{
+public:
+    /**
+     * Statistics of the shader cache
+     */
+    struct Statistics
+    {
+        /// Programs loaded from the disk cache
+        size_t Hits = 0;
+
+        /// Programs that had to be compiled
+        size_t Misses = 0;
+
+        /// Requests served by programs that were already created this run
+        size_t Reused = 0;
+
+        /// Total time spent until programs were ready to use
+        double Milliseconds = 0.0;
+    };
+
+    /**
+     * Program owned by the cache
+     */
+    struct Program
+    {
+        /// Linked program, 0 until the program is ready
+        GLuint ID = 0;
+
+        /// Program that is still being compiled and the shaders attached to it
+        GLuint Pending = 0;
+        GLuint VertexShader = 0;
+        GLuint FragmentShader = 0;
+
+        /// True if compilation or linking failed
+        bool Failed = false;
+
+        /// Cache key of the program
+        unsigned long long Key = 0;
+
+        /// Shaders (and shader variants) holding the program
+        size_t References = 0;
+
+        /// Time the load started at in seconds
+        double LoadStart = 0.0;
+    };
+public:
+    ShaderCache();
+
+    ~ShaderCache();
+
+    /**
+     * Queries the driver and creates the fallback program of shaders without
+     * variants, must be called after the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes all programs, must be called before the context is destroyed.
+     * Programs that haven't been released stay valid but have no program id.
+     */
+    static void shutdown();
+
+    /**
+     * Returns the program with the specified sources. The program is loaded from
+     * the disk cache or compiled if it doesn't exist yet, with parallel compilation
+     * it will not be ready immediately. Every returned program holds a reference
+     * that has to be given back with release.
+     */
+    static Program* getProgram(const std::string& vertexSource, const std::string& fragmentSource);
+
+    /**
+     * Releases a reference returned by getProgram, the program is deleted once
+     * it has no references left
+     */
+    static void release(Program* pProgram);
+
+    /**
+     * Polls a program that is being compiled
+     *
+     * @return Program id or 0 if the program isn't ready yet or failed
+     */
+    static GLuint resolve(Program* pProgram);
+
+    /**
+     * Returns the program used while a shader is still compiling. Variants read
+     * their instance data from different attributes, so a fallback is linked for
+     * each feature set the first time it's requested.
+     *
+     * @param features Shader::Features of the variant that is compiling
+     */
+    static GLuint getFallback(unsigned int features);
+
+    /**
+     * Returns the statistics of the cache
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Returns the path of the cache file for the key
+     */
+    std::string getPath(unsigned long long key) const;
+
+    /**
+     * Returns the cache key of a program with the specified sources
+     */
+    unsigned long long hash(const std::string& vertexSource, const std::string& fragmentSource) const;
+
+    /**
+     * Creates a program from the cached binary
+     *
+     * @return Program id or 0 if the program isn't cached or the binary was rejected
+     */
+    GLuint loadBinary(unsigned long long key);
+
+    /**
+     * Stores the binary of a linked program in the disk cache
+     */
+    void storeBinary(unsigned long long key, GLuint program);
+
+    /**
+     * Starts compiling and linking the program
+     */
+    void compile(Program& program, const std::string& vertexSource, const std::string& fragmentSource);
+
+    /**
+     * Checks the compilation results of the pending program
+     */
+    void finish(Program& program);
+
+    /**
+     * Deletes the shaders and the program ids of the program
+     */
+    void deleteProgram(Program& program);
+
+    /**
+     * Adds a program to the statistics
+     */
+    void addProgram(bool hit, double milliseconds);
+
+    /**
+     * Compiles and links the fallback program of the features, fallbacks are
+     * small enough to be linked synchronously
+     */
+    GLuint createFallback(unsigned int features);
+private:
+    /// Instance used by the static interface
+    static ShaderCache* ms_pInstance;
+
+    /// Directory of the cache files
+    static constexpr const char* ms_directory = "cache/shaders/";
+
+    /// Vendor, renderer and version of the driver
+    std::string m_driver;
+
+    /// True if the driver supports at least one program binary format
+    bool m_binarySupported = false;
+
+    /// True if the driver compiles shaders in parallel
+    bool m_parallel = false;
+
+    /// Programs used while shaders are compiling, keyed by the features of the variant
+    std::unordered_map<unsigned int, GLuint> m_fallbacks;
+
+    /// Programs that are referenced
+    std::unordered_map<unsigned long long, std::unique_ptr<Program>> m_programs;
+
+    /// Statistics
+    std::atomic<size_t> m_hits{ 0 };
+    std::atomic<size_t> m_misses{ 0 };
+    std::atomic<size_t> m_reused{ 0 };
+    std::atomic<long long> m_microseconds{ 0 };
+};
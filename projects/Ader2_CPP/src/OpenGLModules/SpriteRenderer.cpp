@@ -0,0 +1,254 @@
+#include "SpriteRenderer.h"
+
+// Textures and shaders of the runs
+#include "OpenGLModules/GLContext.h"
+
+// Buffers and the vertex array go through the state cache
+#include "OpenGLModules/GLState.h"
+
+// Commands are recorded for the render thread
+#include "OpenGLModules/RenderThread.h"
+
+// For std::stable_sort
+#include <algorithm>
+
+SpriteRenderer* SpriteRenderer::ms_pInstance = nullptr;
+
+// The sprite is read as 2 vec2, a vec4, 2 floats and 4 normalized bytes
+static_assert(sizeof(SpriteRenderer::Sprite) == 44, "Sprite doesn't match the vertex attributes");
+
+namespace
+{
+    /// Attribute locations of the sprite vertex shader
+    enum AttribLocations
+    {
+        al_Position = 0,
+        al_Size = 1,
+        al_TexRect = 2,
+        al_Rotation = 3,
+        al_Color = 4,
+    };
+}
+
+SpriteRenderer::SpriteRenderer()
+{
+    ms_pInstance = this;
+}
+
+SpriteRenderer::~SpriteRenderer()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void SpriteRenderer::init()
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    glGenVertexArrays(1, &s.m_vao);
+    glGenBuffers(1, &s.m_buffer);
+
+    // Orphaning keeps the buffer name, so the attributes are only set up once
+    setupAttributes();
+}
+
+void SpriteRenderer::shutdown()
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    GLState::deleteVertexArray(s.m_vao);
+    GLState::deleteBuffer(s.m_buffer);
+
+    s.m_vao = 0;
+    s.m_buffer = 0;
+    s.m_capacity = 0;
+    s.m_sprites.clear();
+    s.m_runs.clear();
+    s.m_inOrder = true;
+}
+
+void SpriteRenderer::submit(Texture* pTexture, Shader* pShader, const Sprite* pSprites, size_t count)
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    if (count == 0 || pTexture == nullptr || pShader == nullptr)
+    {
+        return;
+    }
+
+    // A run only ends when the texture or the shader changes
+    if (s.m_runs.empty() || s.m_runs.back().pTexture != pTexture || s.m_runs.back().pShader != pShader)
+    {
+        Run run;
+        run.pTexture = pTexture;
+        run.pShader = pShader;
+        run.First = s.m_sprites.size();
+        s.m_runs.push_back(run);
+    }
+
+    // Frames submitted in layer order don't have to be sorted
+    float layer = s.m_sprites.empty() ? pSprites[0].Layer : s.m_sprites.back().Layer;
+    for (size_t i = 0; i < count && s.m_inOrder; i++)
+    {
+        s.m_inOrder = pSprites[i].Layer >= layer;
+        layer = pSprites[i].Layer;
+    }
+
+    s.m_sprites.insert(s.m_sprites.end(), pSprites, pSprites + count);
+}
+
+void SpriteRenderer::flush()
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    size_t count = s.m_sprites.size();
+    s.m_drawnSprites = count;
+    s.m_drawnBatches = 0;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (!s.m_inOrder)
+    {
+        s.sortLayers();
+    }
+
+    // Grow the storage the buffer is orphaned with, it's never shrunk so the
+    // driver can reuse the previous allocations
+    if (count > s.m_capacity)
+    {
+        s.m_capacity = std::max<size_t>(std::max<size_t>(s.m_capacity * 2, count), 1024);
+    }
+
+    size_t capacity = s.m_capacity;
+    const Sprite* pSprites = RenderThread::copy(s.m_sprites.data(), count);
+
+    RenderThread::record([pSprites, count, capacity]()
+    {
+        // The previous frame can still read the old storage
+        GLState::bindBuffer(GL_ARRAY_BUFFER, ms_pInstance->m_buffer);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Sprite), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Sprite), pSprites);
+    });
+
+    // One draw per run, the base instance selects the first sprite
+    for (size_t i = 0; i < s.m_runs.size(); i++)
+    {
+        const Run& run = s.m_runs[i];
+        size_t end = i + 1 < s.m_runs.size() ? s.m_runs[i + 1].First : count;
+
+        run.pShader->bind();
+        run.pTexture->bind();
+
+        GLuint first = (GLuint)run.First;
+        GLsizei instances = (GLsizei)(end - run.First);
+        RenderThread::record([first, instances]()
+        {
+            GLState::bindVertexArray(ms_pInstance->m_vao);
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, instances, first);
+        });
+    }
+
+    s.m_drawnBatches = s.m_runs.size();
+
+    // Textures and shaders may be deleted before the next frame
+    s.m_sprites.clear();
+    s.m_runs.clear();
+    s.m_inOrder = true;
+}
+
+SpriteRenderer::Statistics SpriteRenderer::getStatistics()
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Sprites = s.m_drawnSprites;
+    stats.Batches = s.m_drawnBatches;
+    stats.Capacity = s.m_capacity;
+    return stats;
+}
+
+void SpriteRenderer::sortLayers()
+{
+    size_t count = m_sprites.size();
+
+    // Run of every sprite before the sprites are moved
+    m_spriteRuns.resize(count);
+    for (size_t i = 0; i < m_runs.size(); i++)
+    {
+        size_t end = i + 1 < m_runs.size() ? m_runs[i + 1].First : count;
+        std::fill(m_spriteRuns.begin() + m_runs[i].First, m_spriteRuns.begin() + end, (unsigned int)i);
+    }
+
+    // Stable, so sprites of a layer keep their submit order
+    m_order.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_order[i] = (unsigned int)i;
+    }
+
+    std::stable_sort(m_order.begin(), m_order.end(), [this](unsigned int a, unsigned int b)
+    {
+        return m_sprites[a].Layer < m_sprites[b].Layer;
+    });
+
+    // Sorted sprites with new runs, runs of the same texture and shader that
+    // end up next to each other are merged
+    m_sorted.resize(count);
+    m_sortedRuns.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned int index = m_order[i];
+        const Run& run = m_runs[m_spriteRuns[index]];
+
+        m_sorted[i] = m_sprites[index];
+
+        if (m_sortedRuns.empty() || m_sortedRuns.back().pTexture != run.pTexture || m_sortedRuns.back().pShader != run.pShader)
+        {
+            Run sorted;
+            sorted.pTexture = run.pTexture;
+            sorted.pShader = run.pShader;
+            sorted.First = i;
+            m_sortedRuns.push_back(sorted);
+        }
+    }
+
+    m_sprites.swap(m_sorted);
+    m_runs.swap(m_sortedRuns);
+}
+
+void SpriteRenderer::setupAttributes()
+{
+    SpriteRenderer& s = *ms_pInstance;
+
+    GLState::bindVertexArray(s.m_vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, s.m_buffer);
+
+    // Every attribute advances once per sprite, the quad has no vertex data.
+    // The layer is only used for ordering and isn't read by the shader
+    GLsizei stride = sizeof(Sprite);
+
+    glEnableVertexAttribArray(al_Position);
+    glVertexAttribPointer(al_Position, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Sprite, Position));
+    glVertexAttribDivisor(al_Position, 1);
+
+    glEnableVertexAttribArray(al_Size);
+    glVertexAttribPointer(al_Size, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Sprite, Size));
+    glVertexAttribDivisor(al_Size, 1);
+
+    glEnableVertexAttribArray(al_TexRect);
+    glVertexAttribPointer(al_TexRect, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Sprite, TexRect));
+    glVertexAttribDivisor(al_TexRect, 1);
+
+    glEnableVertexAttribArray(al_Rotation);
+    glVertexAttribPointer(al_Rotation, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Sprite, Rotation));
+    glVertexAttribDivisor(al_Rotation, 1);
+
+    glEnableVertexAttribArray(al_Color);
+    glVertexAttribPointer(al_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(Sprite, Color));
+    glVertexAttribDivisor(al_Color, 1);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+// For sprite buffers
+#include <vector>
+#include <cstddef>
+
+// Sprite positions and colors
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+class Texture;
+class Shader;
+
+
+/**
+ * Sprite renderer draws 2D sprites as instances of a single quad, the corners
+ * are generated and rotated in the vertex shader from gl_VertexID so a sprite
+ * is only its instance data. Sprite heavy scenes submit their sprites every
+ * frame instead of creating a game object for each of them.
+ *
+ * Sprites are submitted in bulk with the texture and shader they are drawn
+ * with and drawn in order of their layer, sprites of the same layer in the
+ * order they were submitted. Consecutive sprites sharing a texture and a
+ * shader are drawn with one instanced draw, a batch only ends when the
+ * texture or the shader changes.
+ *
+ * All sprites of a frame are written into one streaming instance buffer that
+ * is orphaned every frame. Sprites are submitted on the thread recording
+ * render commands, the vertex array and the buffer are only accessed from the
+ * thread executing render commands.
+ */
+class SpriteRenderer
+{
+public:
+    /**
+     * Instance data of a sprite, read by the sprite vertex shader. The layout
+     * matches Ader2.Core.Sprite so managed arrays are submitted without conversion
+     */
+    struct Sprite
+    {
+        /// Center of the sprite in window coordinates
+        glm::vec2 Position = glm::vec2(0.0f);
+
+        /// Width and height of the sprite
+        glm::vec2 Size = glm::vec2(1.0f);
+
+        /// Texture coordinate of the bottom left corner in xy and the size in zw,
+        /// same as the rectangles of atlas regions
+        glm::vec4 TexRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        /// Counter clockwise rotation around the center in radians
+        float Rotation = 0.0f;
+
+        /// Draw order, sprites of higher layers are drawn over lower ones
+        float Layer = 0.0f;
+
+        /// Color the texture is multiplied with, normalized by the attribute
+        glm::u8vec4 Color = glm::u8vec4(255);
+    };
+
+    /**
+     * Statistics of the sprite renderer
+     */
+    struct Statistics
+    {
+        /// Sprites drawn in the last frame
+        size_t Sprites = 0;
+
+        /// Draws of the last frame
+        size_t Batches = 0;
+
+        /// Sprites the instance buffer can hold
+        size_t Capacity = 0;
+    };
+public:
+    SpriteRenderer();
+
+    ~SpriteRenderer();
+
+    /**
+     * Creates the vertex array and the instance buffer, must be called after
+     * the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the vertex array and the instance buffer, must be called before
+     * the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Adds sprites to the frame, the sprites are copied
+     *
+     * @param pTexture Texture the sprites are sampled from
+     * @param pShader Shader the sprites are drawn with
+     * @param pSprites First sprite
+     * @param count Number of sprites
+     */
+    static void submit(Texture* pTexture, Shader* pShader, const Sprite* pSprites, size_t count);
+
+    /**
+     * Uploads and draws every sprite submitted since the last flush, blending
+     * must already be set up
+     */
+    static void flush();
+
+    /**
+     * Returns the statistics of the renderer
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Consecutive sprites sharing a texture and a shader, drawn with one draw
+     */
+    struct Run
+    {
+        Texture* pTexture = nullptr;
+        Shader* pShader = nullptr;
+
+        /// Index of the first sprite of the run
+        size_t First = 0;
+    };
+private:
+    /**
+     * Stable sorts the sprites of the frame by layer, the runs are rebuilt so
+     * they follow the sorted sprites
+     */
+    void sortLayers();
+
+    /**
+     * Points the attributes at the instance buffer, must be called from the
+     * thread executing commands
+     */
+    static void setupAttributes();
+private:
+    /// Instance used by the static interface
+    static SpriteRenderer* ms_pInstance;
+
+    /// Sprites submitted this frame, the capacity is kept between frames
+    std::vector<Sprite> m_sprites;
+
+    /// Runs of the submitted sprites in draw order
+    std::vector<Run> m_runs;
+
+    /// Sorting memory, reused between frames
+    std::vector<unsigned int> m_order;
+    std::vector<unsigned int> m_spriteRuns;
+    std::vector<Sprite> m_sorted;
+    std::vector<Run> m_sortedRuns;
+
+    /// True while the layers of the submitted sprites don't decrease, the
+    /// sort is skipped for frames submitted in layer order
+    bool m_inOrder = true;
+
+    /// Sprites the instance buffer is orphaned with, only grows
+    size_t m_capacity = 0;
+
+    /// Vertex array reading the sprite instances and the instance buffer, render thread only
+    GLuint m_vao = 0;
+    GLuint m_buffer = 0;
+
+    /// Statistics of the last frame
+    size_t m_drawnSprites = 0;
+    size_t m_drawnBatches = 0;
+};
@@ -0,0 +1,388 @@
+#include "TextRenderer.h"
+
+// Textures and shaders of the batches
+#include "OpenGLModules/GLContext.h"
+
+// Buffers and the vertex array go through the state cache
+#include "OpenGLModules/GLState.h"
+
+// Commands are recorded for the render thread
+#include "OpenGLModules/RenderThread.h"
+
+// For std::max
+#include <algorithm>
+
+TextRenderer* TextRenderer::ms_pInstance = nullptr;
+
+// The glyph is read as 2 vec4, 4 normalized bytes and a float
+static_assert(sizeof(TextRenderer::Glyph) == 40, "Glyph doesn't match the vertex attributes");
+
+namespace
+{
+    /// Attribute locations of the text vertex shader
+    enum AttribLocations
+    {
+        al_Rect = 0,
+        al_TexRect = 1,
+        al_Color = 2,
+        al_Layer = 3,
+        al_Offset = 4,
+    };
+}
+
+TextRenderer::TextRenderer()
+{
+    ms_pInstance = this;
+}
+
+TextRenderer::~TextRenderer()
+{
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void TextRenderer::init()
+{
+    TextRenderer& s = *ms_pInstance;
+
+    glGenVertexArrays(1, &s.m_vao);
+    glGenBuffers(1, &s.m_commandBuffer);
+
+    // The instance buffers are created once the first range is allocated
+}
+
+void TextRenderer::shutdown()
+{
+    TextRenderer& s = *ms_pInstance;
+
+    GLState::deleteVertexArray(s.m_vao);
+    GLState::deleteBuffer(s.m_buffer);
+    GLState::deleteBuffer(s.m_offsets);
+    GLState::deleteBuffer(s.m_commandBuffer);
+
+    s.m_vao = 0;
+    s.m_buffer = 0;
+    s.m_offsets = 0;
+    s.m_commandBuffer = 0;
+    s.m_commandCapacity = 0;
+    s.m_capacity = 0;
+    s.m_free.clear();
+    s.m_batches.clear();
+}
+
+TextRenderer::Range TextRenderer::allocate(size_t count)
+{
+    TextRenderer& s = *ms_pInstance;
+
+    // Power of two sizes keep the free list from fragmenting into unusable pieces
+    size_t size = ms_minRange;
+    while (size < count)
+    {
+        size *= 2;
+    }
+
+    while (true)
+    {
+        // First fit, ranges are taken from the start of a free range
+        for (size_t i = 0; i < s.m_free.size(); i++)
+        {
+            Range& free = s.m_free[i];
+            if (free.Capacity < size)
+            {
+                continue;
+            }
+
+            Range range;
+            range.Offset = free.Offset;
+            range.Capacity = size;
+
+            free.Offset += size;
+            free.Capacity -= size;
+            if (free.Capacity == 0)
+            {
+                s.m_free.erase(s.m_free.begin() + i);
+            }
+
+            return range;
+        }
+
+        grow(std::max(s.m_capacity * 2, s.m_capacity + size));
+    }
+}
+
+void TextRenderer::release(Range& range)
+{
+    // Assets can outlive the renderer
+    if (ms_pInstance == nullptr || range.Capacity == 0)
+    {
+        range = Range();
+        return;
+    }
+
+    TextRenderer& s = *ms_pInstance;
+
+    // Buffers were deleted since the range was allocated
+    if (range.Offset + range.Capacity > s.m_capacity)
+    {
+        range = Range();
+        return;
+    }
+
+    auto it = std::lower_bound(s.m_free.begin(), s.m_free.end(), range, [](const Range& a, const Range& b)
+    {
+        return a.Offset < b.Offset;
+    });
+
+    it = s.m_free.insert(it, range);
+    range = Range();
+
+    // Merge with the following and the previous free range
+    auto next = it + 1;
+    if (next != s.m_free.end() && it->Offset + it->Capacity == next->Offset)
+    {
+        it->Capacity += next->Capacity;
+        s.m_free.erase(next);
+    }
+
+    if (it != s.m_free.begin())
+    {
+        auto previous = it - 1;
+        if (previous->Offset + previous->Capacity == it->Offset)
+        {
+            previous->Capacity += it->Capacity;
+            s.m_free.erase(it);
+        }
+    }
+}
+
+void TextRenderer::write(const Range& range, size_t first, const Glyph* pGlyphs, size_t count)
+{
+    TextRenderer& s = *ms_pInstance;
+
+    if (count == 0 || first + count > range.Capacity)
+    {
+        return;
+    }
+
+    s.m_written += count;
+
+    const Glyph* pCopy = RenderThread::copy(pGlyphs, count);
+    size_t offset = (range.Offset + first) * sizeof(Glyph);
+
+    RenderThread::record([pCopy, count, offset]()
+    {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, ms_pInstance->m_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, count * sizeof(Glyph), pCopy);
+    });
+}
+
+void TextRenderer::setOffset(const Range& range, const glm::vec2& offset)
+{
+    TextRenderer& s = *ms_pInstance;
+
+    if (range.Capacity == 0)
+    {
+        return;
+    }
+
+    s.m_offsetsWritten++;
+
+    // Only the value at the base instance of the range is read
+    size_t position = range.Offset * sizeof(glm::vec2);
+    RenderThread::record([offset, position]()
+    {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, ms_pInstance->m_offsets);
+        glBufferSubData(GL_ARRAY_BUFFER, position, sizeof(glm::vec2), &offset);
+    });
+}
+
+void TextRenderer::submit(Texture* pTexture, Shader* pShader, const Range& range, size_t count)
+{
+    TextRenderer& s = *ms_pInstance;
+
+    if (count == 0 || count > range.Capacity || pTexture == nullptr || pShader == nullptr)
+    {
+        return;
+    }
+
+    // There are only a few fonts, a linear search is enough
+    auto it = std::find_if(s.m_batches.begin(), s.m_batches.end(), [pTexture, pShader](const Batch& batch)
+    {
+        return batch.pTexture == pTexture && batch.pShader == pShader;
+    });
+
+    if (it == s.m_batches.end())
+    {
+        s.m_batches.emplace_back();
+        it = s.m_batches.end() - 1;
+        it->pTexture = pTexture;
+        it->pShader = pShader;
+    }
+
+    // One command per slot, the base instance selects the range
+    DrawCommand command;
+    command.InstanceCount = (GLuint)count;
+    command.BaseInstance = (GLuint)range.Offset;
+    it->Commands.push_back(command);
+}
+
+void TextRenderer::flush()
+{
+    TextRenderer& s = *ms_pInstance;
+
+    // Batches that received nothing this frame are dropped, their texture or shader may be deleted
+    s.m_batches.erase(std::remove_if(s.m_batches.begin(), s.m_batches.end(), [](const Batch& batch)
+    {
+        return batch.Commands.empty();
+    }), s.m_batches.end());
+
+    if (s.m_batches.empty())
+    {
+        return;
+    }
+
+    // Commands of all batches are uploaded together
+    s.m_commands.clear();
+    for (const Batch& batch : s.m_batches)
+    {
+        s.m_commands.insert(s.m_commands.end(), batch.Commands.begin(), batch.Commands.end());
+    }
+
+    size_t count = s.m_commands.size();
+    const DrawCommand* pCommands = RenderThread::copy(s.m_commands.data(), count);
+
+    RenderThread::record([pCommands, count]()
+    {
+        TextRenderer& s = *ms_pInstance;
+        size_t size = count * sizeof(DrawCommand);
+
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, s.m_commandBuffer);
+
+        // The command buffer is orphaned every frame so the previous frame can still read the old storage
+        while (s.m_commandCapacity < size)
+        {
+            s.m_commandCapacity = std::max<size_t>(s.m_commandCapacity * 2, 64 * sizeof(DrawCommand));
+        }
+
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, s.m_commandCapacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, pCommands);
+    });
+
+    // One draw per texture and shader
+    size_t first = 0;
+    for (Batch& batch : s.m_batches)
+    {
+        batch.pShader->bind();
+        batch.pTexture->bind();
+
+        GLsizei commands = (GLsizei)batch.Commands.size();
+        const void* pOffset = (const void*)(first * sizeof(DrawCommand));
+        RenderThread::record([commands, pOffset]()
+        {
+            GLState::bindVertexArray(ms_pInstance->m_vao);
+            GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, ms_pInstance->m_commandBuffer);
+            glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, pOffset, commands, 0);
+        });
+
+        first += (size_t)commands;
+        batch.Commands.clear();
+    }
+}
+
+TextRenderer::Statistics TextRenderer::getStatistics()
+{
+    TextRenderer& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Written = s.m_written;
+    stats.Offsets = s.m_offsetsWritten;
+    stats.Capacity = s.m_capacity;
+    return stats;
+}
+
+void TextRenderer::grow(size_t capacity)
+{
+    TextRenderer& s = *ms_pInstance;
+
+    size_t previous = s.m_capacity;
+    s.m_capacity = capacity;
+
+    // The new space is free, merged with a free range ending at the old size
+    Range added;
+    added.Offset = previous;
+    added.Capacity = capacity - previous;
+
+    if (!s.m_free.empty() && s.m_free.back().Offset + s.m_free.back().Capacity == previous)
+    {
+        s.m_free.back().Capacity += added.Capacity;
+    }
+    else
+    {
+        s.m_free.push_back(added);
+    }
+
+    RenderThread::record([previous, capacity]()
+    {
+        TextRenderer& s = *ms_pInstance;
+
+        GLuint buffers[2] = { 0, 0 };
+        glGenBuffers(2, buffers);
+
+        // Glyphs and offsets written so far are copied into the new buffers
+        GLuint old[2] = { s.m_buffer, s.m_offsets };
+        size_t sizes[2] = { sizeof(Glyph), sizeof(glm::vec2) };
+
+        for (size_t i = 0; i < 2; i++)
+        {
+            GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[i]);
+            glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizes[i], nullptr, GL_DYNAMIC_DRAW);
+
+            if (old[i] != 0)
+            {
+                GLState::bindBuffer(GL_COPY_READ_BUFFER, old[i]);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, previous * sizes[i]);
+                GLState::deleteBuffer(old[i]);
+            }
+        }
+
+        s.m_buffer = buffers[0];
+        s.m_offsets = buffers[1];
+        setupAttributes();
+    });
+}
+
+void TextRenderer::setupAttributes()
+{
+    TextRenderer& s = *ms_pInstance;
+
+    GLState::bindVertexArray(s.m_vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, s.m_buffer);
+
+    // Every attribute advances once per glyph, the quad has no vertex data
+    GLsizei stride = sizeof(Glyph);
+
+    glEnableVertexAttribArray(al_Rect);
+    glVertexAttribPointer(al_Rect, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Glyph, Rect));
+    glVertexAttribDivisor(al_Rect, 1);
+
+    glEnableVertexAttribArray(al_TexRect);
+    glVertexAttribPointer(al_TexRect, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Glyph, TexRect));
+    glVertexAttribDivisor(al_TexRect, 1);
+
+    glEnableVertexAttribArray(al_Color);
+    glVertexAttribPointer(al_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(Glyph, Color));
+    glVertexAttribDivisor(al_Color, 1);
+
+    glEnableVertexAttribArray(al_Layer);
+    glVertexAttribPointer(al_Layer, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Glyph, Layer));
+    glVertexAttribDivisor(al_Layer, 1);
+
+    // The offset element of an instance is instance / divisor + base instance
+    GLState::bindBuffer(GL_ARRAY_BUFFER, s.m_offsets);
+
+    glEnableVertexAttribArray(al_Offset);
+    glVertexAttribPointer(al_Offset, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glVertexAttribDivisor(al_Offset, ms_offsetDivisor);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+// For glyph buffers
+#include <vector>
+#include <cstddef>
+
+// Glyph rectangles and colors
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+class Texture;
+class Shader;
+
+
+/**
+ * Text renderer draws the glyphs of all Text assets as instances of a single
+ * quad. The quad corners are generated in the vertex shader from gl_VertexID,
+ * so the glyphs of every Text asset that uses the same font texture and shader
+ * are drawn with one multi draw indirect call.
+ *
+ * Glyphs live in a persistent instance buffer where every text slot owns a
+ * range. Slots only write the glyphs that changed and are positioned with an
+ * offset stored next to the first glyph of their range, the offset attribute
+ * has a divisor larger than any slot so every instance of a draw reads the
+ * value at the base instance. Moving a slot writes one offset instead of all
+ * of its glyphs.
+ *
+ * Ranges are managed on the thread recording render commands, the vertex
+ * array and the buffers are only accessed from the thread executing render
+ * commands.
+ */
+class TextRenderer
+{
+public:
+    /**
+     * Instance data of a glyph, read by the text vertex shader
+     */
+    struct Glyph
+    {
+        /// Bottom left corner of the quad relative to the slot in xy and its size in zw
+        glm::vec4 Rect = glm::vec4(0.0f);
+
+        /// Texture coordinate of the top left corner in xy and the size in zw
+        glm::vec4 TexRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        /// Color the glyph coverage is multiplied with, normalized by the attribute
+        glm::u8vec4 Color = glm::u8vec4(255);
+
+        /// Texture array layer containing the glyph image
+        float Layer = 0.0f;
+    };
+
+    /**
+     * Glyphs of the instance buffer owned by a text slot
+     */
+    struct Range
+    {
+        /// Index of the first glyph in the instance buffer
+        size_t Offset = 0;
+
+        /// Number of glyphs the range can hold, 0 if it isn't allocated
+        size_t Capacity = 0;
+    };
+
+    /**
+     * Statistics of the text renderer
+     */
+    struct Statistics
+    {
+        /// Glyphs written into the instance buffer since the renderer was created
+        size_t Written = 0;
+
+        /// Slot offsets written since the renderer was created
+        size_t Offsets = 0;
+
+        /// Glyphs the instance buffer can hold
+        size_t Capacity = 0;
+    };
+public:
+    TextRenderer();
+
+    ~TextRenderer();
+
+    /**
+     * Creates the vertex array and the instance buffer, must be called after
+     * the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the vertex array and the instance buffer, must be called before
+     * the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Allocates a range of the instance buffer, ranges are rounded up so text
+     * can grow a little without moving
+     *
+     * @param count Number of glyphs the range must hold
+     */
+    static Range allocate(size_t count);
+
+    /**
+     * Returns a range to the free list, the range is reset
+     */
+    static void release(Range& range);
+
+    /**
+     * Writes glyphs into a range, the glyphs are copied
+     *
+     * @param range Range of the slot
+     * @param first Index of the first written glyph in the range
+     * @param pGlyphs First glyph
+     * @param count Number of glyphs
+     */
+    static void write(const Range& range, size_t first, const Glyph* pGlyphs, size_t count);
+
+    /**
+     * Sets the offset added to every glyph of the range
+     */
+    static void setOffset(const Range& range, const glm::vec2& offset);
+
+    /**
+     * Adds the first glyphs of a range to the batch of the texture and shader
+     *
+     * @param pTexture Font texture the glyphs are sampled from
+     * @param pShader Shader the glyphs are drawn with
+     * @param range Range of the slot
+     * @param count Number of glyphs drawn from the start of the range
+     */
+    static void submit(Texture* pTexture, Shader* pShader, const Range& range, size_t count);
+
+    /**
+     * Draws every batch submitted since the last flush with one multi draw
+     * indirect call, blending must already be set up
+     */
+    static void flush();
+
+    /**
+     * Returns the statistics of the renderer
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Indirect command of glMultiDrawArraysIndirect
+     */
+    struct DrawCommand
+    {
+        GLuint Count = 4;
+        GLuint InstanceCount = 0;
+        GLuint First = 0;
+        GLuint BaseInstance = 0;
+    };
+
+    /**
+     * Slots sharing a texture and a shader
+     */
+    struct Batch
+    {
+        Texture* pTexture = nullptr;
+        Shader* pShader = nullptr;
+        std::vector<DrawCommand> Commands;
+    };
+private:
+    /**
+     * Grows the instance and offset buffers, the existing glyphs are copied on
+     * the thread executing render commands
+     */
+    static void grow(size_t capacity);
+
+    /**
+     * Points the attributes at the instance and offset buffers, must be called
+     * from the thread executing commands
+     */
+    static void setupAttributes();
+private:
+    /// Instance used by the static interface
+    static TextRenderer* ms_pInstance;
+
+    /// Ranges are rounded up to a power of two, at least this many glyphs
+    static constexpr size_t ms_minRange = 16;
+
+    /// Divisor of the offset attribute, larger than any range so every instance
+    /// of a draw reads the offset at its base instance
+    static constexpr GLuint ms_offsetDivisor = 1u << 30;
+
+    /// Batches of the frame, batches that stay empty for a frame are removed
+    std::vector<Batch> m_batches;
+
+    /// Commands of all batches in draw order, reused between frames
+    std::vector<DrawCommand> m_commands;
+
+    /// Free ranges sorted by offset
+    std::vector<Range> m_free;
+
+    /// Glyphs the buffers can hold
+    size_t m_capacity = 0;
+
+    /// Vertex array reading the glyph instances, render thread only
+    GLuint m_vao = 0;
+
+    /// Glyph instance buffer, offset buffer with a value for every glyph and the
+    /// indirect command buffer with it's allocated size, render thread only
+    GLuint m_buffer = 0;
+    GLuint m_offsets = 0;
+    GLuint m_commandBuffer = 0;
+    size_t m_commandCapacity = 0;
+
+    /// Statistics
+    size_t m_written = 0;
+    size_t m_offsetsWritten = 0;
+};
@@ -0,0 +1,443 @@
+#include "TextureStreamer.h"
+
+// Texture class
+#include "OpenGLModules/GLContext.h"
+
+// Decoding images
+#include "Utility/File.h"
+
+// Generating mip levels
+#include "Utility/TextureCompression.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// CPU scopes
+#include "Utility/Profiler.h"
+
+// Copying levels
+#include <algorithm>
+#include <cstring>
+
+TextureStreamer* TextureStreamer::ms_pInstance = nullptr;
+
+namespace
+{
+    /**
+     * Returns the internal format of an uncompressed texture
+     */
+    GLenum getInternalFormat(unsigned int BPP)
+    {
+        return BPP == 1 ? GL_R8 : BPP == 3 ? GL_RGB8 : GL_RGBA8;
+    }
+}
+
+TextureStreamer::TextureStreamer()
+{
+    ms_pInstance = this;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    stop();
+
+    if (ms_pInstance == this)
+    {
+        ms_pInstance = nullptr;
+    }
+}
+
+void TextureStreamer::start(size_t budget)
+{
+    TextureStreamer& s = *ms_pInstance;
+    s.m_budget = std::max<size_t>(budget, 1);
+    s.m_running = true;
+
+    // Leave cores for the game and render threads
+    unsigned int cores = std::thread::hardware_concurrency();
+    unsigned int count = std::min(std::max(cores > 2 ? cores - 2 : 1u, 1u), 4u);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        s.m_workers.emplace_back(&TextureStreamer::workerLoop, &s);
+    }
+}
+
+void TextureStreamer::stop()
+{
+    TextureStreamer& s = *ms_pInstance;
+
+    {
+        std::lock_guard<std::mutex> lock(s.m_mutex);
+        s.m_running = false;
+    }
+
+    s.m_condition.notify_all();
+
+    for (std::thread& worker : s.m_workers)
+    {
+        worker.join();
+    }
+
+    s.m_workers.clear();
+    s.m_queue.clear();
+    s.m_decoded.clear();
+    s.m_jobs.clear();
+    s.m_uploading.clear();
+}
+
+void TextureStreamer::init()
+{
+    TextureStreamer& s = *ms_pInstance;
+
+    // 2x2 checker board
+    const unsigned char pixels[] =
+    {
+        160, 160, 160, 255,   96,  96,  96, 255,
+         96,  96,  96, 255,  160, 160, 160, 255,
+    };
+
+    glGenTextures(1, &s.m_placeholder);
+    GLState::bindTexture(0, GL_TEXTURE_2D, s.m_placeholder);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    // Pixel buffer is allocated by the first upload
+    glGenBuffers(1, &s.m_pixelBuffer);
+}
+
+void TextureStreamer::shutdown()
+{
+    TextureStreamer& s = *ms_pInstance;
+
+    GLState::deleteTexture(s.m_placeholder);
+    GLState::deleteBuffer(s.m_pixelBuffer);
+
+    s.m_placeholder = 0;
+    s.m_pixelBuffer = 0;
+    s.m_pixelBufferSize = 0;
+}
+
+void TextureStreamer::request(Texture* pTexture, const std::string& path)
+{
+    TextureStreamer& s = *ms_pInstance;
+
+    // The latest request wins
+    cancel(pTexture);
+
+    std::shared_ptr<Job> pJob = std::make_shared<Job>();
+    pJob->pTexture = pTexture;
+    pJob->Path = path;
+
+    s.m_jobs[pTexture] = pJob;
+
+    {
+        std::lock_guard<std::mutex> lock(s.m_mutex);
+        s.m_queue.push_back(pJob);
+    }
+
+    s.m_condition.notify_one();
+}
+
+void TextureStreamer::cancel(Texture* pTexture)
+{
+    // Textures can outlive the context
+    if (ms_pInstance == nullptr)
+    {
+        return;
+    }
+
+    TextureStreamer& s = *ms_pInstance;
+
+    auto it = s.m_jobs.find(pTexture);
+    if (it == s.m_jobs.end())
+    {
+        return;
+    }
+
+    // Workers skip cancelled jobs, recorded chunks are still executed before the
+    // texture can be deleted since deletion waits for the render thread
+    std::shared_ptr<Job> pJob = it->second;
+    pJob->Cancelled = true;
+    s.m_jobs.erase(it);
+
+    s.m_uploading.erase(
+        std::remove(s.m_uploading.begin(), s.m_uploading.end(), pJob),
+        s.m_uploading.end());
+}
+
+void TextureStreamer::update()
+{
+    PROFILE_SCOPE("TextureStreamer::update");
+
+    TextureStreamer& s = *ms_pInstance;
+
+    // Pick up decoded images
+    {
+        std::lock_guard<std::mutex> lock(s.m_mutex);
+
+        for (std::shared_ptr<Job>& pJob : s.m_decoded)
+        {
+            if (pJob->Cancelled)
+            {
+                continue;
+            }
+
+            if (pJob->Failed)
+            {
+                LOG_WARN("Texture '{0}' couldn't be streamed!", pJob->Path);
+                s.m_jobs.erase(pJob->pTexture);
+                continue;
+            }
+
+            // Coarsest level is uploaded first
+            pJob->NextLevel = (int)pJob->Levels.size() - 1;
+            s.m_uploading.push_back(pJob);
+        }
+
+        s.m_decoded.clear();
+    }
+
+    // Split the levels into chunks until the budget is used
+    s.m_chunks.clear();
+    size_t size = 0;
+
+    for (auto it = s.m_uploading.begin(); it != s.m_uploading.end() && size < s.m_budget;)
+    {
+        Job& job = **it;
+
+        while (job.NextLevel >= 0 && size < s.m_budget)
+        {
+            const Level& level = job.Levels[job.NextLevel];
+            size_t rowBytes = (size_t)level.Width * job.BPP;
+
+            // At least one row is uploaded per chunk, even if that goes over the budget
+            size_t remaining = level.Height - job.NextRow;
+            size_t rows = std::min(remaining, std::max<size_t>((s.m_budget - size) / rowBytes, 1));
+
+            Chunk chunk;
+            chunk.pJob = *it;
+            chunk.Begin = !job.Started;
+            chunk.Level = job.NextLevel;
+            chunk.Row = job.NextRow;
+            chunk.Rows = (unsigned int)rows;
+            chunk.Offset = size;
+
+            job.Started = true;
+            job.NextRow += (unsigned int)rows;
+
+            if (job.NextRow == level.Height)
+            {
+                chunk.LevelDone = true;
+                job.NextLevel--;
+                job.NextRow = 0;
+            }
+
+            s.m_chunks.push_back(chunk);
+
+            // Keep chunks aligned for the copy
+            size = (size + rows * rowBytes + 15) & ~(size_t)15;
+        }
+
+        if (job.NextLevel >= 0)
+        {
+            ++it;
+            continue;
+        }
+
+        // All levels are recorded, commands using the texture after this point see it complete
+        Texture* pTexture = job.pTexture;
+        pTexture->setFormat(job.Levels[0].Width, job.Levels[0].Height, job.BPP, getInternalFormat(job.BPP),
+            (unsigned int)job.Levels.size(), Texture::getUncompressedSize(job.Levels[0].Width, job.Levels[0].Height, job.BPP));
+        pTexture->m_loaded = true;
+
+        s.m_jobs.erase(pTexture);
+        it = s.m_uploading.erase(it);
+    }
+
+    s.m_uploadedBytes = size;
+
+    if (s.m_chunks.empty())
+    {
+        return;
+    }
+
+    // Jobs stay alive until the chunks have been uploaded
+    RenderThread::record([chunks = s.m_chunks, size]()
+    {
+        ms_pInstance->upload(chunks, size);
+    });
+}
+
+GLuint TextureStreamer::getPlaceholder()
+{
+    return ms_pInstance->m_placeholder;
+}
+
+TextureStreamer::Statistics TextureStreamer::getStatistics()
+{
+    TextureStreamer& s = *ms_pInstance;
+
+    Statistics stats;
+    stats.Uploading = s.m_uploading.size();
+    stats.Decoding = s.m_jobs.size() - stats.Uploading;
+    stats.UploadedBytes = s.m_uploadedBytes;
+    return stats;
+}
+
+void TextureStreamer::workerLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<Job> pJob;
+
+        // Wait for a request
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return !m_running || !m_queue.empty(); });
+
+            if (!m_running)
+            {
+                return;
+            }
+
+            pJob = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        if (pJob->Cancelled)
+        {
+            continue;
+        }
+
+        // Decode the image
+        Memory::reference<ImageFileContents> image = readImage(pJob->Path);
+
+        if (!image.valid() || (image->BPP != 1 && image->BPP != 3 && image->BPP != 4))
+        {
+            pJob->Failed = true;
+        }
+        else
+        {
+            Level level;
+            level.Width = image->Width;
+            level.Height = image->Height;
+            level.Data.assign(image->Buffer, image->Buffer + (size_t)image->Width * image->Height * image->BPP);
+
+            pJob->BPP = image->BPP;
+            pJob->Levels.push_back(std::move(level));
+
+            generateLevels(*pJob);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_decoded.push_back(pJob);
+    }
+}
+
+void TextureStreamer::generateLevels(Job& job)
+{
+    while (job.Levels.back().Width > 1 || job.Levels.back().Height > 1)
+    {
+        const Level& source = job.Levels.back();
+
+        Level level;
+        level.Width = std::max(source.Width / 2, 1u);
+        level.Height = std::max(source.Height / 2, 1u);
+        downsampleImage(source.Data.data(), source.Width, source.Height, job.BPP, level.Data);
+
+        job.Levels.push_back(std::move(level));
+    }
+}
+
+void TextureStreamer::upload(const std::vector<Chunk>& chunks, size_t size)
+{
+    GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+
+    // Orphan the previous contents so the driver doesn't wait for the last uploads
+    m_pixelBufferSize = std::max(m_pixelBufferSize, size);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pixelBufferSize, nullptr, GL_STREAM_DRAW);
+
+    unsigned char* pMapped = static_cast<unsigned char*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    if (pMapped == nullptr)
+    {
+        LOG_ERROR("Failed to map the texture streaming buffer!");
+        GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+
+    // Copy all chunks into the pixel buffer
+    for (const Chunk& chunk : chunks)
+    {
+        const Job& job = *chunk.pJob;
+        const Level& level = job.Levels[chunk.Level];
+        size_t rowBytes = (size_t)level.Width * job.BPP;
+
+        memcpy(pMapped + chunk.Offset, level.Data.data() + chunk.Row * rowBytes, chunk.Rows * rowBytes);
+    }
+
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // Rows are tightly packed, this is also what the font upload uses
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (const Chunk& chunk : chunks)
+    {
+        const Job& job = *chunk.pJob;
+        const Level& level = job.Levels[chunk.Level];
+        Texture* pTexture = job.pTexture;
+
+        GLenum format = job.BPP == 1 ? GL_RED : job.BPP == 3 ? GL_RGB : GL_RGBA;
+
+        if (chunk.Begin)
+        {
+            GLenum internalFormat = getInternalFormat(job.BPP);
+            GLint levels = (GLint)job.Levels.size();
+
+            // Replace the current texture
+            pTexture->deleteTexture();
+
+            glGenTextures(1, &pTexture->m_idTexture);
+            GLState::bindTexture(0, GL_TEXTURE_2D, pTexture->m_idTexture);
+
+            // Same parameters as synchronously loaded textures
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            // Sampling is limited to the levels that have been uploaded
+            glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, job.Levels[0].Width, job.Levels[0].Height);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levels - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+            pTexture->m_target = GL_TEXTURE_2D;
+            pTexture->m_hasLevels = false;
+        }
+        else
+        {
+            GLState::bindTexture(0, GL_TEXTURE_2D, pTexture->m_idTexture);
+        }
+
+        // Source is an offset into the bound pixel buffer
+        glTexSubImage2D(GL_TEXTURE_2D, chunk.Level, 0, chunk.Row, level.Width, chunk.Rows,
+            format, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(chunk.Offset));
+
+        // Finer level is complete, start sampling from it
+        if (chunk.LevelDone)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, chunk.Level);
+            pTexture->m_hasLevels = true;
+        }
+    }
+
+    // Other uploads read from client memory
+    GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
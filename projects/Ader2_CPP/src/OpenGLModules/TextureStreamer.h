@@ -0,0 +1,218 @@
+#pragma once
+
+// Decoded images and requests
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+// Worker threads
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+class Texture;
+
+
+/**
+ * Texture streamer loads textures without blocking the frame. Images are decoded
+ * and their mip chain is generated on worker threads, the game thread then records
+ * uploads through a pixel buffer object with a per frame byte budget. Mip levels
+ * are uploaded from the coarsest to the full resolution one and the base level of
+ * the texture follows the uploads, so the texture gets sharper as it streams in.
+ * Until the first level has been uploaded the placeholder texture is bound instead.
+ *
+ * Requests, cancellation and updates happen on the game thread, the placeholder and
+ * the pixel buffer are only accessed from the thread executing render commands.
+ */
+class TextureStreamer
+{
+public:
+    /**
+     * Statistics of the texture streamer
+     */
+    struct Statistics
+    {
+        /// Textures waiting to be decoded or being decoded
+        size_t Decoding = 0;
+
+        /// Textures with levels that still have to be uploaded
+        size_t Uploading = 0;
+
+        /// Bytes uploaded in the last frame
+        size_t UploadedBytes = 0;
+    };
+public:
+    TextureStreamer();
+
+    ~TextureStreamer();
+
+    /**
+     * Starts the worker threads
+     *
+     * @param budget Bytes that can be uploaded per frame
+     */
+    static void start(size_t budget);
+
+    /**
+     * Stops the worker threads and drops all requests
+     */
+    static void stop();
+
+    /**
+     * Creates the placeholder texture and the pixel buffer, must be called after
+     * the context is created
+     */
+    static void init();
+
+    /**
+     * Deletes the placeholder texture and the pixel buffer, must be called before
+     * the context is destroyed
+     */
+    static void shutdown();
+
+    /**
+     * Starts streaming the image into the texture, a request that is already
+     * in progress for the texture is cancelled
+     */
+    static void request(Texture* pTexture, const std::string& path);
+
+    /**
+     * Cancels the request of the texture
+     */
+    static void cancel(Texture* pTexture);
+
+    /**
+     * Records the uploads of the current frame
+     */
+    static void update();
+
+    /**
+     * Returns the texture that is bound while a texture is streaming
+     */
+    static GLuint getPlaceholder();
+
+    /**
+     * Returns the statistics of the streamer
+     */
+    static Statistics getStatistics();
+private:
+    /**
+     * Mip level of a decoded image
+     */
+    struct Level
+    {
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+        std::vector<unsigned char> Data;
+    };
+
+    /**
+     * Streaming request of a single texture
+     */
+    struct Job
+    {
+        /// Texture receiving the image
+        Texture* pTexture = nullptr;
+
+        /// Path to the image file
+        std::string Path;
+
+        /// Set when the texture no longer wants the image
+        std::atomic<bool> Cancelled{ false };
+
+        /// Decoded image, level 0 is the full resolution
+        unsigned int BPP = 0;
+        std::vector<Level> Levels;
+
+        /// True if the image couldn't be decoded
+        bool Failed = false;
+
+        /// True once the texture storage has been recorded
+        bool Started = false;
+
+        /// Level and row the next upload starts at
+        int NextLevel = 0;
+        unsigned int NextRow = 0;
+    };
+
+    /**
+     * Rows of a level uploaded from the pixel buffer
+     */
+    struct Chunk
+    {
+        /// Job the rows belong to, keeps the data alive until the upload
+        std::shared_ptr<Job> pJob;
+
+        /// True if the texture storage has to be created first
+        bool Begin = false;
+
+        /// True if this is the last chunk of the level
+        bool LevelDone = false;
+
+        /// Uploaded rows
+        int Level = 0;
+        unsigned int Row = 0;
+        unsigned int Rows = 0;
+
+        /// Offset of the rows in the pixel buffer
+        size_t Offset = 0;
+    };
+
+    /**
+     * Decodes requests until the streamer is stopped
+     */
+    void workerLoop();
+
+    /**
+     * Generates the mip chain of the decoded image with a box filter
+     */
+    static void generateLevels(Job& job);
+
+    /**
+     * Executes the uploads of a frame, called on the render thread
+     */
+    void upload(const std::vector<Chunk>& chunks, size_t size);
+private:
+    /// Instance used by the static interface
+    static TextureStreamer* ms_pInstance;
+
+    /// Bytes that can be uploaded per frame
+    size_t m_budget = 0;
+
+    /// Worker threads
+    std::vector<std::thread> m_workers;
+
+    /// Guards the queue, the decoded jobs and the running flag
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_running = false;
+
+    /// Jobs waiting to be decoded
+    std::deque<std::shared_ptr<Job>> m_queue;
+
+    /// Decoded jobs that the game thread hasn't picked up yet
+    std::vector<std::shared_ptr<Job>> m_decoded;
+
+    /// Requests in progress per texture, game thread only
+    std::unordered_map<Texture*, std::shared_ptr<Job>> m_jobs;
+
+    /// Decoded jobs in upload order, game thread only
+    std::vector<std::shared_ptr<Job>> m_uploading;
+
+    /// Chunks of the current frame, game thread only
+    std::vector<Chunk> m_chunks;
+
+    /// Placeholder texture and the pixel buffer, render thread only
+    GLuint m_placeholder = 0;
+    GLuint m_pixelBuffer = 0;
+    size_t m_pixelBufferSize = 0;
+
+    /// Bytes recorded in the last frame
+    std::atomic<size_t> m_uploadedBytes{ 0 };
+};
@@ -0,0 +1,136 @@
+#include "AtlasPacker.h"
+
+// For std::max
+#include <algorithm>
+
+namespace Utility
+{
+	AtlasPacker::AtlasPacker(unsigned int width, unsigned int height)
+		: m_width(width), m_height(height)
+	{
+		// The skyline starts as a single segment at the bottom
+		Segment floor;
+		floor.Width = width;
+		m_skyline.push_back(floor);
+	}
+
+	bool AtlasPacker::insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y)
+	{
+		size_t best = m_skyline.size();
+		unsigned int bestTop = m_height + 1;
+		unsigned int bestWidth = m_width + 1;
+		unsigned int bestY = 0;
+
+		// Find the segment where the top of the rectangle is the lowest, ties
+		// go to the narrower segment so wide gaps are left for wide rectangles
+		for (size_t i = 0; i < m_skyline.size(); i++)
+		{
+			unsigned int top = 0;
+			if (!fits(i, width, height, top))
+			{
+				continue;
+			}
+
+			if (top + height < bestTop || (top + height == bestTop && m_skyline[i].Width < bestWidth))
+			{
+				best = i;
+				bestTop = top + height;
+				bestWidth = m_skyline[i].Width;
+				bestY = top;
+			}
+		}
+
+		if (best == m_skyline.size())
+		{
+			return false;
+		}
+
+		x = m_skyline[best].X;
+		y = bestY;
+		addSegment(best, x, bestTop, width);
+
+		m_usedWidth = std::max(m_usedWidth, x + width);
+		m_usedHeight = std::max(m_usedHeight, bestTop);
+		return true;
+	}
+
+	unsigned int AtlasPacker::getUsedWidth() const
+	{
+		return m_usedWidth;
+	}
+
+	unsigned int AtlasPacker::getUsedHeight() const
+	{
+		return m_usedHeight;
+	}
+
+	bool AtlasPacker::fits(size_t index, unsigned int width, unsigned int height, unsigned int& y) const
+	{
+		unsigned int x = m_skyline[index].X;
+		if (x + width > m_width)
+		{
+			return false;
+		}
+
+		// The rectangle rests on the highest segment below it
+		y = 0;
+		unsigned int remaining = width;
+		for (size_t i = index; remaining > 0; i++)
+		{
+			y = std::max(y, m_skyline[i].Y);
+			if (y + height > m_height)
+			{
+				return false;
+			}
+
+			remaining -= std::min(remaining, m_skyline[i].Width);
+		}
+
+		return true;
+	}
+
+	void AtlasPacker::addSegment(size_t index, unsigned int x, unsigned int y, unsigned int width)
+	{
+		Segment segment;
+		segment.X = x;
+		segment.Y = y;
+		segment.Width = width;
+		m_skyline.insert(m_skyline.begin() + index, segment);
+
+		// Shrink or remove the segments covered by the new one
+		for (size_t i = index + 1; i < m_skyline.size();)
+		{
+			Segment& next = m_skyline[i];
+			unsigned int end = x + width;
+
+			if (next.X >= end)
+			{
+				break;
+			}
+
+			unsigned int shrink = end - next.X;
+			if (shrink < next.Width)
+			{
+				next.X += shrink;
+				next.Width -= shrink;
+				break;
+			}
+
+			m_skyline.erase(m_skyline.begin() + i);
+		}
+
+		// Merge neighbours at the same height
+		for (size_t i = 0; i + 1 < m_skyline.size();)
+		{
+			if (m_skyline[i].Y == m_skyline[i + 1].Y)
+			{
+				m_skyline[i].Width += m_skyline[i + 1].Width;
+				m_skyline.erase(m_skyline.begin() + i + 1);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+}
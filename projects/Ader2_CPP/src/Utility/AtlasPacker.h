@@ -0,0 +1,82 @@
+#pragma once
+
+// Skyline segments
+#include <vector>
+#include <cstddef>
+
+namespace Utility
+{
+	/**
+	 * Packs rectangles into a fixed size area using the skyline bottom-left
+	 * heuristic. The top edge of the packed rectangles is kept as a list of
+	 * horizontal segments, a rectangle is placed on the segment where its top
+	 * ends up the lowest. This wastes a bit more space than MaxRects but it
+	 * stays fast with thousands of small images.
+	 */
+	class AtlasPacker
+	{
+	public:
+		/**
+		 * Create an empty packer
+		 *
+		 * @param width Width of the area
+		 * @param height Height of the area
+		 */
+		AtlasPacker(unsigned int width, unsigned int height);
+
+		/**
+		 * Places a rectangle into the area
+		 *
+		 * @param width Width of the rectangle
+		 * @param height Height of the rectangle
+		 * @param x Receives the left edge of the placed rectangle
+		 * @param y Receives the bottom edge of the placed rectangle
+		 *
+		 * @return True if the rectangle was placed, false if it doesn't fit
+		 */
+		bool insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+
+		/**
+		 * Returns the width of the area covered by placed rectangles
+		 */
+		unsigned int getUsedWidth() const;
+
+		/**
+		 * Returns the height of the area covered by placed rectangles
+		 */
+		unsigned int getUsedHeight() const;
+	private:
+		/**
+		 * Horizontal segment of the skyline
+		 */
+		struct Segment
+		{
+			unsigned int X = 0;
+			unsigned int Y = 0;
+			unsigned int Width = 0;
+		};
+
+		/**
+		 * Returns the height a rectangle starting at the segment would be placed at
+		 *
+		 * @return True if the rectangle fits there, false otherwise
+		 */
+		bool fits(size_t index, unsigned int width, unsigned int height, unsigned int& y) const;
+
+		/**
+		 * Raises the skyline under a placed rectangle
+		 */
+		void addSegment(size_t index, unsigned int x, unsigned int y, unsigned int width);
+	private:
+		/// Size of the area
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+
+		/// Area covered by placed rectangles
+		unsigned int m_usedWidth = 0;
+		unsigned int m_usedHeight = 0;
+
+		/// Skyline from left to right
+		std::vector<Segment> m_skyline;
+	};
+}
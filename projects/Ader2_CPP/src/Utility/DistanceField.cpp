@@ -0,0 +1,154 @@
+#include "DistanceField.h"
+
+// For std::sqrt and std::min
+#include <cmath>
+#include <algorithm>
+
+namespace Utility
+{
+	namespace
+	{
+		/// Larger than any squared distance in a field
+		constexpr float c_infinity = 1e20f;
+
+		// Squared distance transform of a sampled function in one dimension,
+		// the lower envelope of the parabolas rooted at every sample
+		void transform(const float* f, size_t n, float* d, size_t* v, float* z)
+		{
+			size_t k = 0;
+			v[0] = 0;
+			z[0] = -c_infinity;
+			z[1] = c_infinity;
+
+			for (size_t q = 1; q < n; q++)
+			{
+				// Remove the parabolas hidden by this one, the first one never is
+				float s = 0.0f;
+				while (true)
+				{
+					size_t p = v[k];
+					s = ((f[q] + (float)(q * q)) - (f[p] + (float)(p * p))) / (2.0f * q - 2.0f * p);
+
+					if (s > z[k])
+					{
+						break;
+					}
+
+					k--;
+				}
+
+				k++;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = c_infinity;
+			}
+
+			k = 0;
+			for (size_t q = 0; q < n; q++)
+			{
+				while (z[k + 1] < q)
+				{
+					k++;
+				}
+
+				float delta = (float)q - (float)v[k];
+				d[q] = delta * delta + f[v[k]];
+			}
+		}
+
+		// Squared distance of every pixel to the nearest pixel where the grid is 0
+		void transform2D(std::vector<float>& grid, size_t width, size_t height)
+		{
+			size_t n = std::max(width, height);
+			std::vector<float> f(n);
+			std::vector<float> d(n);
+			std::vector<float> z(n + 1);
+			std::vector<size_t> v(n);
+
+			// Columns
+			for (size_t x = 0; x < width; x++)
+			{
+				for (size_t y = 0; y < height; y++)
+				{
+					f[y] = grid[y * width + x];
+				}
+
+				transform(f.data(), height, d.data(), v.data(), z.data());
+
+				for (size_t y = 0; y < height; y++)
+				{
+					grid[y * width + x] = d[y];
+				}
+			}
+
+			// Rows
+			for (size_t y = 0; y < height; y++)
+			{
+				transform(&grid[y * width], width, d.data(), v.data(), z.data());
+				std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+			}
+		}
+	}
+
+	void buildDistanceField(const unsigned char* pCoverage, unsigned int width, unsigned int height, unsigned int spread, unsigned int downscale,
+		std::vector<unsigned char>& field, unsigned int& fieldWidth, unsigned int& fieldHeight)
+	{
+		downscale = std::max(downscale, 1u);
+
+		// The image is padded by the spread and rounded up to whole field texels
+		size_t padding = (size_t)spread * downscale;
+		size_t paddedWidth = (width + 2 * padding + downscale - 1) / downscale * downscale;
+		size_t paddedHeight = (height + 2 * padding + downscale - 1) / downscale * downscale;
+
+		// Distances to the inside are measured from outside pixels and the other way around
+		std::vector<float> toInside(paddedWidth * paddedHeight, c_infinity);
+		std::vector<float> toOutside(paddedWidth * paddedHeight, 0.0f);
+
+		for (size_t y = 0; y < height; y++)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				if (pCoverage[y * width + x] >= 128)
+				{
+					size_t index = (y + padding) * paddedWidth + x + padding;
+					toInside[index] = 0.0f;
+					toOutside[index] = c_infinity;
+				}
+			}
+		}
+
+		transform2D(toInside, paddedWidth, paddedHeight);
+		transform2D(toOutside, paddedWidth, paddedHeight);
+
+		fieldWidth = (unsigned int)(paddedWidth / downscale);
+		fieldHeight = (unsigned int)(paddedHeight / downscale);
+		field.resize((size_t)fieldWidth * fieldHeight);
+
+		// Distances are positive inside, the spread maps to half of the value range
+		float range = 2.0f * (float)std::max<size_t>(padding, 1);
+		float samples = (float)(downscale * downscale);
+
+		for (size_t fy = 0; fy < fieldHeight; fy++)
+		{
+			for (size_t fx = 0; fx < fieldWidth; fx++)
+			{
+				float sum = 0.0f;
+				for (size_t y = fy * downscale; y < (fy + 1) * downscale; y++)
+				{
+					for (size_t x = fx * downscale; x < (fx + 1) * downscale; x++)
+					{
+						size_t index = y * paddedWidth + x;
+
+						// Pixel centers are half a pixel away from the edge between them
+						sum += toOutside[index] > 0.0f
+							? std::sqrt(toOutside[index]) - 0.5f
+							: 0.5f - std::sqrt(toInside[index]);
+					}
+				}
+
+				float value = 0.5f + sum / samples / range;
+				field[fy * fieldWidth + fx] = (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Field buffer
+#include <vector>
+
+namespace Utility
+{
+	/**
+	 * Builds a signed distance field from an 8 bit coverage image. Pixels with
+	 * at least half coverage are inside, the exact Euclidean distance of every
+	 * pixel to the nearest pixel on the other side is computed with the
+	 * separable transform of Felzenszwalb and Huttenlocher (2012).
+	 *
+	 * The coverage is usually rendered larger than the field, distances are
+	 * averaged over blocks of downscale x downscale pixels which gives the field
+	 * sub-texel precision along the edges. The field is stored with 0.5 on the
+	 * edge, values above are inside and the range covers spread texels on both
+	 * sides, so a shader can render it at any size with a single threshold.
+	 *
+	 * @param pCoverage Coverage image, rows top down without padding
+	 * @param width Width of the coverage image
+	 * @param height Height of the coverage image
+	 * @param spread Distance in field texels that the field covers outside and inside,
+	 *               the field is surrounded by this many texels
+	 * @param downscale Coverage pixels per field texel
+	 * @param field Receives the field, rows top down without padding
+	 * @param fieldWidth Receives the width of the field
+	 * @param fieldHeight Receives the height of the field
+	 */
+	void buildDistanceField(const unsigned char* pCoverage, unsigned int width, unsigned int height, unsigned int spread, unsigned int downscale,
+		std::vector<unsigned char>& field, unsigned int& fieldWidth, unsigned int& fieldHeight);
+}
@@ -3,6 +3,12 @@
 // ifstream
 #include <fstream>
 
+// Creating directories
+#include <filesystem>
+
+// For memcpy
+#include <cstring>
+
 // Logging
 #include "Utility/Log.h"
 
@@ -38,6 +44,50 @@ std::string readFile(const std::string& path)
 	return result;
 }
 
+bool readBinaryFile(const std::string& path, std::vector<unsigned char>& data)
+{
+	// Open file
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Get size of the file
+	std::streampos fileSize = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	// Resize the buffer and copy file contents
+	data.resize((size_t)fileSize);
+	file.read(reinterpret_cast<char*>(data.data()), fileSize);
+
+	return file.good();
+}
+
+bool writeBinaryFile(const std::string& path, const void* pData, size_t size)
+{
+	// Create missing directories
+	std::error_code ec;
+	std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	if (!directory.empty())
+	{
+		std::filesystem::create_directories(directory, ec);
+	}
+
+	// Open file
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		LOG_WARN("Failed to open '{0}' for writing!", path);
+		return false;
+	}
+
+	file.write(static_cast<const char*>(pData), size);
+	return file.good();
+}
+
 ImageFileContents::~ImageFileContents()
 {
 	// Check if the image has a valid buffer and then free it
@@ -139,125 +189,164 @@ Memory::reference<WaveFileContents> readAudio(const std::string& path)
 	return result;
 }
 
-Memory::reference<FontFileContents> readFont(const std::string& path)
+namespace
 {
-	FT_Library  library;   // Handle to library
-	FT_Face     face;      // Handle to face object
-	FT_Error	error;
+	/// FreeType library shared by all faces
+	FT_Library s_library = nullptr;
 
-	Memory::reference<FontFileContents> result = new FontFileContents();
+	/// Number of open faces, the library is released with the last one
+	unsigned int s_faceCount = 0;
+}
 
-	// Default values
-	result->PixelWidth = 0;
-	result->PixelHeight = 32;
-	result->Width = 128;
-	result->Height = 1;
+struct FontFace
+{
+	/// FreeType face
+	FT_Face Face = nullptr;
 
-	// Init FreeType
-	error = FT_Init_FreeType(&library);
-	if (error)
+	/// Size the face is currently set to
+	unsigned int Size = 0;
+};
+
+FontFace* openFont(const std::string& path)
+{
+	FT_Error error;
+
+	// Init FreeType once for all faces
+	if (s_library == nullptr)
 	{
-		LOG_ERROR("FreeType failed to initialize");
-		FT_Done_FreeType(library);
-		return nullptr;
+		error = FT_Init_FreeType(&s_library);
+		if (error)
+		{
+			LOG_ERROR("FreeType failed to initialize");
+			s_library = nullptr;
+			return nullptr;
+		}
 	}
 
 	// Create new face from the specified path
-	error = FT_New_Face(library,
+	FT_Face face = nullptr;
+	error = FT_New_Face(s_library,
 		path.c_str(),
 		0,
 		&face);
 
 	// Check for errors
-	if (error == FT_Err_Unknown_File_Format)
+	if (error)
 	{
-		FT_Done_Face(face);
-		FT_Done_FreeType(library);
+		if (error == FT_Err_Unknown_File_Format)
+		{
+			LOG_ERROR("The font file '{0}' could be opened and read, but it appears that its font format is unsupported", path);
+		}
+		else
+		{
+			LOG_ERROR("The font file '{0}' could not be opened and read", path);
+		}
 
-		LOG_ERROR("The font file could be opened and read, but it appears that its font format is unsupported");
-		return nullptr;
-	}
-	else if (error)
-	{
-		FT_Done_Face(face);
-		FT_Done_FreeType(library);
+		// Release the library if no other face uses it
+		if (s_faceCount == 0)
+		{
+			FT_Done_FreeType(s_library);
+			s_library = nullptr;
+		}
 
-		LOG_ERROR("The font file could not be opened and read");
 		return nullptr;
 	}
 
-	// Set the size of generated glyph data, resolution could take a parameter but for now it's
-	// enough
-	error = FT_Set_Char_Size(
-		face,							// Handle to face object
-		result->PixelWidth,				// char_width in 1/64th of points
-		result->PixelHeight * 64,		// char_height in 1/64th of points
-		96,								// Horizontal device resolution
-		96);							// Vertical device resolution
-
-	// If any of these values were 0 than the FreeType library set them to the one that isn't 0
-	if (result->PixelWidth == 0)
+	FontFace* pFace = new FontFace();
+	pFace->Face = face;
+	s_faceCount++;
+
+	return pFace;
+}
+
+void closeFont(FontFace* pFace)
+{
+	if (pFace == nullptr)
 	{
-		result->PixelWidth = result->PixelHeight;
+		return;
 	}
-	else if (result->PixelHeight == 0)
+
+	FT_Done_Face(pFace->Face);
+	delete pFace;
+
+	// Clean up FreeType with the last face
+	if (--s_faceCount == 0)
 	{
-		result->PixelHeight = result->PixelWidth;
+		FT_Done_FreeType(s_library);
+		s_library = nullptr;
 	}
+}
 
-	// Additional variables for reserving buffer data and getting width and height correctly
-	int max_dim = (1 + (face->size->metrics.height >> 6))* ceilf(sqrtf(128));
-	int tex_width = 1;
-	while (tex_width < max_dim) tex_width <<= 1;
-	int tex_height = tex_width;
-
-	// Width and height
-	result->Width = tex_width;
-	result->Height = tex_height;
+namespace
+{
+	// Sets the size of the face if it changed
+	bool setFontSize(FontFace* pFace, unsigned int size)
+	{
+		// Changing the size is cheap but not free, glyphs of a size are usually rendered together
+		if (pFace->Size == size)
+		{
+			return true;
+		}
 
-	// Texture buffer
-	result->Buffer = std::vector<unsigned char>(tex_width * tex_height, 0);
+		FT_Error error = FT_Set_Char_Size(
+			pFace->Face,		// Handle to face object
+			0,					// char_width in 1/64th of points, same as the height
+			size * 64,			// char_height in 1/64th of points
+			96,					// Horizontal device resolution
+			96);				// Vertical device resolution
+
+		if (error)
+		{
+			LOG_ERROR("Font size {0} isn't supported by the face", size);
+			return false;
+		}
 
-	// More variables to help generate text
-	int off = 0;
-	int pen_x = 0, pen_y = 0;
+		pFace->Size = size;
+		return true;
+	}
+}
 
-	for (int i = 0; i < 128; ++i)
+int getLineHeight(FontFace* pFace, unsigned int size)
+{
+	if (!setFontSize(pFace, size))
 	{
-		result->Metrics[i] = {};
+		return 0;
+	}
 
-		FT_Load_Char(face, i, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT);
-		FT_Bitmap* bmp = &face->glyph->bitmap;
+	return pFace->Face->size->metrics.height >> 6;
+}
 
-		if (pen_x + bmp->width >= result->Width) {
-			pen_x = 0;
-			pen_y += ((face->size->metrics.height >> 6) + 1);
-		}
+bool renderGlyph(FontFace* pFace, unsigned int size, unsigned int codepoint, GlyphBitmap& glyph)
+{
+	FT_Error error;
 
-		for (int row = 0; row < bmp->rows; ++row) {
-			for (int col = 0; col < bmp->width; ++col) {
-				int x = pen_x + col;
-				int y = pen_y + row;
-				result->Buffer[y * result->Width + x] = bmp->buffer[row * bmp->pitch + col];
-			}
-		}
+	if (!setFontSize(pFace, size))
+	{
+		return false;
+	}
+
+	// Missing characters use glyph 0 which is the replacement glyph of the face
+	error = FT_Load_Char(pFace->Face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT);
+	if (error)
+	{
+		return false;
+	}
 
-		result->Metrics[i].Start.x = pen_x;
-		result->Metrics[i].Start.y = pen_y;
-		result->Metrics[i].End.x = pen_x + bmp->width;
-		result->Metrics[i].End.y = pen_y + bmp->rows;
+	FT_GlyphSlot slot = pFace->Face->glyph;
+	FT_Bitmap* bmp = &slot->bitmap;
 
-		result->Metrics[i].Offset.x = face->glyph->bitmap_left;
-		result->Metrics[i].Offset.y = face->glyph->bitmap_top;
-		result->Metrics[i].Advance = face->glyph->advance.x >> 6;
+	glyph.Width = bmp->width;
+	glyph.Height = bmp->rows;
+	glyph.Left = slot->bitmap_left;
+	glyph.Top = slot->bitmap_top;
+	glyph.Advance = slot->advance.x >> 6;
 
-		pen_x += bmp->width + 1;
+	// Copy the rows, the pitch can be larger than the width
+	glyph.Buffer.resize(glyph.Width * glyph.Height);
+	for (unsigned int row = 0; row < glyph.Height; ++row)
+	{
+		memcpy(glyph.Buffer.data() + row * glyph.Width, bmp->buffer + row * bmp->pitch, glyph.Width);
 	}
 
-	// Clean up FreeType
-	FT_Done_Face(face);
-	FT_Done_FreeType(library);
-
-	// Return the result
-	return result;
+	return true;
 }
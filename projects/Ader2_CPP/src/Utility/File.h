@@ -6,12 +6,6 @@
 // For data buffers
 #include <vector>
 
-// For Metrics map
-#include <unordered_map>
-
-// Vectors
-#include <glm/glm.hpp>
-
 // Reference
 #include "CommonTypes/reference.h"
 
@@ -25,6 +19,27 @@
  */
 std::string readFile(const std::string& path);
 
+/**
+ * Reads entire file contents as binary data
+ *
+ * @param path Path to the file
+ * @param data Vector that receives the file contents
+ *
+ * @return True if the file was read, false otherwise
+ */
+bool readBinaryFile(const std::string& path, std::vector<unsigned char>& data);
+
+/**
+ * Writes binary data to the specified file, missing directories are created
+ *
+ * @param path Path to the file
+ * @param pData Data to write
+ * @param size Size of the data in bytes
+ *
+ * @return True if the file was written, false otherwise
+ */
+bool writeBinaryFile(const std::string& path, const void* pData, size_t size);
+
 /**
  * Struct containing the loaded image file data
  */
@@ -93,38 +108,62 @@ struct WaveFileContents
 Memory::reference<WaveFileContents> readAudio(const std::string& path);
 
 /**
- * Char metrics data structure used for specifying individual character attributes
+ * Font face opened with openFont, FreeType is initialized with the first
+ * face and shut down with the last one
  */
-struct CharMetric
-{
-    /// Start coordinates of the character in the texture
-    glm::vec2 Start;
-    /// End coordinates of the character in the texture
-    glm::vec2 End;
-    /// Offset from the start of the image
-    glm::vec2 Offset;
-    /// Offset to next glyph
-    int Advance;
-};
+struct FontFace;
 
 /**
- * Struct containing the loaded font file data
+ * Image and metrics of a single rendered glyph
  */
-struct FontFileContents
+struct GlyphBitmap
 {
-    unsigned int PixelWidth;
-    unsigned int PixelHeight;
-    unsigned int Width;
-    unsigned int Height;
+    /// Size of the image in pixels, 0 for glyphs without an image (spaces)
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+
+    /// Offset of the top left corner of the image from the pen position
+    int Left = 0;
+    int Top = 0;
+
+    /// Offset to next glyph
+    int Advance = 0;
+
+    /// 8 bit coverage, rows are stored top down without padding
     std::vector<unsigned char> Buffer;
-    std::unordered_map<char, CharMetric> Metrics;
 };
 
 /**
- * Reads font data from the specified file
+ * Opens a font face from the specified file
  *
  * @param path Path to the font file
  *
- * @return Reference to FontFileContents
+ * @return Opened face or nullptr if it couldn't be read
+ */
+FontFace* openFont(const std::string& path);
+
+/**
+ * Closes a face opened with openFont
+ */
+void closeFont(FontFace* pFace);
+
+/**
+ * Returns the distance between two lines of text in pixels
+ *
+ * @param pFace Face of the text
+ * @param size Size of the font in points at 96 DPI
+ */
+int getLineHeight(FontFace* pFace, unsigned int size);
+
+/**
+ * Renders a single glyph of the face
+ *
+ * @param pFace Face to render from
+ * @param size Size of the font in points at 96 DPI
+ * @param codepoint Unicode codepoint of the character
+ * @param glyph Struct that receives the image and metrics
+ *
+ * @return True if the glyph was rendered, characters missing from the face
+ *         render the replacement glyph of the face
  */
-Memory::reference<FontFileContents> readFont(const std::string& path);
\ No newline at end of file
+bool renderGlyph(FontFace* pFace, unsigned int size, unsigned int codepoint, GlyphBitmap& glyph);
\ No newline at end of file
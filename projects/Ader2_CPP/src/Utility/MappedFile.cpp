@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+// Platform mapping functions
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+#ifdef _WIN32
+	// Open the file for reading, other processes may still read it
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// Map the whole file
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_pData = static_cast<const unsigned char*>(pView);
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	// Map the whole file, the mapping stays valid after the descriptor is closed
+	void* pView = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+
+	if (pView == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_pData = static_cast<const unsigned char*>(pView);
+	m_size = (size_t)fileStat.st_size;
+#endif
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_pData == nullptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+#else
+	munmap(const_cast<unsigned char*>(m_pData), m_size);
+#endif
+
+	m_pData = nullptr;
+	m_size = 0;
+	m_file = nullptr;
+	m_mapping = nullptr;
+}
+
+bool MappedFile::isOpen() const
+{
+	return m_pData != nullptr;
+}
+
+const unsigned char* MappedFile::data() const
+{
+	return m_pData;
+}
+
+size_t MappedFile::size() const
+{
+	return m_size;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// For string
+#include <string>
+
+// For size_t
+#include <cstddef>
+
+/**
+ * Read only view of a file mapped into the address space of the process. Pages
+ * are read in by the operating system the first time they are touched, so
+ * large files can be consumed straight from the mapping without reading them
+ * into a buffer first.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+
+    /**
+     * Unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Maps the specified file, a previously mapped file is unmapped first
+     *
+     * @param path Path to the file
+     *
+     * @return True if the file was mapped, false otherwise
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps the file, does nothing if no file is mapped
+     */
+    void close();
+
+    /**
+     * Returns true if a file is mapped
+     */
+    bool isOpen() const;
+
+    /**
+     * Returns the first byte of the mapped file or nullptr if no file is mapped
+     */
+    const unsigned char* data() const;
+
+    /**
+     * Returns the size of the mapped file in bytes
+     */
+    size_t size() const;
+private:
+    /// Start of the mapping
+    const unsigned char* m_pData = nullptr;
+
+    /// Size of the mapping in bytes
+    size_t m_size = 0;
+
+    /// Handles of the file and the mapping object
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+};
@@ -0,0 +1,506 @@
+#include "MeshFile.h"
+
+// Reading and writing files
+#include "Utility/File.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// For vertex merging and parsing
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cfloat>
+
+namespace
+{
+	/// Mesh file identifier and the version written by writeMesh
+	constexpr unsigned int c_meshMagic = 'A' | ('M' << 8) | ('S' << 16) | ('H' << 24);
+	constexpr unsigned int c_meshVersion = 1;
+
+	/// Alignment of the data sections
+	constexpr size_t c_meshAlignment = 16;
+
+	/// More attributes than this can't be bound by the renderer anyway
+	constexpr unsigned int c_maxAttributes = 16;
+
+	static_assert(sizeof(MeshHeader) == 72, "Mesh header must match the file layout");
+	static_assert(sizeof(VertexAttribute) == 20, "Vertex attribute must match the file layout");
+
+	/**
+	 * Position, texture coordinate and normal indices of a face corner, -1 if
+	 * the corner doesn't have the attribute
+	 */
+	struct Corner
+	{
+		int Position;
+		int TexCoord;
+		int Normal;
+
+		bool operator==(const Corner& other) const
+		{
+			return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal;
+		}
+	};
+
+	struct CornerHash
+	{
+		size_t operator()(const Corner& corner) const
+		{
+			size_t hash = (size_t)corner.Position * 73856093u;
+			hash ^= (size_t)corner.TexCoord * 19349663u;
+			hash ^= (size_t)corner.Normal * 83492791u;
+			return hash;
+		}
+	};
+
+	void pad(std::vector<unsigned char>& data, size_t alignment)
+	{
+		data.resize((data.size() + alignment - 1) / alignment * alignment, 0);
+	}
+
+	void append(std::vector<unsigned char>& data, const void* pData, size_t size)
+	{
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		data.insert(data.end(), pBytes, pBytes + size);
+	}
+
+	/**
+	 * Resolves a 1 based OBJ index, negative indices are relative to the end
+	 *
+	 * @return 0 based index or -1 if the index is out of range
+	 */
+	int resolveIndex(long index, size_t count)
+	{
+		long resolved = index > 0 ? index - 1 : (long)count + index;
+		return resolved >= 0 && resolved < (long)count ? (int)resolved : -1;
+	}
+
+	/**
+	 * Parses a face corner in the v, v/vt, v//vn or v/vt/vn format
+	 *
+	 * @return Pointer past the corner or nullptr if there isn't one
+	 */
+	const char* parseCorner(const char* pText, size_t positions, size_t texCoords, size_t normals, Corner& corner)
+	{
+		char* pEnd;
+		long position = strtol(pText, &pEnd, 10);
+		if (pEnd == pText)
+		{
+			return nullptr;
+		}
+
+		corner.Position = resolveIndex(position, positions);
+		corner.TexCoord = -1;
+		corner.Normal = -1;
+		pText = pEnd;
+
+		if (*pText == '/')
+		{
+			pText++;
+			if (*pText != '/')
+			{
+				long texCoord = strtol(pText, &pEnd, 10);
+				if (pEnd != pText)
+				{
+					corner.TexCoord = resolveIndex(texCoord, texCoords);
+					pText = pEnd;
+				}
+			}
+
+			if (*pText == '/')
+			{
+				pText++;
+				long normal = strtol(pText, &pEnd, 10);
+				if (pEnd != pText)
+				{
+					corner.Normal = resolveIndex(normal, normals);
+					pText = pEnd;
+				}
+			}
+		}
+
+		return pText;
+	}
+}
+
+size_t getVertexAttributeSize(VertexAttributeType type, unsigned int components)
+{
+	switch (type)
+	{
+	case vat_Float:
+		return 4 * components;
+	case vat_HalfFloat:
+	case vat_Short:
+	case vat_UnsignedShort:
+		return 2 * components;
+	case vat_Byte:
+	case vat_UnsignedByte:
+		return components;
+	case vat_Int2101010:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+VertexLayout& VertexLayout::add(unsigned int location, unsigned int components, VertexAttributeType type, bool normalized)
+{
+	VertexAttribute attribute;
+	attribute.Location = location;
+	attribute.Components = components;
+	attribute.Type = type;
+	attribute.Normalized = normalized ? 1 : 0;
+	attribute.Offset = Stride;
+	Attributes.push_back(attribute);
+
+	// Keep the next attribute aligned
+	Stride += (unsigned int)((getVertexAttributeSize(type, components) + 3) / 4 * 4);
+	return *this;
+}
+
+const VertexAttribute* VertexLayout::find(unsigned int location) const
+{
+	for (const VertexAttribute& attribute : Attributes)
+	{
+		if (attribute.Location == location)
+		{
+			return &attribute;
+		}
+	}
+
+	return nullptr;
+}
+
+bool isValidLayout(const VertexAttribute* pAttributes, size_t count, unsigned int stride)
+{
+	if (stride == 0)
+	{
+		return false;
+	}
+
+	// Every attribute must be inside the vertex
+	for (size_t i = 0; i < count; i++)
+	{
+		const VertexAttribute& attribute = pAttributes[i];
+		size_t attributeSize = getVertexAttributeSize((VertexAttributeType)attribute.Type, attribute.Components);
+
+		if (attribute.Components == 0 || attribute.Components > 4 || attributeSize == 0 ||
+			attribute.Offset > stride || attributeSize > stride - attribute.Offset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool isMeshPath(const std::string& path)
+{
+	size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+	{
+		return false;
+	}
+
+	std::string extension = path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == "amesh";
+}
+
+bool parseMesh(const unsigned char* pData, size_t size, MeshView& mesh)
+{
+	if (pData == nullptr || size < sizeof(MeshHeader))
+	{
+		return false;
+	}
+
+	const MeshHeader* pHeader = reinterpret_cast<const MeshHeader*>(pData);
+	if (pHeader->Magic != c_meshMagic || pHeader->Version != c_meshVersion)
+	{
+		return false;
+	}
+
+	if (pHeader->AttributeCount == 0 || pHeader->AttributeCount > c_maxAttributes || pHeader->Stride == 0)
+	{
+		return false;
+	}
+
+	if (sizeof(MeshHeader) + pHeader->AttributeCount * sizeof(VertexAttribute) > size)
+	{
+		return false;
+	}
+
+	const VertexAttribute* pAttributes = reinterpret_cast<const VertexAttribute*>(pData + sizeof(MeshHeader));
+	if (!isValidLayout(pAttributes, pHeader->AttributeCount, pHeader->Stride))
+	{
+		return false;
+	}
+
+	// Data sections must be inside the file
+	unsigned long long verticesSize = (unsigned long long)pHeader->VertexCount * pHeader->Stride;
+	if (pHeader->VertexOffset % 4 != 0 || pHeader->VertexOffset > size || verticesSize > size - pHeader->VertexOffset)
+	{
+		return false;
+	}
+
+	unsigned long long indicesSize = (unsigned long long)pHeader->IndexCount * pHeader->IndexSize;
+	if (pHeader->IndexCount > 0)
+	{
+		if ((pHeader->IndexSize != 2 && pHeader->IndexSize != 4) || pHeader->IndexOffset % pHeader->IndexSize != 0 ||
+			pHeader->IndexOffset > size || indicesSize > size - pHeader->IndexOffset)
+		{
+			return false;
+		}
+
+		// Indices are drawn as is, every one must address a vertex
+		const unsigned char* pIndices = pData + pHeader->IndexOffset;
+		for (unsigned int i = 0; i < pHeader->IndexCount; i++)
+		{
+			unsigned int index = pHeader->IndexSize == 2 ?
+				reinterpret_cast<const unsigned short*>(pIndices)[i] :
+				reinterpret_cast<const unsigned int*>(pIndices)[i];
+
+			if (index >= pHeader->VertexCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	mesh.pHeader = pHeader;
+	mesh.pAttributes = pAttributes;
+	mesh.pVertices = pData + pHeader->VertexOffset;
+	mesh.pIndices = pHeader->IndexCount > 0 ? pData + pHeader->IndexOffset : nullptr;
+	return true;
+}
+
+bool writeMesh(const std::string& path, const MeshContents& mesh)
+{
+	const VertexLayout& layout = mesh.Layout;
+	if (layout.Attributes.empty() || layout.Attributes.size() > c_maxAttributes || layout.Stride == 0 ||
+		mesh.Vertices.size() != (size_t)mesh.VertexCount * layout.Stride)
+	{
+		LOG_WARN("Can't write '{0}', the mesh layout doesn't match its data", path);
+		return false;
+	}
+
+	// Every index fits into 16 bits if there are few enough vertices
+	bool shortIndices = mesh.VertexCount <= 0x10000;
+
+	MeshHeader header;
+	header.Magic = c_meshMagic;
+	header.Version = c_meshVersion;
+	header.AttributeCount = (unsigned int)layout.Attributes.size();
+	header.Stride = layout.Stride;
+	header.VertexCount = mesh.VertexCount;
+	header.IndexCount = (unsigned int)mesh.Indices.size();
+	header.IndexSize = shortIndices ? 2 : 4;
+	memcpy(header.BoundsMin, &mesh.BoundsMin[0], sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, &mesh.BoundsMax[0], sizeof(header.BoundsMax));
+
+	// Section offsets
+	size_t vertexOffset = sizeof(MeshHeader) + layout.Attributes.size() * sizeof(VertexAttribute);
+	vertexOffset = (vertexOffset + c_meshAlignment - 1) / c_meshAlignment * c_meshAlignment;
+	size_t indexOffset = vertexOffset + mesh.Vertices.size();
+	indexOffset = (indexOffset + c_meshAlignment - 1) / c_meshAlignment * c_meshAlignment;
+
+	header.VertexOffset = vertexOffset;
+	header.IndexOffset = indexOffset;
+
+	std::vector<unsigned char> data;
+	data.reserve(indexOffset + mesh.Indices.size() * header.IndexSize);
+
+	append(data, &header, sizeof(header));
+	append(data, layout.Attributes.data(), layout.Attributes.size() * sizeof(VertexAttribute));
+	pad(data, c_meshAlignment);
+	append(data, mesh.Vertices.data(), mesh.Vertices.size());
+	pad(data, c_meshAlignment);
+
+	if (shortIndices)
+	{
+		for (unsigned int index : mesh.Indices)
+		{
+			unsigned short value = (unsigned short)index;
+			append(data, &value, sizeof(value));
+		}
+	}
+	else
+	{
+		append(data, mesh.Indices.data(), mesh.Indices.size() * sizeof(unsigned int));
+	}
+
+	return writeBinaryFile(path, data.data(), data.size());
+}
+
+bool readOBJ(const std::string& path, MeshContents& mesh)
+{
+	std::vector<unsigned char> text;
+	if (!readBinaryFile(path, text))
+	{
+		LOG_WARN("Failed to read '{0}'", path);
+		return false;
+	}
+
+	// Terminate the text so the number parsers stop at the end
+	text.push_back('\0');
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<Corner> corners;
+	std::vector<Corner> face;
+
+	const char* pLine = reinterpret_cast<const char*>(text.data());
+	while (*pLine != '\0')
+	{
+		const char* pNext = strchr(pLine, '\n');
+		if (pNext == nullptr)
+		{
+			pNext = pLine + strlen(pLine);
+		}
+
+		// Skip leading whitespace
+		while (*pLine == ' ' || *pLine == '\t')
+		{
+			pLine++;
+		}
+
+		char* pEnd;
+		if (pLine[0] == 'v' && pLine[1] == ' ')
+		{
+			glm::vec3 position;
+			position.x = strtof(pLine + 2, &pEnd);
+			position.y = strtof(pEnd, &pEnd);
+			position.z = strtof(pEnd, &pEnd);
+			positions.push_back(position);
+		}
+		else if (pLine[0] == 'v' && pLine[1] == 't' && pLine[2] == ' ')
+		{
+			glm::vec2 texCoord;
+			texCoord.x = strtof(pLine + 3, &pEnd);
+			texCoord.y = strtof(pEnd, &pEnd);
+			texCoords.push_back(texCoord);
+		}
+		else if (pLine[0] == 'v' && pLine[1] == 'n' && pLine[2] == ' ')
+		{
+			glm::vec3 normal;
+			normal.x = strtof(pLine + 3, &pEnd);
+			normal.y = strtof(pEnd, &pEnd);
+			normal.z = strtof(pEnd, &pEnd);
+			normals.push_back(normal);
+		}
+		else if (pLine[0] == 'f' && pLine[1] == ' ')
+		{
+			// Read every corner of the polygon
+			face.clear();
+			const char* pText = pLine + 2;
+			while (pText < pNext)
+			{
+				while (*pText == ' ' || *pText == '\t')
+				{
+					pText++;
+				}
+
+				Corner corner;
+				pText = parseCorner(pText, positions.size(), texCoords.size(), normals.size(), corner);
+				if (pText == nullptr)
+				{
+					break;
+				}
+
+				if (corner.Position >= 0)
+				{
+					face.push_back(corner);
+				}
+			}
+
+			// Triangulate the polygon as a fan
+			for (size_t i = 2; i < face.size(); i++)
+			{
+				corners.push_back(face[0]);
+				corners.push_back(face[i - 1]);
+				corners.push_back(face[i]);
+			}
+		}
+
+		pLine = *pNext == '\0' ? pNext : pNext + 1;
+	}
+
+	if (corners.empty())
+	{
+		LOG_WARN("'{0}' doesn't contain any faces", path);
+		return false;
+	}
+
+	// Attributes are only stored if every corner has them
+	bool hasTexCoords = std::all_of(corners.begin(), corners.end(), [](const Corner& c) { return c.TexCoord >= 0; });
+	bool hasNormals = std::all_of(corners.begin(), corners.end(), [](const Corner& c) { return c.Normal >= 0; });
+
+	mesh.Layout = VertexLayout();
+	mesh.Layout.add(0, 3, vat_Float);
+
+	if (hasTexCoords)
+	{
+		mesh.Layout.add(1, 2, vat_Float);
+	}
+
+	if (hasNormals)
+	{
+		mesh.Layout.add(2, 3, vat_Float);
+	}
+
+	// Merge corners that share all stored attributes
+	std::unordered_map<Corner, unsigned int, CornerHash> vertices;
+	vertices.reserve(corners.size());
+
+	mesh.Vertices.clear();
+	mesh.Indices.clear();
+	mesh.Indices.reserve(corners.size());
+	mesh.BoundsMin = glm::vec3(FLT_MAX);
+	mesh.BoundsMax = glm::vec3(-FLT_MAX);
+
+	for (Corner corner : corners)
+	{
+		if (!hasTexCoords)
+		{
+			corner.TexCoord = -1;
+		}
+
+		if (!hasNormals)
+		{
+			corner.Normal = -1;
+		}
+
+		auto it = vertices.find(corner);
+		if (it != vertices.end())
+		{
+			mesh.Indices.push_back(it->second);
+			continue;
+		}
+
+		unsigned int index = (unsigned int)vertices.size();
+		vertices.emplace(corner, index);
+		mesh.Indices.push_back(index);
+
+		const glm::vec3& position = positions[corner.Position];
+		append(mesh.Vertices, &position, sizeof(position));
+		mesh.BoundsMin = glm::min(mesh.BoundsMin, position);
+		mesh.BoundsMax = glm::max(mesh.BoundsMax, position);
+
+		if (hasTexCoords)
+		{
+			append(mesh.Vertices, &texCoords[corner.TexCoord], sizeof(glm::vec2));
+		}
+
+		if (hasNormals)
+		{
+			append(mesh.Vertices, &normals[corner.Normal], sizeof(glm::vec3));
+		}
+	}
+
+	mesh.VertexCount = (unsigned int)vertices.size();
+	return true;
+}
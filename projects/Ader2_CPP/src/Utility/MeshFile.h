@@ -0,0 +1,207 @@
+#pragma once
+
+// For string
+#include <string>
+
+// For data buffers
+#include <vector>
+#include <cstddef>
+
+// Bounds
+#include <glm/glm.hpp>
+
+/**
+ * @file
+ * Utility file containing the binary mesh container and the Wavefront OBJ
+ * importer used to create it. Nothing in here uses OpenGL so meshes can be
+ * converted without a context.
+ *
+ * A mesh file is laid out as:
+ *  - MeshHeader
+ *  - MeshHeader::AttributeCount VertexAttribute entries
+ *  - interleaved vertex data at MeshHeader::VertexOffset
+ *  - index data at MeshHeader::IndexOffset
+ *
+ * All values are little endian and the data sections are 16 byte aligned, so
+ * a mapped file can be handed to the GPU without being parsed or copied.
+ */
+
+/**
+ * Component types of a vertex attribute
+ */
+enum VertexAttributeType
+{
+    vat_Float = 0,
+    vat_HalfFloat,
+    vat_Byte,
+    vat_UnsignedByte,
+    vat_Short,
+    vat_UnsignedShort,
+
+    /// 4 components packed as signed 10, 10, 10 and 2 bits
+    vat_Int2101010,
+};
+
+/**
+ * Single attribute of an interleaved vertex
+ */
+struct VertexAttribute
+{
+    /// Shader attribute location
+    unsigned int Location = 0;
+
+    /// Number of components, 1 to 4
+    unsigned int Components = 0;
+
+    /// VertexAttributeType of the components
+    unsigned int Type = vat_Float;
+
+    /// If not 0 integer components are normalized to [0, 1] or [-1, 1]
+    unsigned int Normalized = 0;
+
+    /// Offset of the attribute from the start of the vertex in bytes
+    unsigned int Offset = 0;
+};
+
+/**
+ * Layout of an interleaved vertex
+ */
+struct VertexLayout
+{
+    std::vector<VertexAttribute> Attributes;
+
+    /// Size of a single vertex in bytes
+    unsigned int Stride = 0;
+
+    /**
+     * Appends an attribute after the existing ones, attributes are 4 byte aligned
+     *
+     * @param location Shader attribute location
+     * @param components Number of components, 1 to 4
+     * @param type Type of the components
+     * @param normalized If true integer components are normalized
+     *
+     * @return This layout
+     */
+    VertexLayout& add(unsigned int location, unsigned int components, VertexAttributeType type, bool normalized = false);
+
+    /**
+     * Returns the attribute with the specified location or nullptr if there is none
+     */
+    const VertexAttribute* find(unsigned int location) const;
+};
+
+/**
+ * Header of a mesh file
+ */
+struct MeshHeader
+{
+    /// Mesh file magic, 'AMSH'
+    unsigned int Magic = 0;
+
+    /// Version of the format
+    unsigned int Version = 0;
+
+    /// Number of attributes following the header
+    unsigned int AttributeCount = 0;
+
+    /// Size of a single vertex in bytes
+    unsigned int Stride = 0;
+
+    unsigned int VertexCount = 0;
+    unsigned int IndexCount = 0;
+
+    /// Size of a single index in bytes, 2 or 4
+    unsigned int IndexSize = 0;
+
+    /// Reserved, 0
+    unsigned int Flags = 0;
+
+    /// Axis aligned bounds of the vertex positions
+    float BoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float BoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+
+    /// Location of the vertex and index data from the start of the file
+    unsigned long long VertexOffset = 0;
+    unsigned long long IndexOffset = 0;
+};
+
+/**
+ * Mesh parsed from memory, the pointers point into the parsed data and are
+ * valid as long as it is
+ */
+struct MeshView
+{
+    const MeshHeader* pHeader = nullptr;
+    const VertexAttribute* pAttributes = nullptr;
+    const unsigned char* pVertices = nullptr;
+    const unsigned char* pIndices = nullptr;
+};
+
+/**
+ * Struct containing the mesh data that is written to a mesh file
+ */
+struct MeshContents
+{
+    /// Layout of a single vertex
+    VertexLayout Layout;
+    unsigned int VertexCount = 0;
+
+    /// Interleaved vertex data
+    std::vector<unsigned char> Vertices;
+
+    /// Triangle list indices
+    std::vector<unsigned int> Indices;
+
+    /// Axis aligned bounds of the vertex positions
+    glm::vec3 BoundsMin = glm::vec3(0.0f);
+    glm::vec3 BoundsMax = glm::vec3(0.0f);
+};
+
+/**
+ * Returns the size of a single attribute with the specified type and component count in bytes
+ */
+size_t getVertexAttributeSize(VertexAttributeType type, unsigned int components);
+
+/**
+ * Returns true if every attribute has 1 to 4 components of a known type and
+ * lies inside a vertex of the specified stride
+ */
+bool isValidLayout(const VertexAttribute* pAttributes, size_t count, unsigned int stride);
+
+/**
+ * Returns true if the path has the extension of a mesh file
+ */
+bool isMeshPath(const std::string& path);
+
+/**
+ * Parses a mesh file, the data isn't copied. The layout, the data sections
+ * and every index are validated.
+ *
+ * @param pData File contents, must be aligned to at least 8 bytes
+ * @param size Size of the contents in bytes
+ * @param mesh Struct that receives the pointers into the contents
+ *
+ * @return True if the data contains a valid mesh, false otherwise
+ */
+bool parseMesh(const unsigned char* pData, size_t size, MeshView& mesh);
+
+/**
+ * Writes the mesh to a mesh file, indices are stored as 16 bit values
+ * when every vertex can be addressed with them
+ *
+ * @return True if the file was written, false otherwise
+ */
+bool writeMesh(const std::string& path, const MeshContents& mesh);
+
+/**
+ * Reads a Wavefront OBJ file into an interleaved mesh. Positions go to location
+ * 0, texture coordinates to location 1 and normals to location 2, faces are
+ * triangulated and vertices that share all attributes are merged
+ *
+ * @param path Path to the OBJ file
+ * @param mesh Struct that receives the mesh
+ *
+ * @return True if the file contained at least one triangle, false otherwise
+ */
+bool readOBJ(const std::string& path, MeshContents& mesh);
@@ -0,0 +1,615 @@
+#include "MeshOptimizer.h"
+
+// For sorting clusters
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// Quantization
+#include <glm/gtc/packing.hpp>
+
+namespace
+{
+	/**
+	 * Returns the positions of the mesh or nullptr if it doesn't have
+	 * float positions at location 0
+	 */
+	const float* findPositions(const MeshContents& mesh)
+	{
+		const VertexAttribute* pAttribute = mesh.Layout.find(0);
+		if (pAttribute == nullptr || pAttribute->Type != vat_Float || pAttribute->Components < 3)
+		{
+			return nullptr;
+		}
+
+		return reinterpret_cast<const float*>(mesh.Vertices.data() + pAttribute->Offset);
+	}
+
+	glm::vec3 getPosition(const float* pPositions, size_t stride, unsigned int vertex)
+	{
+		const float* pPosition = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(pPositions) + vertex * stride);
+		return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+	}
+
+	/**
+	 * FIFO post-transform cache, a vertex is cached if fewer than cacheSize
+	 * vertices have been transformed since it was
+	 */
+	struct VertexCache
+	{
+		std::vector<unsigned int> Timestamps;
+		unsigned int Time;
+		unsigned int Size;
+
+		VertexCache(unsigned int vertexCount, unsigned int cacheSize)
+			: Timestamps(vertexCount, 0), Time(cacheSize + 1), Size(cacheSize)
+		{
+		}
+
+		/**
+		 * Uses the vertex and returns true if it had to be transformed
+		 */
+		bool use(unsigned int vertex)
+		{
+			if (Time - Timestamps[vertex] > Size)
+			{
+				Timestamps[vertex] = Time++;
+				return true;
+			}
+
+			return false;
+		}
+
+		/**
+		 * Evicts every vertex
+		 */
+		void flush()
+		{
+			Time += Size + 1;
+		}
+	};
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStatistics result;
+	VertexCache cache(vertexCount, cacheSize);
+
+	for (unsigned int index : indices)
+	{
+		if (cache.use(index))
+		{
+			result.Transformed++;
+		}
+	}
+
+	size_t triangleCount = indices.size() / 3;
+	result.ACMR = triangleCount > 0 ? (float)result.Transformed / triangleCount : 0.0f;
+	result.ATVR = vertexCount > 0 ? (float)result.Transformed / vertexCount : 0.0f;
+	return result;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, std::vector<unsigned int>& clusters, unsigned int cacheSize)
+{
+	clusters.clear();
+
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// Triangles that use each vertex
+	std::vector<unsigned int> live(vertexCount, 0);
+	for (unsigned int index : indices)
+	{
+		live[index]++;
+	}
+
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		offsets[i + 1] = offsets[i] + live[i];
+	}
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	VertexCache cache(vertexCount, cacheSize);
+	std::vector<unsigned char> emitted(triangleCount, 0);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+	deadEnd.reserve(indices.size());
+	result.reserve(indices.size());
+
+	unsigned int cursor = 0;
+	bool newCluster = true;
+	long long fanning = 0;
+
+	while (fanning >= 0)
+	{
+		// Emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+		{
+			unsigned int triangle = adjacency[i];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			if (newCluster)
+			{
+				clusters.push_back((unsigned int)(result.size() / 3));
+				newCluster = false;
+			}
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				unsigned int vertex = indices[triangle * 3 + k];
+				result.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				cache.use(vertex);
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Continue with the candidate that stays in the cache the longest while its
+		// remaining triangles are emitted
+		fanning = -1;
+		long long bestPriority = -1;
+		for (unsigned int vertex : candidates)
+		{
+			if (live[vertex] == 0)
+			{
+				continue;
+			}
+
+			long long priority = 0;
+			long long age = cache.Time - cache.Timestamps[vertex];
+			if (age + 2 * live[vertex] <= cacheSize)
+			{
+				priority = age;
+			}
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanning = vertex;
+			}
+		}
+
+		if (fanning >= 0)
+		{
+			continue;
+		}
+
+		// Dead end, continue from a recently used vertex or the next unprocessed one
+		newCluster = true;
+		while (!deadEnd.empty())
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+
+			if (live[vertex] > 0)
+			{
+				fanning = vertex;
+				break;
+			}
+		}
+
+		while (fanning < 0 && cursor < vertexCount)
+		{
+			if (live[cursor] > 0)
+			{
+				fanning = cursor;
+			}
+
+			cursor++;
+		}
+	}
+
+	indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<unsigned int>& clusters,
+	const float* pPositions, size_t stride, unsigned int vertexCount, float threshold, unsigned int cacheSize)
+{
+	unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+	if (triangleCount == 0 || clusters.empty())
+	{
+		return;
+	}
+
+	// Split the clusters where the cache miss ratio of the part so far is close
+	// to the one of the whole cluster, smaller clusters can be sorted better
+	std::vector<unsigned int> starts;
+	VertexCache cache(vertexCount, cacheSize);
+
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		unsigned int begin = clusters[c];
+		unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+		cache.flush();
+		unsigned int clusterMisses = 0;
+		for (unsigned int i = begin * 3; i < end * 3; i++)
+		{
+			clusterMisses += cache.use(indices[i]) ? 1 : 0;
+		}
+
+		float limit = (float)clusterMisses / (end - begin) * threshold;
+
+		cache.flush();
+		starts.push_back(begin);
+		unsigned int start = begin;
+		unsigned int misses = 0;
+
+		for (unsigned int triangle = begin; triangle < end; triangle++)
+		{
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				misses += cache.use(indices[triangle * 3 + k]) ? 1 : 0;
+			}
+
+			if (triangle + 1 < end && (float)misses / (triangle + 1 - start) <= limit)
+			{
+				start = triangle + 1;
+				starts.push_back(start);
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+
+	// Center of the mesh
+	glm::vec3 meshCenter(0.0f);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		meshCenter += getPosition(pPositions, stride, i);
+	}
+
+	meshCenter /= (float)std::max(vertexCount, 1u);
+
+	// Clusters that face away from the center are likely to hide the others
+	std::vector<float> occlusion(starts.size());
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		unsigned int end = c + 1 < starts.size() ? starts[c + 1] : triangleCount;
+
+		glm::vec3 center(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (unsigned int triangle = starts[c]; triangle < end; triangle++)
+		{
+			glm::vec3 a = getPosition(pPositions, stride, indices[triangle * 3 + 0]);
+			glm::vec3 b = getPosition(pPositions, stride, indices[triangle * 3 + 1]);
+			glm::vec3 d = getPosition(pPositions, stride, indices[triangle * 3 + 2]);
+
+			// Weighted by the triangle area
+			glm::vec3 cross = glm::cross(b - a, d - a);
+			float triangleArea = glm::length(cross);
+
+			center += (a + b + d) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+
+		float normalLength = glm::length(normal);
+		if (area > 0.0f && normalLength > 0.0f)
+		{
+			occlusion[c] = glm::dot(center / area - meshCenter, normal / normalLength);
+		}
+		else
+		{
+			occlusion[c] = 0.0f;
+		}
+	}
+
+	std::vector<unsigned int> order(starts.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+	{
+		return occlusion[a] > occlusion[b];
+	});
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+
+	for (unsigned int c : order)
+	{
+		unsigned int end = c + 1 < starts.size() ? starts[c + 1] : triangleCount;
+		result.insert(result.end(), indices.begin() + starts[c] * 3, indices.begin() + end * 3);
+	}
+
+	indices.swap(result);
+}
+
+unsigned int optimizeVertexFetch(MeshContents& mesh)
+{
+	const unsigned int unused = ~0u;
+	std::vector<unsigned int> remap(mesh.VertexCount, unused);
+	std::vector<unsigned char> vertices;
+	vertices.reserve(mesh.Vertices.size());
+
+	// Vertices are numbered in the order of their first use
+	unsigned int next = 0;
+	for (unsigned int& index : mesh.Indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = next++;
+
+			const unsigned char* pVertex = mesh.Vertices.data() + (size_t)index * mesh.Layout.Stride;
+			vertices.insert(vertices.end(), pVertex, pVertex + mesh.Layout.Stride);
+		}
+
+		index = remap[index];
+	}
+
+	mesh.Vertices.swap(vertices);
+	mesh.VertexCount = next;
+	return next;
+}
+
+bool optimizeMesh(MeshContents& mesh)
+{
+	const float* pPositions = findPositions(mesh);
+	if (pPositions == nullptr)
+	{
+		return false;
+	}
+
+	std::vector<unsigned int> clusters;
+	optimizeVertexCache(mesh.Indices, mesh.VertexCount, clusters);
+	optimizeOverdraw(mesh.Indices, clusters, pPositions, mesh.Layout.Stride, mesh.VertexCount);
+	optimizeVertexFetch(mesh);
+	return true;
+}
+
+bool quantizeMesh(MeshContents& mesh, float* pMaxError)
+{
+	if (findPositions(mesh) == nullptr)
+	{
+		return false;
+	}
+
+	const VertexLayout& source = mesh.Layout;
+
+	// Texture coordinates outside of [0, 1] repeat the texture and can't be normalized
+	bool unitTexCoords = true;
+	const VertexAttribute* pTexCoords = source.find(1);
+	if (pTexCoords && pTexCoords->Type == vat_Float)
+	{
+		for (unsigned int i = 0; i < mesh.VertexCount && unitTexCoords; i++)
+		{
+			const float* pValue = reinterpret_cast<const float*>(mesh.Vertices.data() + (size_t)i * source.Stride + pTexCoords->Offset);
+			for (unsigned int c = 0; c < pTexCoords->Components; c++)
+			{
+				unitTexCoords = unitTexCoords && pValue[c] >= 0.0f && pValue[c] <= 1.0f;
+			}
+		}
+	}
+
+	// Layout of the quantized vertex
+	VertexLayout layout;
+	for (const VertexAttribute& attribute : source.Attributes)
+	{
+		if (attribute.Type != vat_Float)
+		{
+			layout.add(attribute.Location, attribute.Components, (VertexAttributeType)attribute.Type, attribute.Normalized != 0);
+		}
+		else if (attribute.Location == 0)
+		{
+			// 4 halves keep the next attribute aligned, w is 1
+			layout.add(0, 4, vat_HalfFloat);
+		}
+		else if (attribute.Location == 1)
+		{
+			layout.add(1, attribute.Components, unitTexCoords ? vat_UnsignedShort : vat_HalfFloat, unitTexCoords);
+		}
+		else if (attribute.Location == 2 && attribute.Components == 3)
+		{
+			layout.add(2, 4, vat_Int2101010, true);
+		}
+		else
+		{
+			layout.add(attribute.Location, attribute.Components, vat_Float);
+		}
+	}
+
+	std::vector<unsigned char> vertices((size_t)mesh.VertexCount * layout.Stride, 0);
+	float maxError = 0.0f;
+
+	for (unsigned int i = 0; i < mesh.VertexCount; i++)
+	{
+		const unsigned char* pSource = mesh.Vertices.data() + (size_t)i * source.Stride;
+		unsigned char* pDestination = vertices.data() + (size_t)i * layout.Stride;
+
+		for (size_t a = 0; a < source.Attributes.size(); a++)
+		{
+			const VertexAttribute& from = source.Attributes[a];
+			const VertexAttribute& to = layout.Attributes[a];
+			const float* pValue = reinterpret_cast<const float*>(pSource + from.Offset);
+			unsigned char* pTarget = pDestination + to.Offset;
+
+			if (from.Type == to.Type)
+			{
+				memcpy(pTarget, pSource + from.Offset, getVertexAttributeSize((VertexAttributeType)from.Type, from.Components));
+			}
+			else if (to.Type == vat_HalfFloat)
+			{
+				unsigned short* pHalves = reinterpret_cast<unsigned short*>(pTarget);
+				for (unsigned int c = 0; c < to.Components; c++)
+				{
+					float value = c < from.Components ? pValue[c] : 1.0f;
+					pHalves[c] = glm::packHalf1x16(value);
+
+					if (to.Location == 0 && c < from.Components)
+					{
+						maxError = std::max(maxError, std::abs(glm::unpackHalf1x16(pHalves[c]) - value));
+					}
+				}
+			}
+			else if (to.Type == vat_UnsignedShort)
+			{
+				unsigned short* pValues = reinterpret_cast<unsigned short*>(pTarget);
+				for (unsigned int c = 0; c < to.Components; c++)
+				{
+					pValues[c] = glm::packUnorm1x16(pValue[c]);
+				}
+			}
+			else if (to.Type == vat_Int2101010)
+			{
+				// Normals are stored with unit length
+				glm::vec3 normal(pValue[0], pValue[1], pValue[2]);
+				float length = glm::length(normal);
+				normal = length > 0.0f ? normal / length : normal;
+
+				glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+				memcpy(pTarget, &packed, sizeof(packed));
+			}
+		}
+	}
+
+	mesh.Layout = layout;
+	mesh.Vertices.swap(vertices);
+
+	if (pMaxError)
+	{
+		*pMaxError = maxError;
+	}
+
+	return true;
+}
+
+bool buildMeshlets(const MeshContents& mesh, MeshletContents& meshlets, unsigned int maxVertices, unsigned int maxTriangles)
+{
+	const float* pPositions = findPositions(mesh);
+	if (pPositions == nullptr || maxVertices < 3 || maxVertices > 256 || maxTriangles == 0)
+	{
+		return false;
+	}
+
+	meshlets.Meshlets.clear();
+	meshlets.Vertices.clear();
+	meshlets.Triangles.clear();
+
+	// Local index of every mesh vertex in the current meshlet
+	std::vector<int> local(mesh.VertexCount, -1);
+	Meshlet current;
+
+	auto finish = [&]()
+	{
+		const unsigned int* pVertices = meshlets.Vertices.data() + current.VertexOffset;
+		const unsigned char* pTriangles = meshlets.Triangles.data() + current.TriangleOffset * 3;
+
+		// Bounding sphere around the center of the bounds
+		glm::vec3 min(FLT_MAX);
+		glm::vec3 max(-FLT_MAX);
+		for (unsigned int i = 0; i < current.VertexCount; i++)
+		{
+			glm::vec3 position = getPosition(pPositions, mesh.Layout.Stride, pVertices[i]);
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+			local[pVertices[i]] = -1;
+		}
+
+		current.Center = (min + max) * 0.5f;
+		current.Radius = 0.0f;
+		for (unsigned int i = 0; i < current.VertexCount; i++)
+		{
+			current.Radius = std::max(current.Radius, glm::length(getPosition(pPositions, mesh.Layout.Stride, pVertices[i]) - current.Center));
+		}
+
+		// Normal cone
+		std::vector<glm::vec3> normals;
+		glm::vec3 axis(0.0f);
+		for (unsigned int i = 0; i < current.TriangleCount; i++)
+		{
+			glm::vec3 a = getPosition(pPositions, mesh.Layout.Stride, pVertices[pTriangles[i * 3 + 0]]);
+			glm::vec3 b = getPosition(pPositions, mesh.Layout.Stride, pVertices[pTriangles[i * 3 + 1]]);
+			glm::vec3 c = getPosition(pPositions, mesh.Layout.Stride, pVertices[pTriangles[i * 3 + 2]]);
+
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normal / length;
+			}
+		}
+
+		float axisLength = glm::length(axis);
+		if (axisLength > 0.0f)
+		{
+			current.ConeAxis = axis / axisLength;
+			current.ConeCutoff = 1.0f;
+			for (const glm::vec3& normal : normals)
+			{
+				current.ConeCutoff = std::min(current.ConeCutoff, glm::dot(current.ConeAxis, normal));
+			}
+		}
+		else
+		{
+			// Triangles face every direction, the meshlet can't be culled by its cone
+			current.ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+			current.ConeCutoff = -1.0f;
+		}
+
+		meshlets.Meshlets.push_back(current);
+
+		current = Meshlet();
+		current.VertexOffset = (unsigned int)meshlets.Vertices.size();
+		current.TriangleOffset = (unsigned int)(meshlets.Triangles.size() / 3);
+	};
+
+	for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3)
+	{
+		unsigned int a = mesh.Indices[i + 0];
+		unsigned int b = mesh.Indices[i + 1];
+		unsigned int c = mesh.Indices[i + 2];
+
+		// Vertices the triangle would add
+		unsigned int added = (local[a] < 0 ? 1 : 0) + (local[b] < 0 && b != a ? 1 : 0) + (local[c] < 0 && c != a && c != b ? 1 : 0);
+
+		if (current.VertexCount + added > maxVertices || current.TriangleCount + 1 > maxTriangles)
+		{
+			finish();
+		}
+
+		for (unsigned int vertex : { a, b, c })
+		{
+			if (local[vertex] < 0)
+			{
+				local[vertex] = (int)current.VertexCount++;
+				meshlets.Vertices.push_back(vertex);
+			}
+
+			meshlets.Triangles.push_back((unsigned char)local[vertex]);
+		}
+
+		current.TriangleCount++;
+	}
+
+	if (current.TriangleCount > 0)
+	{
+		finish();
+	}
+
+	return true;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// For data buffers
+#include <vector>
+#include <cstddef>
+
+// Meshlet bounds
+#include <glm/glm.hpp>
+
+// Mesh contents
+#include "Utility/MeshFile.h"
+
+/**
+ * @file
+ * Utility file containing the mesh optimizations done when a mesh is cooked.
+ * Triangles are reordered for the post-transform vertex cache (Tipsify), the
+ * resulting clusters are ordered to reduce overdraw, the vertices are
+ * reordered in the order they are fetched and their attributes are quantized.
+ * Like the mesh file nothing in here uses OpenGL.
+ */
+
+/**
+ * Result of simulating a FIFO post-transform vertex cache
+ */
+struct VertexCacheStatistics
+{
+    /// Number of vertices that had to be transformed
+    unsigned int Transformed = 0;
+
+    /// Average cache miss ratio, transformed vertices per triangle, 0.5 is ideal
+    float ACMR = 0.0f;
+
+    /// Average transform to vertex ratio, transformed vertices per vertex, 1 is ideal
+    float ATVR = 0.0f;
+};
+
+/**
+ * Cluster of up to a fixed amount of vertices and triangles, meshlets can be
+ * culled as a whole before any of their triangles are processed
+ */
+struct Meshlet
+{
+    /// Range in MeshletContents::Vertices
+    unsigned int VertexOffset = 0;
+    unsigned int VertexCount = 0;
+
+    /// Range in MeshletContents::Triangles, counted in triangles
+    unsigned int TriangleOffset = 0;
+    unsigned int TriangleCount = 0;
+
+    /// Bounding sphere of the vertices
+    glm::vec3 Center = glm::vec3(0.0f);
+    float Radius = 0.0f;
+
+    /// Average triangle normal and the cosine of the widest angle between it and
+    /// a triangle normal, used to cull meshlets whose triangles all face away
+    glm::vec3 ConeAxis = glm::vec3(0.0f);
+    float ConeCutoff = 1.0f;
+};
+
+/**
+ * Meshlets of a mesh
+ */
+struct MeshletContents
+{
+    std::vector<Meshlet> Meshlets;
+
+    /// Mesh vertex index of every meshlet vertex
+    std::vector<unsigned int> Vertices;
+
+    /// 3 meshlet local vertex indices per triangle
+    std::vector<unsigned char> Triangles;
+};
+
+/**
+ * Simulates a FIFO post-transform vertex cache while drawing the triangle list
+ *
+ * @param indices Triangle list indices
+ * @param vertexCount Number of vertices
+ * @param cacheSize Number of vertices kept by the cache
+ *
+ * @return Cache statistics of the triangle order
+ */
+VertexCacheStatistics analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+/**
+ * Reorders triangles so vertices are reused while they are in the post-transform
+ * cache using Tipsify (Sander et al. 2007)
+ *
+ * @param indices Triangle list indices, reordered on return
+ * @param vertexCount Number of vertices
+ * @param clusters Receives the first triangle of every cluster, a new cluster
+ *                 starts every time the order jumps to an unrelated part of the mesh
+ * @param cacheSize Number of vertices kept by the cache
+ */
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, std::vector<unsigned int>& clusters, unsigned int cacheSize = 16);
+
+/**
+ * Reorders the clusters of a cache optimized triangle list so that clusters facing
+ * away from the center of the mesh are drawn first and hide the rest. Clusters are
+ * split where that keeps the cache miss ratio within the threshold
+ *
+ * @param indices Cache optimized triangle list indices, reordered on return
+ * @param clusters First triangle of every cluster from optimizeVertexCache
+ * @param pPositions First vertex position
+ * @param stride Distance between two positions in bytes
+ * @param vertexCount Number of vertices
+ * @param threshold Allowed increase of the cache miss ratio
+ * @param cacheSize Number of vertices kept by the cache
+ */
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<unsigned int>& clusters,
+    const float* pPositions, size_t stride, unsigned int vertexCount, float threshold = 1.05f, unsigned int cacheSize = 16);
+
+/**
+ * Reorders the vertices in the order the triangles use them, vertices that
+ * aren't used are removed
+ *
+ * @return Number of vertices after the reordering
+ */
+unsigned int optimizeVertexFetch(MeshContents& mesh);
+
+/**
+ * Runs all optimizations on a mesh with float positions at location 0
+ *
+ * @return True if the mesh was optimized, false if it has no usable positions
+ */
+bool optimizeMesh(MeshContents& mesh);
+
+/**
+ * Converts the float attributes written by readOBJ to compact formats: positions
+ * to half floats, texture coordinates to normalized 16 bit values when they are
+ * inside [0, 1] (half floats otherwise) and normals to normalized 10-10-10-2
+ * values. Other attributes are kept as they are
+ *
+ * @param mesh Mesh with float positions at location 0
+ * @param pMaxError Receives the largest position error introduced, can be nullptr
+ *
+ * @return True if the mesh was quantized, false if it has no usable positions
+ */
+bool quantizeMesh(MeshContents& mesh, float* pMaxError = nullptr);
+
+/**
+ * Splits the triangles of a mesh with float positions at location 0 into meshlets
+ * in their current order
+ *
+ * @param mesh Mesh to split
+ * @param meshlets Struct that receives the meshlets
+ * @param maxVertices Maximum number of vertices of a meshlet, at most 256
+ * @param maxTriangles Maximum number of triangles of a meshlet
+ *
+ * @return True if the meshlets were built, false if the mesh has no usable positions
+ */
+bool buildMeshlets(const MeshContents& mesh, MeshletContents& meshlets, unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
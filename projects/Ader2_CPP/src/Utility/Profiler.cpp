@@ -0,0 +1,211 @@
+#include "Profiler.h"
+
+// Scope timing
+#include <chrono>
+
+// Nodes are shared between threads
+#include <mutex>
+
+// For std::min and std::max
+#include <algorithm>
+
+// Name comparison and the report
+#include <cstring>
+#include <cstdio>
+
+namespace Utility
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Scope opened on a thread
+		 */
+		struct OpenScope
+		{
+			size_t Node;
+			Clock::time_point Start;
+		};
+
+		/// Guards the nodes
+		std::mutex s_mutex;
+
+		/// Scopes opened on the calling thread
+		thread_local std::vector<OpenScope> s_stack;
+	}
+
+	std::vector<Profiler::Node> Profiler::ms_nodes;
+	std::vector<size_t> Profiler::ms_roots;
+
+	void Profiler::begin(const char* name)
+	{
+		size_t parent = s_stack.empty() ? ms_none : s_stack.back().Node;
+
+		size_t node;
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			node = child(parent, name);
+		}
+
+		s_stack.push_back({ node, Clock::now() });
+	}
+
+	void Profiler::end()
+	{
+		Clock::time_point now = Clock::now();
+
+		if (s_stack.empty())
+		{
+			return;
+		}
+
+		OpenScope scope = s_stack.back();
+		s_stack.pop_back();
+
+		double milliseconds = std::chrono::duration<double, std::milli>(now - scope.Start).count();
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		Node& node = ms_nodes[scope.Node];
+		node.Frame += milliseconds;
+		node.FrameCalls++;
+	}
+
+	void Profiler::sample(const char* root, const char* name, double milliseconds)
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+
+		size_t rootNode = child(ms_none, root);
+		size_t sampleNode = child(rootNode, name);
+
+		ms_nodes[rootNode].Frame += milliseconds;
+		ms_nodes[rootNode].FrameCalls++;
+		ms_nodes[sampleNode].Frame += milliseconds;
+		ms_nodes[sampleNode].FrameCalls++;
+	}
+
+	void Profiler::endFrame()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+
+		for (Node& node : ms_nodes)
+		{
+			node.History[node.Frames % ms_history] = node.Frame;
+			node.Frames++;
+			node.LastCalls = node.FrameCalls;
+
+			node.Frame = 0.0;
+			node.FrameCalls = 0;
+		}
+	}
+
+	std::vector<Profiler::Scope> Profiler::getStatistics()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+
+		std::vector<Scope> scopes;
+		scopes.reserve(ms_nodes.size());
+
+		for (size_t root : ms_roots)
+		{
+			collect(root, scopes);
+		}
+
+		return scopes;
+	}
+
+	std::string Profiler::report()
+	{
+		std::vector<Scope> scopes = getStatistics();
+
+		std::string result;
+		char line[256];
+
+		snprintf(line, sizeof(line), "%-48s %9s %9s %9s %9s %6s\n", "Scope (ms)", "last", "avg", "min", "max", "calls");
+		result += line;
+
+		for (const Scope& scope : scopes)
+		{
+			// Children are indented under their parent
+			std::string name(scope.Depth * 2, ' ');
+			name += scope.Name;
+
+			snprintf(line, sizeof(line), "%-48s %9.3f %9.3f %9.3f %9.3f %6zu\n",
+				name.c_str(), scope.Last, scope.Average, scope.Min, scope.Max, scope.Calls);
+			result += line;
+		}
+
+		return result;
+	}
+
+	size_t Profiler::child(size_t parent, const char* name)
+	{
+		std::vector<size_t>& siblings = parent == ms_none ? ms_roots : ms_nodes[parent].Children;
+
+		// Names are usually the same literal, compare the contents only if the pointers differ
+		for (size_t sibling : siblings)
+		{
+			const char* siblingName = ms_nodes[sibling].Name;
+			if (siblingName == name || strcmp(siblingName, name) == 0)
+			{
+				return sibling;
+			}
+		}
+
+		Node node;
+		node.Name = name;
+		node.Depth = parent == ms_none ? 0 : ms_nodes[parent].Depth + 1;
+		node.Parent = parent;
+		node.History.resize(ms_history, 0.0);
+
+		ms_nodes.push_back(std::move(node));
+
+		// The reference to the siblings may have been invalidated by the push
+		size_t index = ms_nodes.size() - 1;
+		if (parent == ms_none)
+		{
+			ms_roots.push_back(index);
+		}
+		else
+		{
+			ms_nodes[parent].Children.push_back(index);
+		}
+
+		return index;
+	}
+
+	void Profiler::collect(size_t node, std::vector<Scope>& scopes)
+	{
+		const Node& n = ms_nodes[node];
+
+		Scope scope;
+		scope.Name = n.Name;
+		scope.Depth = n.Depth;
+		scope.Calls = n.LastCalls;
+
+		size_t count = std::min(n.Frames, ms_history);
+		if (count > 0)
+		{
+			scope.Last = n.History[(n.Frames - 1) % ms_history];
+			scope.Min = n.History[0];
+			scope.Max = n.History[0];
+
+			double total = 0.0;
+			for (size_t i = 0; i < count; i++)
+			{
+				total += n.History[i];
+				scope.Min = std::min(scope.Min, n.History[i]);
+				scope.Max = std::max(scope.Max, n.History[i]);
+			}
+
+			scope.Average = total / count;
+		}
+
+		scopes.push_back(scope);
+
+		for (size_t c : n.Children)
+		{
+			collect(c, scopes);
+		}
+	}
+}
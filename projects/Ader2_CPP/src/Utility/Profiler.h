@@ -0,0 +1,162 @@
+#pragma once
+
+// Scope statistics and the report
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace Utility
+{
+	/**
+	 * Frame profiler that keeps rolling statistics of named scopes. Scopes are
+	 * nested per thread, a scope opened inside another one becomes its child, so
+	 * the statistics form a tree of every message phase and the functions it
+	 * calls. Samples measured elsewhere (e.g. GPU timer queries) can be added
+	 * under a root scope of their own.
+	 *
+	 * Times are accumulated over a frame and the last ms_history frames are kept
+	 * for the average, minimum and maximum. Scope names must outlive the profiler,
+	 * string literals are expected.
+	 */
+	class Profiler
+	{
+	public:
+		/**
+		 * Statistics of a single scope, times are in milliseconds per frame
+		 */
+		struct Scope
+		{
+			/// Name of the scope
+			const char* Name = "";
+
+			/// Nesting depth, root scopes have depth 0
+			unsigned int Depth = 0;
+
+			/// Times the scope was entered in the last frame
+			size_t Calls = 0;
+
+			/// Time of the last frame
+			double Last = 0.0;
+
+			/// Rolling statistics
+			double Average = 0.0;
+			double Min = 0.0;
+			double Max = 0.0;
+		};
+	public:
+		/**
+		 * Opens a scope on the calling thread
+		 *
+		 * @param name Name of the scope
+		 */
+		static void begin(const char* name);
+
+		/**
+		 * Closes the last scope opened on the calling thread
+		 */
+		static void end();
+
+		/**
+		 * Adds a sample measured outside of a scope, the time is also added to
+		 * the root scope
+		 *
+		 * @param root Name of the root scope the sample is placed under
+		 * @param name Name of the sample scope
+		 * @param milliseconds Measured time
+		 */
+		static void sample(const char* root, const char* name, double milliseconds);
+
+		/**
+		 * Ends the current frame, the times of all scopes are moved to their history
+		 */
+		static void endFrame();
+
+		/**
+		 * Returns the statistics of all scopes in depth first order
+		 */
+		static std::vector<Scope> getStatistics();
+
+		/**
+		 * Returns the statistics formatted as a table
+		 */
+		static std::string report();
+	private:
+		/**
+		 * Node of the scope tree
+		 */
+		struct Node
+		{
+			const char* Name = "";
+			unsigned int Depth = 0;
+
+			/// Child nodes, the parent of root nodes is ms_none
+			size_t Parent = 0;
+			std::vector<size_t> Children;
+
+			/// Time and calls of the current frame
+			double Frame = 0.0;
+			size_t FrameCalls = 0;
+
+			/// Calls of the last frame
+			size_t LastCalls = 0;
+
+			/// Frames ended since the node was created
+			size_t Frames = 0;
+
+			/// Frame times, written in a ring
+			std::vector<double> History;
+		};
+
+		/**
+		 * Returns the child of the node with the specified name, creates it if
+		 * it doesn't exist, must be called with the lock held
+		 */
+		static size_t child(size_t parent, const char* name);
+
+		/**
+		 * Writes the statistics of a node and its children
+		 */
+		static void collect(size_t node, std::vector<Scope>& scopes);
+	private:
+		/// Frames kept for the rolling statistics
+		static constexpr size_t ms_history = 120;
+
+		/// Parent of root nodes
+		static constexpr size_t ms_none = (size_t)-1;
+
+		/// Scope tree, nodes are never removed so their indices stay valid
+		static std::vector<Node> ms_nodes;
+
+		/// Root nodes in the order they were created
+		static std::vector<size_t> ms_roots;
+	};
+
+	/**
+	 * Opens a profiler scope for the lifetime of the object
+	 */
+	class ProfileScope
+	{
+	public:
+		ProfileScope(const char* name)
+		{
+			Profiler::begin(name);
+		}
+
+		~ProfileScope()
+		{
+			Profiler::end();
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	};
+}
+
+#define ADER_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ADER_PROFILE_CONCAT(a, b) ADER_PROFILE_CONCAT_IMPL(a, b)
+
+/// Profiles the rest of the enclosing block
+#define PROFILE_SCOPE(name) ::Utility::ProfileScope ADER_PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+/// Profiles the rest of the enclosing function
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
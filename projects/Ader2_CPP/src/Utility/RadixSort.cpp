@@ -0,0 +1,122 @@
+#include "RadixSort.h"
+
+// Sorting large inputs in parallel
+#include "WorkerPool.h"
+
+// For std::min, std::fill and memcpy
+#include <algorithm>
+#include <cstring>
+
+namespace Utility
+{
+	void RadixSort::sort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, WorkerPool* pPool)
+	{
+		size_t count = keys.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		// Every thread gets a contiguous chunk of the input
+		size_t chunks = pPool && count >= ms_parallelThreshold ? pPool->getThreadCount() : 1;
+		size_t chunkSize = (count + chunks - 1) / chunks;
+
+		m_keys.resize(count);
+		m_values.resize(count);
+		m_histograms.resize(chunks * ms_buckets);
+
+		auto forEachChunk = [&](const std::function<void(size_t)>& fn)
+		{
+			if (chunks == 1)
+			{
+				fn(0);
+			}
+			else
+			{
+				pPool->run(chunks, fn);
+			}
+		};
+
+		// Bits that differ between the keys, a pass over a digit that is the same
+		// for every key wouldn't change the order
+		uint32_t first = keys[0];
+		uint32_t differ = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			differ |= keys[i] ^ first;
+		}
+
+		for (unsigned int shift = 0; shift < 32; shift += 8)
+		{
+			if (((differ >> shift) & 0xFF) == 0)
+			{
+				continue;
+			}
+
+			// Count the digits of each chunk
+			forEachChunk([&](size_t chunk)
+			{
+				uint32_t* pHistogram = &m_histograms[chunk * ms_buckets];
+				std::fill(pHistogram, pHistogram + ms_buckets, 0);
+
+				size_t begin = chunk * chunkSize;
+				size_t end = std::min(count, begin + chunkSize);
+				const uint32_t* pKeys = keys.data();
+
+				for (size_t i = begin; i < end; i++)
+				{
+					pHistogram[(pKeys[i] >> shift) & 0xFF]++;
+				}
+			});
+
+			// Turn the counts into offsets, within a bucket earlier chunks come
+			// first so that equal digits keep their order
+			uint32_t offset = 0;
+			for (size_t bucket = 0; bucket < ms_buckets; bucket++)
+			{
+				for (size_t chunk = 0; chunk < chunks; chunk++)
+				{
+					uint32_t& entry = m_histograms[chunk * ms_buckets + bucket];
+					uint32_t bucketCount = entry;
+					entry = offset;
+					offset += bucketCount;
+				}
+			}
+
+			// Move every key and value to its place
+			forEachChunk([&](size_t chunk)
+			{
+				uint32_t* pOffsets = &m_histograms[chunk * ms_buckets];
+
+				size_t begin = chunk * chunkSize;
+				size_t end = std::min(count, begin + chunkSize);
+				const uint32_t* pKeys = keys.data();
+				const uint32_t* pValues = values.data();
+				uint32_t* pDstKeys = m_keys.data();
+				uint32_t* pDstValues = m_values.data();
+
+				for (size_t i = begin; i < end; i++)
+				{
+					uint32_t key = pKeys[i];
+					uint32_t dst = pOffsets[(key >> shift) & 0xFF]++;
+					pDstKeys[dst] = key;
+					pDstValues[dst] = pValues[i];
+				}
+			});
+
+			keys.swap(m_keys);
+			values.swap(m_values);
+		}
+	}
+
+	uint32_t RadixSort::floatKey(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		// Positive values get the sign bit set, negative ones are inverted so
+		// that larger magnitudes come first
+		uint32_t mask = (uint32_t)(-(int32_t)(bits >> 31)) | 0x80000000u;
+		return bits ^ mask;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Keys, values and histograms
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Utility
+{
+	class WorkerPool;
+
+	/**
+	 * Stable least significant digit radix sort of 32-bit keys with a value
+	 * attached to each key. Keys are sorted 8 bits at a time, passes whose
+	 * digit is the same for every key are skipped. Keys and values are kept in
+	 * separate arrays so the loops stay simple enough for the compiler to
+	 * vectorize.
+	 *
+	 * Large inputs are split into one chunk per thread of a WorkerPool: every
+	 * chunk builds its own histogram, the histograms are combined into
+	 * per chunk offsets and the chunks are scattered in parallel, which keeps
+	 * the sort stable.
+	 */
+	class RadixSort
+	{
+	public:
+		/**
+		 * Sorts the values by their keys in ascending order
+		 *
+		 * @param keys Keys, sorted on return
+		 * @param values Values, permuted the same way as the keys
+		 * @param pPool Pool used for large inputs, nullptr to sort on the calling thread
+		 */
+		void sort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, WorkerPool* pPool = nullptr);
+
+		/**
+		 * Returns a key that orders floats in ascending order, negative values included
+		 */
+		static uint32_t floatKey(float value);
+	private:
+		/// Buckets of a single digit
+		static constexpr size_t ms_buckets = 256;
+
+		/// Inputs smaller than this are sorted on the calling thread
+		static constexpr size_t ms_parallelThreshold = 16384;
+	private:
+		/// Destination arrays of a pass, swapped with the inputs after every pass
+		std::vector<uint32_t> m_keys;
+		std::vector<uint32_t> m_values;
+
+		/// Histogram of each chunk for the current digit, becomes the scatter offsets
+		std::vector<uint32_t> m_histograms;
+	};
+}
@@ -0,0 +1,1069 @@
+#include "TextureCompression.h"
+
+// Reading and writing containers
+#include "Utility/File.h"
+
+// Logging
+#include "Utility/Log.h"
+
+// Min, max and case conversion
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <climits>
+
+namespace
+{
+	/// OpenGL internal formats, S3TC formats are from GL_EXT_texture_compression_s3tc
+	constexpr unsigned int c_glCompressedRGBAS3TCDXT1 = 0x83F1;
+	constexpr unsigned int c_glCompressedRGBAS3TCDXT5 = 0x83F3;
+	constexpr unsigned int c_glCompressedRedRGTC1 = 0x8DBB;
+	constexpr unsigned int c_glCompressedRGRGTC2 = 0x8DBD;
+	constexpr unsigned int c_glCompressedRGBABPTCUnorm = 0x8E8C;
+
+	/// DXGI formats used by DX10 DDS headers
+	constexpr unsigned int c_dxgiBC1Typeless = 70;
+	constexpr unsigned int c_dxgiBC1Unorm = 71;
+	constexpr unsigned int c_dxgiBC3Typeless = 76;
+	constexpr unsigned int c_dxgiBC3Unorm = 77;
+	constexpr unsigned int c_dxgiBC4Typeless = 79;
+	constexpr unsigned int c_dxgiBC4Unorm = 80;
+	constexpr unsigned int c_dxgiBC5Typeless = 82;
+	constexpr unsigned int c_dxgiBC5Unorm = 83;
+	constexpr unsigned int c_dxgiBC7Typeless = 97;
+	constexpr unsigned int c_dxgiBC7Unorm = 98;
+
+	/// Vulkan formats used by KTX2
+	constexpr unsigned int c_vkBC1RGBUnorm = 131;
+	constexpr unsigned int c_vkBC1RGBAUnorm = 133;
+	constexpr unsigned int c_vkBC3Unorm = 137;
+	constexpr unsigned int c_vkBC4Unorm = 139;
+	constexpr unsigned int c_vkBC5Unorm = 141;
+	constexpr unsigned int c_vkBC7Unorm = 145;
+
+	/// DDS header sizes
+	constexpr size_t c_ddsHeaderSize = 124;
+	constexpr size_t c_ddsDX10HeaderSize = 20;
+
+	/// KTX2 file identifier
+	const unsigned char c_ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	/// BC7 interpolation weights for 4 bit indices
+	const unsigned int c_bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	constexpr unsigned int fourCC(char a, char b, char c, char d)
+	{
+		return (unsigned int)a | ((unsigned int)b << 8) | ((unsigned int)c << 16) | ((unsigned int)d << 24);
+	}
+
+	unsigned int read32(const unsigned char* pData)
+	{
+		return (unsigned int)pData[0] | ((unsigned int)pData[1] << 8) | ((unsigned int)pData[2] << 16) | ((unsigned int)pData[3] << 24);
+	}
+
+	unsigned long long read64(const unsigned char* pData)
+	{
+		return (unsigned long long)read32(pData) | ((unsigned long long)read32(pData + 4) << 32);
+	}
+
+	void write32(std::vector<unsigned char>& data, unsigned int value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			data.push_back((unsigned char)(value >> (i * 8)));
+		}
+	}
+
+	/**
+	 * Fills in the levels of the image from consecutive level data
+	 *
+	 * @return False if the data is too small for the levels
+	 */
+	bool setupLevels(CompressedImageContents& image, unsigned int levelCount, const unsigned char* pData, size_t size)
+	{
+		size_t offset = 0;
+		unsigned int width = image.Width;
+		unsigned int height = image.Height;
+
+		for (unsigned int i = 0; i < levelCount; i++)
+		{
+			CompressedLevel level;
+			level.Width = width;
+			level.Height = height;
+			level.Offset = offset;
+			level.Size = getLevelSize(image.Format, width, height);
+
+			// Sizes come from the file, compared without a sum that could wrap around
+			if (level.Size > size - offset)
+			{
+				return false;
+			}
+
+			image.Levels.push_back(level);
+			offset += level.Size;
+
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+		}
+
+		image.Data.assign(pData, pData + offset);
+		return true;
+	}
+
+	/**
+	 * Color of a BC1 endpoint
+	 */
+	struct Color
+	{
+		int R = 0;
+		int G = 0;
+		int B = 0;
+	};
+
+	unsigned short pack565(const Color& color)
+	{
+		return (unsigned short)(((color.R * 31 + 127) / 255) << 11 | ((color.G * 63 + 127) / 255) << 5 | ((color.B * 31 + 127) / 255));
+	}
+
+	Color unpack565(unsigned short value)
+	{
+		Color color;
+		int r = (value >> 11) & 31;
+		int g = (value >> 5) & 63;
+		int b = value & 31;
+		color.R = (r << 3) | (r >> 2);
+		color.G = (g << 2) | (g >> 4);
+		color.B = (b << 3) | (b >> 2);
+		return color;
+	}
+
+	/**
+	 * Encodes the RGB channels of 16 RGBA pixels, the block always uses the 4 color mode
+	 */
+	void encodeBC1(const unsigned char* pBlock, unsigned char* pOut)
+	{
+		// Bounding box of the colors
+		int minC[3] = { 255, 255, 255 };
+		int maxC[3] = { 0, 0, 0 };
+		int mean[3] = { 0, 0, 0 };
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				minC[c] = std::min(minC[c], (int)pBlock[i * 4 + c]);
+				maxC[c] = std::max(maxC[c], (int)pBlock[i * 4 + c]);
+				mean[c] += pBlock[i * 4 + c];
+			}
+		}
+
+		// Channels that fall while the widest channel rises use the other diagonal
+		int primary = 0;
+		for (int c = 1; c < 3; c++)
+		{
+			if (maxC[c] - minC[c] > maxC[primary] - minC[primary])
+			{
+				primary = c;
+			}
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			if (c == primary)
+			{
+				continue;
+			}
+
+			int covariance = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				covariance += (pBlock[i * 4 + primary] * 16 - mean[primary]) * (pBlock[i * 4 + c] * 16 - mean[c]);
+			}
+
+			if (covariance < 0)
+			{
+				std::swap(minC[c], maxC[c]);
+			}
+		}
+
+		// Inset the endpoints slightly to reduce the error of the extremes
+		Color endpoints[2];
+		int* pEnd[2][3] = { { &endpoints[0].R, &endpoints[0].G, &endpoints[0].B }, { &endpoints[1].R, &endpoints[1].G, &endpoints[1].B } };
+		for (int c = 0; c < 3; c++)
+		{
+			int inset = (maxC[c] - minC[c]) / 16;
+			*pEnd[0][c] = std::min(std::max(maxC[c] - inset, 0), 255);
+			*pEnd[1][c] = std::min(std::max(minC[c] + inset, 0), 255);
+		}
+
+		unsigned short c0 = pack565(endpoints[0]);
+		unsigned short c1 = pack565(endpoints[1]);
+
+		// The 4 color mode requires c0 > c1
+		if (c0 < c1)
+		{
+			std::swap(c0, c1);
+		}
+
+		unsigned int indices = 0;
+
+		if (c0 != c1)
+		{
+			Color palette[4];
+			palette[0] = unpack565(c0);
+			palette[1] = unpack565(c1);
+			palette[2].R = (2 * palette[0].R + palette[1].R) / 3;
+			palette[2].G = (2 * palette[0].G + palette[1].G) / 3;
+			palette[2].B = (2 * palette[0].B + palette[1].B) / 3;
+			palette[3].R = (palette[0].R + 2 * palette[1].R) / 3;
+			palette[3].G = (palette[0].G + 2 * palette[1].G) / 3;
+			palette[3].B = (palette[0].B + 2 * palette[1].B) / 3;
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0;
+				int bestError = INT_MAX;
+
+				for (int p = 0; p < 4; p++)
+				{
+					int dr = pBlock[i * 4 + 0] - palette[p].R;
+					int dg = pBlock[i * 4 + 1] - palette[p].G;
+					int db = pBlock[i * 4 + 2] - palette[p].B;
+					int error = dr * dr + dg * dg + db * db;
+
+					if (error < bestError)
+					{
+						best = p;
+						bestError = error;
+					}
+				}
+
+				indices |= (unsigned int)best << (i * 2);
+			}
+		}
+
+		pOut[0] = (unsigned char)(c0 & 0xFF);
+		pOut[1] = (unsigned char)(c0 >> 8);
+		pOut[2] = (unsigned char)(c1 & 0xFF);
+		pOut[3] = (unsigned char)(c1 >> 8);
+		memcpy(pOut + 4, &indices, 4);
+	}
+
+	/**
+	 * Encodes a single channel of 16 RGBA pixels using the 8 value mode
+	 */
+	void encodeBC4(const unsigned char* pBlock, int channel, unsigned char* pOut)
+	{
+		int minV = 255;
+		int maxV = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			minV = std::min(minV, (int)pBlock[i * 4 + channel]);
+			maxV = std::max(maxV, (int)pBlock[i * 4 + channel]);
+		}
+
+		unsigned long long indices = 0;
+
+		if (maxV != minV)
+		{
+			int palette[8];
+			palette[0] = maxV;
+			palette[1] = minV;
+			for (int p = 1; p < 7; p++)
+			{
+				palette[p + 1] = ((7 - p) * maxV + p * minV) / 7;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int value = pBlock[i * 4 + channel];
+				int best = 0;
+
+				for (int p = 1; p < 8; p++)
+				{
+					if (std::abs(value - palette[p]) < std::abs(value - palette[best]))
+					{
+						best = p;
+					}
+				}
+
+				indices |= (unsigned long long)best << (i * 3);
+			}
+		}
+
+		pOut[0] = (unsigned char)maxV;
+		pOut[1] = (unsigned char)minV;
+		for (int i = 0; i < 6; i++)
+		{
+			pOut[2 + i] = (unsigned char)(indices >> (i * 8));
+		}
+	}
+
+	/**
+	 * Writes bits into a 128 bit block
+	 */
+	void writeBits(unsigned char* pOut, unsigned int& position, unsigned int value, unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++, position++)
+		{
+			if (value & (1u << i))
+			{
+				pOut[position / 8] |= (unsigned char)(1u << (position % 8));
+			}
+		}
+	}
+
+	/**
+	 * Encodes 16 RGBA pixels using BC7 mode 6, a single subset with 7 bit
+	 * endpoints, a p-bit per endpoint and 4 bit indices
+	 */
+	void encodeBC7(const unsigned char* pBlock, unsigned char* pOut)
+	{
+		int minC[4] = { 255, 255, 255, 255 };
+		int maxC[4] = { 0, 0, 0, 0 };
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				minC[c] = std::min(minC[c], (int)pBlock[i * 4 + c]);
+				maxC[c] = std::max(maxC[c], (int)pBlock[i * 4 + c]);
+			}
+		}
+
+		// Quantize both endpoints with the p-bit that gives the smallest error
+		int quantized[2][4];
+		int pBits[2];
+		int endpoints[2][4];
+		const int* pTargets[2] = { minC, maxC };
+
+		for (int e = 0; e < 2; e++)
+		{
+			int bestError = INT_MAX;
+
+			for (int p = 0; p < 2; p++)
+			{
+				int error = 0;
+				int values[4];
+
+				for (int c = 0; c < 4; c++)
+				{
+					values[c] = std::min(std::max((pTargets[e][c] - p + 1) / 2, 0), 127);
+					int decoded = (values[c] << 1) | p;
+					error += (decoded - pTargets[e][c]) * (decoded - pTargets[e][c]);
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					pBits[e] = p;
+					for (int c = 0; c < 4; c++)
+					{
+						quantized[e][c] = values[c];
+						endpoints[e][c] = (values[c] << 1) | p;
+					}
+				}
+			}
+		}
+
+		// Pick the closest of the 16 interpolated colors
+		int indices[16];
+		for (int i = 0; i < 16; i++)
+		{
+			int bestError = INT_MAX;
+
+			for (int w = 0; w < 16; w++)
+			{
+				int error = 0;
+				for (int c = 0; c < 4; c++)
+				{
+					int value = ((64 - c_bc7Weights[w]) * endpoints[0][c] + c_bc7Weights[w] * endpoints[1][c] + 32) >> 6;
+					error += (value - pBlock[i * 4 + c]) * (value - pBlock[i * 4 + c]);
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = w;
+				}
+			}
+		}
+
+		// The most significant bit of the first index is implied to be 0
+		if (indices[0] & 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::swap(quantized[0][c], quantized[1][c]);
+			}
+
+			std::swap(pBits[0], pBits[1]);
+
+			for (int& index : indices)
+			{
+				index = 15 - index;
+			}
+		}
+
+		memset(pOut, 0, 16);
+		unsigned int position = 0;
+
+		// Mode 6
+		writeBits(pOut, position, 1u << 6, 7);
+
+		// Endpoints are stored per channel
+		for (int c = 0; c < 4; c++)
+		{
+			writeBits(pOut, position, quantized[0][c], 7);
+			writeBits(pOut, position, quantized[1][c], 7);
+		}
+
+		writeBits(pOut, position, pBits[0], 1);
+		writeBits(pOut, position, pBits[1], 1);
+
+		writeBits(pOut, position, indices[0], 3);
+		for (int i = 1; i < 16; i++)
+		{
+			writeBits(pOut, position, indices[i], 4);
+		}
+	}
+
+	/**
+	 * Decodes the RGB channels of a BC1 block into 16 RGBA pixels, the 3 color
+	 * mode writes transparent black for index 3
+	 */
+	void decodeBC1(const unsigned char* pIn, unsigned char* pBlock)
+	{
+		unsigned short c0 = (unsigned short)(pIn[0] | (pIn[1] << 8));
+		unsigned short c1 = (unsigned short)(pIn[2] | (pIn[3] << 8));
+
+		Color palette[4];
+		palette[0] = unpack565(c0);
+		palette[1] = unpack565(c1);
+
+		if (c0 > c1)
+		{
+			palette[2].R = (2 * palette[0].R + palette[1].R) / 3;
+			palette[2].G = (2 * palette[0].G + palette[1].G) / 3;
+			palette[2].B = (2 * palette[0].B + palette[1].B) / 3;
+			palette[3].R = (palette[0].R + 2 * palette[1].R) / 3;
+			palette[3].G = (palette[0].G + 2 * palette[1].G) / 3;
+			palette[3].B = (palette[0].B + 2 * palette[1].B) / 3;
+		}
+		else
+		{
+			palette[2].R = (palette[0].R + palette[1].R) / 2;
+			palette[2].G = (palette[0].G + palette[1].G) / 2;
+			palette[2].B = (palette[0].B + palette[1].B) / 2;
+		}
+
+		unsigned int indices = read32(pIn + 4);
+		for (int i = 0; i < 16; i++)
+		{
+			unsigned int index = (indices >> (i * 2)) & 3;
+			pBlock[i * 4 + 0] = (unsigned char)palette[index].R;
+			pBlock[i * 4 + 1] = (unsigned char)palette[index].G;
+			pBlock[i * 4 + 2] = (unsigned char)palette[index].B;
+			pBlock[i * 4 + 3] = c0 <= c1 && index == 3 ? 0 : 255;
+		}
+	}
+
+	/**
+	 * Decodes a BC4 block into a single channel of 16 RGBA pixels
+	 */
+	void decodeBC4(const unsigned char* pIn, int channel, unsigned char* pBlock)
+	{
+		int palette[8];
+		palette[0] = pIn[0];
+		palette[1] = pIn[1];
+
+		if (palette[0] > palette[1])
+		{
+			for (int p = 1; p < 7; p++)
+			{
+				palette[p + 1] = ((7 - p) * palette[0] + p * palette[1]) / 7;
+			}
+		}
+		else
+		{
+			for (int p = 1; p < 5; p++)
+			{
+				palette[p + 1] = ((5 - p) * palette[0] + p * palette[1]) / 5;
+			}
+
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		unsigned long long indices = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			indices |= (unsigned long long)pIn[2 + i] << (i * 8);
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			pBlock[i * 4 + channel] = (unsigned char)palette[(indices >> (i * 3)) & 7];
+		}
+	}
+
+	/**
+	 * Compresses a single RGBA level
+	 */
+	void compressLevel(const unsigned char* pPixels, unsigned int width, unsigned int height, CompressedFormat format, unsigned char* pOut)
+	{
+		size_t blockSize = getBlockSize(format);
+		unsigned char block[64];
+
+		for (unsigned int by = 0; by < height; by += 4)
+		{
+			for (unsigned int bx = 0; bx < width; bx += 4)
+			{
+				// Gather the block, pixels outside of the level repeat the edge
+				for (unsigned int y = 0; y < 4; y++)
+				{
+					for (unsigned int x = 0; x < 4; x++)
+					{
+						unsigned int sx = std::min(bx + x, width - 1);
+						unsigned int sy = std::min(by + y, height - 1);
+						memcpy(block + (y * 4 + x) * 4, pPixels + ((size_t)sy * width + sx) * 4, 4);
+					}
+				}
+
+				switch (format)
+				{
+				case cf_BC1:
+					encodeBC1(block, pOut);
+					break;
+				case cf_BC3:
+					encodeBC4(block, 3, pOut);
+					encodeBC1(block, pOut + 8);
+					break;
+				case cf_BC4:
+					encodeBC4(block, 0, pOut);
+					break;
+				case cf_BC5:
+					encodeBC4(block, 0, pOut);
+					encodeBC4(block, 1, pOut + 8);
+					break;
+				case cf_BC7:
+					encodeBC7(block, pOut);
+					break;
+				default:
+					break;
+				}
+
+				pOut += blockSize;
+			}
+		}
+	}
+}
+
+size_t getBlockSize(CompressedFormat format)
+{
+	switch (format)
+	{
+	case cf_BC1:
+	case cf_BC4:
+		return 8;
+	case cf_BC3:
+	case cf_BC5:
+	case cf_BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+size_t getLevelSize(CompressedFormat format, unsigned int width, unsigned int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+unsigned int getGLInternalFormat(CompressedFormat format)
+{
+	switch (format)
+	{
+	case cf_BC1:
+		return c_glCompressedRGBAS3TCDXT1;
+	case cf_BC3:
+		return c_glCompressedRGBAS3TCDXT5;
+	case cf_BC4:
+		return c_glCompressedRedRGTC1;
+	case cf_BC5:
+		return c_glCompressedRGRGTC2;
+	case cf_BC7:
+		return c_glCompressedRGBABPTCUnorm;
+	default:
+		return 0;
+	}
+}
+
+CompressedFormat getCompressedFormat(const std::string& name)
+{
+	std::string lower = name;
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	if (lower == "bc1")
+	{
+		return cf_BC1;
+	}
+	else if (lower == "bc3")
+	{
+		return cf_BC3;
+	}
+	else if (lower == "bc4")
+	{
+		return cf_BC4;
+	}
+	else if (lower == "bc5")
+	{
+		return cf_BC5;
+	}
+	else if (lower == "bc7")
+	{
+		return cf_BC7;
+	}
+
+	return cf_None;
+}
+
+bool isCompressedImagePath(const std::string& path)
+{
+	size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+	{
+		return false;
+	}
+
+	std::string extension = path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	return extension == "dds" || extension == "ktx2";
+}
+
+bool parseDDS(const unsigned char* pData, size_t size, CompressedImageContents& image)
+{
+	// Magic and header
+	if (size < 4 + c_ddsHeaderSize || read32(pData) != fourCC('D', 'D', 'S', ' '))
+	{
+		return false;
+	}
+
+	const unsigned char* pHeader = pData + 4;
+	if (read32(pHeader) != c_ddsHeaderSize)
+	{
+		return false;
+	}
+
+	image = CompressedImageContents();
+	image.Height = read32(pHeader + 8);
+	image.Width = read32(pHeader + 12);
+
+	unsigned int levelCount = std::max(read32(pHeader + 24), 1u);
+	unsigned int format = read32(pHeader + 80);
+	size_t dataOffset = 4 + c_ddsHeaderSize;
+
+	switch (format)
+	{
+	case fourCC('D', 'X', 'T', '1'):
+		image.Format = cf_BC1;
+		break;
+	case fourCC('D', 'X', 'T', '5'):
+		image.Format = cf_BC3;
+		break;
+	case fourCC('A', 'T', 'I', '1'):
+	case fourCC('B', 'C', '4', 'U'):
+		image.Format = cf_BC4;
+		break;
+	case fourCC('A', 'T', 'I', '2'):
+	case fourCC('B', 'C', '5', 'U'):
+		image.Format = cf_BC5;
+		break;
+	case fourCC('D', 'X', '1', '0'):
+	{
+		if (size < dataOffset + c_ddsDX10HeaderSize)
+		{
+			return false;
+		}
+
+		switch (read32(pData + dataOffset))
+		{
+		case c_dxgiBC1Typeless:
+		case c_dxgiBC1Unorm:
+			image.Format = cf_BC1;
+			break;
+		case c_dxgiBC3Typeless:
+		case c_dxgiBC3Unorm:
+			image.Format = cf_BC3;
+			break;
+		case c_dxgiBC4Typeless:
+		case c_dxgiBC4Unorm:
+			image.Format = cf_BC4;
+			break;
+		case c_dxgiBC5Typeless:
+		case c_dxgiBC5Unorm:
+			image.Format = cf_BC5;
+			break;
+		case c_dxgiBC7Typeless:
+		case c_dxgiBC7Unorm:
+			image.Format = cf_BC7;
+			break;
+		}
+
+		// Only single 2D textures are supported
+		if (read32(pData + dataOffset + 12) > 1)
+		{
+			return false;
+		}
+
+		dataOffset += c_ddsDX10HeaderSize;
+		break;
+	}
+	}
+
+	if (image.Format == cf_None || image.Width == 0 || image.Height == 0)
+	{
+		return false;
+	}
+
+	return setupLevels(image, levelCount, pData + dataOffset, size - dataOffset);
+}
+
+bool parseKTX2(const unsigned char* pData, size_t size, CompressedImageContents& image)
+{
+	// Identifier, header, index and at least one level
+	constexpr size_t headerSize = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+	if (size < headerSize + 24 || memcmp(pData, c_ktx2Identifier, sizeof(c_ktx2Identifier)) != 0)
+	{
+		return false;
+	}
+
+	image = CompressedImageContents();
+
+	unsigned int vkFormat = read32(pData + 12);
+	image.Width = read32(pData + 20);
+	image.Height = read32(pData + 24);
+	unsigned int depth = read32(pData + 28);
+	unsigned int layerCount = read32(pData + 32);
+	unsigned int faceCount = read32(pData + 36);
+	unsigned int levelCount = std::max(read32(pData + 40), 1u);
+	unsigned int supercompression = read32(pData + 44);
+
+	// Only single 2D textures without supercompression are supported
+	if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompression != 0)
+	{
+		return false;
+	}
+
+	switch (vkFormat)
+	{
+	case c_vkBC1RGBUnorm:
+	case c_vkBC1RGBAUnorm:
+		image.Format = cf_BC1;
+		break;
+	case c_vkBC3Unorm:
+		image.Format = cf_BC3;
+		break;
+	case c_vkBC4Unorm:
+		image.Format = cf_BC4;
+		break;
+	case c_vkBC5Unorm:
+		image.Format = cf_BC5;
+		break;
+	case c_vkBC7Unorm:
+		image.Format = cf_BC7;
+		break;
+	}
+
+	if (image.Format == cf_None || image.Width == 0 || image.Height == 0 || size < headerSize + (size_t)levelCount * 24)
+	{
+		return false;
+	}
+
+	// Levels are stored in any order, the index gives their location
+	unsigned int width = image.Width;
+	unsigned int height = image.Height;
+	std::vector<std::pair<unsigned long long, unsigned long long>> ranges;
+
+	for (unsigned int i = 0; i < levelCount; i++)
+	{
+		const unsigned char* pIndex = pData + headerSize + (size_t)i * 24;
+		unsigned long long offset = read64(pIndex);
+		unsigned long long length = read64(pIndex + 8);
+
+		// Values come from the file, compared without a sum that could wrap around
+		if (offset > size || length > size - offset || length < getLevelSize(image.Format, width, height))
+		{
+			return false;
+		}
+
+		ranges.emplace_back(offset, length);
+
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	// Copy levels so that they are consecutive
+	width = image.Width;
+	height = image.Height;
+
+	for (auto& range : ranges)
+	{
+		CompressedLevel level;
+		level.Width = width;
+		level.Height = height;
+		level.Offset = image.Data.size();
+		level.Size = getLevelSize(image.Format, width, height);
+
+		image.Data.insert(image.Data.end(), pData + range.first, pData + range.first + level.Size);
+		image.Levels.push_back(level);
+
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	return true;
+}
+
+Memory::reference<CompressedImageContents> readCompressedImage(const std::string& path)
+{
+	std::vector<unsigned char> data;
+	if (!readBinaryFile(path, data))
+	{
+		LOG_ERROR("Failed to read '{0}'!", path);
+		return nullptr;
+	}
+
+	// Result image
+	Memory::reference<CompressedImageContents> result = new CompressedImageContents();
+
+	if (!parseDDS(data.data(), data.size(), *result) && !parseKTX2(data.data(), data.size(), *result))
+	{
+		LOG_ERROR("'{0}' is not a supported DDS or KTX2 texture!", path);
+		return nullptr;
+	}
+
+	return result;
+}
+
+bool writeDDS(const std::string& path, const CompressedImageContents& image)
+{
+	unsigned int dxgiFormat = 0;
+	switch (image.Format)
+	{
+	case cf_BC1:
+		dxgiFormat = c_dxgiBC1Unorm;
+		break;
+	case cf_BC3:
+		dxgiFormat = c_dxgiBC3Unorm;
+		break;
+	case cf_BC4:
+		dxgiFormat = c_dxgiBC4Unorm;
+		break;
+	case cf_BC5:
+		dxgiFormat = c_dxgiBC5Unorm;
+		break;
+	case cf_BC7:
+		dxgiFormat = c_dxgiBC7Unorm;
+		break;
+	default:
+		return false;
+	}
+
+	std::vector<unsigned char> data;
+	data.reserve(4 + c_ddsHeaderSize + c_ddsDX10HeaderSize + image.Data.size());
+
+	// Magic
+	write32(data, fourCC('D', 'D', 'S', ' '));
+
+	// Caps, height, width, pixel format, mip map count and linear size are valid
+	write32(data, (unsigned int)c_ddsHeaderSize);
+	write32(data, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+	write32(data, image.Height);
+	write32(data, image.Width);
+	write32(data, image.Levels.empty() ? 0 : (unsigned int)image.Levels[0].Size);
+	write32(data, 0);
+	write32(data, (unsigned int)image.Levels.size());
+
+	for (int i = 0; i < 11; i++)
+	{
+		write32(data, 0);
+	}
+
+	// Pixel format, the format is in the DX10 header
+	write32(data, 32);
+	write32(data, 0x4);
+	write32(data, fourCC('D', 'X', '1', '0'));
+	for (int i = 0; i < 5; i++)
+	{
+		write32(data, 0);
+	}
+
+	// Texture, complex and mip map caps
+	write32(data, image.Levels.size() > 1 ? 0x1000 | 0x8 | 0x400000 : 0x1000);
+	for (int i = 0; i < 4; i++)
+	{
+		write32(data, 0);
+	}
+
+	// DX10 header of a single 2D texture
+	write32(data, dxgiFormat);
+	write32(data, 3);
+	write32(data, 0);
+	write32(data, 1);
+	write32(data, 0);
+
+	data.insert(data.end(), image.Data.begin(), image.Data.end());
+
+	return writeBinaryFile(path, data.data(), data.size());
+}
+
+void downsampleImage(const unsigned char* pSource, unsigned int width, unsigned int height, unsigned int BPP, std::vector<unsigned char>& destination)
+{
+	unsigned int levelWidth = std::max(width / 2, 1u);
+	unsigned int levelHeight = std::max(height / 2, 1u);
+	destination.resize((size_t)levelWidth * levelHeight * BPP);
+
+	for (unsigned int y = 0; y < levelHeight; y++)
+	{
+		unsigned int y0 = std::min(y * 2, height - 1);
+		unsigned int y1 = std::min(y * 2 + 1, height - 1);
+
+		for (unsigned int x = 0; x < levelWidth; x++)
+		{
+			unsigned int x0 = std::min(x * 2, width - 1);
+			unsigned int x1 = std::min(x * 2 + 1, width - 1);
+
+			for (unsigned int c = 0; c < BPP; c++)
+			{
+				unsigned int sum =
+					pSource[((size_t)y0 * width + x0) * BPP + c] +
+					pSource[((size_t)y0 * width + x1) * BPP + c] +
+					pSource[((size_t)y1 * width + x0) * BPP + c] +
+					pSource[((size_t)y1 * width + x1) * BPP + c];
+
+				destination[((size_t)y * levelWidth + x) * BPP + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+bool compressImage(const unsigned char* pPixels, unsigned int width, unsigned int height, unsigned int BPP, CompressedFormat format, CompressedImageContents& image)
+{
+	if (format == cf_None || width == 0 || height == 0 || (BPP != 1 && BPP != 3 && BPP != 4))
+	{
+		return false;
+	}
+
+	// The encoder works on RGBA pixels
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			pixels[i * 4 + c] =
+				BPP == 1 ? (c == 3 ? 255 : pPixels[i]) :
+				BPP == 3 ? (c == 3 ? 255 : pPixels[i * 3 + c]) :
+				pPixels[i * 4 + c];
+		}
+	}
+
+	image = CompressedImageContents();
+	image.Format = format;
+	image.Width = width;
+	image.Height = height;
+
+	// Compress every level of the mip chain
+	std::vector<unsigned char> next;
+	while (true)
+	{
+		CompressedLevel level;
+		level.Width = width;
+		level.Height = height;
+		level.Offset = image.Data.size();
+		level.Size = getLevelSize(format, width, height);
+
+		image.Data.resize(level.Offset + level.Size);
+		compressLevel(pixels.data(), width, height, format, image.Data.data() + level.Offset);
+		image.Levels.push_back(level);
+
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+
+		downsampleImage(pixels.data(), width, height, 4, next);
+		pixels.swap(next);
+
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	return true;
+}
+
+bool decompressImage(const CompressedImageContents& image, std::vector<unsigned char>& pixels)
+{
+	// BC7 has no decoder, it is core since OpenGL 4.2 so engine contexts always support it
+	if (image.Levels.empty() || image.Format == cf_None || image.Format == cf_BC7)
+	{
+		return false;
+	}
+
+	unsigned int width = image.Width;
+	unsigned int height = image.Height;
+	size_t blockSize = getBlockSize(image.Format);
+	const unsigned char* pIn = image.Data.data() + image.Levels[0].Offset;
+
+	pixels.assign((size_t)width * height * 4, 0);
+	unsigned char block[64];
+
+	for (unsigned int by = 0; by < height; by += 4)
+	{
+		for (unsigned int bx = 0; bx < width; bx += 4)
+		{
+			// Channels the format doesn't store read as 0, alpha as 1
+			memset(block, 0, sizeof(block));
+			for (int i = 0; i < 16; i++)
+			{
+				block[i * 4 + 3] = 255;
+			}
+
+			switch (image.Format)
+			{
+			case cf_BC1:
+				decodeBC1(pIn, block);
+				break;
+			case cf_BC3:
+				decodeBC1(pIn + 8, block);
+				decodeBC4(pIn, 3, block);
+				break;
+			case cf_BC4:
+				decodeBC4(pIn, 0, block);
+				break;
+			case cf_BC5:
+				decodeBC4(pIn, 0, block);
+				decodeBC4(pIn + 8, 1, block);
+				break;
+			default:
+				break;
+			}
+
+			// Scatter the block, pixels outside of the level are dropped
+			for (unsigned int y = 0; y < 4 && by + y < height; y++)
+			{
+				for (unsigned int x = 0; x < 4 && bx + x < width; x++)
+				{
+					memcpy(pixels.data() + ((size_t)(by + y) * width + bx + x) * 4, block + (y * 4 + x) * 4, 4);
+				}
+			}
+
+			pIn += blockSize;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+// For string
+#include <string>
+
+// For data buffers
+#include <vector>
+
+// Reference
+#include "CommonTypes/reference.h"
+
+/**
+ * @file
+ * Utility file containing block compressed (BCn) texture containers and the
+ * CPU encoder used to create them. Nothing in here uses OpenGL so parsing and
+ * format selection work without a context.
+ */
+
+/**
+ * Block compressed formats
+ */
+enum CompressedFormat
+{
+    cf_None = 0,
+
+    /// RGB, 8 bytes per block
+    cf_BC1,
+
+    /// RGBA, 16 bytes per block
+    cf_BC3,
+
+    /// Single channel, 8 bytes per block
+    cf_BC4,
+
+    /// Two channels, 16 bytes per block
+    cf_BC5,
+
+    /// High quality RGBA, 16 bytes per block
+    cf_BC7,
+};
+
+/**
+ * Mip level of a compressed image
+ */
+struct CompressedLevel
+{
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+
+    /// Location of the level in the image data
+    size_t Offset = 0;
+    size_t Size = 0;
+};
+
+/**
+ * Struct containing the loaded compressed image data
+ */
+struct CompressedImageContents
+{
+    CompressedFormat Format = cf_None;
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+
+    /// Mip levels, level 0 is the full resolution
+    std::vector<CompressedLevel> Levels;
+
+    /// Data of all levels
+    std::vector<unsigned char> Data;
+};
+
+/**
+ * Returns the size of a 4x4 block of the format in bytes
+ */
+size_t getBlockSize(CompressedFormat format);
+
+/**
+ * Returns the size of a level with the specified dimensions in bytes
+ */
+size_t getLevelSize(CompressedFormat format, unsigned int width, unsigned int height);
+
+/**
+ * Returns the OpenGL internal format of the compressed format or 0 if it's unknown
+ */
+unsigned int getGLInternalFormat(CompressedFormat format);
+
+/**
+ * Returns the compressed format with the specified name (bc1, bc3, bc4, bc5, bc7)
+ */
+CompressedFormat getCompressedFormat(const std::string& name);
+
+/**
+ * Returns true if the path has the extension of a compressed texture container
+ */
+bool isCompressedImagePath(const std::string& path);
+
+/**
+ * Parses a DDS file, both legacy FourCC and DX10 headers are supported
+ *
+ * @param pData File contents
+ * @param size Size of the contents in bytes
+ * @param image Struct that receives the image
+ *
+ * @return True if the file contains a supported image, false otherwise
+ */
+bool parseDDS(const unsigned char* pData, size_t size, CompressedImageContents& image);
+
+/**
+ * Parses a KTX2 file without supercompression
+ *
+ * @param pData File contents
+ * @param size Size of the contents in bytes
+ * @param image Struct that receives the image
+ *
+ * @return True if the file contains a supported image, false otherwise
+ */
+bool parseKTX2(const unsigned char* pData, size_t size, CompressedImageContents& image);
+
+/**
+ * Reads a compressed image from a DDS or KTX2 file, the container is detected
+ * from the file contents
+ *
+ * @param path Path to the image file
+ *
+ * @return Reference to CompressedImageContents
+ */
+Memory::reference<CompressedImageContents> readCompressedImage(const std::string& path);
+
+/**
+ * Writes a compressed image to a DDS file with a DX10 header
+ *
+ * @return True if the file was written, false otherwise
+ */
+bool writeDDS(const std::string& path, const CompressedImageContents& image);
+
+/**
+ * Creates the next mip level by averaging 2x2 blocks, edges of odd sizes are clamped
+ *
+ * @param pSource Source pixels
+ * @param width Width of the source
+ * @param height Height of the source
+ * @param BPP Bytes per pixel
+ * @param destination Vector that receives the pixels of the next level
+ */
+void downsampleImage(const unsigned char* pSource, unsigned int width, unsigned int height, unsigned int BPP, std::vector<unsigned char>& destination);
+
+/**
+ * Compresses the image and its full mip chain
+ *
+ * @param pPixels Pixels of the image
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param BPP Bytes per pixel, 1, 3 or 4
+ * @param format Format to compress to
+ * @param image Struct that receives the compressed image
+ *
+ * @return True if the image was compressed, false otherwise
+ */
+bool compressImage(const unsigned char* pPixels, unsigned int width, unsigned int height, unsigned int BPP, CompressedFormat format, CompressedImageContents& image);
+
+/**
+ * Decodes the first level of a compressed image to RGBA pixels, used when the
+ * driver can't sample the format. BC7 isn't decoded.
+ *
+ * @param image Compressed image
+ * @param pixels Vector that receives the pixels
+ *
+ * @return True if the image was decoded, false otherwise
+ */
+bool decompressImage(const CompressedImageContents& image, std::vector<unsigned char>& pixels);
@@ -0,0 +1,140 @@
+#include "WorkerPool.h"
+
+// For std::min
+#include <algorithm>
+
+namespace Utility
+{
+	WorkerPool::WorkerPool(unsigned int workers)
+	{
+		if (workers == 0)
+		{
+			unsigned int cores = std::thread::hardware_concurrency();
+			workers = std::min(cores > 1 ? cores - 1 : 1u, 7u);
+		}
+
+		for (unsigned int i = 0; i < workers; i++)
+		{
+			m_workers.emplace_back(&WorkerPool::workerLoop, this);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+		}
+
+		m_wake.notify_all();
+
+		for (std::thread& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	unsigned int WorkerPool::getThreadCount() const
+	{
+		return (unsigned int)m_workers.size() + 1;
+	}
+
+	void WorkerPool::run(size_t count, const std::function<void(size_t)>& fn)
+	{
+		wait();
+
+		// A single task isn't worth waking the workers
+		if (count == 1 || m_workers.empty())
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				fn(i);
+			}
+
+			return;
+		}
+
+		dispatch(count, fn);
+		wait();
+	}
+
+	void WorkerPool::dispatch(size_t count, std::function<void(size_t)> fn)
+	{
+		wait();
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		// Hand the work out, without workers it's executed by wait
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_fn = std::move(fn);
+			m_count = count;
+			m_next = 0;
+			m_done = 0;
+			m_pending = true;
+
+			if (!m_workers.empty())
+			{
+				m_generation++;
+			}
+		}
+
+		m_wake.notify_all();
+	}
+
+	void WorkerPool::wait()
+	{
+		if (!m_pending)
+		{
+			return;
+		}
+
+		// Help with the work, then wait for the workers to finish theirs
+		execute();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_finished.wait(lock, [this]() { return m_done == m_workers.size(); });
+		m_fn = nullptr;
+		m_pending = false;
+	}
+
+	void WorkerPool::execute()
+	{
+		for (size_t i = m_next++; i < m_count; i = m_next++)
+		{
+			m_fn(i);
+		}
+	}
+
+	void WorkerPool::workerLoop()
+	{
+		size_t generation = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [&]() { return !m_running || m_generation != generation; });
+
+				if (!m_running)
+				{
+					return;
+				}
+
+				generation = m_generation;
+			}
+
+			execute();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_done++;
+			}
+
+			m_finished.notify_one();
+		}
+	}
+}
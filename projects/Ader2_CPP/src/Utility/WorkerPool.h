@@ -0,0 +1,105 @@
+#pragma once
+
+// Worker threads
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+
+namespace Utility
+{
+	/**
+	 * Pool of persistent worker threads used to split a loop across cores.
+	 * Workers sleep until work is handed to them, the calling thread takes
+	 * part in the work and returns once everything has been executed.
+	 *
+	 * Work can also be dispatched without waiting, the calling thread continues
+	 * with other work and waits for the tasks later. Only one set of tasks is
+	 * in flight at a time and only one thread may hand out work.
+	 */
+	class WorkerPool
+	{
+	public:
+		/**
+		 * Creates the worker threads
+		 *
+		 * @param workers Number of worker threads, 0 to use one less than the
+		 * number of cores (capped to 7) so the calling thread completes the set
+		 */
+		WorkerPool(unsigned int workers = 0);
+
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		/**
+		 * Returns the number of threads executing work, including the calling thread
+		 */
+		unsigned int getThreadCount() const;
+
+		/**
+		 * Executes the function for every task index and waits until all tasks
+		 * have finished, tasks are picked up in increasing order
+		 *
+		 * @param count Number of tasks
+		 * @param fn Function taking the task index
+		 */
+		void run(size_t count, const std::function<void(size_t)>& fn);
+
+		/**
+		 * Hands the tasks to the workers and returns without waiting, the
+		 * function is copied. Waits for previously dispatched tasks first
+		 *
+		 * @param count Number of tasks
+		 * @param fn Function taking the task index
+		 */
+		void dispatch(size_t count, std::function<void(size_t)> fn);
+
+		/**
+		 * Helps with the dispatched tasks and waits until all of them have
+		 * finished, returns immediately if nothing was dispatched
+		 */
+		void wait();
+	private:
+		/**
+		 * Executes tasks until there are none left
+		 */
+		void execute();
+
+		/**
+		 * Worker thread loop
+		 */
+		void workerLoop();
+	private:
+		/// Worker threads
+		std::vector<std::thread> m_workers;
+
+		/// Guards the generation and wakes the workers
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_finished;
+
+		/// Incremented every time work is handed out
+		size_t m_generation = 0;
+
+		/// Workers that finished the current generation
+		unsigned int m_done = 0;
+
+		/// True while the workers should keep running
+		bool m_running = true;
+
+		/// Current work
+		std::function<void(size_t)> m_fn;
+		size_t m_count = 0;
+
+		/// True while dispatched tasks haven't been waited for
+		bool m_pending = false;
+
+		/// Next task index to execute
+		std::atomic<size_t> m_next{ 0 };
+	};
+}
@@ -1,18 +1,390 @@
 #include <iostream>
+#include <algorithm>
+#include <cctype>
+
+// Parsing counts from the command line
+#include <cstdlib>
+#include <cerrno>
 
 #include "AderEngine.h"
 
 #include "Utility/Timer.h"
 
-int main()
+// Frame profiler
+#include "Utility/Profiler.h"
+
+// Texture compression tool
+#include "Utility/File.h"
+#include "Utility/TextureCompression.h"
+
+// Mesh conversion tool
+#include "Utility/MeshFile.h"
+#include "Utility/MeshOptimizer.h"
+
+/**
+ * Parses a whole argument as a count
+ *
+ * @return True if the argument only contains a number, false otherwise
+ */
+bool parseCount(const char* text, size_t& value)
+{
+	if (!std::isdigit((unsigned char)text[0]))
+	{
+		return false;
+	}
+
+	char* pEnd = nullptr;
+	errno = 0;
+	unsigned long long result = std::strtoull(text, &pEnd, 10);
+	if (errno == ERANGE || *pEnd != '\0')
+	{
+		return false;
+	}
+
+	value = (size_t)result;
+	return true;
+}
+
+/**
+ * Compresses an image into a DDS file with a full mip chain
+ *
+ * Usage: --compress <input image> <output.dds> <bc1|bc3|bc4|bc5|bc7>
+ */
+int compressTexture(int argc, char** argv)
+{
+	if (argc < 5)
+	{
+		std::cout << "Usage: --compress <input image> <output.dds> <bc1|bc3|bc4|bc5|bc7>" << std::endl;
+		return 1;
+	}
+
+	// Image decoding and file writing report errors through the logger
+	Log::init();
+
+	CompressedFormat format = getCompressedFormat(argv[4]);
+	if (format == cf_None)
+	{
+		std::cout << "Unknown format '" << argv[4] << "'" << std::endl;
+		return 1;
+	}
+
+	Memory::reference<ImageFileContents> image = readImage(argv[2]);
+	if (!image.valid())
+	{
+		return 2;
+	}
+
+	Utility::Timer timer(true);
+
+	CompressedImageContents compressed;
+	if (!compressImage(image->Buffer, image->Width, image->Height, image->BPP, format, compressed))
+	{
+		std::cout << "Images with " << image->BPP << " channels can't be compressed" << std::endl;
+		return 2;
+	}
+
+	timer.end();
+
+	if (!writeDDS(argv[3], compressed))
+	{
+		std::cout << "Failed to write '" << argv[3] << "'" << std::endl;
+		return 3;
+	}
+
+	std::cout << argv[2] << ": " << image->Width << "x" << image->Height << ", "
+		<< compressed.Levels.size() << " levels, " << compressed.Data.size() / 1024 << " KB in "
+		<< timer.milliseconds() << " ms" << std::endl;
+
+	return 0;
+}
+
+/**
+ * Converts a Wavefront OBJ file into a mesh file and compares the time it takes to
+ * upload the mesh with VAO::load and through the array path scripts use, where every
+ * attribute is a separate array copied into a vector and then into the command
+ * buffer. Both uploads run on the null backend. The mesh is optimized for the vertex cache, overdraw
+ * and vertex fetch unless --no-optimize is specified, --meshlets reports how the
+ * mesh splits into meshlets and --quantize stores the attributes in compact formats
+ *
+ * Usage: --mesh <input.obj> <output.amesh> [--no-optimize] [--meshlets] [--quantize]
+ */
+int convertMesh(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		std::cout << "Usage: --mesh <input.obj> <output.amesh> [--no-optimize] [--meshlets] [--quantize]" << std::endl;
+		return 1;
+	}
+
+	bool optimize = true;
+	bool meshlets = false;
+	bool quantize = false;
+	for (int i = 4; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--no-optimize")
+		{
+			optimize = false;
+		}
+		else if (arg == "--meshlets")
+		{
+			meshlets = true;
+		}
+		else if (arg == "--quantize")
+		{
+			quantize = true;
+		}
+	}
+
+	// File reading and writing report errors through the logger
+	Log::init();
+
+	Utility::Timer objTimer(true);
+
+	MeshContents mesh;
+	if (!readOBJ(argv[2], mesh))
+	{
+		return 2;
+	}
+
+	objTimer.end();
+
+	if (optimize)
+	{
+		VertexCacheStatistics before = analyzeVertexCache(mesh.Indices, mesh.VertexCount);
+		Utility::Timer optimizeTimer(true);
+
+		if (!optimizeMesh(mesh))
+		{
+			std::cout << "'" << argv[2] << "' has no positions to optimize with" << std::endl;
+			return 2;
+		}
+
+		optimizeTimer.end();
+		VertexCacheStatistics after = analyzeVertexCache(mesh.Indices, mesh.VertexCount);
+
+		std::cout << "Vertex cache (16 entries) ACMR " << before.ACMR << " -> " << after.ACMR
+			<< ", ATVR " << before.ATVR << " -> " << after.ATVR
+			<< " in " << optimizeTimer.microseconds() / 1000.0 << " ms" << std::endl;
+	}
+
+	if (meshlets)
+	{
+		MeshletContents contents;
+		buildMeshlets(mesh, contents);
+
+		size_t cullable = std::count_if(contents.Meshlets.begin(), contents.Meshlets.end(),
+			[](const Meshlet& meshlet) { return meshlet.ConeCutoff > 0.0f; });
+
+		std::cout << contents.Meshlets.size() << " meshlets, "
+			<< (float)contents.Vertices.size() / std::max<size_t>(contents.Meshlets.size(), 1) << " vertices and "
+			<< (float)contents.Triangles.size() / 3 / std::max<size_t>(contents.Meshlets.size(), 1) << " triangles on average, "
+			<< cullable << " with a normal cone narrower than 90 degrees" << std::endl;
+	}
+
+	// Separate arrays as a script would create them
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	positions.reserve(mesh.VertexCount * 3);
+	texCoords.reserve(mesh.VertexCount * 2);
+	const VertexAttribute* pTexCoords = mesh.Layout.find(1);
+
+	for (unsigned int i = 0; i < mesh.VertexCount; i++)
+	{
+		const unsigned char* pVertex = &mesh.Vertices[i * mesh.Layout.Stride];
+		const float* pPosition = reinterpret_cast<const float*>(pVertex);
+		positions.insert(positions.end(), pPosition, pPosition + 3);
+		if (pTexCoords)
+		{
+			const float* pTexCoord = reinterpret_cast<const float*>(pVertex + pTexCoords->Offset);
+			texCoords.insert(texCoords.end(), pTexCoord, pTexCoord + 2);
+		}
+	}
+
+	// Both paths upload through the engine on the null backend, nothing is drawn
+	// but every buffer upload is executed
+	GLState glState;
+	NullBackend nullBackend;
+	RenderThread renderThread;
+	renderThread.start(nullptr, false);
+
+	RenderThread::run([]()
+	{
+		NullBackend::install();
+		GLState::reset();
+	});
+
+	// Array path, the internal calls copy each script array into a vector that is
+	// recorded by the VAO and uploaded when the frame is executed
+	VAO arrayVAO;
+	RenderThread::sync();
+
+	size_t uploaded = NullBackend::getStatistics().UploadedBytes;
+	Utility::Timer arrayTimer(true);
+
+	std::vector<float> vertexArray(positions.begin(), positions.end());
+	arrayVAO.bind();
+	arrayVAO.createVerticesBuffer(vertexArray, false);
+
+	if (!texCoords.empty())
+	{
+		std::vector<float> texCoordArray(texCoords.begin(), texCoords.end());
+		arrayVAO.bind();
+		arrayVAO.createUVBuffer(texCoordArray, false);
+	}
+
+	std::vector<unsigned int> indexArray(mesh.Indices.begin(), mesh.Indices.end());
+	arrayVAO.bind();
+	arrayVAO.createIndiceBuffer(indexArray, false);
+
+	RenderThread::sync();
+	arrayTimer.end();
+
+	size_t arrayBytes = NullBackend::getStatistics().UploadedBytes - uploaded;
+
+	if (quantize)
+	{
+		unsigned int stride = mesh.Layout.Stride;
+		float maxError = 0.0f;
+		quantizeMesh(mesh, &maxError);
+
+		// Every vertex that misses the cache is fetched as a whole
+		double fetched = analyzeVertexCache(mesh.Indices, mesh.VertexCount).Transformed / (1024.0 * 1024.0);
+		std::cout << "Quantized " << stride << " -> " << mesh.Layout.Stride << " bytes per vertex, "
+			<< "vertex fetch " << fetched * stride << " -> " << fetched * mesh.Layout.Stride << " MB per draw, "
+			<< "position error " << maxError << std::endl;
+	}
+
+	if (!writeMesh(argv[3], mesh))
+	{
+		std::cout << "Failed to write '" << argv[3] << "'" << std::endl;
+		return 3;
+	}
+
+	// Mapped path, the file is parsed and uploaded straight from the mapping
+	VAO mappedVAO;
+	RenderThread::sync();
+
+	uploaded = NullBackend::getStatistics().UploadedBytes;
+	Utility::Timer mappedTimer(true);
+
+	mappedVAO.bind();
+	if (!mappedVAO.load(argv[3]))
+	{
+		std::cout << "Failed to read back '" << argv[3] << "'" << std::endl;
+		return 3;
+	}
+
+	RenderThread::sync();
+	mappedTimer.end();
+
+	size_t mappedBytes = NullBackend::getStatistics().UploadedBytes - uploaded;
+
+	std::cout << argv[2] << ": " << mesh.VertexCount << " vertices, " << mesh.Indices.size() / 3 << " triangles" << std::endl;
+	std::cout << "OBJ parse " << objTimer.microseconds() / 1000.0 << " ms, array path "
+		<< arrayTimer.microseconds() / 1000.0 << " ms (" << arrayBytes / 1024 << " KB uploaded), mapped path "
+		<< mappedTimer.microseconds() / 1000.0 << " ms (" << mappedBytes / 1024 << " KB uploaded)" << std::endl;
+
+	return 0;
+}
+
+int main(int argc, char** argv)
 {
+	// Asset tooling runs without creating the engine
+	if (argc > 1 && std::string(argv[1]) == "--compress")
+	{
+		return compressTexture(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--mesh")
+	{
+		return convertMesh(argc, argv);
+	}
+
+	// Headless runs render a fixed amount of frames through the null backend,
+	// either run can capture frames for the replay tool
+	const char* usage = "Usage: [--headless [frames] [--trace <file>] [--validate]] [--gpu-culling] [--dynamic-resolution] "
+		"[--capture <file> [first frame] [frames]]";
+
+	bool headless = argc > 1 && std::string(argv[1]) == "--headless";
+	size_t frameLimit = headless ? 600 : 0;
+	std::string tracePath;
+	bool validate = false;
+	bool gpuCulling = false;
+	bool dynamicResolution = false;
+	std::string capturePath;
+	size_t captureFirstFrame = 100;
+	size_t captureFrames = 1;
+
+	for (int i = headless ? 2 : 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool valid = true;
+
+		if (arg == "--trace" && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+		}
+		else if (arg == "--validate")
+		{
+			validate = true;
+		}
+		else if (arg == "--gpu-culling")
+		{
+			gpuCulling = true;
+		}
+		else if (arg == "--dynamic-resolution")
+		{
+			dynamicResolution = true;
+		}
+		else if (arg == "--capture" && i + 1 < argc)
+		{
+			capturePath = argv[++i];
+
+			// The first frame and the frame count are optional
+			if (i + 1 < argc && std::isdigit((unsigned char)argv[i + 1][0]))
+			{
+				valid = parseCount(argv[++i], captureFirstFrame);
+			}
+
+			if (valid && i + 1 < argc && std::isdigit((unsigned char)argv[i + 1][0]))
+			{
+				valid = parseCount(argv[++i], captureFrames);
+			}
+		}
+		else if (headless)
+		{
+			valid = parseCount(argv[i], frameLimit);
+		}
+		else
+		{
+			valid = false;
+		}
+
+		// Unknown arguments, missing files and malformed counts
+		if (!valid)
+		{
+			std::cout << "Invalid argument '" << argv[i] << "'" << std::endl;
+			std::cout << usage << std::endl;
+			return 1;
+		}
+	}
+
+	// Measures the time until the first frame has been rendered
+	Utility::Timer startupTimer(true);
+	bool startupReported = false;
+
 	AderEngine aEngine;
 
+	// Request a window to be created
+	GLWindow::CreateWindowParams params {1280, 720, "Test title", headless};
+
+	// Must be configured before the context is created
+	NullBackend::configure(tracePath, validate);
+	GLCapture::configure(capturePath, captureFirstFrame, captureFrames, (int)params.width, (int)params.height);
+
 	// The engine doesn't take away the ability to initialize whenever
 	aEngine.postMessage(Messages::msg_Setup);
-
-	// Request a window to be created
-	GLWindow::CreateWindowParams params {1280, 720, "Test title"};
 	aEngine.postMessage(Messages::msg_CreateWindow, &params);
 
 	// Load assemblies
@@ -28,14 +400,24 @@ int main()
 	// Init all scripts
 	aEngine.postMessage(Messages::msg_InitScripts);
 
+	aEngine.context()->toggleGPUCulling(gpuCulling);
+	aEngine.context()->toggleDynamicResolution(dynamicResolution);
+
 	Utility::Timer timer(false);
 
 	float frameTime = 0.0f;
 
 	bool wFrame = false;
+	bool prePass = false;
+
+	// The profiler report is printed once per F7 press
+	bool reportHeld = false;
+
+	size_t frames = 0;
+	double totalTime = 0.0;
 
 	// Check if the program should exit
-	while (!aEngine.shouldClose())
+	while (!aEngine.shouldClose() && (frameLimit == 0 || frames < frameLimit))
 	{
 		// Keyboard
 		KeyboardState keyboard = aEngine.input()->getKeyState();
@@ -56,6 +438,31 @@ int main()
 			aEngine.context()->toggleWireFrame(wFrame);
 		}
 
+		if (keyboard.Keys[InputEnums::KEY_D] && keyboard.Keys[InputEnums::KEY_P])
+		{
+			prePass = !prePass;
+			aEngine.context()->toggleDepthPrePass(prePass);
+		}
+
+		if (keyboard.Keys[InputEnums::KEY_G] && keyboard.Keys[InputEnums::KEY_C])
+		{
+			gpuCulling = !gpuCulling;
+			aEngine.context()->toggleGPUCulling(gpuCulling);
+		}
+
+		if (keyboard.Keys[InputEnums::KEY_D] && keyboard.Keys[InputEnums::KEY_R])
+		{
+			dynamicResolution = !dynamicResolution;
+			aEngine.context()->toggleDynamicResolution(dynamicResolution);
+		}
+
+		if (keyboard.Keys[InputEnums::KEY_F7] && !reportHeld)
+		{
+			std::cout << std::endl << Utility::Profiler::report() << std::endl;
+		}
+
+		reportHeld = keyboard.Keys[InputEnums::KEY_F7];
+
 		// Start the frame timer
 		timer.start();
 
@@ -76,15 +483,97 @@ int main()
 		// Stop the timer
 		timer.end();
 
+		// Move the profiler scopes of this frame to their history
+		Utility::Profiler::endFrame();
+
 		// Calculate frame time
 		frameTime = timer.microseconds() / 1000 / 1000;
+		totalTime += frameTime;
+		frames++;
+
+		// Report startup time, shader cache hits show if the cache was warm or cold
+		if (!startupReported)
+		{
+			RenderThread::sync();
+			startupTimer.end();
+			startupReported = true;
+
+			ShaderCache::Statistics shaderStats = aEngine.context()->getShaderStatistics();
+			std::cout << "Startup time: " << startupTimer.milliseconds() << " ms, shaders: "
+				<< shaderStats.Hits << " cached, " << shaderStats.Misses << " compiled in "
+				<< shaderStats.Milliseconds << " ms, " << shaderStats.Reused << " reused" << std::endl;
+		}
+
+		// Output frame time, FPS and render thread statistics
+		RenderThread::Statistics renderStats = aEngine.context()->getRenderStatistics();
+		GLState::Statistics stateStats = aEngine.context()->getStateStatistics();
+		TextureStreamer::Statistics streamStats = aEngine.context()->getStreamingStatistics();
+		ResolutionScaler::Statistics resolutionStats = aEngine.context()->getResolutionStatistics();
+		std::cout << "Frame time: " << frameTime << " s, " << 60 / frameTime << "FPS, "
+			<< "queue: " << renderStats.QueueDepth << " cmds " << renderStats.QueueBytes << " B, "
+			<< "render thread: " << (int)(renderStats.Utilization * 100) << "%, "
+			<< "avoided GL calls: " << stateStats.Avoided << "/" << stateStats.Issued + stateStats.Avoided << ", "
+			<< "overdraw: " << aEngine.context()->getOverdraw() << "x" << (prePass ? " (pre-pass)" : "") << ", "
+			<< "resolution: " << resolutionStats.Width << "x" << resolutionStats.Height << ", "
+			<< "streaming: " << streamStats.Decoding + streamStats.Uploading << " textures " << streamStats.UploadedBytes << " B" << "\r";
+	}
+
+	// Report the averages of a headless run, validation errors fail the run
+	size_t errors = 0;
+	if (headless)
+	{
+		RenderThread::sync();
+
+		NullBackend::Statistics backendStats = aEngine.context()->getBackendStatistics();
+		size_t backendFrames = std::max<size_t>(backendStats.Frames, 1);
+		errors = backendStats.Errors;
+
+		std::cout << std::endl << "Headless: " << frames << " frames, "
+			<< totalTime * 1000.0 / std::max<size_t>(frames, 1) << " ms/frame, "
+			<< backendStats.Calls / backendFrames << " calls/frame, "
+			<< backendStats.Draws / backendFrames << " draws/frame, "
+			<< backendStats.Instances / backendFrames << " instances/frame, "
+			<< backendStats.Binds / backendFrames << " binds/frame, "
+			<< backendStats.UploadedBytes / backendFrames << " B/frame uploaded, "
+			<< errors << " validation errors" << std::endl;
 
-		// Output frame time and FPS
-		std::cout << "Frame time: " << frameTime << " s, " << 60 / frameTime << "FPS\r";
+		GPUProfiler::Statistics gpuStats = aEngine.context()->getGPUProfilerStatistics();
+		std::cout << Utility::Profiler::report()
+			<< "GPU timings: " << gpuStats.Resolved << " frames read, " << gpuStats.Dropped << " dropped" << std::endl;
+
+		GlyphCache::Statistics glyphStats = aEngine.context()->getGlyphCacheStatistics();
+		std::cout << "Glyph cache: " << glyphStats.Rasterized << " glyphs rasterized, " << glyphStats.Pages << " pages, "
+			<< glyphStats.Evictions << " evictions, " << glyphStats.Fonts << " fonts" << std::endl;
+
+		TextRenderer::Statistics textStats = aEngine.context()->getTextStatistics();
+		std::cout << "Text: " << textStats.Written << " glyphs written, " << textStats.Offsets << " slot offsets written, "
+			<< textStats.Capacity << " glyph capacity" << std::endl;
+
+		SpriteRenderer::Statistics spriteStats = aEngine.context()->getSpriteStatistics();
+		std::cout << "Sprites: " << spriteStats.Sprites << " sprites in " << spriteStats.Batches << " draws in the last frame, "
+			<< spriteStats.Capacity << " sprite capacity" << std::endl;
+
+		ParticleSystem::Statistics particleStats = aEngine.particles()->getStatistics();
+		std::cout << "Particles: " << particleStats.Particles << " particles of " << particleStats.Emitters << " emitters in "
+			<< particleStats.Chunks << " chunks, " << particleStats.Milliseconds << " ms simulation in the last frame" << std::endl;
+
+		if (dynamicResolution)
+		{
+			ResolutionScaler::Statistics resolutionStats = aEngine.context()->getResolutionStatistics();
+			std::cout << "Dynamic resolution: " << (int)(resolutionStats.Scale * 100) << "% scale, "
+				<< resolutionStats.FrameTime << " ms GPU frame time, " << resolutionStats.Changes << " changes" << std::endl;
+		}
+
+		if (gpuCulling)
+		{
+			GPUCuller::Statistics cullStats = aEngine.context()->getCullingStatistics();
+			std::cout << "GPU culling: " << cullStats.Passes << " passes, " << cullStats.Objects << " objects in "
+				<< cullStats.Commands << " indirect draws" << std::endl;
+		}
 	}
 
 	// Shutdown the engine
 	aEngine.shutdown();
 
-	return 0;
+	return errors > 0 ? 4 : 0;
 }
\ No newline at end of file
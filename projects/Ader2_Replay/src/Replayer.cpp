@@ -0,0 +1,794 @@
+#include "Replayer.h"
+
+// Errors are reported to the console
+#include <iostream>
+#include <fstream>
+
+// Copying arguments
+#include <cstring>
+
+template<typename T>
+T Replayer::Reader::get()
+{
+    T value;
+    memcpy(&value, pData, sizeof(T));
+    pData += sizeof(T);
+    return value;
+}
+
+const void* Replayer::Reader::getData(GLsizeiptr& size)
+{
+    size = get<GLsizeiptr>();
+
+    const unsigned char* pBytes = pData;
+    pData += size;
+    return size > 0 ? pBytes : nullptr;
+}
+
+const void* Replayer::Reader::getPixels()
+{
+    // With a pixel buffer the pointer is an offset into it
+    if (get<GLboolean>())
+    {
+        return (const void*)get<GLintptr>();
+    }
+
+    GLsizeiptr size = 0;
+    return getData(size);
+}
+
+bool Replayer::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        std::cout << "Can't open capture file '" << path << "'" << std::endl;
+        return false;
+    }
+
+    size_t size = (size_t)file.tellg();
+    file.seekg(0);
+
+    if (size < sizeof(CaptureHeader))
+    {
+        std::cout << "'" << path << "' is not a capture file" << std::endl;
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&m_header), sizeof(CaptureHeader));
+    if (m_header.Magic != c_captureMagic || m_header.Version != c_captureVersion)
+    {
+        std::cout << "'" << path << "' is not a capture file of this version" << std::endl;
+        return false;
+    }
+
+    m_data.resize(size - sizeof(CaptureHeader));
+    file.read(reinterpret_cast<char*>(m_data.data()), m_data.size());
+
+    // Find the records starting the frames
+    m_frames.clear();
+    size_t offset = 0;
+    while (offset < m_data.size())
+    {
+        if (m_data.size() - offset < 1 + sizeof(unsigned int))
+        {
+            break;
+        }
+
+        CaptureOp op = (CaptureOp)m_data[offset];
+        unsigned int length = 0;
+        memcpy(&length, m_data.data() + offset + 1, sizeof(unsigned int));
+
+        if (m_data.size() - offset - 1 - sizeof(unsigned int) < length)
+        {
+            break;
+        }
+
+        offset += 1 + sizeof(unsigned int) + length;
+
+        if (op == CaptureOp::Start || op == CaptureOp::Frame)
+        {
+            m_frames.push_back(offset);
+        }
+    }
+
+    if (offset != m_data.size())
+    {
+        std::cout << "Capture file '" << path << "' is truncated" << std::endl;
+        return false;
+    }
+
+    if (m_frames.size() < 2)
+    {
+        std::cout << "Capture file '" << path << "' has no captured frames" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+const CaptureHeader& Replayer::getHeader() const
+{
+    return m_header;
+}
+
+size_t Replayer::getFrameCount() const
+{
+    return m_frames.empty() ? 0 : m_frames.size() - 1;
+}
+
+void Replayer::setup()
+{
+    execute(0, m_frames[0]);
+}
+
+void Replayer::frame(size_t index)
+{
+    execute(m_frames[index], m_frames[index + 1]);
+}
+
+void Replayer::execute(size_t begin, size_t end)
+{
+    size_t offset = begin;
+    while (offset < end)
+    {
+        CaptureOp op = (CaptureOp)m_data[offset];
+        unsigned int length = 0;
+        memcpy(&length, m_data.data() + offset + 1, sizeof(unsigned int));
+
+        Reader r;
+        r.pData = m_data.data() + offset + 1 + sizeof(unsigned int);
+        execute(op, r);
+
+        offset += 1 + sizeof(unsigned int) + length;
+    }
+}
+
+GLuint Replayer::getName(const std::unordered_map<GLuint, GLuint>& names, GLuint name) const
+{
+    if (name == 0)
+    {
+        return 0;
+    }
+
+    auto it = names.find(name);
+    return it != names.end() ? it->second : 0;
+}
+
+void Replayer::generate(std::unordered_map<GLuint, GLuint>& names, Reader& r, PFNGLGENBUFFERSPROC pGenerate, PFNGLDELETEBUFFERSPROC pDelete)
+{
+    GLsizei n = r.get<GLsizei>();
+    for (GLsizei i = 0; i < n; i++)
+    {
+        GLuint name = r.get<GLuint>();
+
+        // A looped frame creates it's objects again
+        auto it = names.find(name);
+        if (it != names.end())
+        {
+            pDelete(1, &it->second);
+        }
+
+        GLuint replayed = 0;
+        pGenerate(1, &replayed);
+        names[name] = replayed;
+    }
+}
+
+void Replayer::remove(std::unordered_map<GLuint, GLuint>& names, Reader& r, PFNGLDELETEBUFFERSPROC pDelete)
+{
+    GLsizei n = r.get<GLsizei>();
+    for (GLsizei i = 0; i < n; i++)
+    {
+        auto it = names.find(r.get<GLuint>());
+        if (it != names.end())
+        {
+            pDelete(1, &it->second);
+            names.erase(it);
+        }
+    }
+}
+
+void Replayer::execute(CaptureOp op, Reader& r)
+{
+    switch (op)
+    {
+    case CaptureOp::Start:
+    case CaptureOp::Frame:
+        break;
+    case CaptureOp::ActiveTexture:
+    {
+        GLenum texture = r.get<GLenum>();
+        glActiveTexture(texture);
+        break;
+    }
+    case CaptureOp::AttachShader:
+    {
+        GLuint program = getName(m_programs, r.get<GLuint>());
+        GLuint shader = getName(m_shaders, r.get<GLuint>());
+        glAttachShader(program, shader);
+        break;
+    }
+    case CaptureOp::Barrier:
+    {
+        GLbitfield barriers = r.get<GLbitfield>();
+        glMemoryBarrier(barriers);
+        break;
+    }
+    case CaptureOp::BindBuffer:
+    {
+        GLenum target = r.get<GLenum>();
+        GLuint buffer = getName(m_buffers, r.get<GLuint>());
+        glBindBuffer(target, buffer);
+
+        if (target == GL_COPY_WRITE_BUFFER)
+        {
+            m_copyWriteBuffer = buffer;
+        }
+        break;
+    }
+    case CaptureOp::BindBufferRange:
+    {
+        GLenum target = r.get<GLenum>();
+        GLuint index = r.get<GLuint>();
+        GLuint buffer = getName(m_buffers, r.get<GLuint>());
+        GLintptr offset = r.get<GLintptr>();
+        GLsizeiptr size = r.get<GLsizeiptr>();
+        glBindBufferRange(target, index, buffer, offset, size);
+        break;
+    }
+    case CaptureOp::BindFramebuffer:
+    {
+        GLenum target = r.get<GLenum>();
+        GLuint framebuffer = getName(m_framebuffers, r.get<GLuint>());
+        glBindFramebuffer(target, framebuffer);
+        break;
+    }
+    case CaptureOp::BindImageTexture:
+    {
+        GLuint unit = r.get<GLuint>();
+        GLuint texture = getName(m_textures, r.get<GLuint>());
+        GLint level = r.get<GLint>();
+        GLboolean layered = r.get<GLboolean>();
+        GLint layer = r.get<GLint>();
+        GLenum access = r.get<GLenum>();
+        GLenum format = r.get<GLenum>();
+        glBindImageTexture(unit, texture, level, layered, layer, access, format);
+        break;
+    }
+    case CaptureOp::BindTexture:
+    {
+        GLenum target = r.get<GLenum>();
+        GLuint texture = getName(m_textures, r.get<GLuint>());
+        glBindTexture(target, texture);
+        break;
+    }
+    case CaptureOp::BindVertexArray:
+    {
+        GLuint array = getName(m_vertexArrays, r.get<GLuint>());
+        glBindVertexArray(array);
+        break;
+    }
+    case CaptureOp::BlendFunc:
+    {
+        GLenum sfactor = r.get<GLenum>();
+        GLenum dfactor = r.get<GLenum>();
+        glBlendFunc(sfactor, dfactor);
+        break;
+    }
+    case CaptureOp::BlitFramebuffer:
+    {
+        GLint srcX0 = r.get<GLint>();
+        GLint srcY0 = r.get<GLint>();
+        GLint srcX1 = r.get<GLint>();
+        GLint srcY1 = r.get<GLint>();
+        GLint dstX0 = r.get<GLint>();
+        GLint dstY0 = r.get<GLint>();
+        GLint dstX1 = r.get<GLint>();
+        GLint dstY1 = r.get<GLint>();
+        GLbitfield mask = r.get<GLbitfield>();
+        GLenum filter = r.get<GLenum>();
+        glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        break;
+    }
+    case CaptureOp::BufferData:
+    {
+        GLenum target = r.get<GLenum>();
+        GLsizeiptr size = r.get<GLsizeiptr>();
+        GLsizeiptr dataSize = 0;
+        const void* data = r.getData(dataSize);
+        GLenum usage = r.get<GLenum>();
+        glBufferData(target, size, data, usage);
+        break;
+    }
+    case CaptureOp::BufferStorage:
+    {
+        GLenum target = r.get<GLenum>();
+        GLsizeiptr size = r.get<GLsizeiptr>();
+        GLsizeiptr dataSize = 0;
+        const void* data = r.getData(dataSize);
+        GLbitfield flags = r.get<GLbitfield>();
+
+        // Mapped memory is uploaded with glBufferSubData
+        glBufferStorage(target, size, data, flags | GL_DYNAMIC_STORAGE_BIT);
+        break;
+    }
+    case CaptureOp::BufferSubData:
+    {
+        GLenum target = r.get<GLenum>();
+        GLintptr offset = r.get<GLintptr>();
+        GLsizeiptr size = 0;
+        const void* data = r.getData(size);
+        glBufferSubData(target, offset, size, data);
+        break;
+    }
+    case CaptureOp::BufferUpdate:
+    {
+        GLuint buffer = getName(m_buffers, r.get<GLuint>());
+        GLintptr offset = r.get<GLintptr>();
+        GLsizeiptr size = 0;
+        const void* data = r.getData(size);
+
+        // The replay doesn't map buffers, the memory is uploaded instead
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_copyWriteBuffer);
+        break;
+    }
+    case CaptureOp::Clear:
+    {
+        GLbitfield mask = r.get<GLbitfield>();
+        glClear(mask);
+        break;
+    }
+    case CaptureOp::ClearColor:
+    {
+        GLfloat red = r.get<GLfloat>();
+        GLfloat green = r.get<GLfloat>();
+        GLfloat blue = r.get<GLfloat>();
+        GLfloat alpha = r.get<GLfloat>();
+        glClearColor(red, green, blue, alpha);
+        break;
+    }
+    case CaptureOp::ColorMask:
+    {
+        GLboolean red = r.get<GLboolean>();
+        GLboolean green = r.get<GLboolean>();
+        GLboolean blue = r.get<GLboolean>();
+        GLboolean alpha = r.get<GLboolean>();
+        glColorMask(red, green, blue, alpha);
+        break;
+    }
+    case CaptureOp::CompileShader:
+    {
+        GLuint shader = getName(m_shaders, r.get<GLuint>());
+        glCompileShader(shader);
+        break;
+    }
+    case CaptureOp::CompressedTexImage2D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLint level = r.get<GLint>();
+        GLenum internalformat = r.get<GLenum>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        GLint border = r.get<GLint>();
+        GLsizei imageSize = r.get<GLsizei>();
+        const void* data = r.getPixels();
+        glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+        break;
+    }
+    case CaptureOp::CopyBufferSubData:
+    {
+        GLenum readTarget = r.get<GLenum>();
+        GLenum writeTarget = r.get<GLenum>();
+        GLintptr readOffset = r.get<GLintptr>();
+        GLintptr writeOffset = r.get<GLintptr>();
+        GLsizeiptr size = r.get<GLsizeiptr>();
+        glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+        break;
+    }
+    case CaptureOp::CopyImageSubData:
+    {
+        GLuint srcName = getName(m_textures, r.get<GLuint>());
+        GLenum srcTarget = r.get<GLenum>();
+        GLint srcLevel = r.get<GLint>();
+        GLint srcX = r.get<GLint>();
+        GLint srcY = r.get<GLint>();
+        GLint srcZ = r.get<GLint>();
+        GLuint dstName = getName(m_textures, r.get<GLuint>());
+        GLenum dstTarget = r.get<GLenum>();
+        GLint dstLevel = r.get<GLint>();
+        GLint dstX = r.get<GLint>();
+        GLint dstY = r.get<GLint>();
+        GLint dstZ = r.get<GLint>();
+        GLsizei srcWidth = r.get<GLsizei>();
+        GLsizei srcHeight = r.get<GLsizei>();
+        GLsizei srcDepth = r.get<GLsizei>();
+        glCopyImageSubData(srcName, srcTarget, srcLevel, srcX, srcY, srcZ, dstName, dstTarget, dstLevel, dstX, dstY, dstZ, srcWidth, srcHeight, srcDepth);
+        break;
+    }
+    case CaptureOp::CreateProgram:
+    {
+        GLuint program = r.get<GLuint>();
+
+        // A looped frame creates it's objects again
+        auto it = m_programs.find(program);
+        if (it != m_programs.end())
+        {
+            glDeleteProgram(it->second);
+        }
+
+        m_programs[program] = glCreateProgram();
+        break;
+    }
+    case CaptureOp::CreateShader:
+    {
+        GLenum type = r.get<GLenum>();
+        GLuint shader = r.get<GLuint>();
+
+        auto it = m_shaders.find(shader);
+        if (it != m_shaders.end())
+        {
+            glDeleteShader(it->second);
+        }
+
+        m_shaders[shader] = glCreateShader(type);
+        break;
+    }
+    case CaptureOp::DeleteBuffers:
+        remove(m_buffers, r, glDeleteBuffers);
+        break;
+    case CaptureOp::DeleteFramebuffers:
+        remove(m_framebuffers, r, glDeleteFramebuffers);
+        break;
+    case CaptureOp::DeleteProgram:
+    {
+        auto it = m_programs.find(r.get<GLuint>());
+        if (it != m_programs.end())
+        {
+            glDeleteProgram(it->second);
+            m_programs.erase(it);
+        }
+        break;
+    }
+    case CaptureOp::DeleteShader:
+    {
+        auto it = m_shaders.find(r.get<GLuint>());
+        if (it != m_shaders.end())
+        {
+            glDeleteShader(it->second);
+            m_shaders.erase(it);
+        }
+        break;
+    }
+    case CaptureOp::DeleteTextures:
+        remove(m_textures, r, glDeleteTextures);
+        break;
+    case CaptureOp::DeleteVertexArrays:
+        remove(m_vertexArrays, r, glDeleteVertexArrays);
+        break;
+    case CaptureOp::DepthFunc:
+    {
+        GLenum func = r.get<GLenum>();
+        glDepthFunc(func);
+        break;
+    }
+    case CaptureOp::DepthMask:
+    {
+        GLboolean flag = r.get<GLboolean>();
+        glDepthMask(flag);
+        break;
+    }
+    case CaptureOp::Disable:
+    {
+        GLenum cap = r.get<GLenum>();
+        glDisable(cap);
+        break;
+    }
+    case CaptureOp::DisableVertexAttribArray:
+    {
+        GLuint index = r.get<GLuint>();
+        glDisableVertexAttribArray(index);
+        break;
+    }
+    case CaptureOp::DispatchCompute:
+    {
+        GLuint num_groups_x = r.get<GLuint>();
+        GLuint num_groups_y = r.get<GLuint>();
+        GLuint num_groups_z = r.get<GLuint>();
+        glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+        break;
+    }
+    case CaptureOp::DrawArrays:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLint first = r.get<GLint>();
+        GLsizei count = r.get<GLsizei>();
+        glDrawArrays(mode, first, count);
+        break;
+    }
+    case CaptureOp::DrawArraysIndirect:
+    {
+        GLenum mode = r.get<GLenum>();
+        const void* indirect = (const void*)r.get<GLintptr>();
+        glDrawArraysIndirect(mode, indirect);
+        break;
+    }
+    case CaptureOp::DrawArraysInstanced:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLint first = r.get<GLint>();
+        GLsizei count = r.get<GLsizei>();
+        GLsizei instancecount = r.get<GLsizei>();
+        glDrawArraysInstanced(mode, first, count, instancecount);
+        break;
+    }
+    case CaptureOp::DrawArraysInstancedBaseInstance:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLint first = r.get<GLint>();
+        GLsizei count = r.get<GLsizei>();
+        GLsizei instancecount = r.get<GLsizei>();
+        GLuint baseinstance = r.get<GLuint>();
+        glDrawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
+        break;
+    }
+    case CaptureOp::DrawElements:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLsizei count = r.get<GLsizei>();
+        GLenum type = r.get<GLenum>();
+        const void* indices = (const void*)r.get<GLintptr>();
+        glDrawElements(mode, count, type, indices);
+        break;
+    }
+    case CaptureOp::DrawElementsIndirect:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLenum type = r.get<GLenum>();
+        const void* indirect = (const void*)r.get<GLintptr>();
+        glDrawElementsIndirect(mode, type, indirect);
+        break;
+    }
+    case CaptureOp::DrawElementsInstanced:
+    {
+        GLenum mode = r.get<GLenum>();
+        GLsizei count = r.get<GLsizei>();
+        GLenum type = r.get<GLenum>();
+        const void* indices = (const void*)r.get<GLintptr>();
+        GLsizei instancecount = r.get<GLsizei>();
+        glDrawElementsInstanced(mode, count, type, indices, instancecount);
+        break;
+    }
+    case CaptureOp::Enable:
+    {
+        GLenum cap = r.get<GLenum>();
+        glEnable(cap);
+        break;
+    }
+    case CaptureOp::EnableVertexAttribArray:
+    {
+        GLuint index = r.get<GLuint>();
+        glEnableVertexAttribArray(index);
+        break;
+    }
+    case CaptureOp::FramebufferTexture2D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLenum attachment = r.get<GLenum>();
+        GLenum textarget = r.get<GLenum>();
+        GLuint texture = getName(m_textures, r.get<GLuint>());
+        GLint level = r.get<GLint>();
+        glFramebufferTexture2D(target, attachment, textarget, texture, level);
+        break;
+    }
+    case CaptureOp::GenBuffers:
+        generate(m_buffers, r, glGenBuffers, glDeleteBuffers);
+        break;
+    case CaptureOp::GenerateMipmap:
+    {
+        GLenum target = r.get<GLenum>();
+        glGenerateMipmap(target);
+        break;
+    }
+    case CaptureOp::GenFramebuffers:
+        generate(m_framebuffers, r, glGenFramebuffers, glDeleteFramebuffers);
+        break;
+    case CaptureOp::GenTextures:
+        generate(m_textures, r, glGenTextures, glDeleteTextures);
+        break;
+    case CaptureOp::GenVertexArrays:
+        generate(m_vertexArrays, r, glGenVertexArrays, glDeleteVertexArrays);
+        break;
+    case CaptureOp::LinkProgram:
+    {
+        GLuint program = getName(m_programs, r.get<GLuint>());
+        glLinkProgram(program);
+        break;
+    }
+    case CaptureOp::MultiDrawArraysIndirect:
+    {
+        GLenum mode = r.get<GLenum>();
+        const void* indirect = (const void*)r.get<GLintptr>();
+        GLsizei drawcount = r.get<GLsizei>();
+        GLsizei stride = r.get<GLsizei>();
+        glMultiDrawArraysIndirect(mode, indirect, drawcount, stride);
+        break;
+    }
+    case CaptureOp::PixelStorei:
+    {
+        GLenum pname = r.get<GLenum>();
+        GLint param = r.get<GLint>();
+        glPixelStorei(pname, param);
+        break;
+    }
+    case CaptureOp::PolygonMode:
+    {
+        GLenum face = r.get<GLenum>();
+        GLenum mode = r.get<GLenum>();
+        glPolygonMode(face, mode);
+        break;
+    }
+    case CaptureOp::ProgramBinary:
+    {
+        GLuint program = getName(m_programs, r.get<GLuint>());
+        GLenum binaryFormat = r.get<GLenum>();
+        GLsizeiptr length = 0;
+        const void* binary = r.getData(length);
+        glProgramBinary(program, binaryFormat, binary, (GLsizei)length);
+        break;
+    }
+    case CaptureOp::ProgramParameteri:
+    {
+        GLuint program = getName(m_programs, r.get<GLuint>());
+        GLenum pname = r.get<GLenum>();
+        GLint value = r.get<GLint>();
+        glProgramParameteri(program, pname, value);
+        break;
+    }
+    case CaptureOp::ShaderSource:
+    {
+        GLuint shader = getName(m_shaders, r.get<GLuint>());
+        GLsizeiptr size = 0;
+        const GLchar* source = static_cast<const GLchar*>(r.getData(size));
+        GLint length = (GLint)size;
+        glShaderSource(shader, 1, &source, &length);
+        break;
+    }
+    case CaptureOp::TexImage2D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLint level = r.get<GLint>();
+        GLint internalformat = r.get<GLint>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        GLint border = r.get<GLint>();
+        GLenum format = r.get<GLenum>();
+        GLenum type = r.get<GLenum>();
+        const void* pixels = r.getPixels();
+        glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        break;
+    }
+    case CaptureOp::TexParameteri:
+    {
+        GLenum target = r.get<GLenum>();
+        GLenum pname = r.get<GLenum>();
+        GLint param = r.get<GLint>();
+        glTexParameteri(target, pname, param);
+        break;
+    }
+    case CaptureOp::TexStorage2D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLsizei levels = r.get<GLsizei>();
+        GLenum internalformat = r.get<GLenum>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        glTexStorage2D(target, levels, internalformat, width, height);
+        break;
+    }
+    case CaptureOp::TexStorage3D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLsizei levels = r.get<GLsizei>();
+        GLenum internalformat = r.get<GLenum>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        GLsizei depth = r.get<GLsizei>();
+        glTexStorage3D(target, levels, internalformat, width, height, depth);
+        break;
+    }
+    case CaptureOp::TexSubImage2D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLint level = r.get<GLint>();
+        GLint xoffset = r.get<GLint>();
+        GLint yoffset = r.get<GLint>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        GLenum format = r.get<GLenum>();
+        GLenum type = r.get<GLenum>();
+        const void* pixels = r.getPixels();
+        glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+        break;
+    }
+    case CaptureOp::TexSubImage3D:
+    {
+        GLenum target = r.get<GLenum>();
+        GLint level = r.get<GLint>();
+        GLint xoffset = r.get<GLint>();
+        GLint yoffset = r.get<GLint>();
+        GLint zoffset = r.get<GLint>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        GLsizei depth = r.get<GLsizei>();
+        GLenum format = r.get<GLenum>();
+        GLenum type = r.get<GLenum>();
+        const void* pixels = r.getPixels();
+        glTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+        break;
+    }
+    case CaptureOp::Uniform1i:
+    {
+        GLint location = r.get<GLint>();
+        GLint v0 = r.get<GLint>();
+        glUniform1i(location, v0);
+        break;
+    }
+    case CaptureOp::Uniform4fv:
+    {
+        GLint location = r.get<GLint>();
+        GLsizei count = r.get<GLsizei>();
+        GLsizeiptr size = 0;
+        const GLfloat* value = static_cast<const GLfloat*>(r.getData(size));
+        glUniform4fv(location, count, value);
+        break;
+    }
+    case CaptureOp::UniformMatrix4fv:
+    {
+        GLint location = r.get<GLint>();
+        GLsizei count = r.get<GLsizei>();
+        GLboolean transpose = r.get<GLboolean>();
+        GLsizeiptr size = 0;
+        const GLfloat* value = static_cast<const GLfloat*>(r.getData(size));
+        glUniformMatrix4fv(location, count, transpose, value);
+        break;
+    }
+    case CaptureOp::UseProgram:
+    {
+        GLuint program = getName(m_programs, r.get<GLuint>());
+        glUseProgram(program);
+        break;
+    }
+    case CaptureOp::VertexAttribDivisor:
+    {
+        GLuint index = r.get<GLuint>();
+        GLuint divisor = r.get<GLuint>();
+        glVertexAttribDivisor(index, divisor);
+        break;
+    }
+    case CaptureOp::VertexAttribPointer:
+    {
+        GLuint index = r.get<GLuint>();
+        GLint size = r.get<GLint>();
+        GLenum type = r.get<GLenum>();
+        GLboolean normalized = r.get<GLboolean>();
+        GLsizei stride = r.get<GLsizei>();
+        const void* pointer = (const void*)r.get<GLintptr>();
+        glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        break;
+    }
+    case CaptureOp::Viewport:
+    {
+        GLint x = r.get<GLint>();
+        GLint y = r.get<GLint>();
+        GLsizei width = r.get<GLsizei>();
+        GLsizei height = r.get<GLsizei>();
+        glViewport(x, y, width, height);
+        break;
+    }
+    default:
+        break;
+    }
+}
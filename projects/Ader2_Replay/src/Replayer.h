@@ -0,0 +1,128 @@
+#pragma once
+
+// Capture file
+#include <string>
+#include <vector>
+
+// Captured names to replayed names
+#include <unordered_map>
+
+// OpenGL includes
+#include <glad/glad.h>
+
+// Layout of the capture file
+#include "OpenGLModules/CaptureFormat.h"
+
+
+/**
+ * Replayer executes the calls of a capture file written by GLCapture. The file
+ * is read into memory and the start of each frame is found when it's loaded,
+ * so a frame can be replayed any amount of times without parsing the file
+ * again. Object names are created when the captured generate and create calls
+ * are replayed and every name argument is translated to the created one.
+ *
+ * The setup creates the resources and the state of the first captured frame
+ * and must be replayed once before the frames. Frames can be replayed in a
+ * loop, objects a frame creates again replace the ones created by the
+ * previous replay of the frame. Must be used on the thread owning the context.
+ */
+class Replayer
+{
+public:
+    /**
+     * Reads a capture file
+     *
+     * @param path Path to the capture file
+     * @return True if the file was read and it's records are complete
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Returns the header of the loaded file
+     */
+    const CaptureHeader& getHeader() const;
+
+    /**
+     * Returns the amount of captured frames
+     */
+    size_t getFrameCount() const;
+
+    /**
+     * Replays the calls before the captured frames
+     */
+    void setup();
+
+    /**
+     * Replays the calls of a captured frame
+     */
+    void frame(size_t index);
+private:
+    /**
+     * Reads the arguments of a record
+     */
+    struct Reader
+    {
+        const unsigned char* pData = nullptr;
+
+        /**
+         * Reads an argument
+         */
+        template<typename T>
+        T get();
+
+        /**
+         * Reads client memory, returns nullptr if it's empty
+         */
+        const void* getData(GLsizeiptr& size);
+
+        /**
+         * Reads the pixels of a texture upload, either an offset into the bound
+         * pixel unpack buffer or the client memory
+         */
+        const void* getPixels();
+    };
+private:
+    /**
+     * Replays the records in the range
+     */
+    void execute(size_t begin, size_t end);
+
+    /**
+     * Replays a record
+     */
+    void execute(CaptureOp op, Reader& r);
+
+    /**
+     * Returns the replayed name of a captured name, 0 stays 0
+     */
+    GLuint getName(const std::unordered_map<GLuint, GLuint>& names, GLuint name) const;
+
+    /**
+     * Creates a name for each captured one of a generate call
+     */
+    void generate(std::unordered_map<GLuint, GLuint>& names, Reader& r, PFNGLGENBUFFERSPROC pGenerate, PFNGLDELETEBUFFERSPROC pDelete);
+
+    /**
+     * Deletes the names of a delete call
+     */
+    void remove(std::unordered_map<GLuint, GLuint>& names, Reader& r, PFNGLDELETEBUFFERSPROC pDelete);
+private:
+    /// Header and records of the file
+    CaptureHeader m_header;
+    std::vector<unsigned char> m_data;
+
+    /// Offsets of the records starting each frame followed by the end of the
+    /// last frame, the setup ends with the first frame
+    std::vector<size_t> m_frames;
+
+    /// Captured names to replayed names by object type
+    std::unordered_map<GLuint, GLuint> m_buffers;
+    std::unordered_map<GLuint, GLuint> m_textures;
+    std::unordered_map<GLuint, GLuint> m_vertexArrays;
+    std::unordered_map<GLuint, GLuint> m_framebuffers;
+    std::unordered_map<GLuint, GLuint> m_programs;
+    std::unordered_map<GLuint, GLuint> m_shaders;
+
+    /// Mapped memory is written through the copy write binding, which is restored after
+    GLuint m_copyWriteBuffer = 0;
+};
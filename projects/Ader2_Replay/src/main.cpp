@@ -0,0 +1,169 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// OpenGL includes
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Captured calls
+#include "Replayer.h"
+
+/**
+ * Replays the frames of a capture file written with --capture as fast as possible
+ * and reports the CPU and GPU time of the frames. The frames are replayed in a
+ * loop, --vsync waits for the display between frames.
+ *
+ * Usage: <capture file> [loops] [--vsync]
+ */
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: <capture file> [loops] [--vsync]" << std::endl;
+		return 1;
+	}
+
+	size_t loops = 100;
+	bool vsync = false;
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--vsync")
+		{
+			vsync = true;
+		}
+		else
+		{
+			loops = std::max<size_t>(std::stoul(arg), 1);
+		}
+	}
+
+	Replayer replayer;
+	if (!replayer.load(argv[1]))
+	{
+		return 1;
+	}
+
+	const CaptureHeader& header = replayer.getHeader();
+
+	// Same context version and window size as the engine
+	if (!glfwInit())
+	{
+		std::cout << "Failed to initialize GLFW" << std::endl;
+		return 1;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+	GLFWwindow* pWindow = glfwCreateWindow(std::max(header.Width, 1), std::max(header.Height, 1), "Ader2 replay", nullptr, nullptr);
+	if (pWindow == nullptr)
+	{
+		std::cout << "Failed to create a window" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(pWindow);
+	glfwSwapInterval(vsync ? 1 : 0);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize Glad" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+
+	std::cout << argv[1] << ": " << replayer.getFrameCount() << " frames, " << header.Width << "x" << header.Height
+		<< ", " << glGetString(GL_RENDERER) << std::endl;
+
+	// Resources and state of the first frame
+	auto setupStart = std::chrono::high_resolution_clock::now();
+	replayer.setup();
+	glFinish();
+	double setupTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count();
+
+	if (GLenum error = glGetError())
+	{
+		std::cout << "OpenGL error " << error << " during the setup" << std::endl;
+	}
+
+	// GPU time of each frame, results are read a few frames later so the replay doesn't wait
+	constexpr size_t queryCount = 4;
+	GLuint queries[queryCount];
+	glGenQueries(queryCount, queries);
+
+	std::vector<double> cpuTimes;
+	std::vector<double> gpuTimes;
+	size_t errors = 0;
+
+	size_t frames = replayer.getFrameCount() * loops;
+	for (size_t i = 0; i < frames && !glfwWindowShouldClose(pWindow); i++)
+	{
+		if (i >= queryCount)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(queries[i % queryCount], GL_QUERY_RESULT, &elapsed);
+			gpuTimes.push_back(elapsed / 1000000.0);
+		}
+
+		auto frameStart = std::chrono::high_resolution_clock::now();
+
+		glBeginQuery(GL_TIME_ELAPSED, queries[i % queryCount]);
+		replayer.frame(i % replayer.getFrameCount());
+		glEndQuery(GL_TIME_ELAPSED);
+
+		glfwSwapBuffers(pWindow);
+		glfwPollEvents();
+
+		cpuTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+
+		// Errors are only checked in the first loop, glGetError waits for the driver
+		if (i < replayer.getFrameCount())
+		{
+			while (glGetError() != GL_NO_ERROR)
+			{
+				errors++;
+			}
+		}
+	}
+
+	glFinish();
+	glDeleteQueries(queryCount, queries);
+
+	// Frame times sorted for the median and the 99th percentile
+	auto report = [](const char* name, std::vector<double> times)
+	{
+		if (times.empty())
+		{
+			return;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		double total = 0.0;
+		for (double time : times)
+		{
+			total += time;
+		}
+
+		std::cout << name << ": " << total / times.size() << " ms average, "
+			<< times[times.size() / 2] << " ms median, "
+			<< times[std::min(times.size() - 1, times.size() * 99 / 100)] << " ms 99th percentile, "
+			<< times.front() << " ms min, " << times.back() << " ms max" << std::endl;
+	};
+
+	std::cout << "Setup: " << setupTime << " ms, replayed " << cpuTimes.size() << " frames, " << errors << " OpenGL errors" << std::endl;
+	report("Frame time", cpuTimes);
+	report("GPU time", gpuTimes);
+
+	glfwDestroyWindow(pWindow);
+	glfwTerminate();
+
+	return errors == 0 ? 0 : 1;
+}
@@ -66,6 +66,31 @@ namespace Ader2.Core
             return asset;
         }
 
+        /// <summary>
+        /// Creates a texture atlas and packs the images into it
+        /// </summary>
+        /// <param name="Name">Name of the atlas</param>
+        /// <param name="MaxSize">Maximum width and height of a page</param>
+        /// <param name="Padding">Pixels around each image</param>
+        /// <param name="Sources">Image files to pack</param>
+        /// <returns>Packed atlas</returns>
+        public static TextureAtlas PackAtlas(string Name, int MaxSize, int Padding, params string[] Sources)
+        {
+            // Create the atlas
+            TextureAtlas atlas = New<TextureAtlas>(Name);
+
+            // Pack the images
+            foreach (string source in Sources)
+            {
+                atlas.Add(source);
+            }
+
+            atlas.Build(MaxSize, Padding);
+
+            // Return the atlas
+            return atlas;
+        }
+
         /// <summary>
         /// Check if the specified asset exists
         /// </summary>
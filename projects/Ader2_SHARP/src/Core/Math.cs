@@ -35,4 +35,24 @@ namespace Ader2.Core
             Z = aZ;
         }
     }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct Vector4
+    {
+        public float X;
+        public float Y;
+        public float Z;
+        public float W;
+
+        /// <summary>
+        /// Construct empty Vector4
+        /// </summary>
+        public Vector4(float aX, float aY, float aZ, float aW)
+        {
+            X = aX;
+            Y = aY;
+            Z = aZ;
+            W = aW;
+        }
+    }
 }
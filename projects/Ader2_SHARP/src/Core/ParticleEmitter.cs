@@ -0,0 +1,234 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Ader2.Core
+{
+    /// <summary>
+    /// Settings of a particle emitter, the layout matches the native settings
+    /// so they are passed without conversion
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct ParticleEmitterSettings
+    {
+        /// <summary>
+        /// Position particles are spawned at
+        /// </summary>
+        public Vector3 Position;
+
+        /// <summary>
+        /// Particles are spawned up to this far from the position on each axis
+        /// </summary>
+        public Vector3 PositionSpread;
+
+        /// <summary>
+        /// Velocity of spawned particles
+        /// </summary>
+        public Vector3 Velocity;
+
+        /// <summary>
+        /// Velocity of spawned particles varies up to this much on each axis
+        /// </summary>
+        public Vector3 VelocitySpread;
+
+        /// <summary>
+        /// Acceleration applied to every particle
+        /// </summary>
+        public Vector3 Gravity;
+
+        /// <summary>
+        /// Fraction of the velocity lost each second
+        /// </summary>
+        public float Drag;
+
+        /// <summary>
+        /// Particles spawned per second
+        /// </summary>
+        public float Rate;
+
+        /// <summary>
+        /// Most particles alive at once
+        /// </summary>
+        public int MaxParticles;
+
+        /// <summary>
+        /// Seconds a particle lives, picked between the minimum and the maximum
+        /// </summary>
+        public float MinLifetime;
+        public float MaxLifetime;
+
+        /// <summary>
+        /// Atlas cells the particles animate through, counted row by row from
+        /// the top left cell of the visual
+        /// </summary>
+        public int FrameCount;
+
+        /// <summary>
+        /// Frames per second of the animation, 0 plays the frames once over the lifetime
+        /// </summary>
+        public float FrameRate;
+
+        /// <summary>
+        /// Construct settings spawning the specified amount of particles per second
+        /// </summary>
+        public ParticleEmitterSettings(float rate, int maxParticles, float lifetime)
+        {
+            Position = new Vector3(0, 0, 0);
+            PositionSpread = new Vector3(0, 0, 0);
+            Velocity = new Vector3(0, 1, 0);
+            VelocitySpread = new Vector3(0, 0, 0);
+            Gravity = new Vector3(0, 0, 0);
+            Drag = 0.0f;
+            Rate = rate;
+            MaxParticles = maxParticles;
+            MinLifetime = lifetime;
+            MaxLifetime = lifetime;
+            FrameCount = 1;
+            FrameRate = 0.0f;
+        }
+    }
+
+    /// <summary>
+    /// Particle emitter spawns and simulates particles natively, an effect is
+    /// configured once instead of being driven by a game object per particle.
+    /// Particles are drawn with the VAO, shader, textures and atlas size of the
+    /// emitter visual and only simulated once the emitter is added to a scene
+    /// </summary>
+    public class ParticleEmitter : AderAsset
+    {
+        // Creates new ParticleEmitter
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static IntPtr __new(IntPtr manager, string name);
+
+        // Replaces the settings of the emitter
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __configure(IntPtr instance, ref ParticleEmitterSettings settings);
+
+        // Sets the visual the particles are drawn with
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setVisual(IntPtr instance, IntPtr visual);
+
+        // Sets the color over the lifetime of a particle
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setColorCurve(IntPtr instance, float[] times, Vector4[] colors);
+
+        // Sets the scale over the lifetime of a particle
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setSizeCurve(IntPtr instance, float[] times, float[] sizes);
+
+        // Gets the position of the emitter
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __getPosition(IntPtr instance, out Vector3 value);
+
+        // Sets the position of the emitter
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setPosition(IntPtr instance, ref Vector3 value);
+
+        // Returns true if the emitter spawns particles
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __getEmitting(IntPtr instance, out bool value);
+
+        // Starts or stops spawning particles
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setEmitting(IntPtr instance, ref bool value);
+
+        public ParticleEmitter()
+        {
+        }
+
+        public ParticleEmitter(IntPtr instance)
+        {
+            InstantiateFromPtr(instance);
+        }
+
+        /// <summary>
+        /// Replaces the settings of the emitter, living particles keep their state
+        /// </summary>
+        /// <param name="Settings">New settings</param>
+        public void Configure(ParticleEmitterSettings Settings)
+        {
+            __configure(_CInstance, ref Settings);
+        }
+
+        /// <summary>
+        /// Visual the particles are drawn with
+        /// </summary>
+        public Visual Visual
+        {
+            set
+            {
+                __setVisual(_CInstance, value.GetCInstance());
+            }
+        }
+
+        /// <summary>
+        /// Sets the color over the lifetime of a particle, colors are interpolated
+        /// between the keys. Particles are white without a curve
+        /// </summary>
+        /// <param name="Times">Ages of the keys between 0 and 1 in increasing order</param>
+        /// <param name="Colors">Color of each key</param>
+        public void SetColorCurve(float[] Times, Vector4[] Colors)
+        {
+            __setColorCurve(_CInstance, Times, Colors);
+        }
+
+        /// <summary>
+        /// Sets the scale over the lifetime of a particle, scales are interpolated
+        /// between the keys. Particles have a scale of 1 without a curve
+        /// </summary>
+        /// <param name="Times">Ages of the keys between 0 and 1 in increasing order</param>
+        /// <param name="Sizes">Scale of each key</param>
+        public void SetSizeCurve(float[] Times, float[] Sizes)
+        {
+            __setSizeCurve(_CInstance, Times, Sizes);
+        }
+
+        /// <summary>
+        /// Position particles are spawned at, moving the emitter doesn't move
+        /// particles that were already spawned
+        /// </summary>
+        public Vector3 Position
+        {
+            get
+            {
+                Vector3 value;
+                __getPosition(_CInstance, out value);
+                return value;
+            }
+
+            set
+            {
+                __setPosition(_CInstance, ref value);
+            }
+        }
+
+        /// <summary>
+        /// True while the emitter spawns particles, living particles are simulated
+        /// until they die either way
+        /// </summary>
+        public bool Emitting
+        {
+            get
+            {
+                bool value;
+                __getEmitting(_CInstance, out value);
+                return value;
+            }
+
+            set
+            {
+                __setEmitting(_CInstance, ref value);
+            }
+        }
+
+        protected internal override void InstantiateNew(IntPtr manager, string name)
+        {
+            _CInstance = __new(manager, name);
+        }
+
+        protected internal override void InstantiateFromPtr(IntPtr ptr)
+        {
+            _CInstance = ptr;
+        }
+    }
+}
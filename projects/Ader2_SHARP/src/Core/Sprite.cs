@@ -0,0 +1,108 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Ader2.Core
+{
+    /// <summary>
+    /// Instance data of a single sprite drawn by the SpriteBatch, the layout
+    /// matches the native sprite so arrays are submitted without conversion
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct Sprite
+    {
+        /// <summary>
+        /// Center of the sprite in window coordinates
+        /// </summary>
+        public Vector2 Position;
+
+        /// <summary>
+        /// Width and height of the sprite
+        /// </summary>
+        public Vector2 Size;
+
+        /// <summary>
+        /// Texture coordinate offset in xy and scale in zw, the same as the
+        /// rectangles returned by TextureAtlas.GetRegion
+        /// </summary>
+        public Vector4 TexRect;
+
+        /// <summary>
+        /// Counter clockwise rotation around the center in radians
+        /// </summary>
+        public float Rotation;
+
+        /// <summary>
+        /// Draw order, sprites of higher layers are drawn over lower ones
+        /// </summary>
+        public float Layer;
+
+        /// <summary>
+        /// Color the texture is multiplied with, packed with PackColor
+        /// </summary>
+        public uint Color;
+
+        /// <summary>
+        /// Packed white, the texture is drawn unchanged
+        /// </summary>
+        public const uint White = 0xFFFFFFFF;
+
+        /// <summary>
+        /// Construct a white sprite showing the whole texture
+        /// </summary>
+        public Sprite(Vector2 position, Vector2 size)
+        {
+            Position = position;
+            Size = size;
+            TexRect = new Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+            Rotation = 0.0f;
+            Layer = 0.0f;
+            Color = White;
+        }
+
+        /// <summary>
+        /// Packs a color with components in the range of 0 to 1 into the Color field
+        /// </summary>
+        public static uint PackColor(Vector4 color)
+        {
+            uint r = (uint)(Math.Min(Math.Max(color.X, 0.0f), 1.0f) * 255.0f + 0.5f);
+            uint g = (uint)(Math.Min(Math.Max(color.Y, 0.0f), 1.0f) * 255.0f + 0.5f);
+            uint b = (uint)(Math.Min(Math.Max(color.Z, 0.0f), 1.0f) * 255.0f + 0.5f);
+            uint a = (uint)(Math.Min(Math.Max(color.W, 0.0f), 1.0f) * 255.0f + 0.5f);
+            return r | (g << 8) | (b << 16) | (a << 24);
+        }
+    }
+
+    /// <summary>
+    /// Draws sprites without creating a game object for each of them. Sprites
+    /// are submitted every frame in bulk and drawn over the scene, consecutive
+    /// sprites with the same texture and shader are drawn together
+    /// </summary>
+    public static class SpriteBatch
+    {
+        // Submits the first count sprites of the array
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __submit(IntPtr texture, IntPtr shader, Sprite[] sprites, int count);
+
+        /// <summary>
+        /// Submits sprites for the current frame, the sprites are copied so the
+        /// array can be changed right after the call
+        /// </summary>
+        /// <param name="texture">Texture the sprites are sampled from</param>
+        /// <param name="shader">Shader the sprites are drawn with, e.g. res/vertex_sprite.txt</param>
+        /// <param name="sprites">Sprites to draw</param>
+        /// <param name="count">Number of sprites from the start of the array</param>
+        public static void Submit(Texture texture, Shader shader, Sprite[] sprites, int count)
+        {
+            __submit(texture.GetCInstance(), shader.GetCInstance(), sprites, count);
+        }
+
+        /// <summary>
+        /// Submits every sprite of the array for the current frame
+        /// </summary>
+        public static void Submit(Texture texture, Shader shader, Sprite[] sprites)
+        {
+            __submit(texture.GetCInstance(), shader.GetCInstance(), sprites, sprites.Length);
+        }
+    }
+}
@@ -45,6 +45,24 @@ namespace Ader2.Core
             }
         }
 
+        /// <summary>
+        /// Color of this text slot, white by default
+        /// </summary>
+        public Vector4 Color
+        {
+            get
+            {
+                Vector4 value;
+                __getColor(_CInstance, out value);
+                return value;
+            }
+
+            set
+            {
+                __setColor(_CInstance, ref value);
+            }
+        }
+
         /// <summary>
         /// Visibility of this text slot
         /// </summary>
@@ -64,6 +82,17 @@ namespace Ader2.Core
         }
 
 
+        /// <summary>
+        /// Sets the content to a number without creating a string, meant for
+        /// labels that change every frame like frame counters
+        /// </summary>
+        /// <param name="value">Number to show</param>
+        /// <param name="decimals">Digits after the decimal point</param>
+        public void SetNumber(double value, int decimals = 0)
+        {
+            __setNumber(_CInstance, value, decimals);
+        }
+
         private TextSlot() { }
         internal TextSlot(IntPtr instance)
         {
@@ -78,6 +107,10 @@ namespace Ader2.Core
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __setContent(IntPtr instance, string value);
 
+        // Sets the contents of this object to a formatted number
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setNumber(IntPtr instance, double value, int decimals);
+
         // Gets the position of this object
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static string __getPosition(IntPtr instance, out Vector2 value);
@@ -86,6 +119,14 @@ namespace Ader2.Core
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __setPosition(IntPtr instance, ref Vector2 value);
 
+        // Gets the color of this object
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __getColor(IntPtr instance, out Vector4 value);
+
+        // Sets the color of this object
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setColor(IntPtr instance, ref Vector4 value);
+
         // Gets the visibility of this object
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static string __getVisible(IntPtr instance, out bool value);
@@ -103,6 +144,17 @@ namespace Ader2.Core
         /// </summary>
         public string Source { get; set; }
 
+        /// <summary>
+        /// Font size in points, glyphs are rasterized at this size when first used
+        /// </summary>
+        public uint Size { get; set; } = 32;
+
+        /// <summary>
+        /// If true the glyphs are signed distance fields that stay sharp at any size,
+        /// the text must use a distance field shader (res/fragment_text_sdf.txt)
+        /// </summary>
+        public bool DistanceField { get; set; } = false;
+
         /// <summary>
         /// Used to get a specified text slot if it doesn't exist
         /// than a new one will be created
@@ -120,7 +172,7 @@ namespace Ader2.Core
 
         // Loads the text with the specified source
         [MethodImpl(MethodImplOptions.InternalCall)]
-        extern static void __load(IntPtr instance, string source);
+        extern static void __load(IntPtr instance, string source, uint size, bool distanceField);
 
         // Sets the contents of this object
         [MethodImpl(MethodImplOptions.InternalCall)]
@@ -140,11 +192,11 @@ namespace Ader2.Core
         }
 
         /// <summary>
-        /// Loads the texture using the Source property
+        /// Loads the font using the Source, Size and DistanceField properties
         /// </summary>
         public void Load()
         {
-            __load(_CInstance, Source);
+            __load(_CInstance, Source, Size, DistanceField);
         }
 
         /// <summary>
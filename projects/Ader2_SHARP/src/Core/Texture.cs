@@ -18,6 +18,14 @@ namespace Ader2.Core
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __load(IntPtr instance, string source);
 
+        // Starts streaming the texture from the specified path
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __loadAsync(IntPtr instance, string source);
+
+        // Returns true if the texture has been completely loaded
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static bool __isLoaded(IntPtr instance);
+
         public Texture()
         {
         }
@@ -35,6 +43,23 @@ namespace Ader2.Core
             __load(_CInstance, Source);
         }
 
+        /// <summary>
+        /// Starts loading the texture using the Source property without blocking,
+        /// a placeholder is rendered until the texture has been streamed in
+        /// </summary>
+        public void LoadAsync()
+        {
+            __loadAsync(_CInstance, Source);
+        }
+
+        /// <summary>
+        /// True if the texture has been completely loaded
+        /// </summary>
+        public bool IsLoaded
+        {
+            get { return __isLoaded(_CInstance); }
+        }
+
         protected internal override void InstantiateNew(IntPtr manager, string name)
         {
             _CInstance = __new(manager, name);
@@ -0,0 +1,105 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+
+namespace Ader2.Core
+{
+    /// <summary>
+    /// Texture atlas packs many small images into a few textures (pages),
+    /// game objects select their image with the region rectangle
+    /// </summary>
+    public class TextureAtlas : AderAsset
+    {
+        // Creates new TextureAtlas
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static IntPtr __new(IntPtr manager, string name);
+
+        // Adds an image that is packed on the next build
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __addSource(IntPtr instance, string source);
+
+        // Packs the images and returns the amount of packed images
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static int __build(IntPtr instance, int maxSize, int padding);
+
+        // Returns the page of the image and its rectangle
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static IntPtr __getRegion(IntPtr instance, string source, out Vector4 rect);
+
+        // Returns the amount of pages
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static int __getPageCount(IntPtr instance);
+
+        // Returns the page at the specified index
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static IntPtr __getPage(IntPtr instance, int index);
+
+        public TextureAtlas()
+        {
+        }
+
+        public TextureAtlas(IntPtr instance)
+        {
+            InstantiateFromPtr(instance);
+        }
+
+        /// <summary>
+        /// Adds an image file that is packed on the next build
+        /// </summary>
+        public void Add(string source)
+        {
+            __addSource(_CInstance, source);
+        }
+
+        /// <summary>
+        /// Packs all added images, existing pages are replaced
+        /// </summary>
+        /// <param name="maxSize">Maximum width and height of a page</param>
+        /// <param name="padding">Pixels around each image filled with its edges</param>
+        /// <returns>Amount of packed images</returns>
+        public int Build(int maxSize = 2048, int padding = 2)
+        {
+            return __build(_CInstance, maxSize, padding);
+        }
+
+        /// <summary>
+        /// Returns the page that contains the image or null if it wasn't packed,
+        /// the rectangle can be assigned to GameObject.TextureRect
+        /// </summary>
+        public Texture GetRegion(string source, out Vector4 rect)
+        {
+            IntPtr page = __getRegion(_CInstance, source, out rect);
+            if (page == IntPtr.Zero)
+            {
+                return null;
+            }
+
+            return new Texture(page);
+        }
+
+        /// <summary>
+        /// Amount of pages in the atlas
+        /// </summary>
+        public int PageCount
+        {
+            get { return __getPageCount(_CInstance); }
+        }
+
+        /// <summary>
+        /// Returns the page at the specified index
+        /// </summary>
+        public Texture GetPage(int index)
+        {
+            return new Texture(__getPage(_CInstance, index));
+        }
+
+        protected internal override void InstantiateNew(IntPtr manager, string name)
+        {
+            _CInstance = __new(manager, name);
+        }
+
+        protected internal override void InstantiateFromPtr(IntPtr ptr)
+        {
+            _CInstance = ptr;
+        }
+    }
+}
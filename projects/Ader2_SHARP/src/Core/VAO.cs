@@ -21,6 +21,18 @@ namespace Ader2.Core
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __setUV(IntPtr instance, float[] texCoords);
 
+        // Loads a mesh file
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static bool __load(IntPtr instance, string path);
+
+        // Sets interleaved vertex data
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setVertexData(IntPtr instance, float[] data, uint[] layout);
+
+        // Sets interleaved vertex data of packed formats
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setVertexData(IntPtr instance, byte[] data, uint[] layout);
+
         public VAO()
         {
         }
@@ -57,6 +69,40 @@ namespace Ader2.Core
             __setUV(_CInstance, texCoords);
         }
 
+        /// <summary>
+        /// Sets interleaved vertex data stored in a single buffer, replacing the
+        /// vertices and texture coordinates set with SetVertices and SetUV
+        /// </summary>
+        /// <param name="data">Vertices laid out as described by the layout</param>
+        /// <param name="layout">Layout of a single vertex</param>
+        public void SetVertexData(float[] data, VertexLayout layout)
+        {
+            __setVertexData(_CInstance, data, layout.ToArray());
+        }
+
+        /// <summary>
+        /// Sets interleaved vertex data stored in a single buffer, used for layouts
+        /// with half floats, normalized integers or packed normals
+        /// </summary>
+        /// <param name="data">Vertices laid out as described by the layout</param>
+        /// <param name="layout">Layout of a single vertex</param>
+        public void SetVertexData(byte[] data, VertexLayout layout)
+        {
+            __setVertexData(_CInstance, data, layout.ToArray());
+        }
+
+        /// <summary>
+        /// Loads the vertices, texture coordinates, normals and indices of the
+        /// array from a .amesh file, replacing the ones set with the methods above.
+        /// The file is read by the engine so no managed arrays are created
+        /// </summary>
+        /// <param name="path">Path to the mesh file</param>
+        /// <returns>True if the mesh was loaded</returns>
+        public bool Load(string path)
+        {
+            return __load(_CInstance, path);
+        }
+
         protected internal override void InstantiateNew(IntPtr manager, string name)
         {
             _CInstance = __new(manager, name);
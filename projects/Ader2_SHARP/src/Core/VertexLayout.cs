@@ -0,0 +1,87 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace Ader2.Core
+{
+    /// <summary>
+    /// Component types of a vertex attribute
+    /// </summary>
+    public enum VertexAttributeType
+    {
+        Float = 0,
+        HalfFloat,
+        Byte,
+        UnsignedByte,
+        Short,
+        UnsignedShort,
+
+        /// <summary>
+        /// 4 components packed as signed 10, 10, 10 and 2 bits
+        /// </summary>
+        Int2101010,
+    }
+
+    /// <summary>
+    /// Layout of an interleaved vertex, used to describe the data passed to
+    /// VAO.SetVertexData. Location 0 is the position, 1 the texture coordinate
+    /// and 2 the normal
+    /// </summary>
+    public class VertexLayout
+    {
+        // Location, components, type, normalized and offset of every attribute
+        private List<uint> _attributes = new List<uint>();
+
+        /// <summary>
+        /// Size of a single vertex in bytes
+        /// </summary>
+        public uint Stride { get; private set; }
+
+        /// <summary>
+        /// Appends an attribute after the existing ones, attributes are 4 byte aligned
+        /// </summary>
+        /// <param name="location">Shader attribute location</param>
+        /// <param name="components">Number of components, 1 to 4</param>
+        /// <param name="type">Type of the components</param>
+        /// <param name="normalized">If true integer components are normalized to [0, 1] or [-1, 1]</param>
+        /// <returns>This layout</returns>
+        public VertexLayout Add(uint location, uint components, VertexAttributeType type, bool normalized = false)
+        {
+            _attributes.Add(location);
+            _attributes.Add(components);
+            _attributes.Add((uint)type);
+            _attributes.Add(normalized ? 1u : 0u);
+            _attributes.Add(Stride);
+
+            Stride += (GetSize(type, components) + 3) / 4 * 4;
+            return this;
+        }
+
+        /// <summary>
+        /// Returns the stride followed by the attributes
+        /// </summary>
+        internal uint[] ToArray()
+        {
+            uint[] result = new uint[_attributes.Count + 1];
+            result[0] = Stride;
+            _attributes.CopyTo(result, 1);
+            return result;
+        }
+
+        private static uint GetSize(VertexAttributeType type, uint components)
+        {
+            switch (type)
+            {
+                case VertexAttributeType.Float:
+                    return 4 * components;
+                case VertexAttributeType.HalfFloat:
+                case VertexAttributeType.Short:
+                case VertexAttributeType.UnsignedShort:
+                    return 2 * components;
+                case VertexAttributeType.Int2101010:
+                    return 4;
+                default:
+                    return components;
+            }
+        }
+    }
+}
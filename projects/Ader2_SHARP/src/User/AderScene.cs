@@ -63,6 +63,10 @@ namespace Ader2
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __addText(IntPtr scene, IntPtr text);
 
+        // Adds a particle emitter to the scene
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __addEmitter(IntPtr scene, IntPtr emitter);
+
         /// <summary>
         /// Create ader scene object
         /// </summary>
@@ -107,6 +111,16 @@ namespace Ader2
             __addText(_CInstance, text._CInstance);
         }
 
+        /// <summary>
+        /// Add particle emitter to this scene, its particles are simulated
+        /// and drawn while the scene is active
+        /// </summary>
+        /// <param name="emitter">Emitter to add</param>
+        public void AddEmitter(ParticleEmitter emitter)
+        {
+            __addEmitter(_CInstance, emitter._CInstance);
+        }
+
         /// <summary>
         /// Internal use only
         /// Returns the C++ instance of the visual
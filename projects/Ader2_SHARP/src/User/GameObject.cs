@@ -98,6 +98,26 @@ namespace Ader2
             }
         }
 
+        /// <summary>
+        /// Texture rectangle if using a packed atlas, X,Y is the offset
+        /// and Z,W the scale of the texture coordinates. While the scale
+        /// is 0,0 the texture offset is used instead
+        /// </summary>
+        public Vector4 TextureRect
+        {
+            get
+            {
+                Vector4 value;
+                __getTexRect(_CInstance, out value);
+                return value;
+            }
+
+            set
+            {
+                __setTexRect(_CInstance, ref value);
+            }
+        }
+
         // Returns visual of the game object
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static IntPtr __getVisual(IntPtr gObject);
@@ -138,6 +158,14 @@ namespace Ader2
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __setTexOffset(IntPtr gObject, ref Vector2 value);
 
+        // Gets the texture rectangle of the game object
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __getTexRect(IntPtr gObject, out Vector4 value);
+
+        // Sets the texture rectangle of the game object
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setTexRect(IntPtr gObject, ref Vector4 value);
+
 
         public GameObject(IntPtr instance)
         {
@@ -59,6 +59,26 @@ namespace Ader2
             }
         }
 
+        /// <summary>
+        /// True if the visual blends with what is behind it, transparent visuals
+        /// are drawn after opaque ones and don't hide what is behind them.
+        /// Visuals are opaque by default
+        /// </summary>
+        public bool Transparent
+        {
+            get
+            {
+                bool value;
+                __getTransparent(_CInstance, out value);
+                return value;
+            }
+
+            set
+            {
+                __setTransparent(_CInstance, ref value);
+            }
+        }
+
         /// <summary>
         /// Sets the visual texture slot to the specified texture
         /// </summary>
@@ -115,6 +135,14 @@ namespace Ader2
         [MethodImpl(MethodImplOptions.InternalCall)]
         extern static void __setSize(IntPtr visual, ref Vector2 value);
 
+        // Returns true if the visual is transparent
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __getTransparent(IntPtr visual, out bool value);
+
+        // Sets if the visual is transparent
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        extern static void __setTransparent(IntPtr visual, ref bool value);
+
         public Visual()
         {
         }
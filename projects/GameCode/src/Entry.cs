@@ -26,8 +26,16 @@ namespace Scripts
             //shader.VertexSource = "res/vertex_texture_instanced.txt";
             //shader.FragmentSource = "res/fragment_texture_instanced.txt";
             
-            shader.VertexSource = "res/vertex_texture_instanced_atlas.txt";
-            shader.FragmentSource = "res/fragment_texture_instanced_atlas.txt";
+            //shader.VertexSource = "res/vertex_texture_instanced_atlas.txt";
+            //shader.FragmentSource = "res/fragment_texture_instanced_atlas.txt";
+
+            // Visuals that only differ in texture are merged into a single draw
+            //shader.VertexSource = "res/vertex_texture_instanced_atlas_array.txt";
+            //shader.FragmentSource = "res/fragment_texture_instanced_atlas_array.txt";
+
+            // The renderer picks the variant matching the visual
+            shader.VertexSource = "res/vertex_texture_variants.txt";
+            shader.FragmentSource = "res/fragment_texture_variants.txt";
 
             shader.Load();
 
@@ -71,7 +79,9 @@ namespace Scripts
 
             //tex.Source = "res/container.jpg";
             tex.Source = "res/atlas.png";
-            tex.Load();
+
+            // Streams in without blocking, tex.IsLoaded tells when it's done
+            tex.LoadAsync();
 
             vis.SetTexture(0, tex);
 
@@ -131,7 +141,70 @@ namespace Scripts
             testText["testTextSlot0"].Content = "Test text!";
             testText["testTextSlot0"].Position = new Vector2(50, 50);
 
+            testText["fpsLabel"].Content = "FPS:";
+            testText["fpsLabel"].Position = new Vector2(50, 10);
+
+            FPSScript.Slot = testText["fpsValue"];
+            FPSScript.Slot.Position = new Vector2(120, 10);
+
             this.AddUIElement(testText);
+
+            // Distance field text is scaled from one set of glyphs
+            Shader sdfShader = AderAssets.New<Shader>("text_sdf_shader");
+
+            sdfShader.VertexSource = "res/vertex_text.txt";
+            sdfShader.FragmentSource = "res/fragment_text_sdf.txt";
+
+            sdfShader.Load();
+
+            Text titleText = AderAssets.New<Text>("title_text");
+            titleText.Source = "res/arial.ttf";
+            titleText.Size = 72;
+            titleText.DistanceField = true;
+            titleText.Load();
+            titleText.SetShader(sdfShader);
+
+            titleText["title"].Content = "Ader2";
+            titleText["title"].Position = new Vector2(50, 120);
+
+            this.AddUIElement(titleText);
+
+            // Sprites are submitted every frame by the sprite script
+            Shader spriteShader = AderAssets.New<Shader>("sprite_shader");
+
+            spriteShader.VertexSource = "res/vertex_sprite.txt";
+            spriteShader.FragmentSource = "res/fragment_sprite.txt";
+
+            spriteShader.Load();
+
+            SpriteScript.Texture = tex;
+            SpriteScript.Shader = spriteShader;
+
+            // Particles are simulated natively, the visual gives them their look
+            Visual particleVisual = AderAssets.New<Visual>("particle_visual");
+            particleVisual.VAO = vao;
+            particleVisual.Shader = shader;
+            particleVisual.SetTexture(0, tex);
+            particleVisual.Size = new Vector2(3, 3);
+
+            ParticleEmitterSettings settings = new ParticleEmitterSettings(2000, 10000, 2.0f);
+            settings.Position = new Vector3(0, -5, 5);
+            settings.PositionSpread = new Vector3(0.5f, 0, 0);
+            settings.Velocity = new Vector3(0, 10, 0);
+            settings.VelocitySpread = new Vector3(4, 2, 0);
+            settings.Gravity = new Vector3(0, -9.81f, 0);
+            settings.Drag = 0.2f;
+            settings.MinLifetime = 1.5f;
+            settings.FrameCount = 4;
+
+            ParticleEmitter emitter = AderAssets.New<ParticleEmitter>("test_emitter");
+            emitter.Configure(settings);
+            emitter.Visual = particleVisual;
+            emitter.SetColorCurve(new float[] { 0.0f, 1.0f }, new Vector4[] { new Vector4(1, 1, 1, 1), new Vector4(1, 0.5f, 0, 0) });
+            emitter.SetSizeCurve(new float[] { 0.0f, 0.2f, 1.0f }, new float[] { 0.1f, 0.4f, 0.2f });
+
+            this.AddEmitter(emitter);
+            EmitterScript.Emitter = emitter;
         }
     }
 
@@ -155,6 +228,108 @@ namespace Scripts
         }
     }
 
+    class FPSScript : AderScript
+    {
+        // Set by the scene once the text is created
+        public static TextSlot Slot;
+
+        System.Diagnostics.Stopwatch watch = new System.Diagnostics.Stopwatch();
+        int frames = 0;
+
+        public override void Init()
+        {
+            watch.Start();
+        }
+
+        public override void Update()
+        {
+            if (Slot == null)
+            {
+                return;
+            }
+
+            frames++;
+
+            // Only the digits that changed are written
+            double elapsed = watch.Elapsed.TotalSeconds;
+            if (elapsed >= 0.25)
+            {
+                Slot.SetNumber(frames / elapsed, 1);
+                frames = 0;
+                watch.Restart();
+            }
+        }
+    }
+
+    class EmitterScript : AderScript
+    {
+        // Set by the scene once the emitter is created
+        public static ParticleEmitter Emitter;
+
+        System.Diagnostics.Stopwatch watch = new System.Diagnostics.Stopwatch();
+
+        public override void Init()
+        {
+            watch.Start();
+        }
+
+        public override void Update()
+        {
+            if (Emitter == null)
+            {
+                return;
+            }
+
+            // Bursts of 2 seconds with pauses long enough for every particle to
+            // die, so the emitter releases its storage and grows it again
+            bool emitting = watch.Elapsed.TotalSeconds % 5.0 < 2.0;
+            if (emitting != Emitter.Emitting)
+            {
+                Emitter.Emitting = emitting;
+            }
+        }
+    }
+
+    class SpriteScript : AderScript
+    {
+        // Set by the scene once the assets are created
+        public static Texture Texture;
+        public static Shader Shader;
+
+        Sprite[] sprites = new Sprite[1000];
+        float time = 0.0f;
+
+        public override void Init()
+        {
+            // A grid of atlas cells, the layer alternates so the sprites are
+            // sorted before they are drawn
+            for (int i = 0; i < sprites.Length; i++)
+            {
+                sprites[i] = new Sprite(new Vector2(20 + (i % 100) * 12, 200 + (i / 100) * 12), new Vector2(10, 10));
+                sprites[i].TexRect = new Vector4((i % 3) / 3.0f, ((i / 3) % 3) / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f);
+                sprites[i].Layer = i % 2;
+                sprites[i].Color = Sprite.PackColor(new Vector4(1.0f, 1.0f, 1.0f, 0.8f));
+            }
+        }
+
+        public override void Update()
+        {
+            if (Texture == null || Shader == null)
+            {
+                return;
+            }
+
+            time += 0.01f;
+            for (int i = 0; i < sprites.Length; i++)
+            {
+                sprites[i].Rotation = time + i * 0.1f;
+            }
+
+            // One call for the whole array, drawn with a single draw
+            SpriteBatch.Submit(Texture, Shader, sprites);
+        }
+    }
+
     class LogScript : AderScript
     {
         int i = 0;